@@ -101,9 +101,21 @@ INCLUDEPATH += . \
 
 SOURCES +=  src/uas/UAS.cc \
             src/comm/MAVLinkProtocol.cc \
+            src/comm/MAVLinkProtocolWorker.cc \
+            src/comm/MAVLinkMessagePool.cc \
+            src/comm/QGCMAVLinkFrameParser.cc \
+            src/comm/QGCMAVLinkLogWriter.cc \
+            src/comm/QGCMAVLinkLogIndex.cc \
+            src/ui/linechart/QGCRollingStatistics.cc \
+            src/ui/linechart/QGCSeriesStore.cc \
+            src/ui/linechart/QGCSeriesPlotData.cc \
+            src/ui/linechart/QGCSampleRecorder.cc \
+            src/LogCompressor.cc \
+            src/ui/QGCCsvLoader.cc \
             src/uas/UASWaypointManager.cc \
             src/Waypoint.cc \
             src/ui/RadioCalibration/RadioCalibrationData.cc \
+            src/ui/MAVLinkChannelRegistry.cc \
             src/uas/SlugsMAV.cc \
             src/uas/PxQuadMAV.cc \
             src/uas/ArduPilotMegaMAV.cc \
@@ -112,19 +124,51 @@ SOURCES +=  src/uas/UAS.cc \
             src/comm/LinkManager.cc \
             src/QGC.cc \
             src/comm/SerialLink.cc \
+            src/comm/UDPLink.cc \
+            src/comm/MAVLinkSimulationLink.cc \
+            src/comm/MAVLinkSimulationMAV.cc \
+            src/comm/MAVLinkSimulationWaypointPlanner.cc \
+            src/comm/MAVLinkSwarmSimulationLink.cc \
+            src/comm/MAVLinkSwarmSimulationWorker.cc \
             $$TESTDIR/SlugsMavUnitTest.cc \
             $$TESTDIR/testSuite.cc \
             $$TESTDIR/UASUnitTest.cc \
+            $$TESTDIR/MAVLinkProtocolBenchmark.cc \
+            $$TESTDIR/SerialLinkTest.cc \
+            $$TESTDIR/UDPLinkBenchmark.cc \
+            $$TESTDIR/MAVLinkSwarmSimulationTest.cc \
+            $$TESTDIR/QGCMAVLinkLogWriterTest.cc \
+            $$TESTDIR/QGCRollingStatisticsTest.cc \
+            $$TESTDIR/QGCSeriesStoreTest.cc \
+            $$TESTDIR/LinechartBenchmark.cc \
+            $$TESTDIR/QGCSampleRecorderTest.cc \
+            $$TESTDIR/LogCompressorTest.cc \
+            $$TESTDIR/QGCCsvLoaderTest.cc \
     src/uas/QGCMAVLinkUASFactory.cc
 
 
 HEADERS += src/uas/UASInterface.h \
+            src/uas/UASTelemetrySnapshot.h \
+            src/uas/QGCSampleBlock.h \
             src/uas/UAS.h \
             src/comm/MAVLinkProtocol.h \
+            src/comm/MAVLinkProtocolWorker.h \
+            src/comm/MAVLinkMessagePool.h \
+            src/comm/QGCByteRing.h \
+            src/comm/QGCMAVLinkFrameParser.h \
+            src/comm/QGCMAVLinkLogWriter.h \
+            src/comm/QGCMAVLinkLogIndex.h \
             src/comm/ProtocolInterface.h \
             src/uas/UASWaypointManager.h \
             src/Waypoint.h \
             src/ui/RadioCalibration/RadioCalibrationData.h \
+            src/ui/MAVLinkChannelRegistry.h \
+            src/ui/linechart/QGCRollingStatistics.h \
+            src/ui/linechart/QGCSeriesStore.h \
+            src/ui/linechart/QGCSeriesPlotData.h \
+            src/ui/linechart/QGCSampleRecorder.h \
+            src/LogCompressor.h \
+            src/ui/QGCCsvLoader.h \
             src/uas/SlugsMAV.h \
             src/uas/PxQuadMAV.h \
             src/uas/ArduPilotMegaMAV.h \
@@ -135,9 +179,26 @@ HEADERS += src/uas/UASInterface.h \
             src/QGC.h \
             src/comm/SerialLinkInterface.h \
             src/comm/SerialLink.h \
+            src/comm/UDPLink.h \
+            src/comm/MAVLinkSimulationLink.h \
+            src/comm/MAVLinkSimulationMAV.h \
+            src/comm/MAVLinkSimulationWaypointPlanner.h \
+            src/comm/MAVLinkSwarmSimulationLink.h \
+            src/comm/MAVLinkSwarmSimulationWorker.h \
             $$TESTDIR//SlugsMavUnitTest.h \
             $$TESTDIR/AutoTest.h \
             $$TESTDIR/UASUnitTest.h \
+            $$TESTDIR/MAVLinkProtocolBenchmark.h \
+            $$TESTDIR/SerialLinkTest.h \
+            $$TESTDIR/UDPLinkBenchmark.h \
+            $$TESTDIR/MAVLinkSwarmSimulationTest.h \
+            $$TESTDIR/QGCMAVLinkLogWriterTest.h \
+            $$TESTDIR/QGCRollingStatisticsTest.h \
+            $$TESTDIR/QGCSeriesStoreTest.h \
+            $$TESTDIR/LinechartBenchmark.h \
+            $$TESTDIR/QGCSampleRecorderTest.h \
+            $$TESTDIR/LogCompressorTest.h \
+            $$TESTDIR/QGCCsvLoaderTest.h \
     src/uas/QGCMAVLinkUASFactory.h
 
 
@@ -0,0 +1,94 @@
+#include <QImage>
+#include <QPainter>
+#include <qwt_plot_curve.h>
+#include <qwt_scale_map.h>
+#include <math.h>
+#include "LinechartBenchmark.h"
+
+LinechartBenchmark::LinechartBenchmark()
+{
+}
+
+void LinechartBenchmark::fill(QGCSeriesStore& store, int count)
+{
+    qsrand(count);
+    for (int i = 0; i < count; i++)
+    {
+        double value = sin(i * 0.001) + (qrand() % 100) / 1000.0;
+        if (i % 50000 == 1234) value = 100.0;
+        store.append(i, value);
+    }
+    store.setKeepFrom(0);
+}
+
+void LinechartBenchmark::plotData_test()
+{
+    const int width = 800;
+    QGCSeriesStore store;
+    fill(store, 200000);
+
+    QGCSeriesPlotData samples(&store, NULL, width, false);
+    QGCSeriesPlotData envelope(&store, NULL, width);
+    QCOMPARE(samples.size(), (size_t)200000);
+    // Bounded by the width, not by the samples
+    QVERIFY(envelope.size() <= (size_t)(16 * width + 2));
+
+    double lastTime = -1.0;
+    double max = -1.0;
+    for (size_t i = 0; i < envelope.size(); i++)
+    {
+        QVERIFY(envelope.x(i) >= lastTime);
+        lastTime = envelope.x(i);
+        max = qMax(max, envelope.y(i));
+    }
+    // The spikes are still there and the curve ends at the newest sample
+    QCOMPARE(max, 100.0);
+    QCOMPARE(lastTime, 199999.0);
+}
+
+void LinechartBenchmark::replot_benchmark_data()
+{
+    QTest::addColumn<int>("samples");
+    QTest::addColumn<bool>("envelope");
+    QTest::newRow("1k samples") << 1000 << false;
+    QTest::newRow("1k envelope") << 1000 << true;
+    QTest::newRow("10k samples") << 10000 << false;
+    QTest::newRow("10k envelope") << 10000 << true;
+    QTest::newRow("100k samples") << 100000 << false;
+    QTest::newRow("100k envelope") << 100000 << true;
+    QTest::newRow("1M samples") << 1000000 << false;
+    QTest::newRow("1M envelope") << 1000000 << true;
+}
+
+/**
+ * Draws one curve with the whole window on an 800 pixel wide canvas, as
+ * the linechart does on every refresh. Drawing all samples grows with the
+ * window length, the envelope stays flat once it is used.
+ */
+void LinechartBenchmark::replot_benchmark()
+{
+    QFETCH(int, samples);
+    QFETCH(bool, envelope);
+
+    QGCSeriesStore store;
+    fill(store, samples);
+
+    QwtPlotCurve curve;
+    curve.setPaintAttribute(QwtPlotCurve::PaintFiltered);
+    curve.setData(QGCSeriesPlotData(&store, NULL, 800, envelope));
+
+    QwtScaleMap xMap;
+    xMap.setPaintInterval(0, 800);
+    xMap.setScaleInterval(0, samples);
+    QwtScaleMap yMap;
+    yMap.setPaintInterval(300, 0);
+    yMap.setScaleInterval(-2, 2);
+
+    QImage image(800, 300, QImage::Format_RGB32);
+    QPainter painter(&image);
+
+    QBENCHMARK {
+        image.fill(0);
+        curve.draw(&painter, xMap, yMap, 0, -1);
+    }
+}
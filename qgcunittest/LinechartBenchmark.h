@@ -0,0 +1,34 @@
+#ifndef LINECHARTBENCHMARK_H
+#define LINECHARTBENCHMARK_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "linechart/QGCSeriesStore.h"
+#include "linechart/QGCSeriesPlotData.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Checks the level of detail of the linechart curves and measures
+ * the drawing time against the number of samples in the plot window
+ */
+class LinechartBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    LinechartBenchmark();
+
+private slots:
+    void plotData_test();
+    void replot_benchmark_data();
+    void replot_benchmark();
+
+protected:
+    /** @brief Fill the store with a noisy sine and a few spikes */
+    void fill(QGCSeriesStore& store, int count);
+};
+
+DECLARE_TEST(LinechartBenchmark)
+
+#endif // LINECHARTBENCHMARK_H
@@ -0,0 +1,139 @@
+#include <QDir>
+#include "LogCompressorTest.h"
+
+/** @brief Raw log with unsorted keys and timestamps, repeated values, an empty value, a single space and an invalid timestamp */
+static const char* rawLog =
+    "20\t1\troll\t0.5\n"
+    "10\t1\tyaw rate\t-3\n"
+    "10\t1\troll\t0.25\n"
+    "30\t2\tpitch\t7\r\n"
+    "20\t1\troll\t0.75\n"
+    "30\t1\troll\t \n"
+    "40\t1\tyaw rate\t\n"
+    "40\t2\tpitch\t8\n"
+    "x\t1\troll\t9\n";
+
+/** @brief Compressor filling the rows in windows of a few values */
+class SmallWindowCompressor : public LogCompressor
+{
+public:
+    SmallWindowCompressor(QString logFileName, QString outFileName, int cells) :
+        LogCompressor(logFileName, outFileName)
+    {
+        windowCells = cells;
+    }
+};
+
+LogCompressorTest::LogCompressorTest()
+{
+}
+
+void LogCompressorTest::init()
+{
+    fileName = QDir::tempPath() + "/qgc_compressor_test.txt";
+    outName = QDir::tempPath() + "/qgc_compressor_test.csv";
+    QFile::remove(fileName);
+    QFile::remove(outName);
+}
+
+void LogCompressorTest::cleanup()
+{
+    QFile::remove(fileName);
+    QFile::remove(outName);
+}
+
+void LogCompressorTest::writeLog(const QByteArray& log)
+{
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(log);
+}
+
+QByteArray LogCompressorTest::compress(bool holeFilling, const QString& output)
+{
+    LogCompressor compressor(fileName, output);
+    compressor.startCompression(holeFilling);
+    compressor.wait();
+
+    QFile file(output);
+    file.open(QIODevice::ReadOnly | QIODevice::Text);
+    return file.readAll();
+}
+
+void LogCompressorTest::compress_test()
+{
+    writeLog(rawLog);
+    QCOMPARE(compress(false, outName), QByteArray(
+                 "timestamp_ms\tpitch\troll\tyaw_rate\t\n"
+                 "10\t\t0.25\t-3\t\n"
+                 "20\t\t0.75\t\t\n"
+                 "30\t7\t \t\t\n"
+                 "40\t8\t\t\t\n"));
+}
+
+void LogCompressorTest::holeFilling_test()
+{
+    // The values of a row move to the front, the remaining fields are
+    // filled with the previous value at the same position
+    writeLog(rawLog);
+    QCOMPARE(compress(true, outName), QByteArray(
+                 "timestamp_ms\tpitch\troll\tyaw_rate\t\n"
+                 "10\t0.25\t-3\tNaN\n"
+                 "20\t0.75\t-3\tNaN\n"
+                 "30\t7\t \tNaN\n"
+                 "40\t8\t-3\tNaN\n"));
+}
+
+void LogCompressorTest::replace_test()
+{
+    writeLog(rawLog);
+    QByteArray expected = compress(false, outName);
+    QCOMPARE(compress(false, fileName), expected);
+    QVERIFY(!QFile::exists(fileName + ".tmp"));
+}
+
+void LogCompressorTest::window_test()
+{
+    // Timestamps out of order, so the lines of a row are spread over the log
+    QByteArray log = rawLog;
+    qsrand(7);
+    for (int i = 0; i < 20000; i++)
+    {
+        log += QByteArray::number((qrand() % 500) * 10) + "\t1\tchannel" + QByteArray::number(qrand() % 7) + "\t" + QByteArray::number(i) + "\n";
+    }
+    writeLog(log);
+
+    for (int fill = 0; fill < 2; fill++)
+    {
+        const QByteArray expected = compress(fill, outName);
+        const int cells[] = {1, 5, 64};
+        for (unsigned int i = 0; i < sizeof(cells)/sizeof(cells[0]); i++)
+        {
+            SmallWindowCompressor compressor(fileName, outName, cells[i]);
+            compressor.startCompression(fill);
+            compressor.wait();
+            QFile file(outName);
+            QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+            QCOMPARE(file.readAll(), expected);
+        }
+    }
+}
+
+void LogCompressorTest::compress_benchmark()
+{
+    // 100 channels at 100 Hz for one minute
+    QByteArray log;
+    for (int time = 0; time < 60000; time += 10)
+    {
+        for (int channel = 0; channel < 100; channel++)
+        {
+            log += QByteArray::number(time) + "\t1\tchannel" + QByteArray::number(channel) + "\t" + QByteArray::number(qrand() / (double)RAND_MAX, 'g', 18) + "\n";
+        }
+    }
+    writeLog(log);
+
+    QBENCHMARK {
+        compress(true, outName);
+    }
+    QCOMPARE(compress(false, outName).count('\n'), 6000 + 1);
+}
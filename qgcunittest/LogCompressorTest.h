@@ -0,0 +1,42 @@
+#ifndef LOGCOMPRESSORTEST_H
+#define LOGCOMPRESSORTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "LogCompressor.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the conversion of raw linechart logs into CSV files
+ */
+class LogCompressorTest : public QObject
+{
+    Q_OBJECT
+public:
+    LogCompressorTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void compress_test();
+    void holeFilling_test();
+    void replace_test();
+    void window_test();
+    void compress_benchmark();
+
+protected:
+    /** @brief Write a raw log */
+    void writeLog(const QByteArray& log);
+    /** @brief Run the compressor and return the output */
+    QByteArray compress(bool holeFilling, const QString& output);
+
+    QString fileName;
+    QString outName;
+};
+
+DECLARE_TEST(LogCompressorTest)
+
+#endif // LOGCOMPRESSORTEST_H
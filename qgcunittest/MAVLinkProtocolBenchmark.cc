@@ -0,0 +1,399 @@
+#include "MAVLinkProtocolBenchmark.h"
+
+MAVLinkProtocolBenchmark::MAVLinkProtocolBenchmark() :
+    mav(NULL),
+    link(NULL),
+    arrived(0)
+{
+}
+
+void MAVLinkProtocolBenchmark::initTestCase()
+{
+    mav = new MAVLinkProtocol();
+    link = new SerialLink();
+}
+
+void MAVLinkProtocolBenchmark::cleanupTestCase()
+{
+    deleteSystems();
+    delete link;
+    delete mav;
+}
+
+void MAVLinkProtocolBenchmark::createSystems(int count)
+{
+    deleteSystems();
+    for (int i = 1; i <= count; i++)
+    {
+        UAS* uas = new UAS(mav, i);
+        mav->addSystemRoute(uas);
+        systems.append(uas);
+    }
+}
+
+void MAVLinkProtocolBenchmark::deleteSystems()
+{
+    qDeleteAll(systems);
+    systems.clear();
+}
+
+void MAVLinkProtocolBenchmark::dispatchRoutes_test()
+{
+    createSystems(3);
+
+    // Every system gets its own route
+    QCOMPARE(mav->getSystemRoute(1), systems.at(0));
+    QCOMPARE(mav->getSystemRoute(3), systems.at(2));
+    QVERIFY(mav->getSystemRoute(4) == NULL);
+
+    // Routes are dropped with the UAS object
+    delete systems.takeAt(1);
+    QVERIFY(mav->getSystemRoute(2) == NULL);
+    QCOMPARE(mav->getSystemRoute(3), systems.at(1));
+
+    deleteSystems();
+    QVERIFY(mav->getSystemRoute(1) == NULL);
+}
+
+void MAVLinkProtocolBenchmark::dispatch_benchmark_data()
+{
+    QTest::addColumn<int>("vehicles");
+    QTest::newRow("1 vehicle") << 1;
+    QTest::newRow("10 vehicles") << 10;
+    QTest::newRow("40 vehicles") << 40;
+    QTest::newRow("100 vehicles") << 100;
+}
+
+/**
+ * Dispatches one batch of 1000 attitude messages spread over all vehicles.
+ * With the dispatch table the time per batch stays flat with growing
+ * vehicle count, as every message reaches exactly one UAS.
+ */
+void MAVLinkProtocolBenchmark::dispatch_benchmark()
+{
+    QFETCH(int, vehicles);
+    createSystems(vehicles);
+
+    QList<MAVLinkMessageHandle> messages;
+    for (int i = 0; i < 1000; i++)
+    {
+        MAVLinkMessageHandle msg = MAVLinkMessageHandle::create();
+        mavlink_msg_attitude_pack(1 + (i % vehicles), MAV_COMP_ID_IMU, msg.data(), i, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+        messages.append(msg);
+    }
+
+    QBENCHMARK
+    {
+        foreach (const MAVLinkMessageHandle& msg, messages)
+        {
+            mav->dispatchMessage(link, msg);
+        }
+    }
+
+    deleteSystems();
+}
+
+/**
+ * Creates a byte stream of typical telemetry: heartbeats, attitude and
+ * position messages of several systems, optionally with corrupted frames
+ * and garbage between them.
+ */
+QByteArray MAVLinkProtocolBenchmark::recordTraffic(int bytes, bool corrupt)
+{
+    QByteArray traffic;
+    traffic.reserve(bytes + MAVLINK_MAX_PACKET_LEN);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int i = 0;
+    qsrand(42);
+    while (traffic.size() < bytes)
+    {
+        mavlink_message_t msg;
+        int sysid = 1 + (i % 8);
+        switch (i % 4)
+        {
+        case 0:
+            mavlink_msg_heartbeat_pack(sysid, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_GENERIC, 0, 0, MAV_STATE_ACTIVE);
+            break;
+        case 1:
+            mavlink_msg_global_position_int_pack(sysid, 1, &msg, i, 473977420, 85455940, 500000, 10000, 10, 20, 30, 9000);
+            break;
+        default:
+            mavlink_msg_attitude_pack(sysid, 1, &msg, i, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+            break;
+        }
+        int len = mavlink_msg_to_send_buffer(buffer, &msg);
+        if (corrupt && (qrand() % 8) == 0)
+        {
+            buffer[qrand() % len] ^= 0x10;
+            traffic.append(MAVLINK_STX);
+        }
+        traffic.append((const char*)buffer, len);
+        i++;
+    }
+    return traffic;
+}
+
+void MAVLinkProtocolBenchmark::frameParser_test()
+{
+    QByteArray traffic = recordTraffic(256*1024, true);
+
+    // Reference: the byte-wise parser of the MAVLink library
+    QList<QByteArray> reference;
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    for (int i = 0; i < traffic.size(); i++)
+    {
+        if (mavlink_parse_char(MAVLINK_COMM_1, (uint8_t)traffic.at(i), &msg, &status))
+        {
+            reference.append(QByteArray((const char*)&msg, sizeof(msg)));
+        }
+    }
+
+    // Feed odd chunk sizes to cut frames at every possible position
+    QList<QByteArray> parsed;
+    QGCMAVLinkFrameParser parser;
+    for (int pos = 0; pos < traffic.size(); pos += 333)
+    {
+        parser.setData(traffic.constData() + pos, qMin(333, traffic.size() - pos));
+        while (parser.next(&msg))
+        {
+            parsed.append(QByteArray((const char*)&msg, sizeof(msg)));
+        }
+    }
+
+    QCOMPARE(parsed.size(), reference.size());
+    for (int i = 0; i < parsed.size(); i++)
+    {
+        const mavlink_message_t* a = (const mavlink_message_t*)parsed.at(i).constData();
+        const mavlink_message_t* b = (const mavlink_message_t*)reference.at(i).constData();
+        QCOMPARE(a->msgid, b->msgid);
+        QCOMPARE(a->seq, b->seq);
+        QCOMPARE(a->sysid, b->sysid);
+        QVERIFY(memcmp(_MAV_PAYLOAD(a), _MAV_PAYLOAD(b), a->len + MAVLINK_NUM_CHECKSUM_BYTES) == 0);
+    }
+}
+
+void MAVLinkProtocolBenchmark::parse_benchmark_data()
+{
+    QTest::addColumn<int>("rate");
+    QTest::addColumn<bool>("bulk");
+    QTest::newRow("1 MB/s byte-wise") << 1 << false;
+    QTest::newRow("1 MB/s bulk") << 1 << true;
+    QTest::newRow("10 MB/s byte-wise") << 10 << false;
+    QTest::newRow("10 MB/s bulk") << 10 << true;
+    QTest::newRow("100 MB/s byte-wise") << 100 << false;
+    QTest::newRow("100 MB/s bulk") << 100 << true;
+}
+
+/**
+ * Parses 100 ms of traffic at the given rate in chunks of 4 KB, as the
+ * protocol worker receives them.
+ */
+void MAVLinkProtocolBenchmark::parse_benchmark()
+{
+    QFETCH(int, rate);
+    QFETCH(bool, bulk);
+    QByteArray traffic = recordTraffic(rate * 1024 * 1024 / 10, false);
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    QGCMAVLinkFrameParser parser;
+    int count = 0;
+
+    QBENCHMARK
+    {
+        for (int pos = 0; pos < traffic.size(); pos += 4096)
+        {
+            int length = qMin(4096, traffic.size() - pos);
+            if (bulk)
+            {
+                parser.setData(traffic.constData() + pos, length);
+                while (parser.next(&msg)) count++;
+            }
+            else
+            {
+                for (int i = pos; i < pos + length; i++)
+                {
+                    count += mavlink_parse_char(MAVLINK_COMM_2, (uint8_t)traffic.at(i), &msg, &status);
+                }
+            }
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+/** @brief Thread allocating messages, to release them in another thread */
+class MessageAllocatingThread : public QThread
+{
+public:
+    QVector<MAVLinkMessageHandle> first;
+    QVector<MAVLinkMessageHandle> second;
+    QSemaphore ready;
+    QSemaphore proceed;
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < 100; i++) first.append(MAVLinkMessageHandle::create());
+        ready.release();
+        proceed.acquire();
+        for (int i = 0; i < 100; i++) second.append(MAVLinkMessageHandle::create());
+    }
+};
+
+void MAVLinkProtocolBenchmark::messagePool_test()
+{
+    // Blocks are recycled in the allocating thread
+    {
+        MAVLinkMessageHandle warmup = MAVLinkMessageHandle::create();
+    }
+    unsigned int allocations = MAVLinkMessagePool::getAllocations();
+    for (int i = 0; i < 1000; i++)
+    {
+        MAVLinkMessageHandle msg = MAVLinkMessageHandle::create();
+    }
+    QCOMPARE(MAVLinkMessagePool::getAllocations(), allocations);
+
+    // Copies share the message, only the last one returns it
+    MAVLinkMessageHandle a = MAVLinkMessageHandle::create();
+    mavlink_msg_attitude_pack(1, MAV_COMP_ID_IMU, a.data(), 1, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+    QVERIFY(!a.isShared());
+    MAVLinkMessageHandle b = a;
+    QVERIFY(a.isShared());
+    QCOMPARE(b.constData(), a.constData());
+    QCOMPARE(b->msgid, (uint8_t)MAVLINK_MSG_ID_ATTITUDE);
+    b = MAVLinkMessageHandle();
+    QVERIFY(b.isNull());
+    QVERIFY(!a.isShared());
+
+    // Blocks released in another thread return to the pool of the
+    // allocating thread, which reuses them instead of the heap
+    MessageAllocatingThread* thread = new MessageAllocatingThread();
+    thread->start();
+    thread->ready.acquire();
+    allocations = MAVLinkMessagePool::getAllocations();
+    thread->first.clear();
+    thread->proceed.release();
+    QVERIFY(thread->wait(5000));
+    QCOMPARE(MAVLinkMessagePool::getAllocations(), allocations);
+
+    // The second set outlives its thread and is freed with the last handle
+    QCOMPARE(thread->second.size(), 100);
+    QCOMPARE(thread->second.first()->len, thread->second.last()->len);
+    delete thread;
+}
+
+void MAVLinkProtocolBenchmark::fanout_benchmark_data()
+{
+    QTest::addColumn<bool>("pooled");
+    QTest::newRow("value copies") << false;
+    QTest::newRow("pooled handles") << true;
+}
+
+/**
+ * Parses 64 KB of telemetry into a batch, hands the batch over as the
+ * protocol worker does and delivers every message to five listeners which
+ * keep the last message per ID, like the inspector. Without the pool each
+ * hand-over is a copy of the whole message.
+ */
+void MAVLinkProtocolBenchmark::fanout_benchmark()
+{
+    QFETCH(bool, pooled);
+    const int listeners = 5;
+    QByteArray traffic = recordTraffic(64*1024, false);
+    QGCMAVLinkFrameParser parser;
+    static mavlink_message_t latest[listeners][256];
+    static MAVLinkMessageHandle latestHandles[listeners][256];
+    unsigned int allocations = MAVLinkMessagePool::getAllocations();
+    int count = 0;
+    int passCount = 0;
+
+    QBENCHMARK
+    {
+        parser.setData(traffic.constData(), traffic.size());
+        if (pooled)
+        {
+            QVector<MAVLinkMessageHandle> batch;
+            MAVLinkMessageHandle handle = MAVLinkMessageHandle::create();
+            while (parser.next(handle.data()))
+            {
+                batch.append(handle);
+                handle = MAVLinkMessageHandle::create();
+            }
+            foreach (const MAVLinkMessageHandle& msg, batch)
+            {
+                for (int i = 0; i < listeners; i++)
+                {
+                    latestHandles[i][msg->msgid] = msg;
+                }
+                count++;
+            }
+            passCount = batch.size();
+        }
+        else
+        {
+            QVector<mavlink_message_t> batch;
+            mavlink_message_t message;
+            while (parser.next(&message))
+            {
+                batch.append(message);
+            }
+            foreach (const mavlink_message_t& msg, batch)
+            {
+                for (int i = 0; i < listeners; i++)
+                {
+                    latest[i][msg.msgid] = msg;
+                }
+                count++;
+            }
+        }
+    }
+    QVERIFY(count > 0);
+
+    if (pooled)
+    {
+        // Only the first pass allocates, later passes recycle its blocks
+        // except for the last message per ID kept by the listeners
+        QVERIFY(MAVLinkMessagePool::getAllocations() - allocations <= (unsigned int)passCount + 1 + 256);
+        for (int i = 0; i < listeners; i++)
+        {
+            for (int j = 0; j < 256; j++) latestHandles[i][j] = MAVLinkMessageHandle();
+        }
+    }
+}
+
+void MAVLinkProtocolBenchmark::messageArrived(LinkInterface* link, MAVLinkMessageHandle message)
+{
+    Q_UNUSED(link);
+    Q_UNUSED(message);
+    arrived++;
+}
+
+/**
+ * Measures the time from handing the bytes of one message to the protocol,
+ * as the link thread does, until the message is delivered in the GUI
+ * thread. The bytes pass the ring of the link, the protocol worker and the
+ * queued batch.
+ */
+void MAVLinkProtocolBenchmark::latency_benchmark()
+{
+    connect(mav, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), this, SLOT(messageArrived(LinkInterface*,MAVLinkMessageHandle)));
+    mavlink_message_t msg;
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    mavlink_msg_heartbeat_pack(200, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_GENERIC, 0, 0, MAV_STATE_ACTIVE);
+    QByteArray heartbeat((const char*)buffer, mavlink_msg_to_send_buffer(buffer, &msg));
+
+    QBENCHMARK
+    {
+        const int expected = arrived + 1;
+        mav->receiveBytes(link, heartbeat);
+        QTime timeout;
+        timeout.start();
+        while (arrived < expected && timeout.elapsed() < 1000)
+        {
+            QCoreApplication::processEvents();
+        }
+        QCOMPARE(arrived, expected);
+    }
+
+    disconnect(mav, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), this, SLOT(messageArrived(LinkInterface*,MAVLinkMessageHandle)));
+}
@@ -0,0 +1,54 @@
+#ifndef MAVLINKPROTOCOLBENCHMARK_H
+#define MAVLINKPROTOCOLBENCHMARK_H
+
+#include <QObject>
+#include <QList>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "UAS.h"
+#include "MAVLinkProtocol.h"
+#include "SerialLink.h"
+#include "QGCMAVLinkFrameParser.h"
+#include "MAVLinkMessagePool.h"
+#include "AutoTest.h"
+
+class MAVLinkProtocolBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkProtocolBenchmark();
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void dispatchRoutes_test();
+    void dispatch_benchmark_data();
+    void dispatch_benchmark();
+    void frameParser_test();
+    void parse_benchmark_data();
+    void parse_benchmark();
+    void messagePool_test();
+    void fanout_benchmark_data();
+    void fanout_benchmark();
+    void latency_benchmark();
+
+protected slots:
+    /** @brief Count the messages delivered by the protocol */
+    void messageArrived(LinkInterface* link, MAVLinkMessageHandle message);
+
+protected:
+    void createSystems(int count);
+    void deleteSystems();
+    QByteArray recordTraffic(int bytes, bool corrupt);
+
+    MAVLinkProtocol* mav;
+    SerialLink* link;
+    QList<UAS*> systems;
+    int arrived;
+};
+
+DECLARE_TEST(MAVLinkProtocolBenchmark)
+
+#endif // MAVLINKPROTOCOLBENCHMARK_H
@@ -0,0 +1,82 @@
+#include "MAVLinkSwarmSimulationTest.h"
+
+MAVLinkSwarmSimulationTest::MAVLinkSwarmSimulationTest() :
+    link(NULL),
+    unexpected(0)
+{
+}
+
+void MAVLinkSwarmSimulationTest::receiveBytes(LinkInterface* from, QByteArray data)
+{
+    Q_UNUSED(from);
+    QMutexLocker locker(&receivedMutex);
+    mavlink_message_t msg;
+    mavlink_status_t status;
+    for (int i = 0; i < data.size(); i++)
+    {
+        if (mavlink_parse_char(MAVLINK_COMM_0, data.at(i), &msg, &status))
+        {
+            if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) frames[msg.sysid]++;
+            else unexpected++;
+        }
+    }
+}
+
+void MAVLinkSwarmSimulationTest::init()
+{
+    frames.clear();
+    unexpected = 0;
+    link = new MAVLinkSwarmSimulationLink();
+    connect(link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+}
+
+void MAVLinkSwarmSimulationTest::cleanup()
+{
+    // Also stops and deletes the workers
+    delete link;
+    link = NULL;
+}
+
+int MAVLinkSwarmSimulationTest::framesReceived()
+{
+    QMutexLocker locker(&receivedMutex);
+    int count = 0;
+    foreach (int vehicleFrames, frames) count += vehicleFrames;
+    return count;
+}
+
+/**
+ * Three vehicles on two workers only send heartbeats at 20 Hz. Every
+ * vehicle has to show up with its own system ID and all generated frames
+ * have to arrive intact.
+ */
+void MAVLinkSwarmSimulationTest::systemIds_test()
+{
+    const int vehicles = 3;
+    link->setVehicleCount(vehicles);
+    link->setWorkerCount(2);
+    for (int i = 0; i < 256; i++) link->setMessageRate(i, 0.0f);
+    link->setMessageRate(MAVLINK_MSG_ID_HEARTBEAT, 20.0f);
+
+    QVERIFY(link->connect());
+    for (int i = 0; i < 300 && framesReceived() < vehicles * 20; i++)
+    {
+        QTest::qSleep(10);
+    }
+    QVERIFY(link->disconnect());
+
+    QCOMPARE(link->getFramesLost(), (quint64)0);
+    QCOMPARE(link->getFramesDropped(), (quint64)0);
+    QVERIFY(framesReceived() >= vehicles * 20);
+    // Frames still queued in the rings at disconnect are not emitted
+    QVERIFY((quint64)framesReceived() <= link->getFramesSent());
+
+    QMutexLocker locker(&receivedMutex);
+    QCOMPARE(unexpected, 0);
+    QCOMPARE(frames.keys(), QList<int>() << 1 << 2 << 3);
+    foreach (int vehicleFrames, frames)
+    {
+        // All vehicles send at the same rate
+        QVERIFY(vehicleFrames >= 10);
+    }
+}
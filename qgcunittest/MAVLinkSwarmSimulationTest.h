@@ -0,0 +1,44 @@
+#ifndef MAVLINKSWARMSIMULATIONTEST_H
+#define MAVLINKSWARMSIMULATIONTEST_H
+
+#include <QObject>
+#include <QMutex>
+#include <QMap>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "MAVLinkSwarmSimulationLink.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the traffic generated by the swarm simulation link
+ */
+class MAVLinkSwarmSimulationTest : public QObject
+{
+    Q_OBJECT
+public:
+    MAVLinkSwarmSimulationTest();
+
+public slots:
+    /** @brief Parse the bytes emitted by the link, called in the link thread */
+    void receiveBytes(LinkInterface* from, QByteArray data);
+
+private slots:
+    void init();
+    void cleanup();
+
+    void systemIds_test();
+
+protected:
+    /** @brief Get the number of frames parsed since init() */
+    int framesReceived();
+
+    MAVLinkSwarmSimulationLink* link;
+    QMutex receivedMutex;
+    QMap<int, int> frames;  ///< Parsed heartbeats per system ID
+    int unexpected;         ///< Parsed frames other than heartbeats
+};
+
+DECLARE_TEST(MAVLinkSwarmSimulationTest)
+
+#endif // MAVLINKSWARMSIMULATIONTEST_H
@@ -0,0 +1,175 @@
+#include <QDir>
+#include <cmath>
+#include "QGCCsvLoaderTest.h"
+
+QGCCsvLoaderTest::QGCCsvLoaderTest()
+{
+}
+
+void QGCCsvLoaderTest::init()
+{
+    fileName = QDir::tempPath() + "/qgc_csv_loader_test.csv";
+    QFile::remove(fileName);
+}
+
+void QGCCsvLoaderTest::cleanup()
+{
+    QFile::remove(fileName);
+}
+
+QList<QGCCsvLoader::Block*> QGCCsvLoaderTest::load(const QByteArray& log, const QByteArray& separator, const QVector<int>& columns, const QVector<int>& curves, int chunkSize)
+{
+    const QByteArray header = "time" + separator + "a" + separator + "b\n";
+    QFile file(fileName);
+    file.open(QIODevice::WriteOnly);
+    file.write(header);
+    file.write(log);
+    file.close();
+
+    QGCCsvLoader loader;
+    loader.setChunkSize(chunkSize);
+    loader.load(fileName, header.size(), separator, 0, columns, curves);
+    loader.wait();
+    QList<QGCCsvLoader::Block*> blocks;
+    if (!loader.isDone()) return blocks;
+    QGCCsvLoader::Block* block;
+    while ((block = loader.takeBlock()) != NULL) {
+        blocks.append(block);
+    }
+    return blocks;
+}
+
+void QGCCsvLoaderTest::parse_test()
+{
+    // Accepted values must convert exactly like QString::toDouble()
+    QStringList texts;
+    texts << "0" << "-0" << "+1" << " 3.25\t" << ".5" << "5." << "-.5e3" << "00012.5000"
+          << "0.1" << "0.30000000000000004" << "9007199254740993" << "123456789012345678901"
+          << "1e22" << "1e23" << "1e-22" << "1e-23" << "1.7976931348623157e308" << "4.9e-324"
+          << "1e400" << "0e999999" << "1.00000000000000000000001"
+          << "" << "  " << "1e" << "e5" << "." << "-" << "abc" << "0x10" << "1,5" << "1.5f" << "1 2";
+    qsrand(1);
+    for (int i = 0; i < 100000; i++)
+    {
+        const double value = (qrand() - RAND_MAX / 2) * pow(10.0, qrand() % 40 - 20) / (qrand() + 1);
+        texts << QString::number(value, 'g', qrand() % 18 + 1);
+        texts << QString::number(value, 'f', qrand() % 8);
+        texts << QString::number(value, 'e', qrand() % 16);
+    }
+
+    foreach (const QString& text, texts)
+    {
+        const QByteArray bytes = text.toLatin1();
+        double value = 0;
+        const bool ok = QGCCsvLoader::parseValue(bytes.constData(), bytes.constData() + bytes.size(), &value);
+        bool expectedOk = !text.trimmed().isEmpty();
+        const double expected = expectedOk ? text.trimmed().toDouble(&expectedOk) : 0;
+        QCOMPARE(ok, expectedOk);
+        if (ok) QVERIFY(value == expected);
+    }
+}
+
+void QGCCsvLoaderTest::load_test()
+{
+    QByteArray log;
+    QVector<double> x[2];
+    QVector<double> y[2];
+    for (int i = 0; i < 5000; i++)
+    {
+        const QByteArray time = QByteArray::number(i * 0.5);
+        switch (i % 5)
+        {
+        case 0:
+            // Lines without a valid x value are skipped
+            log += (i % 10) ? "\n" : "x,1,2\n";
+            break;
+        case 1:
+            // Short line with Windows line ending
+            log += time + "," + QByteArray::number(i) + "\r\n";
+            x[0].append(i * 0.5);
+            y[0].append(i);
+            break;
+        case 2:
+            // Empty and invalid values
+            log += time + ",, nan ,\n";
+            break;
+        default:
+            log += time + "," + QByteArray::number(i * 0.1, 'g', 17) + ", " + QByteArray::number(-i) + " \n";
+            x[0].append(i * 0.5);
+            y[0].append(i * 0.1);
+            x[1].append(i * 0.5);
+            y[1].append(-i);
+            break;
+        }
+    }
+
+    // Small chunks split the log into many windows and blocks
+    QVector<int> columns;
+    QVector<int> curves;
+    columns << 1 << 2;
+    curves << 0 << 1;
+    foreach (int chunkSize, QList<int>() << 100 << 1000000)
+    {
+        QList<QGCCsvLoader::Block*> blocks = load(log, ",", columns, curves, chunkSize);
+        QVERIFY(!blocks.isEmpty());
+        QVector<double> loadedX[2];
+        QVector<double> loadedY[2];
+        int progress = 0;
+        foreach (QGCCsvLoader::Block* block, blocks)
+        {
+            QCOMPARE(block->x.size(), 2);
+            QVERIFY(block->progress >= progress);
+            progress = block->progress;
+            for (int i = 0; i < 2; i++)
+            {
+                loadedX[i] += block->x.at(i);
+                loadedY[i] += block->y.at(i);
+            }
+        }
+        qDeleteAll(blocks);
+        QCOMPARE(progress, 100);
+        for (int i = 0; i < 2; i++)
+        {
+            QCOMPARE(loadedX[i], x[i]);
+            QCOMPARE(loadedY[i], y[i]);
+        }
+    }
+
+    // Multi character separator, the same column plotted twice into one curve
+    columns.clear();
+    curves.clear();
+    columns << 2 << 2;
+    curves << 0 << 0;
+    QList<QGCCsvLoader::Block*> blocks = load("1; 2; 3\n2;;4", "; ", columns, curves, 1000);
+    QCOMPARE(blocks.size(), 1);
+    QCOMPARE(blocks.first()->y.first(), QVector<double>() << 3 << 3);
+    qDeleteAll(blocks);
+}
+
+void QGCCsvLoaderTest::load_benchmark()
+{
+    // 20 columns, 200000 lines
+    QByteArray log;
+    for (int i = 0; i < 200000; i++)
+    {
+        log += QByteArray::number(i * 10);
+        for (int j = 1; j < 20; j++)
+        {
+            log += "\t" + QByteArray::number(qrand() / (double)RAND_MAX * 100, 'g', 6);
+        }
+        log += "\n";
+    }
+    QVector<int> columns;
+    QVector<int> curves;
+    for (int j = 1; j < 20; j++)
+    {
+        columns << j;
+        curves << j - 1;
+    }
+
+    QBENCHMARK {
+        QList<QGCCsvLoader::Block*> blocks = load(log, "\t", columns, curves, QGCCsvLoader::defaultChunkSize);
+        QVERIFY(!blocks.isEmpty());
+        qDeleteAll(blocks);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef QGCCSVLOADERTEST_H
+#define QGCCSVLOADERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "QGCCsvLoader.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the parallel loading of CSV logs into plot curves
+ */
+class QGCCsvLoaderTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCCsvLoaderTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void parse_test();
+    void load_test();
+    void load_benchmark();
+
+protected:
+    /** @brief Write a log and load the value columns, one curve per column */
+    QList<QGCCsvLoader::Block*> load(const QByteArray& log, const QByteArray& separator, const QVector<int>& columns, const QVector<int>& curves, int chunkSize);
+
+    QString fileName;
+};
+
+DECLARE_TEST(QGCCsvLoaderTest)
+
+#endif // QGCCSVLOADERTEST_H
@@ -0,0 +1,181 @@
+#include <QDir>
+#include "QGCMAVLinkLogWriterTest.h"
+
+QGCMAVLinkLogWriterTest::QGCMAVLinkLogWriterTest()
+{
+}
+
+void QGCMAVLinkLogWriterTest::init()
+{
+    fileName = QDir::tempPath() + "/qgc_logwriter_test.mavlink";
+    QFile::remove(fileName);
+}
+
+void QGCMAVLinkLogWriterTest::cleanup()
+{
+    QFile::remove(fileName);
+    QFile::remove(QGCMAVLinkLogIndex::sidecarName(fileName));
+}
+
+mavlink_message_t QGCMAVLinkLogWriterTest::heartbeat(int sysid)
+{
+    mavlink_message_t msg;
+    mavlink_msg_heartbeat_pack(sysid, 1, &msg, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PIXHAWK, 0, 0, 0);
+    return msg;
+}
+
+void QGCMAVLinkLogWriterTest::variableLength_test()
+{
+    const int count = 1000;
+    QGCMAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(!writer.isLegacyFormat());
+    for (int i = 0; i < count; i++)
+    {
+        QVERIFY(writer.log(1000 + i, heartbeat(1 + (i % 10))));
+    }
+    writer.close();
+    QVERIFY(!writer.isOpen());
+    QCOMPARE(writer.getRecordsLogged(), (quint64)count);
+    QCOMPARE(writer.getRecordsDropped(), (quint64)0);
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(QGCMAVLinkLogWriter::hasFileHeader(&file));
+    QCOMPARE(file.read(QGCMAVLinkLogWriter::headerLength), QGCMAVLinkLogWriter::fileHeader());
+
+    // Each record holds the timestamp and the packet without padding
+    const int recordLength = sizeof(quint64) + MAVLINK_MSG_ID_HEARTBEAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    QCOMPARE(file.size(), (qint64)(QGCMAVLinkLogWriter::headerLength + count * recordLength));
+    QCOMPARE(writer.getBytesWritten(), (quint64)(count * recordLength));
+
+    for (int i = 0; i < count; i++)
+    {
+        QByteArray record = file.read(recordLength);
+        QCOMPARE(record.size(), recordLength);
+        quint64 time;
+        memcpy(&time, record.constData(), sizeof(quint64));
+        QCOMPARE(time, (quint64)(1000 + i));
+        QCOMPARE((quint8)record.at(sizeof(quint64)), (quint8)MAVLINK_STX);
+        QCOMPARE((int)(quint8)record.at(sizeof(quint64) + 3), 1 + (i % 10));
+    }
+}
+
+void QGCMAVLinkLogWriterTest::append_test()
+{
+    QGCMAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    writer.log(1, heartbeat(1));
+    writer.close();
+    QVERIFY(writer.open(fileName));
+    QVERIFY(!writer.isLegacyFormat());
+    writer.log(2, heartbeat(1));
+    writer.close();
+
+    // Only one file header
+    const int recordLength = sizeof(quint64) + MAVLINK_MSG_ID_HEARTBEAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    QCOMPARE(QFileInfo(fileName).size(), (qint64)(QGCMAVLinkLogWriter::headerLength + 2 * recordLength));
+}
+
+void QGCMAVLinkLogWriterTest::legacyAppend_test()
+{
+    // Write one legacy record by hand
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QByteArray record(QGCMAVLinkLogWriter::legacyRecordLength, '\0');
+    quint64 time = 1;
+    memcpy(record.data(), &time, sizeof(quint64));
+    mavlink_message_t msg = heartbeat(1);
+    mavlink_msg_to_send_buffer(reinterpret_cast<uint8_t*>(record.data()) + sizeof(quint64), &msg);
+    file.write(record);
+    file.close();
+
+    QGCMAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    QVERIFY(writer.isLegacyFormat());
+    writer.log(2, heartbeat(1));
+    writer.close();
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(!QGCMAVLinkLogWriter::hasFileHeader(&file));
+    QCOMPARE(file.size(), (qint64)(2 * QGCMAVLinkLogWriter::legacyRecordLength));
+}
+
+void QGCMAVLinkLogWriterTest::index_test()
+{
+    const int count = 1000;
+    QGCMAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    for (int i = 0; i < count; i++)
+    {
+        writer.log(1000 * i, heartbeat(1));
+    }
+    writer.close();
+
+    QGCMAVLinkLogIndex index;
+    index.open(fileName);
+    for (int i = 0; i < 500 && !index.isReady(); i++)
+    {
+        QTest::qWait(10);
+    }
+    QVERIFY(index.isReady());
+    QCOMPARE(index.getPacketCount(), (quint32)count);
+    QCOMPARE(index.getStartTime(), (quint64)0);
+    QCOMPARE(index.getEndTime(), (quint64)(1000 * (count - 1)));
+    QCOMPARE(index.getDataOffset(), (qint64)QGCMAVLinkLogWriter::headerLength);
+    QVERIFY(index.isMonotonic());
+
+    // Closest indexed record before the time and packet
+    const int recordLength = sizeof(quint64) + MAVLINK_MSG_ID_HEARTBEAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    QGCMAVLinkLogIndex::Entry entry;
+    QVERIFY(index.findTime(600500, &entry));
+    QCOMPARE(entry.packet, (quint32)512);
+    QCOMPARE(entry.offset, (qint64)(QGCMAVLinkLogWriter::headerLength + 512 * recordLength));
+    QVERIFY(index.findPacket(count - 1, &entry));
+    QCOMPARE(entry.packet, (quint32)768);
+    QVERIFY(!index.findPacket(count, &entry));
+
+    // The second open loads the sidecar
+    index.close();
+    QVERIFY(QFile::exists(QGCMAVLinkLogIndex::sidecarName(fileName)));
+    index.open(fileName);
+    QVERIFY(index.isReady());
+    QCOMPARE(index.getPacketCount(), (quint32)count);
+}
+
+void QGCMAVLinkLogWriterTest::nonMonotonicIndex_test()
+{
+    // The clock is reset after 600 records
+    const int count = 1000;
+    QGCMAVLinkLogWriter writer;
+    QVERIFY(writer.open(fileName));
+    for (int i = 0; i < count; i++)
+    {
+        writer.log(1000 * (i < 600 ? i : i - 600), heartbeat(1));
+    }
+    writer.close();
+
+    QGCMAVLinkLogIndex index;
+    index.open(fileName);
+    for (int i = 0; i < 500 && !index.isReady(); i++)
+    {
+        QTest::qWait(10);
+    }
+    QVERIFY(index.isReady());
+    QVERIFY(!index.isMonotonic());
+
+    // The entry where the log first reaches the time
+    QGCMAVLinkLogIndex::Entry entry;
+    QVERIFY(index.findTime(300500, &entry));
+    QCOMPARE(entry.packet, (quint32)256);
+    QVERIFY(index.findTime(50, &entry));
+    QCOMPARE(entry.packet, (quint32)0);
+
+    // The flag is kept in the sidecar
+    index.close();
+    index.open(fileName);
+    QVERIFY(index.isReady());
+    QVERIFY(!index.isMonotonic());
+    QVERIFY(index.findTime(300500, &entry));
+    QCOMPARE(entry.packet, (quint32)256);
+}
@@ -0,0 +1,41 @@
+#ifndef QGCMAVLINKLOGWRITERTEST_H
+#define QGCMAVLINKLOGWRITERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "QGCMAVLinkLogWriter.h"
+#include "QGCMAVLinkLogIndex.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the record formats written by the background packet logger
+ * and the time index built over them
+ */
+class QGCMAVLinkLogWriterTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCMAVLinkLogWriterTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void variableLength_test();
+    void append_test();
+    void legacyAppend_test();
+    void index_test();
+    void nonMonotonicIndex_test();
+
+protected:
+    /** @brief Pack a heartbeat with the given system id */
+    mavlink_message_t heartbeat(int sysid);
+
+    QString fileName;
+};
+
+DECLARE_TEST(QGCMAVLinkLogWriterTest)
+
+#endif // QGCMAVLINKLOGWRITERTEST_H
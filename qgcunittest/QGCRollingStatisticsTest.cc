@@ -0,0 +1,112 @@
+#include <qnumeric.h>
+#include "QGCRollingStatisticsTest.h"
+
+QGCRollingStatisticsTest::QGCRollingStatisticsTest()
+{
+}
+
+double QGCRollingStatisticsTest::quantile(QList<double> values, double q)
+{
+    qSort(values);
+    double position = q * (values.count() - 1);
+    int below = static_cast<int>(position);
+    if (below + 1 >= values.count()) return values.at(below);
+    return values.at(below) + (position - below) * (values.at(below + 1) - values.at(below));
+}
+
+void QGCRollingStatisticsTest::statistics_test()
+{
+    const int windows[] = {1, 2, 7, 50};
+    for (unsigned int w = 0; w < sizeof(windows)/sizeof(windows[0]); w++)
+    {
+        QGCRollingStatistics statistics(windows[w]);
+        QList<double> window;
+        qsrand(windows[w]);
+        for (int i = 0; i < 2000; i++)
+        {
+            // Few distinct values to get duplicates in the window
+            double value = (qrand() % 100) / 8.0 - 5.0;
+            statistics.append(value);
+            window.append(value);
+            if (window.count() > windows[w]) window.removeFirst();
+
+            double mean = 0.0;
+            foreach (double v, window) mean += v;
+            mean /= window.count();
+            double variance = 0.0;
+            foreach (double v, window) variance += (v - mean) * (v - mean);
+            variance /= window.count();
+
+            QCOMPARE(statistics.count(), window.count());
+            QVERIFY(qAbs(statistics.getMean() - mean) < 1e-9);
+            QVERIFY(qAbs(statistics.getVariance() - variance) < 1e-9);
+            QCOMPARE(statistics.getMedian(), quantile(window, 0.5));
+        }
+    }
+}
+
+void QGCRollingStatisticsTest::quantile_test()
+{
+    QGCRollingQuantile percentile(0.9);
+    QCOMPARE(percentile.getValue(), 0.0);
+
+    QList<double> window;
+    qsrand(42);
+    for (int i = 0; i < 2000; i++)
+    {
+        double value = qrand() % 1000;
+        percentile.add(value);
+        window.append(value);
+        if (window.count() > 30)
+        {
+            percentile.remove(window.takeFirst());
+        }
+        QCOMPARE(percentile.count(), window.count());
+        QVERIFY(qAbs(percentile.getValue() - quantile(window, 0.9)) < 1e-9);
+    }
+
+    percentile.clear();
+    QCOMPARE(percentile.count(), 0);
+}
+
+void QGCRollingStatisticsTest::invalid_test()
+{
+    QGCRollingStatistics statistics(4);
+    statistics.append(1.0);
+    statistics.append(qQNaN());
+    statistics.append(qInf());
+    statistics.append(3.0);
+    QCOMPARE(statistics.count(), 2);
+    QCOMPARE(statistics.getMean(), 2.0);
+    QCOMPARE(statistics.getMedian(), 2.0);
+    QCOMPARE(statistics.getVariance(), 1.0);
+
+    // Changing the window starts over
+    statistics.setWindowSize(10);
+    QCOMPARE(statistics.count(), 0);
+    QCOMPARE(statistics.getWindowSize(), 10);
+}
+
+void QGCRollingStatisticsTest::recompute_test()
+{
+    // A huge sample cancels most digits of the running sums while it is in the window
+    QGCRollingStatistics statistics(4);
+    statistics.append(1e12);
+    for (int i = 0; i < 20; i++) statistics.append((i % 2 == 0) ? 1.0 : 3.0);
+
+    // After the window turned over the sums are exact again
+    QCOMPARE(statistics.getMean(), 2.0);
+    QCOMPARE(statistics.getVariance(), 1.0);
+}
+
+void QGCRollingStatisticsTest::append_benchmark()
+{
+    // 1000 sample window as used for long averages in the linechart
+    QGCRollingStatistics statistics(1000);
+    QVector<double> values(10000);
+    for (int i = 0; i < values.size(); i++) values[i] = qrand() / (double)RAND_MAX;
+
+    QBENCHMARK {
+        for (int i = 0; i < values.size(); i++) statistics.append(values[i]);
+    }
+}
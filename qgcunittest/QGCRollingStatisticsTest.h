@@ -0,0 +1,35 @@
+#ifndef QGCROLLINGSTATISTICSTEST_H
+#define QGCROLLINGSTATISTICSTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "linechart/QGCRollingStatistics.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Compares the sliding window statistics of the linechart with a
+ * full recomputation over the window
+ */
+class QGCRollingStatisticsTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCRollingStatisticsTest();
+
+private slots:
+    void statistics_test();
+    void quantile_test();
+    void invalid_test();
+    void recompute_test();
+    void append_benchmark();
+
+protected:
+    /** @brief Quantile of the values with linear interpolation between ranks */
+    static double quantile(QList<double> values, double q);
+};
+
+DECLARE_TEST(QGCRollingStatisticsTest)
+
+#endif // QGCROLLINGSTATISTICSTEST_H
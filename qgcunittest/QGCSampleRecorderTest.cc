@@ -0,0 +1,159 @@
+#include <QDir>
+#include "QGCSampleRecorderTest.h"
+
+QGCSampleRecorderTest::QGCSampleRecorderTest()
+{
+}
+
+void QGCSampleRecorderTest::init()
+{
+    fileName = QDir::tempPath() + "/qgc_recorder_test.qgcrec";
+    textName = QDir::tempPath() + "/qgc_recorder_test.txt";
+    QFile::remove(fileName);
+    QFile::remove(textName);
+}
+
+void QGCSampleRecorderTest::cleanup()
+{
+    QFile::remove(fileName);
+    QFile::remove(textName);
+}
+
+void QGCSampleRecorderTest::export_test()
+{
+    QGCSampleRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    int roll = recorder.addChannel(1, "roll", QGCSampleRecorder::DOUBLE);
+    int count = recorder.addChannel(2, "count", QGCSampleRecorder::INTEGER);
+    int big = recorder.addChannel(1, "big", QGCSampleRecorder::UNSIGNED);
+    QCOMPARE(recorder.getChannelCount(), 3);
+
+    // The lines the former text log contained, ordered by time
+    QString expected;
+    for (int i = 0; i < 2000; i++)
+    {
+        double value = i * 0.1234567;
+        QVERIFY(recorder.record(roll, 10 * i, value));
+        expected += QString::number(10 * i) + "\t1\troll\t" + QString::number(value, 'g', 18) + "\n";
+        if (i % 3 == 0)
+        {
+            QVERIFY(recorder.record(count, 10 * i, (qint64)-i));
+            expected += QString::number(10 * i) + "\t2\tcount\t" + QString::number((qint64)-i) + "\n";
+        }
+        if (i % 7 == 0)
+        {
+            quint64 value = Q_UINT64_C(18446744073709551615) - i;
+            QVERIFY(recorder.record(big, 10 * i + 5, value));
+            expected += QString::number(10 * i + 5) + "\t1\tbig\t" + QString::number(value) + "\n";
+        }
+    }
+    // Unknown channels are not recorded
+    QVERIFY(!recorder.record(3, 0, 1.0));
+
+    recorder.close(textName);
+    QVERIFY(!recorder.isOpen());
+    QVERIFY(recorder.wait(10000));
+    QCOMPARE(recorder.getValuesDropped(), (quint64)0);
+    QCOMPARE(QFileInfo(fileName).size(), (qint64)recorder.getBytesWritten());
+
+    // 16 bytes per value plus the block and dictionary records
+    QVERIFY(recorder.getBytesWritten() < recorder.getValuesRecorded() * 17 + 200);
+
+    QFile text(textName);
+    QVERIFY(text.open(QIODevice::ReadOnly | QIODevice::Text));
+    QCOMPARE(QString::fromLatin1(text.readAll()), expected);
+}
+
+void QGCSampleRecorderTest::truncated_test()
+{
+    QGCSampleRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    int channel = recorder.addChannel(1, "yaw", QGCSampleRecorder::DOUBLE);
+    for (int i = 0; i < 3 * QGCSampleRecorder::blockSize; i++)
+    {
+        recorder.record(channel, i, 0.5 * i);
+    }
+    recorder.close();
+    QVERIFY(recorder.wait(10000));
+
+    // Cut the last block, the complete blocks stay readable
+    QFile file(fileName);
+    QVERIFY(file.resize(file.size() - 100));
+    QVERIFY(QGCSampleRecorder::exportText(fileName, textName));
+    QFile text(textName);
+    QVERIFY(text.open(QIODevice::ReadOnly | QIODevice::Text));
+    QList<QByteArray> lines = text.readAll().split('\n');
+    QCOMPARE(lines.size() - 1, 2 * QGCSampleRecorder::blockSize);
+    QCOMPARE(lines.at(1), QByteArray("1\t1\tyaw\t0.5"));
+
+    // Not a recording
+    QVERIFY(!QGCSampleRecorder::exportText(textName, fileName));
+}
+
+void QGCSampleRecorderTest::exportFailed_test()
+{
+    QGCSampleRecorder recorder;
+    QSignalSpy exported(&recorder, SIGNAL(exported(QString)));
+    QSignalSpy failed(&recorder, SIGNAL(exportFailed(QString)));
+    QVERIFY(recorder.open(fileName));
+    int channel = recorder.addChannel(1, "pitch", QGCSampleRecorder::DOUBLE);
+    QVERIFY(recorder.record(channel, 0, 1.0));
+
+    // The directory of the text log does not exist
+    const QString missing = QDir::tempPath() + "/qgc_recorder_missing/log.txt";
+    recorder.close(missing);
+    QVERIFY(recorder.wait(10000));
+    QCOMPARE(exported.count(), 0);
+    QCOMPARE(failed.count(), 1);
+    QCOMPARE(failed.at(0).at(0).toString(), missing);
+}
+
+void QGCSampleRecorderTest::sustained_test()
+{
+    // 500 channels at 100 Hz for one second
+    const int channels = 500;
+    QGCSampleRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    for (int i = 0; i < channels; i++)
+    {
+        QCOMPARE(recorder.addChannel(1, QString("channel%1").arg(i), QGCSampleRecorder::DOUBLE), i);
+    }
+    for (int tick = 0; tick < 100; tick++)
+    {
+        for (int i = 0; i < channels; i++)
+        {
+            recorder.record(i, 10 * tick, (double)(i + tick));
+        }
+        QTest::qSleep(10);
+    }
+    recorder.close(textName);
+    QVERIFY(recorder.wait(30000));
+    QCOMPARE(recorder.getValuesRecorded(), (quint64)(100 * channels));
+    QCOMPARE(recorder.getValuesDropped(), (quint64)0);
+
+    QFile text(textName);
+    QVERIFY(text.open(QIODevice::ReadOnly | QIODevice::Text));
+    QCOMPARE(text.readAll().count('\n'), 100 * channels);
+}
+
+void QGCSampleRecorderTest::record_benchmark()
+{
+    const int channels = 500;
+    QGCSampleRecorder recorder;
+    QVERIFY(recorder.open(fileName));
+    for (int i = 0; i < channels; i++)
+    {
+        recorder.addChannel(1, QString("channel%1").arg(i), QGCSampleRecorder::DOUBLE);
+    }
+
+    // One update of all channels, as done on the GUI thread
+    quint64 time = 0;
+    QBENCHMARK {
+        for (int i = 0; i < channels; i++)
+        {
+            recorder.record(i, time, (double)i);
+        }
+        time += 10;
+    }
+    recorder.close();
+}
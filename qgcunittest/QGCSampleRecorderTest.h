@@ -0,0 +1,37 @@
+#ifndef QGCSAMPLERECORDERTEST_H
+#define QGCSAMPLERECORDERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "linechart/QGCSampleRecorder.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the binary linechart recording and its export to the text log
+ */
+class QGCSampleRecorderTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCSampleRecorderTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void export_test();
+    void truncated_test();
+    void exportFailed_test();
+    void sustained_test();
+    void record_benchmark();
+
+protected:
+    QString fileName;
+    QString textName;
+};
+
+DECLARE_TEST(QGCSampleRecorderTest)
+
+#endif // QGCSAMPLERECORDERTEST_H
@@ -0,0 +1,135 @@
+#include "QGCSeriesStoreTest.h"
+
+QGCSeriesStoreTest::QGCSeriesStoreTest() :
+    budget(0)
+{
+}
+
+void QGCSeriesStoreTest::init()
+{
+    budget = QGCSeriesMemoryBudget::instance()->getBudget();
+}
+
+void QGCSeriesStoreTest::cleanup()
+{
+    QGCSeriesMemoryBudget::instance()->setBudget(budget);
+}
+
+void QGCSeriesStoreTest::append_test()
+{
+    const int count = 5 * QGCSeriesChunk::CAPACITY + 17;
+    QGCSeriesStore store;
+    for (int i = 0; i < count; i++)
+    {
+        store.append(i, 2.0 * i);
+    }
+    QCOMPARE(store.firstIndex(), (quint64)0);
+    QCOMPARE(store.endIndex(), (quint64)count);
+    for (int i = 0; i < count; i++)
+    {
+        QCOMPARE(store.time(i), (double)i);
+        QCOMPARE(store.value(i), 2.0 * i);
+    }
+    QCOMPARE(store.getMemoryUsage(), (qint64)(6 * sizeof(QGCSeriesChunk)));
+
+    store.clear();
+    QCOMPARE(store.endIndex(), (quint64)0);
+    QCOMPARE(store.getMemoryUsage(), (qint64)0);
+}
+
+void QGCSeriesStoreTest::budget_test()
+{
+    QGCSeriesMemoryBudget* memory = QGCSeriesMemoryBudget::instance();
+    const qint64 before = memory->getUsed();
+    memory->setBudget(before + 80 * sizeof(QGCSeriesChunk));
+
+    // Four channels for a long time, the plot window is the last 2000 samples
+    const int window = 2000;
+    QGCSeriesStore stores[4];
+    qint64 maxUsed = 0;
+    for (int i = 0; i < 200 * QGCSeriesChunk::CAPACITY; i++)
+    {
+        for (int s = 0; s < 4; s++)
+        {
+            stores[s].setKeepFrom(i - window);
+            stores[s].append(i, s);
+        }
+        maxUsed = qMax(maxUsed, memory->getUsed());
+    }
+    QVERIFY(maxUsed <= memory->getBudget());
+
+    for (int s = 0; s < 4; s++)
+    {
+        // The plot window is still at full resolution and consistent
+        QVERIFY(stores[s].endIndex() - stores[s].firstIndex() >= (quint64)window);
+        for (quint64 i = stores[s].firstIndex(); i < stores[s].endIndex(); i++)
+        {
+            QCOMPARE(stores[s].time(i), (double)i);
+        }
+        QVERIFY(stores[s].getDownsampledCount() > 0);
+    }
+}
+
+void QGCSeriesStoreTest::downsample_test()
+{
+    QGCSeriesMemoryBudget* memory = QGCSeriesMemoryBudget::instance();
+    memory->setBudget(memory->getUsed() + 12 * sizeof(QGCSeriesChunk));
+
+    QGCSeriesStore store;
+    const int count = 100 * QGCSeriesChunk::CAPACITY;
+    for (int i = 0; i < count; i++)
+    {
+        store.setKeepFrom(i - 100);
+        // One spike in an otherwise flat series
+        store.append(i, (i == 1234) ? 1000.0 : 0.0);
+    }
+
+    // The spike survives in the history, which stays in time order
+    double maxValue = 0.0;
+    double lastTime = -1.0;
+    for (int i = 0; i < store.getDownsampledCount(); i++)
+    {
+        maxValue = qMax(maxValue, store.downsampledValue(i));
+        QVERIFY(store.downsampledTime(i) >= lastTime);
+        lastTime = store.downsampledTime(i);
+    }
+    QCOMPARE(maxValue, 1000.0);
+    QVERIFY(lastTime < store.time(store.firstIndex()));
+    QVERIFY(store.getDownsampledBucket() >= 32);
+}
+
+void QGCSeriesStoreTest::envelope_test()
+{
+    QGCSeriesStore store;
+    const int count = 70000;
+    QVector<double> values(count);
+    qsrand(7);
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = qrand() % 10000 - 5000;
+        store.append(i, values[i]);
+    }
+
+    // Every bucket of every level against the samples
+    for (int level = 0; level < QGCSeriesStore::ENVELOPE_LEVELS; level++)
+    {
+        const int size = 1 << QGCSeriesStore::envelopeShift(level);
+        for (int bucket = 0; bucket * size < count; bucket++)
+        {
+            double min = values[bucket * size];
+            double max = min;
+            for (int i = bucket * size; i < qMin(count, (bucket + 1) * size); i++)
+            {
+                min = qMin(min, values[i]);
+                max = qMax(max, values[i]);
+            }
+            QCOMPARE(store.envelopeMin(level, bucket), min);
+            QCOMPARE(store.envelopeMax(level, bucket), max);
+        }
+    }
+
+    // Few samples per pixel are drawn as they are
+    QCOMPARE(QGCSeriesStore::envelopeLevel(1000, 800), -1);
+    QCOMPARE(QGCSeriesStore::envelopeLevel(8 * 800, 800), 0);
+    QCOMPARE(QGCSeriesStore::envelopeLevel(100000000, 800), QGCSeriesStore::ENVELOPE_LEVELS - 1);
+}
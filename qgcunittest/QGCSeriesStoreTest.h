@@ -0,0 +1,35 @@
+#ifndef QGCSERIESSTORETEST_H
+#define QGCSERIESSTORETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "linechart/QGCSeriesStore.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the chunked linechart storage and its memory budget
+ */
+class QGCSeriesStoreTest : public QObject
+{
+    Q_OBJECT
+public:
+    QGCSeriesStoreTest();
+
+private slots:
+    void init();
+    void cleanup();
+
+    void append_test();
+    void budget_test();
+    void downsample_test();
+    void envelope_test();
+
+protected:
+    qint64 budget;
+};
+
+DECLARE_TEST(QGCSeriesStoreTest)
+
+#endif // QGCSERIESSTORETEST_H
@@ -0,0 +1,119 @@
+#include "SerialLinkTest.h"
+#include "QGC.h"
+
+#ifndef _WIN32
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+SerialLinkTest::SerialLinkTest() :
+    master(-1),
+    link(NULL)
+{
+}
+
+void SerialLinkTest::receiveBytes(LinkInterface* from, QByteArray data)
+{
+    Q_UNUSED(from);
+    QMutexLocker locker(&receivedMutex);
+    received.append(data);
+}
+
+void SerialLinkTest::initTestCase()
+{
+#ifdef _WIN32
+    QSKIP("Pseudo-terminals are only available on POSIX systems", SkipAll);
+#else
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    QVERIFY(master >= 0);
+    QVERIFY(grantpt(master) == 0);
+    QVERIFY(unlockpt(master) == 0);
+
+    link = new SerialLink(QString(ptsname(master)), 921600);
+    connect(link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    link->connect();
+
+    // Wait for the link thread to open the port
+    for (int i = 0; i < 100 && !link->isConnected(); i++)
+    {
+        QTest::qWait(10);
+    }
+    QVERIFY(link->isConnected());
+#endif
+}
+
+void SerialLinkTest::cleanupTestCase()
+{
+    if (link) link->disconnect();
+    delete link;
+#ifndef _WIN32
+    if (master >= 0) close(master);
+#endif
+}
+
+bool SerialLinkTest::transfer(const QByteArray& data, int timeout, qint64* latencyUsecs)
+{
+#ifdef _WIN32
+    Q_UNUSED(data);
+    Q_UNUSED(timeout);
+    Q_UNUSED(latencyUsecs);
+    return false;
+#else
+    receivedMutex.lock();
+    received.clear();
+    receivedMutex.unlock();
+    quint64 start = QGC::groundTimeUsecs();
+    if (write(master, data.constData(), data.size()) != data.size()) return false;
+
+    // The bytes are collected in the link thread, poll without the event loop
+    while (QGC::groundTimeUsecs() - start < (quint64)timeout * 1000)
+    {
+        receivedMutex.lock();
+        int size = received.size();
+        receivedMutex.unlock();
+        if (size >= data.size())
+        {
+            if (latencyUsecs) *latencyUsecs = QGC::groundTimeUsecs() - start;
+            return size == data.size();
+        }
+        usleep(50);
+    }
+    return false;
+#endif
+}
+
+void SerialLinkTest::receiveAll_test()
+{
+    // Larger than the old 2048 byte read limit
+    QByteArray data;
+    for (int i = 0; i < 3000; i++)
+    {
+        data.append((char)(i % 251));
+    }
+    QVERIFY(transfer(data, 1000, NULL));
+
+    QMutexLocker locker(&receivedMutex);
+    QCOMPARE(received, data);
+}
+
+void SerialLinkTest::wakeLatency_test()
+{
+    // A single attitude packet, idle link before
+    QByteArray packet(36, (char)0xFE);
+    QList<qint64> latencies;
+    for (int i = 0; i < 40; i++)
+    {
+        QTest::qWait(5);
+        qint64 latency = 0;
+        QVERIFY(transfer(packet, 1000, &latency));
+        latencies.append(latency);
+    }
+    qSort(latencies);
+
+    // Sub-millisecond wakeups, the median tolerates single scheduler delays
+    const qint64 median = latencies.at(latencies.size() / 2);
+    QVERIFY2(median < 1000, qPrintable(QString("Median wake latency %1 us").arg(median)));
+    // Polling would take up to a full poll interval
+    QVERIFY2(latencies.last() < SerialLink::poll_interval * 1000, qPrintable(QString("Worst wake latency %1 us").arg(latencies.last())));
+}
@@ -0,0 +1,47 @@
+#ifndef SERIALLINKTEST_H
+#define SERIALLINKTEST_H
+
+#include <QObject>
+#include <QMutex>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "SerialLink.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Tests the serial link against a pseudo-terminal pair
+ *
+ * The link opens the slave side of the pair, the test writes to the
+ * master side as if it was the radio. Only available on POSIX systems.
+ */
+class SerialLinkTest : public QObject
+{
+    Q_OBJECT
+public:
+    SerialLinkTest();
+
+public slots:
+    /** @brief Collect the bytes emitted by the link, called in the link thread */
+    void receiveBytes(LinkInterface* from, QByteArray data);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void receiveAll_test();
+    void wakeLatency_test();
+
+protected:
+    /** @brief Write to the master side and wait until the link emitted all bytes */
+    bool transfer(const QByteArray& data, int timeout, qint64* latencyUsecs);
+
+    int master;
+    SerialLink* link;
+    QMutex receivedMutex;
+    QByteArray received; ///< Bytes emitted by the link since the last transfer()
+};
+
+DECLARE_TEST(SerialLinkTest)
+
+#endif // SERIALLINKTEST_H
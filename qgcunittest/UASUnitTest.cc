@@ -35,6 +35,25 @@ void UASUnitTest::getUASID_test()
     QCOMPARE(uas->getUASID(), 100);
 }
 
+void UASUnitTest::getUASForId_test()
+{
+    UASManager* manager = UASManager::instance();
+    UAS* uas2 = new UAS(mav, 42);
+    QVERIFY(manager->getUASForId(42) == NULL);
+
+    // Systems are found by ID once they are added
+    manager->addUAS(uas2);
+    QCOMPARE(manager->getUASForId(42), static_cast<UASInterface*>(uas2));
+    QVERIFY(manager->getUASForId(43) == NULL);
+    QVERIFY(manager->getUASForId(-1) == NULL);
+    QVERIFY(manager->getUASForId(256) == NULL);
+
+    // And are gone once removed
+    manager->removeUAS(uas2);
+    QVERIFY(manager->getUASForId(42) == NULL);
+    delete uas2;
+}
+
 void UASUnitTest::getUASName_test()
 {
   // Test that the name is build as MAV + ID
@@ -157,6 +176,35 @@ void UASUnitTest::getYaw_test()
     QCOMPARE(uas->getYaw(), 0.0);
 }
 
+void UASUnitTest::getTelemetrySnapshot_test()
+{
+    SerialLink* link2 = new SerialLink();
+    UAS* uas2 = new UAS(mav, 43);
+
+    // Nothing is published before the first message
+    UASTelemetrySnapshot empty = uas2->getTelemetrySnapshot();
+    QCOMPARE(empty.attitudeTime, (quint64)0);
+
+    // An attitude message is visible in the next snapshot
+    mavlink_message_t msg;
+    mavlink_msg_attitude_pack(43, MAV_COMP_ID_IMU, &msg, 1000, 0.1f, -0.2f, 0.3f, 0.01f, 0.02f, 0.03f);
+    uas2->receiveMessage(link2, msg);
+    UASTelemetrySnapshot snapshot = uas2->getTelemetrySnapshot();
+    QVERIFY(snapshot.attitudeTime != 0);
+    QCOMPARE(snapshot.roll, uas2->getRoll());
+    QCOMPARE(snapshot.pitch, uas2->getPitch());
+    QCOMPARE(snapshot.yaw, uas2->getYaw());
+    QCOMPARE((float)snapshot.yawSpeed, 0.03f);
+
+    // Messages of other systems are not
+    mavlink_msg_attitude_pack(44, MAV_COMP_ID_IMU, &msg, 2000, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+    uas2->receiveMessage(link2, msg);
+    QCOMPARE(uas2->getTelemetrySnapshot().attitudeTime, snapshot.attitudeTime);
+
+    delete uas2;
+    delete link2;
+}
+
 void UASUnitTest::getSelected_test()
 {
     QCOMPARE(uas->getSelected(), false);
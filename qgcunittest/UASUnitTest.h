@@ -13,6 +13,7 @@
 #include "AutoTest.h"
 #include "LinkManager.h"
 #include "UASWaypointManager.h"
+#include "UASManager.h"
 #include "SerialLink.h"
 #include "LinkInterface.h"
 
@@ -33,6 +34,7 @@ private slots:
 
 
   void getUASID_test();
+  void getUASForId_test();
   void getUASName_test();
   void getUpTime_test();
   void getCommunicationStatus_test();
@@ -49,6 +51,7 @@ private slots:
   void getRoll_test();
   void getPitch_test();
   void getYaw_test();
+  void getTelemetrySnapshot_test();
 
   void getSelected_test();
   void getSystemType_test();
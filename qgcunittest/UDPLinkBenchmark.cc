@@ -0,0 +1,101 @@
+#include "UDPLinkBenchmark.h"
+#include "QGC.h"
+
+UDPLinkBenchmark::UDPLinkBenchmark() :
+    link(NULL),
+    sender(NULL),
+    received(0)
+{
+}
+
+void UDPLinkBenchmark::receiveBytes(LinkInterface* from, QByteArray data)
+{
+    Q_UNUSED(from);
+    QMutexLocker locker(&receivedMutex);
+    received += data.size();
+}
+
+void UDPLinkBenchmark::initTestCase()
+{
+    link = new UDPLink(QHostAddress::LocalHost, port);
+    connect(link, SIGNAL(bytesReceived(LinkInterface*,QByteArray)), this, SLOT(receiveBytes(LinkInterface*,QByteArray)), Qt::DirectConnection);
+    QVERIFY(link->connect());
+    sender = new QUdpSocket();
+}
+
+void UDPLinkBenchmark::cleanupTestCase()
+{
+    delete sender;
+    if (link) link->disconnect();
+    delete link;
+}
+
+bool UDPLinkBenchmark::transfer(const QByteArray& datagram, int count, int timeout, QUdpSocket* from)
+{
+    if (!from) from = sender;
+    receivedMutex.lock();
+    received = 0;
+    receivedMutex.unlock();
+    for (int i = 0; i < count; i++)
+    {
+        if (from->writeDatagram(datagram, QHostAddress::LocalHost, port) != datagram.size()) return false;
+    }
+
+    // The bytes are counted in the link thread, poll without the event loop
+    quint64 start = QGC::groundTimeUsecs();
+    while (QGC::groundTimeUsecs() - start < (quint64)timeout * 1000)
+    {
+        receivedMutex.lock();
+        qint64 size = received;
+        receivedMutex.unlock();
+        if (size >= (qint64)datagram.size() * count) return size == (qint64)datagram.size() * count;
+        QTest::qSleep(1);
+    }
+    return false;
+}
+
+void UDPLinkBenchmark::oversized_test()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Only the batched receive of Linux uses fixed size buffers", SkipAll);
+#else
+    // Datagrams up to the largest UDP payload arrive in one piece
+    int dropped = link->getDatagramsDropped();
+    QVERIFY(transfer(QByteArray(8000, (char)0xFE), 1, 1000));
+    QVERIFY(transfer(QByteArray(65507, (char)0xFE), 1, 1000));
+    QCOMPARE(link->getDatagramsDropped(), dropped);
+
+    // The link keeps receiving afterwards
+    QVERIFY(transfer(QByteArray(100, (char)0xFE), 1, 1000));
+#endif
+}
+
+void UDPLinkBenchmark::peers_test()
+{
+    // Two vehicles on one host, each one is a peer of its own
+    QUdpSocket first;
+    QUdpSocket second;
+    QVERIFY(first.bind(QHostAddress::LocalHost, 0));
+    QVERIFY(second.bind(QHostAddress::LocalHost, 0));
+    const int peers = link->getHosts().size();
+    for (int i = 0; i < 3; i++)
+    {
+        QVERIFY(transfer(QByteArray(20, (char)0xFE), 1, 1000, &first));
+        QVERIFY(transfer(QByteArray(20, (char)0xFE), 1, 1000, &second));
+    }
+    QCOMPARE(link->getHosts().size(), peers + 2);
+}
+
+/**
+ * Sends bursts of 1000 datagrams of the size of an attitude packet, small
+ * enough to fit into the default socket buffer, and waits until the link
+ * emitted all of them.
+ */
+void UDPLinkBenchmark::throughput_benchmark()
+{
+    QByteArray datagram(36, (char)0xFE);
+    QBENCHMARK
+    {
+        QVERIFY(transfer(datagram, 1000, 5000));
+    }
+}
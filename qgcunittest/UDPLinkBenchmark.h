@@ -0,0 +1,47 @@
+#ifndef UDPLINKBENCHMARK_H
+#define UDPLINKBENCHMARK_H
+
+#include <QObject>
+#include <QMutex>
+#include <QUdpSocket>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "UDPLink.h"
+#include "AutoTest.h"
+
+/**
+ * @brief Measures the receive throughput of the UDP link over the loopback interface
+ */
+class UDPLinkBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    UDPLinkBenchmark();
+
+public slots:
+    /** @brief Count the bytes emitted by the link, called in the link thread */
+    void receiveBytes(LinkInterface* from, QByteArray data);
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void oversized_test();
+    void peers_test();
+    void throughput_benchmark();
+
+protected:
+    /** @brief Send datagrams to the link and wait until it emitted all bytes, from the default sender if from is NULL */
+    bool transfer(const QByteArray& datagram, int count, int timeout, QUdpSocket* from = NULL);
+
+    static const quint16 port = 14650;
+    UDPLink* link;
+    QUdpSocket* sender;
+    QMutex receivedMutex;
+    qint64 received; ///< Bytes emitted by the link since the last transfer()
+};
+
+DECLARE_TEST(UDPLinkBenchmark)
+
+#endif // UDPLINKBENCHMARK_H
@@ -258,6 +258,8 @@ INCLUDEPATH += src \
 HEADERS += src/MG.h \
     src/QGCCore.h \
     src/uas/UASInterface.h \
+    src/uas/UASTelemetrySnapshot.h \
+    src/uas/QGCSampleBlock.h \
     src/uas/UAS.h \
     src/uas/UASManager.h \
     src/comm/LinkManager.h \
@@ -266,6 +268,13 @@ HEADERS += src/MG.h \
     src/comm/SerialLink.h \
     src/comm/ProtocolInterface.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkProtocolWorker.h \
+    src/comm/MAVLinkMessagePool.h \
+    src/comm/QGCByteRing.h \
+    src/comm/QGCMAVLinkFrameParser.h \
+    src/comm/QGCMAVLinkLogWriter.h \
+    src/comm/QGCMAVLinkLogIndex.h \
+    src/comm/QGCMAVLinkLogReplay.h \
     src/comm/QGCFlightGearLink.h \
     src/ui/CommConfigurationWindow.h \
     src/ui/SerialConfigurationWindow.h \
@@ -276,6 +285,10 @@ HEADERS += src/MG.h \
     src/ui/HUD.h \
     src/ui/linechart/LinechartWidget.h \
     src/ui/linechart/LinechartPlot.h \
+    src/ui/linechart/QGCRollingStatistics.h \
+    src/ui/linechart/QGCSeriesStore.h \
+    src/ui/linechart/QGCSeriesPlotData.h \
+    src/ui/linechart/QGCSampleRecorder.h \
     src/ui/linechart/Scrollbar.h \
     src/ui/linechart/ScrollZoomer.h \
     src/configuration.h \
@@ -311,6 +324,7 @@ HEADERS += src/MG.h \
     src/ui/QGCFirmwareUpdate.h \
     src/ui/QGCPxImuFirmwareUpdate.h \
     src/ui/QGCDataPlot2D.h \
+    src/ui/QGCCsvLoader.h \
     src/ui/linechart/IncrementalPlot.h \
     src/ui/QGCRemoteControlView.h \
     src/ui/RadioCalibration/RadioCalibrationData.h \
@@ -327,6 +341,7 @@ HEADERS += src/MG.h \
     src/ui/SlugsPadCameraControl.h \
     src/ui/QGCMainWindowAPConfigurator.h \
     src/comm/MAVLinkSwarmSimulationLink.h \
+    src/comm/MAVLinkSwarmSimulationWorker.h \
     src/ui/uas/QGCUnconnectedInfoWidget.h \
     src/ui/designer/QGCToolWidget.h \
     src/ui/designer/QGCParamSlider.h \
@@ -352,7 +367,10 @@ HEADERS += src/MG.h \
     src/QGCGeo.h \
     src/ui/QGCToolBar.h \
     src/ui/QGCMAVLinkInspector.h \
+    src/ui/QGCFrameScheduler.h \
     src/ui/MAVLinkDecoder.h \
+    src/ui/MAVLinkChannelRegistry.h \
+    src/ui/QGCSampleAdapter.h \
     src/ui/WaypointViewOnlyView.h \
     src/ui/WaypointViewOnlyView.h \
     src/ui/WaypointEditableView.h \    
@@ -411,6 +429,12 @@ SOURCES += src/main.cc \
     src/comm/LinkInterface.cpp \
     src/comm/SerialLink.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkProtocolWorker.cc \
+    src/comm/MAVLinkMessagePool.cc \
+    src/comm/QGCMAVLinkFrameParser.cc \
+    src/comm/QGCMAVLinkLogWriter.cc \
+    src/comm/QGCMAVLinkLogIndex.cc \
+    src/comm/QGCMAVLinkLogReplay.cc \
     src/comm/QGCFlightGearLink.cc \
     src/ui/CommConfigurationWindow.cc \
     src/ui/SerialConfigurationWindow.cc \
@@ -421,6 +445,10 @@ SOURCES += src/main.cc \
     src/ui/HUD.cc \
     src/ui/linechart/LinechartWidget.cc \
     src/ui/linechart/LinechartPlot.cc \
+    src/ui/linechart/QGCRollingStatistics.cc \
+    src/ui/linechart/QGCSeriesStore.cc \
+    src/ui/linechart/QGCSeriesPlotData.cc \
+    src/ui/linechart/QGCSampleRecorder.cc \
     src/ui/linechart/Scrollbar.cc \
     src/ui/linechart/ScrollZoomer.cc \
     src/ui/uas/UASView.cc \
@@ -455,6 +483,7 @@ SOURCES += src/main.cc \
     src/ui/QGCFirmwareUpdate.cc \
     src/ui/QGCPxImuFirmwareUpdate.cc \
     src/ui/QGCDataPlot2D.cc \
+    src/ui/QGCCsvLoader.cc \
     src/ui/linechart/IncrementalPlot.cc \
     src/ui/QGCRemoteControlView.cc \
     src/ui/RadioCalibration/RadioCalibrationWindow.cc \
@@ -470,6 +499,7 @@ SOURCES += src/main.cc \
     src/ui/SlugsPadCameraControl.cpp \
     src/ui/QGCMainWindowAPConfigurator.cc \
     src/comm/MAVLinkSwarmSimulationLink.cc \
+    src/comm/MAVLinkSwarmSimulationWorker.cc \
     src/ui/uas/QGCUnconnectedInfoWidget.cc \
     src/ui/designer/QGCToolWidget.cc \
     src/ui/designer/QGCParamSlider.cc \
@@ -493,7 +523,10 @@ SOURCES += src/main.cc \
     src/ui/map/QGCMapToolBar.cc \
     src/ui/QGCToolBar.cc \
     src/ui/QGCMAVLinkInspector.cc \
+    src/ui/QGCFrameScheduler.cc \
     src/ui/MAVLinkDecoder.cc \
+    src/ui/MAVLinkChannelRegistry.cc \
+    src/ui/QGCSampleAdapter.cc \
     src/ui/WaypointViewOnlyView.cc \
     src/ui/WaypointEditableView.cc \
     src/ui/UnconnectedUASInfoWidget.cc \
@@ -28,14 +28,310 @@ This file is part of the QGROUNDCONTROL project
  */
 
 #include <QFile>
-#include <QTextStream>
 #include <QStringList>
 #include <QFileInfo>
 #include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <string.h>
 #include "LogCompressor.h"
 
 #include <QDebug>
 
+namespace
+{
+/** @brief Lines of the log with the range of their timestamps */
+struct LogSegment
+{
+    qint64 begin;       ///< Offset of the first value line
+    qint64 end;         ///< Offset after the last line
+    quint64 minTime;    ///< Smallest timestamp of the value lines, an invalid one counts as 0
+    quint64 maxTime;    ///< Largest timestamp of the value lines
+};
+
+/** @brief One value of the current window of output rows */
+struct WindowEntry
+{
+    qint64 offset;  ///< Offset of the value in the log
+    qint32 length;  ///< Length of the value in bytes
+    qint32 cell;    ///< Row in the window times number of keys plus column
+};
+
+/** @brief Fields of one line of the log */
+struct LogLine
+{
+    const char* next;   ///< Start of the following line
+    bool empty;         ///< The line has no characters
+    bool hasValue;      ///< Time, system, key and value are present
+    bool timeValid;     ///< The timestamp could be parsed
+    quint64 time;       ///< Timestamp, 0 if it could not be parsed
+    const char* key;
+    int keyLength;
+    const char* value;
+    int valueLength;
+};
+
+/**
+ * @brief Parse a timestamp like QString::toLongLong()
+ *
+ * Surrounding whitespace and a sign are accepted, negative values wrap
+ * around like in the cast of the former text based implementation.
+ */
+quint64 parseTime(const char* p, const char* end, bool* ok)
+{
+    *ok = false;
+    while (p < end && (*p == ' ' || (*p >= '\t' && *p <= '\r'))) p++;
+    while (end > p && (end[-1] == ' ' || (end[-1] >= '\t' && end[-1] <= '\r'))) end--;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end) return 0;
+
+    const quint64 limit = negative ? Q_UINT64_C(9223372036854775808) : Q_UINT64_C(9223372036854775807);
+    quint64 value = 0;
+    for (; p < end; ++p)
+    {
+        if (*p < '0' || *p > '9') return 0;
+        const unsigned int digit = *p - '0';
+        if (value > (limit - digit) / 10) return 0;
+        value = value * 10 + digit;
+    }
+    *ok = true;
+    return negative ? (0 - value) : value;
+}
+
+/** @brief Split the line starting at p into its fields */
+void splitLine(const char* p, const char* stop, LogLine& line)
+{
+    const char* eol = static_cast<const char*>(memchr(p, '\n', stop - p));
+    if (!eol) eol = stop;
+    line.next = eol + 1;
+    const char* lineEnd = eol;
+    if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+    line.empty = (lineEnd == p);
+
+    // Start of the first five fields: time, system, key, value and the rest
+    const char* fields[5];
+    int tabs = 0;
+    fields[0] = p;
+    const char* q = p;
+    while (tabs < 4)
+    {
+        const char* tab = static_cast<const char*>(memchr(q, '\t', lineEnd - q));
+        if (!tab) break;
+        fields[++tabs] = tab + 1;
+        q = tab + 1;
+    }
+
+    line.hasValue = (tabs >= 3);
+    if (!line.hasValue) return;
+    line.time = parseTime(fields[0], fields[1] - 1, &line.timeValid);
+    line.key = fields[2];
+    line.keyLength = fields[3] - 1 - fields[2];
+    line.value = fields[3];
+    line.valueLength = ((tabs >= 4) ? (fields[4] - 1) : lineEnd) - fields[3];
+}
+
+/**
+ * @brief Parses one chunk of whole lines of the log
+ *
+ * The chunks are processed in parallel in two phases. First the lines are
+ * scanned for the timestamps and the dictionary of the keys in the chunk,
+ * no per-line data is kept. Once the columns and rows are known, the output
+ * is produced in windows of rows: for each window the chunks collect the
+ * values of its rows, skipping the segments whose timestamps lie outside of
+ * it. A log written in time order is therefore parsed about twice, the
+ * memory for the values is bounded by the window size.
+ */
+class LogChunk : public QThread
+{
+public:
+    enum Phase {
+        PARSE, COLLECT
+    };
+
+    LogChunk(const char* data, qint64 begin, qint64 end, qint64 segmentSize) :
+        data(data),
+        begin(begin),
+        end(end),
+        segmentSize(segmentSize),
+        phase(PARSE),
+        invalidTimes(0),
+        ignored(0),
+        rowTimes(NULL),
+        windowRows(0),
+        keyCount(0)
+    {
+    }
+
+    const char* data;               ///< The whole log
+    qint64 begin;                   ///< Offset of the first line of the chunk
+    qint64 end;                     ///< Offset after the last line of the chunk
+    qint64 segmentSize;             ///< Bytes of lines summarized by one segment
+    Phase phase;
+
+    QHash<QByteArray, int> keyIds;  ///< Keys of the chunk
+    QList<QByteArray> keys;         ///< Keys of the chunk by ID
+    QVector<quint64> times;         ///< Valid timestamps of the chunk, sorted and unique
+    QVector<LogSegment> segments;   ///< Timestamp ranges of the lines of the chunk
+    int invalidTimes;               ///< Value lines without a valid timestamp
+    int ignored;                    ///< Non-empty lines without a value
+
+    QVector<int> columns;           ///< Output column by key ID
+    const quint64* rowTimes;        ///< Sorted timestamps of the rows of the window
+    int windowRows;                 ///< Number of rows in the window
+    int keyCount;                   ///< Number of output columns
+    QVector<WindowEntry> window;    ///< Values of the window in the order of the log
+
+protected:
+    void run()
+    {
+        switch (phase)
+        {
+        case PARSE:
+            parse();
+            break;
+        case COLLECT:
+            collect();
+            break;
+        }
+    }
+
+    void parse();
+    void collect();
+};
+
+void LogChunk::parse()
+{
+    const char* p = data + begin;
+    const char* stop = data + end;
+    LogSegment segment;
+    bool segmentOpen = false;
+    while (p < stop)
+    {
+        // Segments end at line boundaries
+        if (segmentOpen && (p - data) - segment.begin >= segmentSize)
+        {
+            segment.end = p - data;
+            segments.append(segment);
+            segmentOpen = false;
+        }
+
+        LogLine line;
+        splitLine(p, stop, line);
+        if (line.hasValue)
+        {
+            if (!segmentOpen)
+            {
+                segment.begin = p - data;
+                segment.minTime = line.time;
+                segment.maxTime = line.time;
+                segmentOpen = true;
+            }
+            segment.minTime = qMin(segment.minTime, line.time);
+            segment.maxTime = qMax(segment.maxTime, line.time);
+
+            if (!line.timeValid)
+            {
+                invalidTimes++;
+            }
+            else if (times.isEmpty() || times.last() != line.time)
+            {
+                // Consecutive lines mostly share their timestamp
+                times.append(line.time);
+            }
+
+            // Look the key up without copying it
+            const QByteArray key = QByteArray::fromRawData(line.key, line.keyLength);
+            if (!keyIds.contains(key))
+            {
+                keys.append(QByteArray(key.constData(), key.size()));
+                keyIds.insert(keys.last(), keys.size() - 1);
+            }
+        }
+        else if (!line.empty)
+        {
+            // Lines without a value are not part of the output
+            ignored++;
+        }
+        p = line.next;
+    }
+    if (segmentOpen)
+    {
+        segment.end = qMin(static_cast<qint64>(p - data), end);
+        segments.append(segment);
+    }
+
+    qSort(times);
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+}
+
+void LogChunk::collect()
+{
+    window.clear();
+    if (windowRows == 0) return;
+    const quint64 first = rowTimes[0];
+    const quint64 last = rowTimes[windowRows - 1];
+
+    foreach (const LogSegment& segment, segments)
+    {
+        if (segment.maxTime < first || segment.minTime > last) continue;
+
+        const char* p = data + segment.begin;
+        const char* stop = data + segment.end;
+        while (p < stop)
+        {
+            LogLine line;
+            splitLine(p, stop, line);
+            p = line.next;
+            // A line with an invalid timestamp uses time 0, like the former implementation
+            if (!line.hasValue || line.time < first || line.time > last) continue;
+            const quint64* row = std::lower_bound(rowTimes, rowTimes + windowRows, line.time);
+            if (*row != line.time) continue;
+
+            WindowEntry entry;
+            entry.offset = line.value - data;
+            entry.length = line.valueLength;
+            entry.cell = static_cast<int>(row - rowTimes) * keyCount + columns.at(keyIds.value(QByteArray::fromRawData(line.key, line.keyLength)));
+            window.append(entry);
+        }
+    }
+}
+
+/** @brief Run the current phase of all chunks in parallel and wait for them */
+void runChunks(const QList<LogChunk*>& chunks)
+{
+    foreach (LogChunk* chunk, chunks)
+    {
+        chunk->start();
+    }
+    foreach (LogChunk* chunk, chunks)
+    {
+        chunk->wait();
+    }
+}
+
+/** @brief Append a value of the log, converting it like the former text stream based implementation */
+void appendValue(QByteArray& out, const char* value, int length)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        if (static_cast<uchar>(value[i]) >= 0x80)
+        {
+            out += QString::fromLocal8Bit(value, length).toLatin1();
+            return;
+        }
+    }
+    out.append(value, length);
+}
+}
+
 /**
  * It will only get active upon calling startCompression()
  */
@@ -46,255 +342,269 @@ LogCompressor::LogCompressor(QString logFileName, QString outFileName, int uasid
     currentDataLine(0),
     dataLines(1),
     uasid(uasid),
-    holeFillingEnabled(true)
+    holeFillingEnabled(true),
+    windowCells(maxWindowCells)
 {
 }
 
+/**
+ * The log is mapped and split into chunks of whole lines, which are parsed
+ * in parallel into per-chunk key dictionaries and timestamps. The keys are
+ * merged and sorted into the output columns, the unique timestamps into the
+ * output rows. The rows are then filled in windows: the chunks collect the
+ * values of the rows of a window, which are placed into a matrix of values
+ * and written out before the next window.
+ *
+ * Besides the mapped log, the memory grows with the number of rows (8 bytes
+ * per unique timestamp) and is bounded by the window of maxWindowCells values
+ * (28 bytes per value), not by the number of lines. Segments of the log are
+ * only searched if their timestamps overlap the window, so a log in time
+ * order is searched once in total. A log in random order is searched once
+ * per window.
+ *
+ * The output is the same as the one of the former line-by-line
+ * implementation: one row per timestamp in ascending order, one column per
+ * key in ascending order, the last value of a key and timestamp wins. With
+ * hole filling, the values of a row are moved to the front and the missing
+ * trailing fields are filled from the previous rows.
+ */
 void LogCompressor::run()
 {
     QString separator = "\t";
     QString fileName = logFileName;
     QFile file(fileName);
     QFile outfile(outFileName);
-    QStringList* keys = new QStringList();
-    QList<quint64> times;// = new QList<quint64>();
-    QList<quint64> finalTimes;
-
-    //qDebug() << "LOG COMPRESSOR: Starting" << fileName;
 
-    if (!file.exists() || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        //qDebug() << "LOG COMPRESSOR: INPUT FILE DOES NOT EXIST";
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
         emit logProcessingStatusChanged(tr("Log Compressor: Cannot start/compress log file, since input file %1 is not readable").arg(QFileInfo(fileName).absoluteFilePath()));
         return;
     }
 
     // Check if file is writeable
-    if (outFileName == ""/* || !QFileInfo(outfile).isWritable()*/) {
-        //qDebug() << "LOG COMPRESSOR: OUTPUT FILE DOES NOT EXIST" << outFileName;
+    if (outFileName == "") {
         emit logProcessingStatusChanged(tr("Log Compressor: Cannot start/compress log file, since output file %1 is not writable").arg(QFileInfo(outFileName).absoluteFilePath()));
         return;
     }
 
-    // Find all keys
-    QTextStream in(&file);
-
-    // Search only a certain region, assuming that not more
-    // than N dimensions at H Hertz can be send
-    const unsigned int keySearchLimit = 15000;
-    // e.g. 500 Hz * 30 values or
-    // e.g. 100 Hz * 150 values
-
-    unsigned int keyCounter = 0;
-    while (!in.atEnd() && keyCounter < keySearchLimit) {
-        QString line = in.readLine();
-        // Accumulate map of keys
-        // Data field name is at position 2
-        QString key = line.split(separator).at(2);
-        if (!keys->contains(key))
+    // Map the log, fall back to reading it if mapping is not possible
+    const qint64 size = file.size();
+    QByteArray buffer;
+    const char* data = NULL;
+    if (size > 0) data = reinterpret_cast<const char*>(file.map(0, size));
+    if (!data)
+    {
+        buffer = file.readAll();
+        data = buffer.constData();
+    }
+
+    // Skip a unicode byte order mark, the text stream did so as well
+    qint64 begin = 0;
+    if (size >= 3 && memcmp(data, "\xEF\xBB\xBF", 3) == 0) begin = 3;
+
+    // Split the log into chunks of whole lines and parse them in parallel
+    const qint64 minChunkSize = 1024 * 1024;
+    const int chunkCount = static_cast<int>(qBound(Q_INT64_C(1), qMin(static_cast<qint64>(QThread::idealThreadCount()), (size - begin) / minChunkSize + 1), static_cast<qint64>(maxWorkers)));
+    QList<LogChunk*> chunks;
+    qint64 chunkBegin = begin;
+    for (int i = 0; i < chunkCount; ++i)
+    {
+        qint64 chunkEnd = (i == chunkCount - 1) ? size : begin + (size - begin) * (i + 1) / chunkCount;
+        if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+        const char* eol = static_cast<const char*>(memchr(data + chunkEnd, '\n', size - chunkEnd));
+        if (chunkEnd < size) chunkEnd = eol ? (eol - data + 1) : size;
+        chunks.append(new LogChunk(data, chunkBegin, chunkEnd, segmentSize));
+        chunkBegin = chunkEnd;
+    }
+    runChunks(chunks);
+
+    // Merge the dictionaries, the keys are sorted like QStringList::sort()
+    QMap<QString, int> keyColumns;
+    foreach (LogChunk* chunk, chunks)
+    {
+        foreach (const QByteArray& key, chunk->keys)
         {
-            keys->append(key);
+            keyColumns.insert(QString::fromLocal8Bit(key.constData(), key.size()), 0);
         }
-        keyCounter++;
     }
-    keys->sort();
+    QStringList keys = keyColumns.keys();
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        keyColumns[keys.at(i)] = i;
+    }
+    const int keyCount = keys.size();
 
     QString header = "";
-    QString spacer = "";
-    for (int i = 0; i < keys->length(); i++) {
-        header += keys->at(i) + separator;
-        spacer += separator;
+    for (int i = 0; i < keyCount; i++) {
+        header += keys.at(i) + separator;
     }
 
     emit logProcessingStatusChanged(tr("Log compressor: Dataset contains dimension: ") + header);
 
-    // Find all times
-    //in.reset();
-    file.reset();
-    in.reset();
-    in.resetStatus();
-    bool ok;
-    while (!in.atEnd()) {
-        QString line = in.readLine();
-        // Accumulate map of keys
-        // Data field name is at position 2b
-        quint64 time = static_cast<QString>(line.split(separator).at(0)).toLongLong(&ok);
-        if (ok) {
-            times.append(time);
-        }
+    // Merge the timestamps into the rows
+    QVector<quint64> finalTimes;
+    int ignored = 0;
+    int invalidTimes = 0;
+    foreach (LogChunk* chunk, chunks)
+    {
+        finalTimes += chunk->times;
+        chunk->times = QVector<quint64>();
+        ignored += chunk->ignored;
+        invalidTimes += chunk->invalidTimes;
     }
+    qSort(finalTimes);
+    finalTimes.erase(std::unique(finalTimes.begin(), finalTimes.end()), finalTimes.end());
 
-    qSort(times);
+    // A line with an invalid timestamp uses time 0, like the former implementation
+    if (finalTimes.isEmpty() || finalTimes.first() != 0) ignored += invalidTimes;
 
-    qint64 lastTime = -1;
-
-    // Create lines
-    QStringList* outLines = new QStringList();
-    for (int i = 0; i < times.length(); i++) {
-        // Cast to signed on purpose, 64 bit timestamp still long enough
-        if (static_cast<qint64>(times.at(i)) != lastTime) {
-            outLines->append(QString("%1").arg(times.at(i)) + separator + spacer);
-            lastTime = static_cast<qint64>(times.at(i));
-            finalTimes.append(times.at(i));
-            //qDebug() << "ADDED:" << outLines->last();
-        }
-    }
+    dataLines = finalTimes.size();
 
-    dataLines = finalTimes.length();
-
-    emit logProcessingStatusChanged(tr("Log compressor: Now processing %1 log lines").arg(finalTimes.length()));
-
-    // Fill in the values for all keys
-    file.reset();
-    QTextStream data(&file);
-    int linecounter = 0;
-    quint64 lastTimeIndex = 0;
-    bool failed = false;
-
-    while (!data.atEnd()) {
-        linecounter++;
-        currentDataLine = linecounter;
-        QString line = data.readLine();
-        QStringList parts = line.split(separator);
-        // Get time
-        quint64 time = static_cast<QString>(parts.first()).toLongLong(&ok);
-        QString field = parts.at(2);
-        int fieldIndex = keys->indexOf(field);
-        QString value = parts.at(3);
-//        // Enforce NaN if no value is present
-//        if (value.length() == 0 || value == "" || value == " " || value == "\t" || value == "\n") {
-//            // Hole filling disabled, fill with NaN
-//            value = "NaN";
-//        }
-        // Get matching output line
-
-        // Constraining the search area might result in not finding a key,
-        // but it significantly reduces the time needed for the search
-        // setting a window of 100 entries means that a 1 Hz data point
-        // can still be located
-        quint64 offsetLimit = 100;
-        quint64 offset;
-        qint64 index = -1;
-        failed = false;
-
-        // Search the index until it is valid (!= -1)
-        // or the start of the list has been reached (failed)
-        while (index == -1 && !failed) {
-            if (lastTimeIndex > offsetLimit) {
-                offset = lastTimeIndex - offsetLimit;
-            } else {
-                offset = 0;
-            }
+    emit logProcessingStatusChanged(tr("Log compressor: Now processing %1 log lines").arg(finalTimes.size()));
 
-            index = finalTimes.indexOf(time, offset);
-            if (index == -1) {
-                if (offset == 0) {
-                    emit logProcessingStatusChanged(tr("Log compressor: Timestamp %1 not found in dataset, ignoring log line %2").arg(time).arg(linecounter));
-                    qDebug() << "Completely failed finding value";
-                    //continue;
-                    failed = true;
-                } else {
-                    emit logProcessingStatusChanged(tr("Log compressor: Timestamp %1 not found in dataset, restarting search.").arg(time));
-                    offsetLimit*=2;
-                }
-            }
+    // Rows are filled in windows, a window is one matrix of values
+    const int windowRows = qBound(1, windowCells / qMax(1, keyCount), finalTimes.size() > 0 ? finalTimes.size() : 1);
+    foreach (LogChunk* chunk, chunks)
+    {
+        chunk->phase = LogChunk::COLLECT;
+        chunk->columns.resize(chunk->keys.size());
+        for (int i = 0; i < chunk->keys.size(); ++i)
+        {
+            const QByteArray& key = chunk->keys.at(i);
+            chunk->columns[i] = keyColumns.value(QString::fromLocal8Bit(key.constData(), key.size()));
         }
+        chunk->keyCount = keyCount;
+    }
 
-        if (dataLines > 100) if (index % (dataLines/100) == 0) emit logProcessingStatusChanged(tr("Log compressor: Processed %1% of %2 lines").arg(index/(float)dataLines*100, 0, 'f', 2).arg(dataLines));
-
-        if (!failed) {
-            // When the algorithm reaches here the correct index was found
-            lastTimeIndex = index;
-            QString outLine = outLines->at(index);
-            QStringList outParts = outLine.split(separator);
-            // Replace measurement placeholder with current value
-            outParts.replace(fieldIndex+1, value);
-            outLine = outParts.join(separator);
-            outLines->replace(index, outLine);
-        }
+    if (ignored > 0)
+    {
+        emit logProcessingStatusChanged(tr("Log compressor: Ignored %1 log lines without value or valid timestamp").arg(ignored));
     }
 
-    ///////////////////////////
-    // HOLE FILLING
+    // Write into a temporary file if the log is replaced
+    const bool replace = (outFileName == logFileName);
+    if (replace)
+    {
+        outfile.setFileName(outFileName + ".tmp");
+    }
+    if (!outfile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qDeleteAll(chunks);
+        return;
+    }
+    outfile.write(QString(QString("timestamp_ms") + separator + header.replace(" ", "_") + QString("\n")).toLatin1());
+    emit logProcessingStatusChanged(tr("Log Compressor: Writing output to file %1").arg(QFileInfo(outFileName).absoluteFilePath()));
 
-    // If hole filling is enabled, run again through the whole file and replace holes
-    if (holeFillingEnabled)
+    // Fill the matrix of each window and stream it out
+    QVector<qint64> cellOffsets(windowRows * keyCount);
+    QVector<int> cellLengths(windowRows * keyCount);
+    QVector<int> present(keyCount);
+    // Hole filling values by field position, -1 for NaN
+    QVector<qint64> fillOffsets(keyCount, -1);
+    QVector<int> fillLengths(keyCount, 0);
+    QByteArray out;
+    out.reserve(2 * writeSize);
+    int lastPercent = 0;
+
+    for (int firstRow = 0; firstRow < finalTimes.size(); firstRow += windowRows)
     {
-        // Build up the fill values - initialize to NaN
-        QStringList fillValues;
-        int fillCount = keys->count();
-        for (int i = 0; i< fillCount; ++i)
+        const int lastRow = qMin(firstRow + windowRows, finalTimes.size());
+        foreach (LogChunk* chunk, chunks)
         {
-            fillValues.append("NaN");
+            chunk->rowTimes = finalTimes.constData() + firstRow;
+            chunk->windowRows = lastRow - firstRow;
         }
+        runChunks(chunks);
 
-        // Run through all lines and replace with fill values
-        for (int index = 0; index < outLines->count(); ++index)
+        // The chunks are in the order of the log, so the last value of a cell wins
+        cellLengths.fill(-1);
+        foreach (LogChunk* chunk, chunks)
         {
-            QString line = outLines->at(index);
-            //qDebug() << "LINE" << line;
-            QStringList fields = line.split(separator, QString::SkipEmptyParts);
-            // The fields line contains the timestamp
-            // index of the data fields therefore runs from 1 to n-1
-            int fieldCount = fields.count();
-            for (int i = 1; i < fillCount+1; ++i)
+            foreach (const WindowEntry& entry, chunk->window)
             {
-                if (fieldCount <= i) fields.append("");
+                cellOffsets[entry.cell] = entry.offset;
+                cellLengths[entry.cell] = entry.length;
+            }
+        }
 
-                // Allow input data to be screwed up
-                if (fields.at(i) == "\t" || fields.at(i) == " " || fields.at(i) == "\n")
+        for (int row = firstRow; row < lastRow; ++row)
+        {
+            const int cell = (row - firstRow) * keyCount;
+            out += QByteArray::number(finalTimes.at(row));
+            if (!holeFillingEnabled)
+            {
+                for (int i = 0; i < keyCount; ++i)
                 {
-                    // Remove invalid data
-                    if (fieldCount > fillCount+1)
-                    {
-                        // This field has a seperator value and is too much
-                        //qDebug() << "REMOVED INVALID INPUT DATA";
-                        fields.removeAt(i);
-                    }
-                    // Continue on invalid data
-                    continue;
+                    out += '\t';
+                    if (cellLengths.at(cell + i) > 0) appendValue(out, data + cellOffsets.at(cell + i), cellLengths.at(cell + i));
                 }
-
-                // Check if this is NaN
-                if (fields.at(i) == 0 || fields.at(i) == "")
+                out += '\t';
+            }
+            else
+            {
+                // The present values move to the front, the rest is filled
+                int count = 0;
+                for (int i = 0; i < keyCount; ++i)
                 {
-                    // Value was empty, replace it
-                    fields.replace(i, fillValues[i-1]);
-                    //qDebug() << "FILL" << fillValues.at(i-1);
+                    if (cellLengths.at(cell + i) > 0) present[count++] = cell + i;
                 }
-                else
+                for (int i = 0; i < keyCount; ++i)
                 {
-                    // Value was not NaN, use it as
-                    // new fill value
-                    fillValues.replace(i-1, fields[i]);
+                    out += '\t';
+                    if (i < count)
+                    {
+                        const char* value = data + cellOffsets.at(present.at(i));
+                        const int length = cellLengths.at(present.at(i));
+                        // A single space is kept, but does not become a fill value
+                        if (length != 1 || value[0] != ' ')
+                        {
+                            fillOffsets[i] = value - data;
+                            fillLengths[i] = length;
+                        }
+                        appendValue(out, value, length);
+                    }
+                    else if (fillOffsets.at(i) < 0)
+                    {
+                        out += "NaN";
+                    }
+                    else
+                    {
+                        appendValue(out, data + fillOffsets.at(i), fillLengths.at(i));
+                    }
                 }
             }
-            outLines->replace(index, fields.join(separator));
+            out += '\n';
         }
-    }
 
-    // Add header, write out file
-    file.close();
-
-    if (outFileName == logFileName) {
-        QFile::remove(file.fileName());
-        outfile.setFileName(file.fileName());
+        if (out.size() >= writeSize)
+        {
+            outfile.write(out);
+            out.clear();
+        }
 
+        currentDataLine = lastRow;
+        const int percent = static_cast<int>(lastRow * 100.0 / finalTimes.size());
+        if (dataLines > 100 && percent > lastPercent)
+        {
+            lastPercent = percent;
+            emit logProcessingStatusChanged(tr("Log compressor: Processed %1% of %2 lines").arg(lastRow/(float)dataLines*100, 0, 'f', 2).arg(dataLines));
+        }
     }
-    if (!outfile.open(QIODevice::WriteOnly | QIODevice::Text))
-        return;
-    outfile.write(QString(QString("timestamp_ms") + separator + header.replace(" ", "_") + QString("\n")).toLatin1());
-    emit logProcessingStatusChanged(tr("Log Compressor: Writing output to file %1").arg(QFileInfo(outFileName).absoluteFilePath()));
-
-    // File output
-    for (int i = 0; i < outLines->length(); i++) {
-        //qDebug() << outLines->at(i);
-        outfile.write(QString(outLines->at(i) + "\n").toLatin1());
+    qDeleteAll(chunks);
+    chunks.clear();
+    outfile.write(out);
+    outfile.close();
 
+    // Replace the log if requested
+    file.close();
+    if (replace)
+    {
+        QFile::remove(outFileName);
+        QFile::rename(outfile.fileName(), outFileName);
+        outfile.setFileName(outFileName);
     }
 
     currentDataLine = 0;
     dataLines = 1;
-    delete keys;
     emit logProcessingStatusChanged(tr("Log compressor: Finished processing file: %1").arg(outfile.fileName()));
     qDebug() << "Done with logfile processing";
     emit finishedFile(outfile.fileName());
@@ -24,6 +24,12 @@ protected:
     int dataLines;
     int uasid;
     bool holeFillingEnabled;       ///< Enables the filling of holes in the dataset with the previous value (or NaN if none exists)
+    int windowCells;               ///< Number of values in the matrix of one window of rows
+
+    static const int maxWorkers = 8;             ///< Maximum number of threads parsing the log
+    static const int maxWindowCells = 1024*1024; ///< Default number of values in the matrix of one window of rows
+    static const int segmentSize = 64*1024;      ///< Lines are searched for the values of a window in pieces of about this size
+    static const int writeSize = 1024*1024;      ///< Output is written in pieces of about this size
 
 signals:
     /** @brief This signal is emitted once a logfile has been finished writing
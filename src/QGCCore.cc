@@ -52,6 +52,7 @@ This file is part of the QGROUNDCONTROL project
 #endif
 #include "UDPLink.h"
 #include "MAVLinkSimulationLink.h"
+#include "MAVLinkSwarmSimulationLink.h"
 
 
 /**
@@ -159,6 +160,16 @@ QGCCore::QGCCore(int &argc, char* argv[]) : QApplication(argc, argv)
     simulationLink->disconnect();
     //mainWindow->addLink(simulationLink);
 
+    // Emulate a swarm for load testing, e.g. --swarm 200
+    int swarmIndex = arguments().indexOf("--swarm");
+    if (swarmIndex > 0 && swarmIndex + 1 < arguments().size())
+    {
+        MAVLinkSwarmSimulationLink* swarmLink = new MAVLinkSwarmSimulationLink();
+        swarmLink->setVehicleCount(arguments().at(swarmIndex + 1).toInt());
+        MainWindow::instance()->addLink(swarmLink);
+        swarmLink->connect();
+    }
+
     mainWindow = MainWindow::instance(splashScreen);
 
     // Remove splash screen
@@ -87,9 +87,10 @@ void LinkManager::addProtocol(LinkInterface* link, ProtocolInterface* protocol)
     // OR if link has not been added to protocol, add
     if ((linkList.length() > 0 && !linkList.contains(link)) || linkList.length() == 0) {
         // Protocol is new, add
-        connect(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)), protocol, SLOT(receiveBytes(LinkInterface*, QByteArray)));
+        connect(link, SIGNAL(bytesReceived(LinkInterface*, QByteArray)), protocol, SLOT(receiveBytes(LinkInterface*, QByteArray)), protocol->receiveConnectionType());
         // Store the connection information in the protocol links map
         protocolLinks.insertMulti(protocol, link);
+        emit protocolLinksChanged(protocol);
     }
     //qDebug() << __FILE__ << __LINE__ << "ADDED LINK TO PROTOCOL" << link->getName() << protocol->getName() << "NEW SIZE OF LINK LIST:" << protocolLinks.size();
 }
@@ -157,6 +158,7 @@ bool LinkManager::removeLink(LinkInterface* link)
         QList<ProtocolInterface* > protocols = protocolLinks.keys(link);
         foreach (ProtocolInterface* proto, protocols) {
             protocolLinks.remove(proto, link);
+            emit protocolLinksChanged(proto);
         }
         return true;
     }
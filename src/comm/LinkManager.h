@@ -91,6 +91,8 @@ private:
 
 signals:
     void newLink(LinkInterface* link);
+    /** @brief The links of a protocol changed, emitted after the change */
+    void protocolLinksChanged(ProtocolInterface* protocol);
 
 };
 
@@ -0,0 +1,233 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkMessagePool
+ *
+ */
+
+#include <QThreadStorage>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "MAVLinkMessagePool.h"
+#include "QGC.h"
+
+/** @brief Thread local owner of a pool, orphans the pool once the thread exits */
+class MAVLinkMessagePoolHolder
+{
+public:
+    MAVLinkMessagePoolHolder() :
+        pool(new MAVLinkMessagePool())
+    {
+    }
+
+    ~MAVLinkMessagePoolHolder()
+    {
+        pool->orphan();
+    }
+
+    MAVLinkMessagePool* pool;
+};
+
+static QThreadStorage<MAVLinkMessagePoolHolder*> pools;
+static QAtomicInt allocations;
+static QAtomicInt acquisitions;
+
+MAVLinkMessagePool::MAVLinkMessagePool() :
+    freeBlocks(NULL),
+    freeCount(0),
+    returnedBlocks(NULL),
+    users(1),
+    orphaned(0)
+{
+}
+
+MAVLinkMessagePool::~MAVLinkMessagePool()
+{
+}
+
+MAVLinkMessagePool::Block* MAVLinkMessagePool::acquire()
+{
+    if (!pools.hasLocalData())
+    {
+        pools.setLocalData(new MAVLinkMessagePoolHolder());
+    }
+    return pools.localData()->pool->take();
+}
+
+MAVLinkMessagePool::Block* MAVLinkMessagePool::take()
+{
+    if (!freeBlocks)
+    {
+        // Take over everything other threads handed back since the last time
+        freeBlocks = returnedBlocks.fetchAndStoreAcquire(NULL);
+        freeCount = 0;
+        for (Block* block = freeBlocks; block; block = block->next)
+        {
+            freeCount++;
+        }
+        // Shrink back after a burst
+        while (freeCount > maxFreeBlocks)
+        {
+            Block* block = freeBlocks;
+            freeBlocks = block->next;
+            freeCount--;
+            delete block;
+            unreference();
+        }
+    }
+
+    Block* block = freeBlocks;
+    if (block)
+    {
+        freeBlocks = block->next;
+        freeCount--;
+    }
+    else
+    {
+        block = new Block;
+        block->pool = this;
+        users.ref();
+        allocations.ref();
+    }
+    block->ref = 1;
+    acquisitions.ref();
+    return block;
+}
+
+/**
+ * The owner thread puts the block back onto its freelist. Any other thread
+ * pushes it onto the return stack and holds a reference of the pool while
+ * doing so, as the owner could exit at the same time. If it did, nobody
+ * will take over the return stack again and the releasing thread deletes
+ * the returned blocks itself.
+ */
+void MAVLinkMessagePool::recycle(Block* block)
+{
+    if (pools.hasLocalData() && pools.localData()->pool == this)
+    {
+        if (freeCount < maxFreeBlocks)
+        {
+            block->next = freeBlocks;
+            freeBlocks = block;
+            freeCount++;
+        }
+        else
+        {
+            delete block;
+            unreference();
+        }
+        return;
+    }
+
+    users.ref();
+    Block* head;
+    do
+    {
+        head = returnedBlocks;
+        block->next = head;
+    }
+    while (!returnedBlocks.testAndSetOrdered(head, block));
+
+    if (orphaned.fetchAndAddOrdered(0))
+    {
+        drain();
+    }
+    unreference();
+}
+
+void MAVLinkMessagePool::drain()
+{
+    Block* block = returnedBlocks.fetchAndStoreOrdered(NULL);
+    while (block)
+    {
+        Block* next = block->next;
+        delete block;
+        unreference();
+        block = next;
+    }
+}
+
+void MAVLinkMessagePool::orphan()
+{
+    orphaned.fetchAndStoreOrdered(1);
+    while (freeBlocks)
+    {
+        Block* block = freeBlocks;
+        freeBlocks = block->next;
+        delete block;
+        unreference();
+    }
+    freeCount = 0;
+    drain();
+    // Drop the reference of the owner thread
+    unreference();
+}
+
+void MAVLinkMessagePool::unreference()
+{
+    if (!users.deref())
+    {
+        delete this;
+    }
+}
+
+unsigned int MAVLinkMessagePool::getAllocations()
+{
+    return static_cast<unsigned int>(allocations.fetchAndAddRelaxed(0));
+}
+
+unsigned int MAVLinkMessagePool::getAcquisitions()
+{
+    return static_cast<unsigned int>(acquisitions.fetchAndAddRelaxed(0));
+}
+
+/**
+ * The rate is updated at most once per second, calls in between return
+ * the last value. The counters wrap around, only their difference is used.
+ */
+float MAVLinkMessagePool::getAllocationRate()
+{
+    static QMutex mutex;
+    static quint64 lastTime = 0;
+    static unsigned int lastAllocations = 0;
+    static float rate = 0.0f;
+
+    QMutexLocker locker(&mutex);
+    quint64 time = QGC::groundTimeMilliseconds();
+    unsigned int count = getAllocations();
+    if (lastTime == 0)
+    {
+        lastTime = time;
+        lastAllocations = count;
+    }
+    else if (time - lastTime >= 1000)
+    {
+        rate = (count - lastAllocations) * 1000.0f / (time - lastTime);
+        lastTime = time;
+        lastAllocations = count;
+    }
+    return rate;
+}
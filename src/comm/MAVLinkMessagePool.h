@@ -0,0 +1,189 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Pooled, reference counted storage of received MAVLink messages
+ *
+ */
+
+#ifndef MAVLINKMESSAGEPOOL_H
+#define MAVLINKMESSAGEPOOL_H
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMetaType>
+#include <string.h>
+#include "QGCMAVLink.h"
+
+/**
+ * @brief Per-thread freelist of message blocks
+ *
+ * Every thread allocating messages owns one pool. Blocks released in the
+ * owning thread go straight back to its freelist, blocks released in any
+ * other thread are pushed onto a lock-free return stack which the owner
+ * takes over as a whole once its freelist runs empty. The heap is thus
+ * only touched until the pool reached the working set of its thread.
+ *
+ * If the owning thread exits while blocks are still in use, the pool is
+ * orphaned: the remaining blocks are deleted on release and the pool
+ * itself once the last block is gone.
+ */
+class MAVLinkMessagePool
+{
+public:
+    /** @brief One message together with its reference count */
+    struct Block
+    {
+        QAtomicInt ref;              ///< Number of handles sharing this block
+        MAVLinkMessagePool* pool;    ///< Pool the block returns to
+        Block* next;                 ///< Next block in a freelist
+        mavlink_message_t message;   ///< The message, immutable once shared
+    };
+
+    /** @brief Get a block with a reference count of one from the pool of the calling thread */
+    static Block* acquire();
+    /** @brief Drop one reference, the block returns to its pool with the last one */
+    static void release(Block* block) {
+        if (!block->ref.deref()) block->pool->recycle(block);
+    }
+
+    /** @brief Get the number of blocks allocated on the heap so far */
+    static unsigned int getAllocations();
+    /** @brief Get the number of blocks handed out so far, recycled or not */
+    static unsigned int getAcquisitions();
+    /** @brief Get the heap allocations per second, averaged over at least one second */
+    static float getAllocationRate();
+
+    /** @brief Maximum number of free blocks kept per thread */
+    static const int maxFreeBlocks = 4096;
+
+protected:
+    MAVLinkMessagePool();
+    ~MAVLinkMessagePool();
+
+    /** @brief Take a block from the freelist or the heap, owner thread only */
+    Block* take();
+    /** @brief Return a block with no references left, any thread */
+    void recycle(Block* block);
+    /** @brief Delete all blocks handed back by other threads */
+    void drain();
+    /** @brief Detach the pool from its exiting owner thread */
+    void orphan();
+    /** @brief Drop one user, deletes the pool with the last one */
+    void unreference();
+
+    Block* freeBlocks;                    ///< Freelist, owner thread only
+    int freeCount;                        ///< Length of the freelist
+    QAtomicPointer<Block> returnedBlocks; ///< Blocks released by other threads
+    QAtomicInt users;                     ///< Live blocks plus one for the owner thread
+    QAtomicInt orphaned;                  ///< Non-zero once the owner thread exited
+
+    friend class MAVLinkMessagePoolHolder;
+
+private:
+    Q_DISABLE_COPY(MAVLinkMessagePool)
+};
+
+/**
+ * @brief Shared, immutable handle of a received message
+ *
+ * Copying a handle only increments the reference count of the underlying
+ * block, so all listeners of a message read the same copy, regardless of
+ * the thread they run in. The message may only be written through data()
+ * as long as the handle is not shared.
+ */
+class MAVLinkMessageHandle
+{
+public:
+    /** @brief Create a null handle */
+    MAVLinkMessageHandle() :
+        block(NULL)
+    {
+    }
+
+    /** @brief Copy a message into a new pooled block */
+    explicit MAVLinkMessageHandle(const mavlink_message_t& message) :
+        block(MAVLinkMessagePool::acquire())
+    {
+        memcpy(&block->message, &message, sizeof(mavlink_message_t));
+    }
+
+    MAVLinkMessageHandle(const MAVLinkMessageHandle& other) :
+        block(other.block)
+    {
+        if (block) block->ref.ref();
+    }
+
+    ~MAVLinkMessageHandle()
+    {
+        if (block) MAVLinkMessagePool::release(block);
+    }
+
+    MAVLinkMessageHandle& operator=(const MAVLinkMessageHandle& other)
+    {
+        if (other.block) other.block->ref.ref();
+        if (block) MAVLinkMessagePool::release(block);
+        block = other.block;
+        return *this;
+    }
+
+    /** @brief Create a handle of an uninitialized message, to be filled through data() */
+    static MAVLinkMessageHandle create()
+    {
+        MAVLinkMessageHandle handle;
+        handle.block = MAVLinkMessagePool::acquire();
+        return handle;
+    }
+
+    bool isNull() const {
+        return block == NULL;
+    }
+    /** @brief Check if other handles refer to the same message */
+    bool isShared() const {
+        return block && block->ref != 1;
+    }
+
+    const mavlink_message_t& operator*() const {
+        return block->message;
+    }
+    const mavlink_message_t* operator->() const {
+        return &block->message;
+    }
+    const mavlink_message_t* constData() const {
+        return &block->message;
+    }
+    /** @brief Get the writable message, only valid as long as the handle is not shared */
+    mavlink_message_t* data() {
+        Q_ASSERT(block && !isShared());
+        return &block->message;
+    }
+
+private:
+    MAVLinkMessagePool::Block* block;
+};
+
+Q_DECLARE_TYPEINFO(MAVLinkMessageHandle, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(MAVLinkMessageHandle)
+
+#endif // MAVLINKMESSAGEPOOL_H
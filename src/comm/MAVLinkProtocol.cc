@@ -47,17 +47,21 @@ MAVLinkProtocol::MAVLinkProtocol() :
     m_multiplexingEnabled(false),
     m_authEnabled(false),
     m_loggingEnabled(false),
-    m_logfile(NULL),
-    m_enable_version_check(true),
+    logWriter(new QGCMAVLinkLogWriter(this)),
+    m_enable_version_check(1),
     m_paramRetransmissionTimeout(350),
     m_paramRewriteTimeout(500),
     m_paramGuardEnabled(true),
     m_actionGuardEnabled(false),
     m_actionRetransmissionTimeout(100),
-    versionMismatchIgnore(false),
-    systemId(QGC::defaultSystemId)
+    versionMismatchIgnore(0),
+    systemId(QGC::defaultSystemId),
+    worker(new MAVLinkProtocolWorker(this)),
+    sendLinksValid(false)
 {
     m_authKey = "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx";
+    connect(logWriter, SIGNAL(writeFailed(QString)), this, SLOT(logWriteFailed(QString)), Qt::QueuedConnection);
+    connect(logWriter, SIGNAL(recordsDroppedChanged(QString,int,int)), this, SIGNAL(logRecordsDropped(QString,int,int)), Qt::QueuedConnection);
     loadSettings();
     //start(QThread::LowPriority);
     // Start heartbeat timer, emitting a heartbeat at the configured rate
@@ -73,9 +77,20 @@ MAVLinkProtocol::MAVLinkProtocol() :
         {
             lastIndex[i][j] = -1;
         }
+        systemRoutes[i] = NULL;
+        knownSystems[i] = false;
     }
 
-    emit versionCheckChanged(m_enable_version_check);
+    // Rebuild the cached send links only if links come and go
+    connect(LinkManager::instance(), SIGNAL(protocolLinksChanged(ProtocolInterface*)), this, SLOT(protocolLinksChanged(ProtocolInterface*)));
+
+    // Parse on the protocol worker, deliver in the thread of this object
+    qRegisterMetaType<MAVLinkMessageHandle>("MAVLinkMessageHandle");
+    connect(worker, SIGNAL(messagesReceived(MAVLinkMessageBatch)), this, SLOT(receiveMessages(MAVLinkMessageBatch)), Qt::QueuedConnection);
+    connect(worker, SIGNAL(receiveErrorsChanged(int,int)), this, SIGNAL(receiveErrorsChanged(int,int)), Qt::QueuedConnection);
+    worker->start(QThread::HighPriority);
+
+    emit versionCheckChanged(versionCheckEnabled());
 }
 
 void MAVLinkProtocol::loadSettings()
@@ -85,17 +100,17 @@ void MAVLinkProtocol::loadSettings()
     settings.sync();
     settings.beginGroup("QGC_MAVLINK_PROTOCOL");
     enableHeartbeats(settings.value("HEARTBEATS_ENABLED", m_heartbeatsEnabled).toBool());
-    enableVersionCheck(settings.value("VERSION_CHECK_ENABLED", m_enable_version_check).toBool());
+    enableVersionCheck(settings.value("VERSION_CHECK_ENABLED", versionCheckEnabled()).toBool());
     enableMultiplexing(settings.value("MULTIPLEXING_ENABLED", m_multiplexingEnabled).toBool());
 
     // Only set logfile if there is a name present in settings
-    if (settings.contains("LOGFILE_NAME") && m_logfile == NULL)
+    if (settings.contains("LOGFILE_NAME") && m_logfileName.isEmpty())
     {
-        m_logfile = new QFile(settings.value("LOGFILE_NAME").toString());
+        m_logfileName = settings.value("LOGFILE_NAME").toString();
     }
-    else if (m_logfile == NULL)
+    else if (m_logfileName.isEmpty())
     {
-        m_logfile = new QFile(QDesktopServices::storageLocation(QDesktopServices::HomeLocation) + "/qgroundcontrol_packetlog.mavlink");
+        m_logfileName = QDesktopServices::storageLocation(QDesktopServices::HomeLocation) + "/qgroundcontrol_packetlog.mavlink";
     }
     // Enable logging
     enableLogging(settings.value("LOGGING_ENABLED", m_loggingEnabled).toBool());
@@ -128,15 +143,15 @@ void MAVLinkProtocol::storeSettings()
     settings.beginGroup("QGC_MAVLINK_PROTOCOL");
     settings.setValue("HEARTBEATS_ENABLED", m_heartbeatsEnabled);
     settings.setValue("LOGGING_ENABLED", m_loggingEnabled);
-    settings.setValue("VERSION_CHECK_ENABLED", m_enable_version_check);
+    settings.setValue("VERSION_CHECK_ENABLED", versionCheckEnabled());
     settings.setValue("MULTIPLEXING_ENABLED", m_multiplexingEnabled);
     settings.setValue("GCS_SYSTEM_ID", systemId);
     settings.setValue("GCS_AUTH_KEY", m_authKey);
     settings.setValue("GCS_AUTH_ENABLED", m_authEnabled);
-    if (m_logfile)
+    if (!m_logfileName.isEmpty())
     {
         // Logfile exists, store the name
-        settings.setValue("LOGFILE_NAME", m_logfile->fileName());
+        settings.setValue("LOGFILE_NAME", m_logfileName);
     }
     // Parameter interface settings
     settings.setValue("PARAMETER_RETRANSMISSION_TIMEOUT", m_paramRetransmissionTimeout);
@@ -150,23 +165,18 @@ void MAVLinkProtocol::storeSettings()
 MAVLinkProtocol::~MAVLinkProtocol()
 {
     storeSettings();
-    if (m_logfile)
-    {
-        if (m_logfile->isOpen())
-        {
-            m_logfile->flush();
-            m_logfile->close();
-        }
-        delete m_logfile;
-        m_logfile = NULL;
-    }
+    // Stop parsing before the log file is closed
+    worker->stop();
+    delete worker;
+    worker = NULL;
+    logWriter->close();
 }
 
 QString MAVLinkProtocol::getLogfileName()
 {
-    if (m_logfile)
+    if (!m_logfileName.isEmpty())
     {
-        return m_logfile->fileName();
+        return m_logfileName;
     }
     else
     {
@@ -176,7 +186,9 @@ QString MAVLinkProtocol::getLogfileName()
 
 /**
  * The bytes are copied by calling the LinkInterface::readBytes() method.
- * This method parses all incoming bytes and constructs a MAVLink packet.
+ * This method only queues the bytes for the protocol worker, which parses
+ * them and constructs the MAVLink packets. It is thread-safe and directly
+ * called from the thread of the link.
  * It can handle multiple links in parallel, as each link has it's own buffer/
  * parsing state machine.
  * @param link The interface to read from
@@ -184,15 +196,29 @@ QString MAVLinkProtocol::getLogfileName()
  **/
 void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 {
-//    receiveMutex.lock();
-    mavlink_message_t message;
-    mavlink_status_t status;
+    worker->pushBytes(link, b);
+}
 
-    for (int position = 0; position < b.size(); position++) {
-        unsigned int decodeState = mavlink_parse_char(link->getId(), (uint8_t)(b.at(position)), &message, &status);
+/**
+ * Executed in the protocol worker thread. Parses the bytes, logs and counts
+ * the decoded messages and appends them to the batch for the GUI thread.
+ *
+ * @param link The interface the bytes were received on
+ * @param parser The frame parser holding the parsing state of this interface
+ * @param data The received bytes
+ * @param length The number of received bytes
+ * @param batch The decoded messages are appended to this batch
+ **/
+void MAVLinkProtocol::parseBytes(LinkInterface* link, QGCMAVLinkFrameParser* parser, const char* data, int length, MAVLinkMessageBatch& batch)
+{
+    // Messages are parsed straight into pooled blocks, a block is only
+    // replaced once it was handed to the batch
+    MAVLinkMessageHandle handle = MAVLinkMessageHandle::create();
 
-        if (decodeState == 1)
-        {
+    parser->setData(data, length);
+    while (parser->next(handle.data()))
+    {
+        const mavlink_message_t& message = *handle;
 //#ifdef MAVLINK_MESSAGE_LENGTHS
 //	    const uint8_t message_lengths[] = MAVLINK_MESSAGE_LENGTHS;
 //	    if (message.msgid >= sizeof(message_lengths) ||
@@ -203,219 +229,292 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
 //#endif
 #if defined(QGC_PROTOBUF_ENABLED)
 
-            if (message.msgid == MAVLINK_MSG_ID_EXTENDED_MESSAGE)
-            {
-                mavlink_extended_message_t extended_message;
+        if (message.msgid == MAVLINK_MSG_ID_EXTENDED_MESSAGE)
+        {
+            mavlink_extended_message_t extended_message;
 
-                extended_message.base_msg = message;
+            extended_message.base_msg = message;
 
-                // read extended header
-                uint8_t* payload = reinterpret_cast<uint8_t*>(message.payload64);
-                memcpy(&extended_message.extended_payload_len, payload + 3, 4);
+            // read extended header
+            const uint8_t* payload = reinterpret_cast<const uint8_t*>(message.payload64);
+            memcpy(&extended_message.extended_payload_len, payload + 3, 4);
 
-                const uint8_t* extended_payload = reinterpret_cast<const uint8_t*>(b.constData()) + MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_EXTENDED_HEADER_LEN;
+            const uint8_t* extended_payload = reinterpret_cast<const uint8_t*>(data) + MAVLINK_NUM_NON_PAYLOAD_BYTES + MAVLINK_EXTENDED_HEADER_LEN;
 
-                // copy extended payload data
-                memcpy(extended_message.extended_payload, extended_payload, extended_message.extended_payload_len);
+            // copy extended payload data
+            memcpy(extended_message.extended_payload, extended_payload, extended_message.extended_payload_len);
 
 #if defined(QGC_USE_PIXHAWK_MESSAGES)
 
-                if (protobufManager.cacheFragment(extended_message))
+            if (protobufManager.cacheFragment(extended_message))
+            {
+                std::tr1::shared_ptr<google::protobuf::Message> protobuf_msg;
+
+                if (protobufManager.getMessage(protobuf_msg))
                 {
-                    std::tr1::shared_ptr<google::protobuf::Message> protobuf_msg;
+                    const google::protobuf::Descriptor* descriptor = protobuf_msg->GetDescriptor();
+                    if (!descriptor)
+                    {
+                        continue;
+                    }
 
-                    if (protobufManager.getMessage(protobuf_msg))
+                    const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
+                    if (!headerField)
                     {
-                        const google::protobuf::Descriptor* descriptor = protobuf_msg->GetDescriptor();
-                        if (!descriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* headerField = descriptor->FindFieldByName("header");
-                        if (!headerField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
-                        if (!headerDescriptor)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
-                        if (!sourceSysIdField)
-                        {
-                            continue;
-                        }
-
-                        const google::protobuf::Reflection* reflection = protobuf_msg->GetReflection();
-                        const google::protobuf::Message& headerMsg = reflection->GetMessage(*protobuf_msg, headerField);
-                        const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
-
-                        int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
-
-                        UASInterface* uas = UASManager::instance()->getUASForId(source_sysid);
-
-                        if (uas != NULL)
-                        {
-                            emit extendedMessageReceived(link, protobuf_msg);
-                        }
+                        continue;
+                    }
+
+                    const google::protobuf::Descriptor* headerDescriptor = headerField->message_type();
+                    if (!headerDescriptor)
+                    {
+                        continue;
+                    }
+
+                    const google::protobuf::FieldDescriptor* sourceSysIdField = headerDescriptor->FindFieldByName("source_sysid");
+                    if (!sourceSysIdField)
+                    {
+                        continue;
+                    }
+
+                    const google::protobuf::Reflection* reflection = protobuf_msg->GetReflection();
+                    const google::protobuf::Message& headerMsg = reflection->GetMessage(*protobuf_msg, headerField);
+                    const google::protobuf::Reflection* headerReflection = headerMsg.GetReflection();
+
+                    int source_sysid = headerReflection->GetInt32(headerMsg, sourceSysIdField);
+
+                    if (source_sysid >= 0 && source_sysid < 256 && knownSystems[source_sysid])
+                    {
+                        emit extendedMessageReceived(link, protobuf_msg);
                     }
                 }
+            }
 #endif
 
-                position += extended_message.extended_payload_len;
+            parser->skip(extended_message.extended_payload_len);
 
-                continue;
-            }
+            continue;
+        }
 #endif
 
-            // Log data
-            if (m_loggingEnabled && m_logfile)
+        // Log data, queued for the log writer thread
+        logWriter->log(QGC::groundTimeUsecs(), message);
+
+        // Systems are only known once they sent a valid heartbeat,
+        // the UAS object is then created in the GUI thread
+        if (!knownSystems[message.sysid] && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+        {
+            mavlink_heartbeat_t heartbeat;
+            // Reset version field to 0
+            heartbeat.mavlink_version = 0;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
+
+            // Check if the UAS has a different protocol version
+            if (versionCheckEnabled() && (heartbeat.mavlink_version != MAVLINK_VERSION))
             {
-                const int len = MAVLINK_MAX_PACKET_LEN+sizeof(quint64);
-                uint8_t buf[len];
-                quint64 time = QGC::groundTimeUsecs();
-                memcpy(buf, (void*)&time, sizeof(quint64));
-                // Write message to buffer
-                mavlink_msg_to_send_buffer(buf+sizeof(quint64), &message);
-                QByteArray b((const char*)buf, len);
-                if(m_logfile->write(b) < static_cast<qint64>(MAVLINK_MAX_PACKET_LEN+sizeof(quint64)))
+                // Bring up dialog to inform user, only once
+                if (versionMismatchIgnore.testAndSetOrdered(0, 1))
                 {
-                    emit protocolStatusMessage(tr("MAVLink Logging failed"), tr("Could not write to file %1, disabling logging.").arg(m_logfile->fileName()));
-                    // Stop logging
-                    enableLogging(false);
+                    emit protocolStatusMessage(tr("The MAVLink protocol version on the MAV and QGroundControl mismatch!"),
+                                               tr("It is unsafe to use different MAVLink versions. QGroundControl therefore refuses to connect to system %1, which sends MAVLink version %2 (QGroundControl uses version %3).").arg(message.sysid).arg(heartbeat.mavlink_version).arg(MAVLINK_VERSION));
                 }
+
+                // Ignore this message and continue gracefully
+                continue;
             }
 
-            // ORDER MATTERS HERE!
-            // If the matching UAS object does not yet exist, it has to be created
-            // before emitting the packetReceived signal
+            knownSystems[message.sysid] = true;
+        }
 
-            UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
+        // Only count message if the system is known
+        if (knownSystems[message.sysid])
+        {
+            // Increase receive counter
+            totalReceiveCounter++;
+            currReceiveCounter++;
+
+            // Update last message sequence ID
+            uint8_t expectedIndex;
+            if (lastIndex[message.sysid][message.compid] == -1)
+            {
+                lastIndex[message.sysid][message.compid] = message.seq;
+                expectedIndex = message.seq;
+            }
+            else
+            {
+                // NOTE: Using uint8_t here auto-wraps the number around to 0.
+                expectedIndex = lastIndex[message.sysid][message.compid] + 1;
+            }
 
-            // Check and (if necessary) create UAS object
-            if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+            // Make some noise if a message was skipped
+            //qDebug() << "SYSID" << message.sysid << "COMPID" << message.compid << "MSGID" << message.msgid << "EXPECTED INDEX:" << expectedIndex << "SEQ" << message.seq;
+            if (message.seq != expectedIndex)
             {
-                // ORDER MATTERS HERE!
-                // The UAS object has first to be created and connected,
-                // only then the rest of the application can be made aware
-                // of its existence, as it only then can send and receive
-                // it's first messages.
-
-                // Check if the UAS has the same id like this system
-                if (message.sysid == getSystemId())
+                // Determine how many messages were skipped accounting for 0-wraparound
+                int16_t lostMessages = message.seq - expectedIndex; 
+                if (lostMessages < 0)
+                {
+                    // Usually, this happens in the case of an out-of order packet
+                    lostMessages = 0;
+                }
+                else
                 {
-                    emit protocolStatusMessage(tr("SYSTEM ID CONFLICT!"), tr("Warning: A second system is using the same system id (%1)").arg(getSystemId()));
+                   qDebug() << QString("Lost %1 messages: expected sequence ID %2 but received %3.").arg(lostMessages).arg(expectedIndex).arg(message.seq);
                 }
+                totalLossCounter += lostMessages;
+                currLossCounter += lostMessages;
+            }
 
-                // Create a new UAS based on the heartbeat received
-                // Todo dynamically load plugin at run-time for MAV
-                // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
+            // Update the last sequence ID
+            lastIndex[message.sysid][message.compid] = message.seq;
 
-                // First create new UAS object
-                // Decode heartbeat message
-                mavlink_heartbeat_t heartbeat;
-                // Reset version field to 0
-                heartbeat.mavlink_version = 0;
-                mavlink_msg_heartbeat_decode(&message, &heartbeat);
+            // Update on every 32th packet
+            if (totalReceiveCounter % 32 == 0)
+            {
+                // Calculate new loss ratio
+                // Receive loss
+                float receiveLoss = (double)currLossCounter/(double)(currReceiveCounter+currLossCounter);
+                receiveLoss *= 100.0f;
+                currLossCounter = 0;
+                currReceiveCounter = 0;
+                emit receiveLossChanged(message.sysid, receiveLoss);
+            }
 
-                // Check if the UAS has a different protocol version
-                if (m_enable_version_check && (heartbeat.mavlink_version != MAVLINK_VERSION))
-                {
-                    // Bring up dialog to inform user
-                    if (!versionMismatchIgnore)
-                    {
-                        emit protocolStatusMessage(tr("The MAVLink protocol version on the MAV and QGroundControl mismatch!"),
-                                                   tr("It is unsafe to use different MAVLink versions. QGroundControl therefore refuses to connect to system %1, which sends MAVLink version %2 (QGroundControl uses version %3).").arg(message.sysid).arg(heartbeat.mavlink_version).arg(MAVLINK_VERSION));
-                        versionMismatchIgnore = true;
-                    }
+            MAVLinkReceivedMessage received;
+            received.link = link;
+            received.message = handle;
+            batch.append(received);
+            handle = MAVLinkMessageHandle::create();
+        }
+    }
+}
 
-                    // Ignore this message and continue gracefully
-                    continue;
-                }
+/**
+ * Executed in the GUI thread. Creates the UAS objects of new systems and
+ * hands the messages to their listeners.
+ *
+ * @param batch The messages decoded by the protocol worker
+ **/
+void MAVLinkProtocol::receiveMessages(MAVLinkMessageBatch batch)
+{
+    LinkInterface* forwardLink = NULL;
+    forwardBuffer.resize(0);
 
-                // Create a new UAS object
-                uas = QGCMAVLinkUASFactory::createUAS(this, link, message.sysid, &heartbeat);
-            }
+    foreach (const MAVLinkReceivedMessage& received, batch)
+    {
+        LinkInterface* link = received.link;
+        const mavlink_message_t& message = *received.message;
+
+        // ORDER MATTERS HERE!
+        // If the matching UAS object does not yet exist, it has to be created
+        // before emitting the packetReceived signal
+
+        UASInterface* uas = UASManager::instance()->getUASForId(message.sysid);
 
-            // Only count message if UAS exists for this message
-            if (uas != NULL)
+        // Check and (if necessary) create UAS object
+        if (uas == NULL && message.msgid == MAVLINK_MSG_ID_HEARTBEAT)
+        {
+            // ORDER MATTERS HERE!
+            // The UAS object has first to be created and connected,
+            // only then the rest of the application can be made aware
+            // of its existence, as it only then can send and receive
+            // it's first messages.
+
+            // Check if the UAS has the same id like this system
+            if (message.sysid == getSystemId())
             {
+                emit protocolStatusMessage(tr("SYSTEM ID CONFLICT!"), tr("Warning: A second system is using the same system id (%1)").arg(getSystemId()));
+            }
 
-                // Increase receive counter
-                totalReceiveCounter++;
-                currReceiveCounter++;
+            // Create a new UAS based on the heartbeat received
+            // Todo dynamically load plugin at run-time for MAV
+            // WIKISEARCH:AUTOPILOT_TYPE_INSTANTIATION
 
-                // Update last message sequence ID
-                uint8_t expectedIndex;
-                if (lastIndex[message.sysid][message.compid] == -1)
-                {
-                    lastIndex[message.sysid][message.compid] = message.seq;
-                    expectedIndex = message.seq;
-                }
-                else
-                {
-                    // NOTE: Using uint8_t here auto-wraps the number around to 0.
-                    expectedIndex = lastIndex[message.sysid][message.compid] + 1;
-                }
+            // First create new UAS object
+            // Decode heartbeat message, the protocol
+            // version was already checked by the worker
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&message, &heartbeat);
 
-                // Make some noise if a message was skipped
-                //qDebug() << "SYSID" << message.sysid << "COMPID" << message.compid << "MSGID" << message.msgid << "EXPECTED INDEX:" << expectedIndex << "SEQ" << message.seq;
-                if (message.seq != expectedIndex)
-                {
-                    // Determine how many messages were skipped accounting for 0-wraparound
-                    int16_t lostMessages = message.seq - expectedIndex; 
-                    if (lostMessages < 0)
-                    {
-                        // Usually, this happens in the case of an out-of order packet
-                        lostMessages = 0;
-                    }
-                    else
-                    {
-                       qDebug() << QString("Lost %1 messages: expected sequence ID %2 but received %3.").arg(lostMessages).arg(expectedIndex).arg(message.seq);
-                    }
-                    totalLossCounter += lostMessages;
-                    currLossCounter += lostMessages;
-                }
+            // Create a new UAS object
+            uas = QGCMAVLinkUASFactory::createUAS(this, link, message.sysid, &heartbeat);
+        }
 
-                // Update the last sequence ID
-                lastIndex[message.sysid][message.compid] = message.seq;
+        // Only emit message if UAS exists for this message
+        if (uas != NULL)
+        {
+            // Hand the packet to the listeners and to the UAS owning it
+            dispatchMessage(link, received.message);
 
-                // Update on every 32th packet
-                if (totalReceiveCounter % 32 == 0)
+            // Multiplex message if enabled
+            if (m_multiplexingEnabled)
+            {
+                // Forward the packets of consecutive messages from the
+                // same link at once, not to the link they came from
+                int packetLength = MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len;
+                if ((link != forwardLink || forwardBuffer.size() + packetLength > forwardChunkSize) && !forwardBuffer.isEmpty())
                 {
-                    // Calculate new loss ratio
-                    // Receive loss
-                    float receiveLoss = (double)currLossCounter/(double)(currReceiveCounter+currLossCounter);
-                    receiveLoss *= 100.0f;
-                    currLossCounter = 0;
-                    currReceiveCounter = 0;
-                    emit receiveLossChanged(message.sysid, receiveLoss);
+                    writeToLinks(forwardBuffer.constData(), forwardBuffer.size(), forwardLink);
+                    forwardBuffer.resize(0);
                 }
+                forwardLink = link;
 
-                // The packet is emitted as a whole, as it is only 255 - 261 bytes short
-                // kind of inefficient, but no issue for a groundstation pc.
-                // It buys as reentrancy for the whole code over all threads
-                emit messageReceived(link, message);
+                // The packet is relayed unchanged, keeping system ID and sequence
+                int pos = forwardBuffer.size();
+                forwardBuffer.resize(pos + packetLength);
+                mavlink_msg_to_send_buffer(reinterpret_cast<uint8_t*>(forwardBuffer.data()) + pos, &message);
+            }
+        }
+    }
 
-                // Multiplex message if enabled
-                if (m_multiplexingEnabled)
-                {
-                    // Get all links connected to this unit
-                    QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
+    if (!forwardBuffer.isEmpty())
+    {
+        writeToLinks(forwardBuffer.constData(), forwardBuffer.size(), forwardLink);
+    }
+}
 
-                    // Emit message on all links that are currently connected
-                    foreach (LinkInterface* currLink, links)
-                    {
-                        // Only forward this message to the other links,
-                        // not the link the message was received on
-                        if (currLink != link) sendMessage(currLink, message);
-                    }
-                }
-            }
+/**
+ * The packet is first emitted to all listeners interested in the complete
+ * traffic. They all share the one pooled copy made by the parser, emitting
+ * the handle only touches its reference count, also for listeners in other
+ * threads. The owning UAS is then looked up in the dispatch table, so the
+ * cost per packet does not grow with the number of systems.
+ *
+ * @param link The link the message was received on
+ * @param message The decoded message
+ */
+void MAVLinkProtocol::dispatchMessage(LinkInterface* link, const MAVLinkMessageHandle& message)
+{
+    emit messageReceived(link, message);
+
+    UAS* uas = systemRoutes[message->sysid];
+    if (uas)
+    {
+        uas->receiveMessage(link, *message);
+    }
+}
+
+void MAVLinkProtocol::addSystemRoute(UAS* uas)
+{
+    if (!uas) return;
+    int sysid = uas->getUASID();
+    if (sysid < 0 || sysid > 255) return;
+
+    if (systemRoutes[sysid] != uas)
+    {
+        systemRoutes[sysid] = uas;
+        connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeSystemRoute(QObject*)), Qt::UniqueConnection);
+    }
+}
+
+void MAVLinkProtocol::removeSystemRoute(QObject* uas)
+{
+    // The object is already partially destroyed here,
+    // only compare the addresses
+    for (int i = 0; i < 256; i++)
+    {
+        if (systemRoutes[i] && static_cast<QObject*>(systemRoutes[i]) == uas)
+        {
+            systemRoutes[i] = NULL;
         }
     }
 }
@@ -448,17 +547,50 @@ int MAVLinkProtocol::getComponentId()
 /**
  * @param message message to send
  */
+/**
+ * The message is serialized once and the same bytes are written to every
+ * link. It has to be finalized already, as done by the pack and encode
+ * functions, so all links see the same sequence number.
+ *
+ * @param message message to send
+ */
 void MAVLinkProtocol::sendMessage(mavlink_message_t message)
 {
-    // Get all links connected to this unit
-    QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int len = mavlink_msg_to_send_buffer(buffer, &message);
+    writeToLinks(reinterpret_cast<const char*>(buffer), len);
+}
+
+void MAVLinkProtocol::protocolLinksChanged(ProtocolInterface* protocol)
+{
+    if (protocol == this) sendLinksValid = false;
+}
 
-    // Emit message on all links that are currently connected
-    QList<LinkInterface*>::iterator i;
-    for (i = links.begin(); i != links.end(); ++i)
+const QVector<LinkInterface*>& MAVLinkProtocol::getSendLinks()
+{
+    if (!sendLinksValid)
     {
-        sendMessage(*i, message);
-        //qDebug() << __FILE__ << __LINE__ << "SENT MESSAGE OVER" << ((LinkInterface*)*i)->getName() << "LIST SIZE:" << links.size();
+        sendLinks = LinkManager::instance()->getLinksForProtocol(this).toVector();
+        sendLinksValid = true;
+    }
+    return sendLinks;
+}
+
+/**
+ * @param data The serialized packets
+ * @param length The number of bytes
+ * @param except Link to skip, e.g. the link the packets were received on
+ */
+void MAVLinkProtocol::writeToLinks(const char* data, int length, LinkInterface* except)
+{
+    const QVector<LinkInterface*>& links = getSendLinks();
+    for (int i = 0; i < links.size(); i++)
+    {
+        LinkInterface* link = links.at(i);
+        if (link != except && link->isConnected())
+        {
+            link->writeBytes(data, length);
+        }
     }
 }
 
@@ -576,19 +708,16 @@ void MAVLinkProtocol::enableLogging(bool enabled)
     bool changed = false;
     if (enabled != m_loggingEnabled) changed = true;
 
+    // Closing commits all records queued by the protocol worker
+    logWriter->close();
+
     if (enabled)
     {
-        if (m_logfile && m_logfile->isOpen())
-        {
-            m_logfile->flush();
-            m_logfile->close();
-        }
-
-        if (m_logfile)
+        if (!m_logfileName.isEmpty())
         {
-            if (!m_logfile->open(QIODevice::WriteOnly | QIODevice::Append))
+            if (!logWriter->open(m_logfileName))
             {
-                emit protocolStatusMessage(tr("Opening MAVLink logfile for writing failed"), tr("MAVLink cannot log to the file %1, please choose a different file. Stopping logging.").arg(m_logfile->fileName()));
+                emit protocolStatusMessage(tr("Opening MAVLink logfile for writing failed"), tr("MAVLink cannot log to the file %1, please choose a different file. Stopping logging.").arg(m_logfileName));
                 m_loggingEnabled = false;
             }
         }
@@ -597,39 +726,25 @@ void MAVLinkProtocol::enableLogging(bool enabled)
             emit protocolStatusMessage(tr("Opening MAVLink logfile for writing failed"), tr("MAVLink cannot start logging, no logfile selected."));
         }
     }
-    else if (!enabled)
-    {
-        if (m_logfile)
-        {
-            if (m_logfile->isOpen())
-            {
-                m_logfile->flush();
-                m_logfile->close();
-            }
-        }
-    }
     m_loggingEnabled = enabled;
     if (changed) emit loggingChanged(enabled);
 }
 
 void MAVLinkProtocol::setLogfileName(const QString& filename)
 {
-    if (!m_logfile)
-    {
-        m_logfile = new QFile(filename);
-    }
-    else
-    {
-        m_logfile->flush();
-        m_logfile->close();
-    }
-    m_logfile->setFileName(filename);
+    m_logfileName = filename;
     enableLogging(m_loggingEnabled);
 }
 
+void MAVLinkProtocol::logWriteFailed(const QString& filename)
+{
+    emit protocolStatusMessage(tr("MAVLink Logging failed"), tr("Could not write to file %1, disabling logging.").arg(filename));
+    enableLogging(false);
+}
+
 void MAVLinkProtocol::enableVersionCheck(bool enabled)
 {
-    m_enable_version_check = enabled;
+    m_enable_version_check = enabled ? 1 : 0;
     emit versionCheckChanged(enabled);
 }
 
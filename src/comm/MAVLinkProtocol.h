@@ -32,13 +32,17 @@ This file is part of the QGROUNDCONTROL project
 
 #include <QObject>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QString>
 #include <QTimer>
 #include <QFile>
 #include <QMap>
+#include <QVector>
 #include <QByteArray>
 #include "ProtocolInterface.h"
 #include "LinkInterface.h"
+#include "MAVLinkProtocolWorker.h"
+#include "QGCMAVLinkLogWriter.h"
 #include "QGCMAVLink.h"
 #include "QGC.h"
 
@@ -50,6 +54,7 @@ This file is part of the QGROUNDCONTROL project
 #endif
 #endif
 
+class UAS;
 
 /**
  * @brief MAVLink micro air vehicle protocol reference implementation.
@@ -68,6 +73,10 @@ public:
 
     /** @brief Get the human-friendly name of this protocol */
     QString getName();
+    /** @brief Links deliver their bytes directly from their thread, receiveBytes() is thread-safe */
+    Qt::ConnectionType receiveConnectionType() const {
+        return Qt::DirectConnection;
+    }
     /** @brief Get the system id of this application */
     int getSystemId();
     /** @brief Get the component id of this application */
@@ -84,7 +93,7 @@ public:
     }
     /** @brief Get protocol version check state */
     bool versionCheckEnabled() const {
-        return m_enable_version_check;
+        return m_enable_version_check != 0;
     }
     /** @brief Get the multiplexing state */
     bool multiplexingEnabled() const {
@@ -124,11 +133,31 @@ public:
     int getActionRetransmissionTimeout() {
         return m_actionRetransmissionTimeout;
     }
+    /**
+     * @brief Route all messages of one system directly to its UAS object
+     *
+     * Only the UAS owning a system ID receives the messages of this system,
+     * all other UAS objects never see them. Listeners interested in the
+     * complete traffic (inspector, decoder) connect to messageReceived().
+     *
+     * @param uas The UAS object owning the system ID uas->getUASID()
+     */
+    void addSystemRoute(UAS* uas);
+    /** @brief Get the UAS messages of this system ID are routed to, NULL if none */
+    UAS* getSystemRoute(int sysid) const {
+        return (sysid >= 0 && sysid < 256) ? systemRoutes[sysid] : NULL;
+    }
 
 public slots:
-    /** @brief Receive bytes from a communication interface */
+    /** @brief Receive bytes from a communication interface, called from the link thread */
     void receiveBytes(LinkInterface* link, QByteArray b);
-    /** @brief Send MAVLink message through serial interface */
+    /** @brief Receive the messages decoded by the protocol worker */
+    void receiveMessages(MAVLinkMessageBatch batch);
+    /** @brief Deliver a decoded message to the all-traffic listeners and the owning UAS */
+    void dispatchMessage(LinkInterface* link, const MAVLinkMessageHandle& message);
+    /** @brief Remove the route of a UAS, called once the UAS object is destroyed */
+    void removeSystemRoute(QObject* uas);
+    /** @brief Send MAVLink message through all links of this protocol */
     void sendMessage(mavlink_message_t message);
     /** @brief Send MAVLink message through serial interface */
     void sendMessage(LinkInterface* link, mavlink_message_t message);
@@ -163,6 +192,10 @@ public slots:
 
     /** @brief Set log file name */
     void setLogfileName(const QString& filename);
+    /** @brief Stop logging after the log writer failed */
+    void logWriteFailed(const QString& filename);
+    /** @brief Drop the cached links if the links of this protocol changed */
+    void protocolLinksChanged(ProtocolInterface* protocol);
 
     /** @brief Enable / disable version check */
     void enableVersionCheck(bool enabled);
@@ -184,6 +217,15 @@ public slots:
     void storeSettings();
 
 protected:
+    /** @brief Parse received bytes, executed in the protocol worker thread */
+    void parseBytes(LinkInterface* link, QGCMAVLinkFrameParser* parser, const char* data, int length, MAVLinkMessageBatch& batch);
+    friend class MAVLinkProtocolWorker;
+    friend class QGCMAVLinkLogReplay;
+    /** @brief Get the links of this protocol, cached until the links change */
+    const QVector<LinkInterface*>& getSendLinks();
+    /** @brief Write serialized packets to all connected links of this protocol */
+    void writeToLinks(const char* data, int length, LinkInterface* except = NULL);
+
     QTimer* heartbeatTimer;    ///< Timer to emit heartbeats
     int heartbeatRate;         ///< Heartbeat rate, controls the timer interval
     bool m_heartbeatsEnabled;  ///< Enabled/disable heartbeat emission
@@ -191,8 +233,9 @@ protected:
     bool m_authEnabled;        ///< Enable authentication token broadcast
     QString m_authKey;         ///< Authentication key
     bool m_loggingEnabled;     ///< Enable/disable packet logging
-    QFile* m_logfile;           ///< Logfile
-    bool m_enable_version_check; ///< Enable checking of version match of MAV and QGC
+    QString m_logfileName;     ///< Logfile
+    QGCMAVLinkLogWriter* logWriter; ///< Writes the logfile in the background
+    QAtomicInt m_enable_version_check; ///< Enable checking of version match of MAV and QGC, read by the protocol worker
     int m_paramRetransmissionTimeout; ///< Timeout for parameter retransmission
     int m_paramRewriteTimeout;    ///< Timeout for sending re-write request
     bool m_paramGuardEnabled;       ///< Parameter retransmission/rewrite enabled
@@ -200,19 +243,32 @@ protected:
     int m_actionRetransmissionTimeout; ///< Timeout for parameter retransmission
     QMutex receiveMutex;       ///< Mutex to protect receiveBytes function
     int lastIndex[256][256];	///< Store the last received sequence ID for each system/componenet pair
+    UAS* systemRoutes[256];     ///< Dispatch table, the UAS owning each system ID
+    bool knownSystems[256];     ///< Systems which sent a valid heartbeat, protocol worker only
     int totalReceiveCounter;
     int totalLossCounter;
     int currReceiveCounter;
     int currLossCounter;
-    bool versionMismatchIgnore;
+    QAtomicInt versionMismatchIgnore; ///< Set once the version mismatch was reported, protocol worker only
     int systemId;
+    MAVLinkProtocolWorker* worker; ///< Thread parsing the received bytes
+    QVector<LinkInterface*> sendLinks; ///< Links of this protocol, valid if sendLinksValid is set
+    bool sendLinksValid;
+    QByteArray forwardBuffer;   ///< Packets to multiplex, reused across batches
+    static const int forwardChunkSize = 1400; ///< Forwarded bytes per write, fits one Ethernet frame over UDP
 #if defined(QGC_PROTOBUF_ENABLED) && defined(QGC_USE_PIXHAWK_MESSAGES)
     mavlink::ProtobufManager protobufManager;
 #endif
 
 signals:
-    /** @brief Message received and directly copied via signal */
-    void messageReceived(LinkInterface* link, mavlink_message_t message);
+    /**
+     * @brief Message received, shared with all listeners via signal
+     *
+     * This signal carries the traffic of all systems. UAS objects do not
+     * connect to it, they are served through the dispatch table instead.
+     * The handle keeps the message alive as long as a listener holds it.
+     */
+    void messageReceived(LinkInterface* link, MAVLinkMessageHandle message);
 #if defined(QGC_PROTOBUF_ENABLED)
     /** @brief Message received via signal */
     void extendedMessageReceived(LinkInterface *link, std::tr1::shared_ptr<google::protobuf::Message> message);
@@ -229,8 +285,12 @@ signals:
     void authChanged(bool enabled);
     /** @brief Emitted if version check is enabled / disabled */
     void versionCheckChanged(bool enabled);
+    /** @brief Emitted if bytes were dropped or corrupt frames received, at most once per second */
+    void receiveErrorsChanged(int droppedBytes, int parseErrors);
     /** @brief Emitted if a message from the protocol should reach the user */
     void protocolStatusMessage(const QString& title, const QString& message);
+    /** @brief Emitted if the log writer dropped records because the disk did not keep up, at most once per second */
+    void logRecordsDropped(const QString& fileName, int dropped, int peakFill);
     /** @brief Emitted if a new system ID was set */
     void systemIdChanged(int systemId);
     /** @brief Emitted if param guard status changed */
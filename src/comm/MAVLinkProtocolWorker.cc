@@ -0,0 +1,174 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkProtocolWorker
+ *
+ */
+
+#include <QDebug>
+
+#include "MAVLinkProtocolWorker.h"
+#include "MAVLinkProtocol.h"
+
+MAVLinkProtocolWorker::MAVLinkProtocolWorker(MAVLinkProtocol* protocol) :
+    protocol(protocol),
+    running(false),
+    droppedBytes(0),
+    parseErrors(0),
+    reportedDroppedBytes(0),
+    reportedParseErrors(0)
+{
+    qRegisterMetaType<MAVLinkMessageBatch>("MAVLinkMessageBatch");
+}
+
+MAVLinkProtocolWorker::~MAVLinkProtocolWorker()
+{
+    stop();
+    QWriteLocker locker(&channelsLock);
+    qDeleteAll(channels);
+    channels.clear();
+}
+
+/**
+ * This method is executed in the thread of the emitting link. There is
+ * exactly one writing thread per link, so the ring of the link needs no lock.
+ * The channel map is only locked for reading, it only changes if a link
+ * is seen for the first time or deleted. The read lock is held while the
+ * bytes are copied, so removeLink() cannot delete the channel meanwhile.
+ *
+ * @param link The link the bytes were received on
+ * @param bytes The received bytes
+ */
+void MAVLinkProtocolWorker::pushBytes(LinkInterface* link, const QByteArray& bytes)
+{
+    QReadLocker locker(&channelsLock);
+    Channel* channel = channels.value(link, NULL);
+
+    if (!channel)
+    {
+        locker.unlock();
+        channelsLock.lockForWrite();
+        channel = channels.value(link, NULL);
+        if (!channel)
+        {
+            channel = new Channel;
+            channels.insert(link, channel);
+            connect(link, SIGNAL(deleteLink(LinkInterface* const)), this, SLOT(removeLink(LinkInterface* const)), Qt::DirectConnection);
+        }
+        channelsLock.unlock();
+
+        // The link may have been removed again before the read lock is back
+        locker.relock();
+        channel = channels.value(link, NULL);
+        if (!channel) return;
+    }
+
+    int written = channel->ring.write(bytes.constData(), bytes.size());
+    if (written < bytes.size())
+    {
+        // The worker does not keep up, drop the rest. The parser
+        // resynchronizes on the next start sign.
+        droppedBytes.fetchAndAddRelaxed(bytes.size() - written);
+    }
+    bytesAvailable.release();
+}
+
+void MAVLinkProtocolWorker::removeLink(LinkInterface* const link)
+{
+    QWriteLocker locker(&channelsLock);
+    delete channels.take(link);
+}
+
+void MAVLinkProtocolWorker::stop()
+{
+    running = false;
+    bytesAvailable.release();
+    wait();
+}
+
+/**
+ * Drains the rings of all links, one chunk per link and pass so a busy link
+ * cannot starve the others. All messages decoded in one pass are delivered
+ * as one batch.
+ */
+void MAVLinkProtocolWorker::run()
+{
+    running = true;
+    char buffer[4096];
+    MAVLinkMessageBatch batch;
+
+    while (running)
+    {
+        // Block until new bytes arrive, the timeout only
+        // guards against a lost wakeup
+        bytesAvailable.tryAcquire(1, 100);
+        bytesAvailable.tryAcquire(bytesAvailable.available());
+
+        bool pending = true;
+        while (pending && running)
+        {
+            pending = false;
+            channelsLock.lockForRead();
+            QMap<LinkInterface*, Channel*>::const_iterator i;
+            for (i = channels.constBegin(); i != channels.constEnd(); ++i)
+            {
+                int length = i.value()->ring.read(buffer, sizeof(buffer));
+                if (length > 0)
+                {
+                    QGCMAVLinkFrameParser* parser = &i.value()->parser;
+                    const quint64 errors = parser->getParseErrors();
+                    protocol->parseBytes(i.key(), parser, buffer, length, batch);
+                    parseErrors += parser->getParseErrors() - errors;
+                    if (length == sizeof(buffer)) pending = true;
+                }
+            }
+            channelsLock.unlock();
+        }
+
+        if (!batch.isEmpty())
+        {
+            emit messagesReceived(batch);
+            batch.clear();
+        }
+
+        reportErrors();
+    }
+}
+
+/**
+ * Reports the receive errors at most once per second and only if they
+ * changed, so a noisy link does not flood the GUI thread.
+ */
+void MAVLinkProtocolWorker::reportErrors()
+{
+    const quint64 dropped = static_cast<unsigned int>(droppedBytes.fetchAndAddRelaxed(0));
+    if (dropped == reportedDroppedBytes && parseErrors == reportedParseErrors) return;
+    if (reportTime.isValid() && reportTime.elapsed() < 1000) return;
+
+    reportTime.start();
+    reportedDroppedBytes = dropped;
+    reportedParseErrors = parseErrors;
+    emit receiveErrorsChanged(static_cast<int>(dropped), static_cast<int>(parseErrors));
+}
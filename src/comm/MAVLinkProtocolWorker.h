@@ -0,0 +1,126 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkProtocolWorker
+ *
+ */
+
+#ifndef MAVLINKPROTOCOLWORKER_H
+#define MAVLINKPROTOCOLWORKER_H
+
+#include <QThread>
+#include <QMap>
+#include <QVector>
+#include <QSemaphore>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+#include <QTime>
+#include <QMetaType>
+#include "LinkInterface.h"
+#include "QGCByteRing.h"
+#include "QGCMAVLinkFrameParser.h"
+#include "MAVLinkMessagePool.h"
+#include "QGCMAVLink.h"
+
+class MAVLinkProtocol;
+
+/** @brief A decoded message together with the link it was received on */
+struct MAVLinkReceivedMessage
+{
+    LinkInterface* link;
+    MAVLinkMessageHandle message; ///< Shared with all listeners, never copied
+};
+
+Q_DECLARE_TYPEINFO(MAVLinkReceivedMessage, Q_MOVABLE_TYPE);
+
+/** @brief Messages decoded in one pass of the protocol worker */
+typedef QVector<MAVLinkReceivedMessage> MAVLinkMessageBatch;
+
+Q_DECLARE_METATYPE(MAVLinkMessageBatch)
+
+/**
+ * @brief Protocol thread decoupling MAVLink parsing from the GUI thread
+ *
+ * Each link writes its received bytes into its own lock-free byte ring from
+ * the link thread. The worker drains all rings, parses the bytes, updates
+ * the loss statistics and the packet log and then hands the decoded
+ * messages in batches to the protocol object in the GUI thread. A slow
+ * repaint thus only delays the delivery of messages, but never the ingest.
+ */
+class MAVLinkProtocolWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkProtocolWorker(MAVLinkProtocol* protocol);
+    ~MAVLinkProtocolWorker();
+
+    /** @brief Queue bytes of a link, called from the thread of the link */
+    void pushBytes(LinkInterface* link, const QByteArray& bytes);
+    /** @brief Stop parsing and terminate the thread */
+    void stop();
+    /** @brief Get the number of bytes dropped because a ring was full */
+    quint64 getDroppedBytes() {
+        return static_cast<unsigned int>(droppedBytes.fetchAndAddRelaxed(0));
+    }
+
+public slots:
+    /** @brief Remove the ring of a link which is going to be deleted */
+    void removeLink(LinkInterface* const link);
+
+signals:
+    /** @brief A batch of messages was decoded */
+    void messagesReceived(MAVLinkMessageBatch batch);
+    /** @brief Bytes were dropped on full rings or corrupt frames were received, rate-limited */
+    void receiveErrorsChanged(int droppedBytes, int parseErrors);
+
+protected:
+    void run();
+    /** @brief Emit receiveErrorsChanged() if the counts changed, worker thread only */
+    void reportErrors();
+
+    /** @brief Receive buffer of one link */
+    struct Channel
+    {
+        QGCByteRing ring;             ///< Bytes written by the link, read by the worker
+        QGCMAVLinkFrameParser parser; ///< Parsing state of this link
+    };
+
+    MAVLinkProtocol* protocol;               ///< Protocol parsing the bytes
+    QMap<LinkInterface*, Channel*> channels; ///< Receive buffer per link
+    QReadWriteLock channelsLock;             ///< Only taken for writing if links come and go
+    QSemaphore bytesAvailable;               ///< Wakes up the worker for new bytes
+    volatile bool running;                   ///< False once stop() was called
+    QAtomicInt droppedBytes;                 ///< Bytes dropped on full rings, written by the link threads
+    quint64 parseErrors;                     ///< Corrupt frames of all links, worker thread only
+    quint64 reportedDroppedBytes;            ///< Dropped bytes at the last report
+    quint64 reportedParseErrors;             ///< Parse errors at the last report
+    QTime reportTime;                        ///< Time of the last report
+
+private:
+    Q_DISABLE_COPY(MAVLinkProtocolWorker)
+};
+
+#endif // MAVLINKPROTOCOLWORKER_H
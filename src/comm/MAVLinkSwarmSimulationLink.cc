@@ -1,10 +1,157 @@
+#include <string.h>
 #include "MAVLinkSwarmSimulationLink.h"
 
 MAVLinkSwarmSimulationLink::MAVLinkSwarmSimulationLink(QString readFile, QString writeFile, int rate, QObject *parent) :
-    MAVLinkSimulationLink(readFile, writeFile, rate, parent)
+    MAVLinkSimulationLink(readFile, writeFile, rate, parent),
+    vehicleCount(10),
+    workerCount(qBound(1, QThread::idealThreadCount() - 1, maxWorkers))
 {
+    name = tr("MAVLink swarm simulation");
+
+    memset(settings.rates, 0, sizeof(settings.rates));
+    settings.rates[MAVLINK_MSG_ID_HEARTBEAT] = 1.0f;
+    settings.rates[MAVLINK_MSG_ID_SYS_STATUS] = 1.0f;
+    settings.rates[MAVLINK_MSG_ID_ATTITUDE] = 25.0f;
+    settings.rates[MAVLINK_MSG_ID_GLOBAL_POSITION_INT] = 10.0f;
+    settings.rates[MAVLINK_MSG_ID_GPS_RAW_INT] = 5.0f;
+    settings.rates[MAVLINK_MSG_ID_VFR_HUD] = 10.0f;
+    settings.rates[MAVLINK_MSG_ID_SERVO_OUTPUT_RAW] = 2.0f;
+    settings.loss = 0.0f;
+    settings.jitter = 0;
+}
+
+MAVLinkSwarmSimulationLink::~MAVLinkSwarmSimulationLink()
+{
+    disconnect();
+    qDeleteAll(workers);
+    workers.clear();
+}
+
+void MAVLinkSwarmSimulationLink::setVehicleCount(int count)
+{
+    vehicleCount = qBound(1, count, maxVehicles);
+}
+
+void MAVLinkSwarmSimulationLink::setWorkerCount(int count)
+{
+    workerCount = qBound(1, count, maxWorkers);
+}
+
+void MAVLinkSwarmSimulationLink::setMessageRate(int msgid, float rate)
+{
+    if (msgid >= 0 && msgid < 256) settings.rates[msgid] = qMax(0.0f, rate);
+}
+
+void MAVLinkSwarmSimulationLink::setLoss(float probability)
+{
+    settings.loss = qBound(0.0f, probability, 1.0f);
+}
+
+void MAVLinkSwarmSimulationLink::setJitter(int usecs)
+{
+    settings.jitter = qMax(0, usecs);
+}
+
+quint64 MAVLinkSwarmSimulationLink::getFramesSent() const
+{
+    quint64 frames = 0;
+    foreach (MAVLinkSwarmSimulationWorker* worker, workers) frames += worker->getFramesSent();
+    return frames;
 }
 
+quint64 MAVLinkSwarmSimulationLink::getFramesLost() const
+{
+    quint64 frames = 0;
+    foreach (MAVLinkSwarmSimulationWorker* worker, workers) frames += worker->getFramesLost();
+    return frames;
+}
+
+quint64 MAVLinkSwarmSimulationLink::getFramesDropped() const
+{
+    quint64 frames = 0;
+    foreach (MAVLinkSwarmSimulationWorker* worker, workers) frames += worker->getFramesDropped();
+    return frames;
+}
+
+/**
+ * Start the workers and the thread collecting their frames. Each worker
+ * packs on its own MAVLink channel, counted down from the last one so the
+ * channels of the regular links stay untouched.
+ */
+bool MAVLinkSwarmSimulationLink::connect()
+{
+    if (isConnected()) return true;
+
+    // Statistics of the last run are kept until the link is connected again
+    qDeleteAll(workers);
+    workers.clear();
+
+    int count = qMin(workerCount, vehicleCount);
+    int firstSystemId = 1;
+    for (int i = 0; i < count; i++)
+    {
+        // Distribute the remainder over the first workers
+        int vehicles = vehicleCount / count + (i < vehicleCount % count ? 1 : 0);
+        int channel = MAVLINK_COMM_NUM_BUFFERS - 1 - (i % MAVLINK_COMM_NUM_BUFFERS);
+        workers.append(new MAVLinkSwarmSimulationWorker(firstSystemId, vehicles, channel, settings, &bytesAvailable));
+        firstSystemId += vehicles;
+    }
+
+    _isConnected = true;
+    start(LowPriority);
+    foreach (MAVLinkSwarmSimulationWorker* worker, workers) worker->start(LowPriority);
+
+    emit connected();
+    emit connected(true);
+    return true;
+}
+
+bool MAVLinkSwarmSimulationLink::disconnect()
+{
+    if (!isConnected()) return true;
+
+    foreach (MAVLinkSwarmSimulationWorker* worker, workers) worker->stop();
+    _isConnected = false;
+    bytesAvailable.release();
+    wait();
+
+    emit disconnected();
+    emit connected(false);
+    return true;
+}
+
+/**
+ * Collect the frames of all workers. The thread sleeps until a worker
+ * signals new data and then empties all rings in large blocks, so the
+ * protocol is called a few hundred times per second independent of the
+ * number of vehicles.
+ */
+void MAVLinkSwarmSimulationLink::run()
+{
+    QByteArray block(32*1024, 0);
+
+    while (_isConnected)
+    {
+        // Gather the wakeups of all workers into one pass
+        bytesAvailable.tryAcquire(1, 100);
+        bytesAvailable.tryAcquire(bytesAvailable.available());
+
+        foreach (MAVLinkSwarmSimulationWorker* worker, workers)
+        {
+            int length;
+            while ((length = worker->read(block.data(), block.size())) > 0)
+            {
+                emit bytesReceived(this, QByteArray(block.constData(), length));
+            }
+        }
+    }
+}
+
+void MAVLinkSwarmSimulationLink::writeBytes(const char* data, qint64 size)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+}
 
 void MAVLinkSwarmSimulationLink::mainloop()
 {
@@ -1,19 +1,68 @@
 #ifndef MAVLINKSWARMSIMULATIONLINK_H
 #define MAVLINKSWARMSIMULATIONLINK_H
 
+#include <QList>
+#include <QSemaphore>
 #include "MAVLinkSimulationLink.h"
+#include "MAVLinkSwarmSimulationWorker.h"
 
+/**
+ * @brief Simulation link emulating a swarm of up to 250 vehicles
+ *
+ * The vehicles are split across worker threads which generate the
+ * telemetry into their own ring buffers. The thread of the link only
+ * collects the finished frames and hands them to the protocol in blocks.
+ * Settings apply the next time the link is connected.
+ */
 class MAVLinkSwarmSimulationLink : public MAVLinkSimulationLink
 {
     Q_OBJECT
 public:
     MAVLinkSwarmSimulationLink(QString readFile="", QString writeFile="", int rate=5, QObject *parent = 0);
+    ~MAVLinkSwarmSimulationLink();
 
-signals:
+    bool connect();
+    bool disconnect();
+    void run();
+
+    /** @brief Set the number of simulated vehicles, they use the system IDs 1 to count */
+    void setVehicleCount(int count);
+    int getVehicleCount() const {
+        return vehicleCount;
+    }
+    /** @brief Set the number of threads generating the traffic */
+    void setWorkerCount(int count);
+    int getWorkerCount() const {
+        return workerCount;
+    }
+    /** @brief Set the rate of one message type in Hz, 0 disables the message */
+    void setMessageRate(int msgid, float rate);
+    /** @brief Set the probability that a frame is lost, 0..1 */
+    void setLoss(float probability);
+    /** @brief Set the maximum delay of a frame against its nominal send time */
+    void setJitter(int usecs);
+
+    /** @brief Get the number of frames generated by all workers */
+    quint64 getFramesSent() const;
+    /** @brief Get the number of frames lost on purpose */
+    quint64 getFramesLost() const;
+    /** @brief Get the number of frames dropped because the link did not keep up */
+    quint64 getFramesDropped() const;
+
+    static const int maxVehicles = 250;
+    static const int maxWorkers = 8;
 
 public slots:
+    /** @brief Commands of the ground station are ignored */
+    void writeBytes(const char* data, qint64 size);
     void mainloop();
 
+protected:
+    MAVLinkSwarmSettings settings;
+    int vehicleCount;
+    int workerCount;
+    QList<MAVLinkSwarmSimulationWorker*> workers;
+    QSemaphore bytesAvailable;  ///< Released by the workers when they wrote frames
 };
 
 #endif // MAVLINKSWARMSIMULATIONLINK_H
@@ -0,0 +1,233 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkSwarmSimulationWorker
+ *
+ */
+
+#include <qmath.h>
+#include "MAVLinkSwarmSimulationWorker.h"
+#include "QGC.h"
+
+const quint8 MAVLinkSwarmSimulationWorker::streamIds[MAVLinkSwarmSimulationWorker::streamCount] = {
+    MAVLINK_MSG_ID_HEARTBEAT,
+    MAVLINK_MSG_ID_SYS_STATUS,
+    MAVLINK_MSG_ID_ATTITUDE,
+    MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+    MAVLINK_MSG_ID_GPS_RAW_INT,
+    MAVLINK_MSG_ID_VFR_HUD,
+    MAVLINK_MSG_ID_SERVO_OUTPUT_RAW
+};
+
+/**
+ * @param firstSystemId System ID of the first vehicle, the others follow consecutively
+ * @param vehicleCount Number of vehicles simulated by this worker
+ * @param channel MAVLink channel used for packing, only used by this worker
+ * @param settings Rates, loss and jitter, copied and fixed for the lifetime of the worker
+ * @param bytesAvailable Released whenever new frames are in the ring
+ */
+MAVLinkSwarmSimulationWorker::MAVLinkSwarmSimulationWorker(int firstSystemId, int vehicleCount, int channel, const MAVLinkSwarmSettings& settings, QSemaphore* bytesAvailable) :
+    vehicles(vehicleCount),
+    settings(settings),
+    channel(channel),
+    startTime(QGC::groundTimeUsecs()),
+    randomState(2463534242u ^ (firstSystemId * 2654435761u)),
+    ring(64*1024),
+    bytesAvailable(bytesAvailable),
+    running(true),
+    framesSent(0),
+    framesLost(0),
+    framesDropped(0)
+{
+    for (int i = 0; i < streamCount; i++)
+    {
+        float rate = settings.rates[streamIds[i]];
+        periods[i] = (rate > 0.0f) ? static_cast<quint64>(1000000.0f / rate) : 0;
+    }
+
+    for (int i = 0; i < vehicleCount; i++)
+    {
+        Vehicle& vehicle = vehicles[i];
+        int systemId = firstSystemId + i;
+        vehicle.systemId = systemId;
+        vehicle.sequence = 0;
+        // Spread the vehicles on a grid around the default simulation position
+        vehicle.latitude = 47.3764 + ((systemId - 1) / 16) * 0.002;
+        vehicle.longitude = 8.5481 + ((systemId - 1) % 16) * 0.003;
+        vehicle.phase = (nextRandom() % 6283) / 1000.0;
+        // Start the streams at random offsets so the vehicles do not send in bursts
+        for (int j = 0; j < streamCount; j++)
+        {
+            vehicle.nominal[j] = startTime + (periods[j] ? nextRandom() % periods[j] : 0);
+            vehicle.due[j] = vehicle.nominal[j];
+        }
+    }
+}
+
+MAVLinkSwarmSimulationWorker::~MAVLinkSwarmSimulationWorker()
+{
+    stop();
+}
+
+void MAVLinkSwarmSimulationWorker::stop()
+{
+    running = false;
+    wait();
+}
+
+/**
+ * @brief Xorshift generator, cheap and good enough for loss and jitter
+ */
+quint32 MAVLinkSwarmSimulationWorker::nextRandom()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+void MAVLinkSwarmSimulationWorker::pack(int index, int stream, quint64 time, mavlink_message_t* msg)
+{
+    const Vehicle& vehicle = vehicles[index];
+    const quint8 systemId = vehicle.systemId;
+    const quint8 componentId = MAV_COMP_ID_IMU;
+    const quint64 elapsed = time - startTime;
+    const quint32 bootMs = elapsed / 1000;
+
+    // Fly a circle with a radius of about 100 m at 10 m/s
+    const double radius = 0.0009;
+    const double angle = vehicle.phase + elapsed / 1000000.0 * 0.1;
+    const double latitude = vehicle.latitude + radius * qCos(angle);
+    const double longitude = vehicle.longitude + radius * qSin(angle);
+    const float yaw = QGC::limitAngleToPMPIf(angle + M_PI / 2.0);
+    const float altitude = 50.0f + 5.0f * qSin(angle * 3.0);
+    const float speed = 10.0f;
+    const quint16 heading = static_cast<quint16>((yaw < 0 ? yaw + 2.0 * M_PI : yaw) / M_PI * 18000.0);
+
+    switch (streamIds[stream])
+    {
+    case MAVLINK_MSG_ID_HEARTBEAT:
+        mavlink_msg_heartbeat_pack_chan(systemId, componentId, channel, msg, MAV_TYPE_FIXED_WING, MAV_AUTOPILOT_GENERIC,
+                                        MAV_MODE_FLAG_SAFETY_ARMED | MAV_MODE_FLAG_GUIDED_ENABLED, 0, MAV_STATE_ACTIVE);
+        break;
+    case MAVLINK_MSG_ID_SYS_STATUS:
+        mavlink_msg_sys_status_pack_chan(systemId, componentId, channel, msg, 0, 0, 0, 500, 11800 - (elapsed / 1000000) % 1000, 1200,
+                                         90 - (elapsed / 60000000) % 60, 0, 0, 0, 0, 0, 0);
+        break;
+    case MAVLINK_MSG_ID_ATTITUDE:
+        mavlink_msg_attitude_pack_chan(systemId, componentId, channel, msg, bootMs, 0.35f, 0.05f * qSin(angle * 3.0), yaw, 0.0f, 0.0f, 0.1f);
+        break;
+    case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
+        mavlink_msg_global_position_int_pack_chan(systemId, componentId, channel, msg, bootMs, latitude * 1E7, longitude * 1E7,
+                                                  altitude * 1000, altitude * 1000, -speed * 100 * qSin(angle), speed * 100 * qCos(angle), 0, heading);
+        break;
+    case MAVLINK_MSG_ID_GPS_RAW_INT:
+        mavlink_msg_gps_raw_int_pack_chan(systemId, componentId, channel, msg, elapsed, 3, latitude * 1E7, longitude * 1E7,
+                                          altitude * 1000, 150, 200, speed * 100, heading, 9);
+        break;
+    case MAVLINK_MSG_ID_VFR_HUD:
+        mavlink_msg_vfr_hud_pack_chan(systemId, componentId, channel, msg, speed, speed, heading / 100, 45, altitude, 0.0f);
+        break;
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        mavlink_msg_servo_output_raw_pack_chan(systemId, componentId, channel, msg, elapsed, 0,
+                                               1700, 1500, 1500, 1550, 1500, 1500, 1500, 1500);
+        break;
+    }
+}
+
+/**
+ * @brief Replace the channel sequence number by the one of the vehicle and update the checksum
+ */
+static void setSequence(mavlink_message_t* msg, quint8 sequence)
+{
+    static const quint8 crcExtra[256] = MAVLINK_MESSAGE_CRCS;
+    msg->seq = sequence;
+    uint16_t checksum = crc_calculate(reinterpret_cast<const uint8_t*>(&msg->len), msg->len + MAVLINK_CORE_HEADER_LEN);
+    crc_accumulate(crcExtra[msg->msgid], &checksum);
+    mavlink_ck_a(msg) = static_cast<uint8_t>(checksum & 0xFF);
+    mavlink_ck_b(msg) = static_cast<uint8_t>(checksum >> 8);
+}
+
+void MAVLinkSwarmSimulationWorker::run()
+{
+    mavlink_message_t msg;
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    const quint32 lossThreshold = static_cast<quint32>(qBound(0.0f, settings.loss, 1.0f) * 4294967295.0);
+    const int jitter = qMax(0, settings.jitter);
+
+    while (running)
+    {
+        quint64 now = QGC::groundTimeUsecs();
+        quint64 next = now + 20000;
+        bool written = false;
+
+        for (int i = 0; i < vehicles.size(); i++)
+        {
+            Vehicle& vehicle = vehicles[i];
+            for (int j = 0; j < streamCount; j++)
+            {
+                if (!periods[j]) continue;
+                if (vehicle.due[j] <= now)
+                {
+                    // Schedule from the nominal time to stay free of drift, jitter only delays single frames
+                    vehicle.nominal[j] += periods[j];
+                    if (vehicle.nominal[j] < now) vehicle.nominal[j] = now + periods[j];
+                    vehicle.due[j] = vehicle.nominal[j];
+                    if (jitter > 0) vehicle.due[j] += nextRandom() % (jitter + 1);
+
+                    // A lost frame still uses up its sequence number, so the receiver sees the gap
+                    quint8 sequence = vehicle.sequence++;
+                    if (lossThreshold > 0 && nextRandom() <= lossThreshold)
+                    {
+                        framesLost++;
+                    }
+                    else
+                    {
+                        pack(i, j, now, &msg);
+                        setSequence(&msg, sequence);
+                        int length = mavlink_msg_to_send_buffer(frame, &msg);
+                        // Only whole frames go into the ring, a partial frame would corrupt the stream
+                        if (ring.space() < length)
+                        {
+                            framesDropped++;
+                        }
+                        else
+                        {
+                            ring.write(reinterpret_cast<const char*>(frame), length);
+                            framesSent++;
+                            written = true;
+                        }
+                    }
+                }
+                next = qMin(next, vehicle.due[j]);
+            }
+        }
+
+        if (written) bytesAvailable->release();
+
+        now = QGC::groundTimeUsecs();
+        if (next > now) QGC::SLEEP::usleep(next - now);
+    }
+}
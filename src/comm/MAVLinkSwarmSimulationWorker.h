@@ -0,0 +1,124 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkSwarmSimulationWorker
+ *
+ */
+
+#ifndef MAVLINKSWARMSIMULATIONWORKER_H
+#define MAVLINKSWARMSIMULATIONWORKER_H
+
+#include <QThread>
+#include <QSemaphore>
+#include <QVector>
+#include "QGCByteRing.h"
+#include "QGCMAVLink.h"
+
+/** @brief Traffic settings shared by all workers of a swarm */
+struct MAVLinkSwarmSettings
+{
+    float rates[256];   ///< Rate in Hz per message ID, 0 disables the message
+    float loss;         ///< Probability that a frame is lost, 0..1
+    int jitter;         ///< Maximum deviation from the nominal send time in microseconds
+};
+
+/**
+ * @brief Generates the telemetry of a group of simulated vehicles
+ *
+ * Each vehicle flies a circle and sends heartbeat, status, attitude,
+ * position, GPS, HUD and servo messages at the configured rates. Every
+ * vehicle has its own sequence numbers, so lost frames show up as packet
+ * loss in the ground station. Whole frames are written into a lock-free
+ * ring which is drained by the thread of the swarm link. If the link does
+ * not keep up, frames are dropped and counted.
+ */
+class MAVLinkSwarmSimulationWorker : public QThread
+{
+    Q_OBJECT
+
+public:
+    MAVLinkSwarmSimulationWorker(int firstSystemId, int vehicleCount, int channel, const MAVLinkSwarmSettings& settings, QSemaphore* bytesAvailable);
+    ~MAVLinkSwarmSimulationWorker();
+
+    /** @brief Read generated bytes, only called from the thread of the link */
+    int read(char* data, int maxLength) {
+        return ring.read(data, maxLength);
+    }
+    /** @brief Stop generating and terminate the thread */
+    void stop();
+
+    /** @brief Get the number of frames written to the ring */
+    quint64 getFramesSent() const {
+        return framesSent;
+    }
+    /** @brief Get the number of frames lost on purpose */
+    quint64 getFramesLost() const {
+        return framesLost;
+    }
+    /** @brief Get the number of frames dropped because the ring was full */
+    quint64 getFramesDropped() const {
+        return framesDropped;
+    }
+
+protected:
+    void run();
+    /** @brief Pack the message of one stream with the current vehicle state */
+    void pack(int vehicle, int stream, quint64 time, mavlink_message_t* msg);
+    /** @brief Get the next pseudo-random number, not shared between threads */
+    quint32 nextRandom();
+
+    static const int streamCount = 7;
+    static const quint8 streamIds[streamCount]; ///< Messages each vehicle sends
+
+    /** @brief State of one simulated vehicle */
+    struct Vehicle
+    {
+        quint8 systemId;
+        quint8 sequence;            ///< Sequence number of the next frame
+        double latitude;            ///< Center of the flown circle
+        double longitude;
+        double phase;               ///< Position on the circle at start
+        quint64 nominal[streamCount]; ///< Next send time per stream without jitter in microseconds
+        quint64 due[streamCount];   ///< Next send time per stream in microseconds
+    };
+
+    QVector<Vehicle> vehicles;
+    MAVLinkSwarmSettings settings;
+    quint64 periods[streamCount];   ///< Send interval per stream in microseconds, 0 if disabled
+    int channel;                    ///< MAVLink channel used for packing, not shared with other workers
+    quint64 startTime;
+    quint32 randomState;
+    QGCByteRing ring;               ///< Generated frames, read by the link thread
+    QSemaphore* bytesAvailable;     ///< Wakes up the link thread
+    volatile bool running;
+    volatile quint64 framesSent;
+    volatile quint64 framesLost;
+    volatile quint64 framesDropped;
+
+private:
+    Q_DISABLE_COPY(MAVLinkSwarmSimulationWorker)
+};
+
+#endif // MAVLINKSWARMSIMULATIONWORKER_H
@@ -52,6 +52,15 @@ class ProtocolInterface : public QObject
 public:
     //virtual ~ProtocolInterface() {};
     virtual QString getName() = 0;
+    /**
+     * @brief Get the connection type links use to deliver their bytes
+     *
+     * Protocols with a thread-safe receiveBytes() return Qt::DirectConnection
+     * to receive the bytes directly in the thread of the link.
+     */
+    virtual Qt::ConnectionType receiveConnectionType() const {
+        return Qt::AutoConnection;
+    }
 
 public slots:
     virtual void receiveBytes(LinkInterface *link, QByteArray b) = 0;
@@ -0,0 +1,133 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Lock-free single-producer / single-consumer byte ring
+ *
+ */
+
+#ifndef QGCBYTERING_H
+#define QGCBYTERING_H
+
+#include <QAtomicInt>
+#include <string.h>
+
+/**
+ * @brief Lock-free byte ring for exactly one writing and one reading thread
+ *
+ * The writer only ever advances the head index, the reader only the tail
+ * index. Both indices run freely and are masked on access, so the capacity
+ * is rounded up to a power of two. If the ring is full, write() accepts
+ * only the bytes which still fit and the caller decides about the rest.
+ */
+class QGCByteRing
+{
+public:
+    QGCByteRing(int capacity = 256*1024) :
+        head(0),
+        tail(0)
+    {
+        size = 1;
+        while (size < capacity) size <<= 1;
+        buffer = new char[size];
+        mask = size - 1;
+    }
+
+    ~QGCByteRing()
+    {
+        delete[] buffer;
+    }
+
+    /** @brief Get the size of the ring in bytes */
+    int capacity() const {
+        return size;
+    }
+
+    /** @brief Get the number of bytes ready to be read, reader thread only */
+    int available() {
+        return static_cast<unsigned int>(head.fetchAndAddAcquire(0)) - static_cast<unsigned int>(tail.fetchAndAddAcquire(0));
+    }
+
+    /** @brief Get the number of bytes which can be written, writer thread only */
+    int space() {
+        return size - static_cast<int>(static_cast<unsigned int>(head.fetchAndAddAcquire(0)) - static_cast<unsigned int>(tail.fetchAndAddAcquire(0)));
+    }
+
+    /**
+     * @brief Copy bytes into the ring, writer thread only
+     *
+     * @return The number of bytes written, smaller than length if the ring is full
+     */
+    int write(const char* data, int length)
+    {
+        unsigned int h = head.fetchAndAddAcquire(0);
+        unsigned int t = tail.fetchAndAddAcquire(0);
+        int space = size - static_cast<int>(h - t);
+        if (length > space) length = space;
+        if (length <= 0) return 0;
+
+        int offset = h & mask;
+        int first = qMin(length, size - offset);
+        memcpy(buffer + offset, data, first);
+        memcpy(buffer, data + first, length - first);
+
+        // Publish the bytes only once they are completely copied
+        head.fetchAndStoreRelease(h + length);
+        return length;
+    }
+
+    /**
+     * @brief Copy bytes out of the ring, reader thread only
+     *
+     * @return The number of bytes read, 0 if the ring is empty
+     */
+    int read(char* data, int maxLength)
+    {
+        unsigned int t = tail.fetchAndAddAcquire(0);
+        unsigned int h = head.fetchAndAddAcquire(0);
+        int length = qMin(maxLength, static_cast<int>(h - t));
+        if (length <= 0) return 0;
+
+        int offset = t & mask;
+        int first = qMin(length, size - offset);
+        memcpy(data, buffer + offset, first);
+        memcpy(data + first, buffer, length - first);
+
+        // Free the space only once the bytes are completely copied
+        tail.fetchAndStoreRelease(t + length);
+        return length;
+    }
+
+protected:
+    char* buffer;         ///< Ring storage, power of two sized
+    int size;             ///< Size of the storage in bytes
+    int mask;             ///< Index mask, size - 1
+    QAtomicInt head;      ///< Write index, only advanced by the writer
+    QAtomicInt tail;      ///< Read index, only advanced by the reader
+
+private:
+    Q_DISABLE_COPY(QGCByteRing)
+};
+
+#endif // QGCBYTERING_H
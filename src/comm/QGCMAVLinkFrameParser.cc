@@ -0,0 +1,217 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCMAVLinkFrameParser
+ *
+ */
+
+#include <string.h>
+
+#include "QGCMAVLinkFrameParser.h"
+
+namespace
+{
+/**
+ * Lookup tables for the reflected CRC-16 (polynomial 0x8408) computed by
+ * crc_accumulate(). Table k advances the checksum over a byte followed by
+ * k zero bytes, which allows to process four bytes per step.
+ */
+struct CrcTables
+{
+    quint16 t[4][256];
+
+    CrcTables()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            quint16 crc = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 1) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+            }
+            t[0][i] = crc;
+        }
+        for (int k = 1; k < 4; k++)
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const CrcTables crcTables;
+
+#if MAVLINK_CRC_EXTRA
+const quint8 messageCrcs[256] = MAVLINK_MESSAGE_CRCS;
+#endif
+#ifdef MAVLINK_CHECK_MESSAGE_LENGTH
+const quint8 messageLengths[256] = MAVLINK_MESSAGE_LENGTHS;
+#endif
+}
+
+QGCMAVLinkFrameParser::QGCMAVLinkFrameParser() :
+    input(NULL),
+    inputLength(0),
+    position(0),
+    parseErrors(0),
+    framesReceived(0)
+{
+}
+
+quint16 QGCMAVLinkFrameParser::crcAccumulate(const quint8* data, int length, quint16 crc)
+{
+    while (length >= 4)
+    {
+        quint32 x = crc ^ (data[0] | (data[1] << 8));
+        crc = crcTables.t[3][x & 0xFF] ^ crcTables.t[2][(x >> 8) & 0xFF] ^ crcTables.t[1][data[2]] ^ crcTables.t[0][data[3]];
+        data += 4;
+        length -= 4;
+    }
+    while (length--)
+    {
+        crc = (crc >> 8) ^ crcTables.t[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+void QGCMAVLinkFrameParser::setData(const char* data, int length)
+{
+    if (pending.isEmpty())
+    {
+        input = reinterpret_cast<const quint8*>(data);
+        inputLength = length;
+    }
+    else
+    {
+        // Complete the cut off frame, the pending part is at most one frame long
+        scratch.resize(0);
+        scratch.append(pending);
+        scratch.append(data, length);
+        pending.resize(0);
+        input = reinterpret_cast<const quint8*>(scratch.constData());
+        inputLength = scratch.size();
+    }
+    position = 0;
+}
+
+void QGCMAVLinkFrameParser::skip(int count)
+{
+    position = qMin(position + count, inputLength);
+}
+
+void QGCMAVLinkFrameParser::keepRemainder()
+{
+    pending = QByteArray(reinterpret_cast<const char*>(input) + position, inputLength - position);
+    position = inputLength;
+}
+
+bool QGCMAVLinkFrameParser::next(mavlink_message_t* message)
+{
+    while (position < inputLength)
+    {
+        // Skip garbage up to the next start sign
+        const quint8* stx = static_cast<const quint8*>(memchr(input + position, MAVLINK_STX, inputLength - position));
+        if (!stx)
+        {
+            position = inputLength;
+            return false;
+        }
+        position = stx - input;
+        int available = inputLength - position;
+
+        if (available < 2)
+        {
+            keepRemainder();
+            return false;
+        }
+
+        const quint8* frame = stx;
+        quint8 len = frame[1];
+#if (MAVLINK_MAX_PAYLOAD_LEN < 255)
+        if (len > MAVLINK_MAX_PAYLOAD_LEN)
+        {
+            // The length byte is consumed, continue behind it
+            parseErrors++;
+            position += 2;
+            continue;
+        }
+#endif
+
+        if (available < len + MAVLINK_NUM_NON_PAYLOAD_BYTES)
+        {
+            keepRemainder();
+            return false;
+        }
+
+        quint8 msgid = frame[5];
+#ifdef MAVLINK_CHECK_MESSAGE_LENGTH
+        if (len != messageLengths[msgid])
+        {
+            // Header is consumed, continue behind the message id
+            parseErrors++;
+            position += MAVLINK_CORE_HEADER_LEN + 1;
+            continue;
+        }
+#endif
+
+        // Checksum over length, header and payload, without the start sign
+        quint16 crc = crcAccumulate(frame + 1, MAVLINK_CORE_HEADER_LEN + len, X25_INIT_CRC);
+#if MAVLINK_CRC_EXTRA
+        crc = crcAccumulate(&messageCrcs[msgid], 1, crc);
+#endif
+
+        const quint8* ck = frame + MAVLINK_CORE_HEADER_LEN + 1 + len;
+        if (ck[0] != (crc & 0xFF))
+        {
+            // Continue at the failed checksum byte, it could be a start sign
+            parseErrors++;
+            position = ck - input;
+            continue;
+        }
+        if (ck[1] != (crc >> 8))
+        {
+            parseErrors++;
+            position = ck + 1 - input;
+            continue;
+        }
+
+        message->checksum = crc;
+        message->magic = MAVLINK_STX;
+        message->len = len;
+        message->seq = frame[2];
+        message->sysid = frame[3];
+        message->compid = frame[4];
+        message->msgid = msgid;
+        // Payload and checksum bytes, like mavlink_parse_char()
+        memcpy(_MAV_PAYLOAD_NON_CONST(message), frame + MAVLINK_CORE_HEADER_LEN + 1, len + MAVLINK_NUM_CHECKSUM_BYTES);
+
+        position += len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        framesReceived++;
+        return true;
+    }
+    return false;
+}
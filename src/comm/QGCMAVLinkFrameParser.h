@@ -0,0 +1,90 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Bulk MAVLink frame parser
+ *
+ */
+
+#ifndef QGCMAVLINKFRAMEPARSER_H
+#define QGCMAVLINKFRAMEPARSER_H
+
+#include <QByteArray>
+#include "QGCMAVLink.h"
+
+/**
+ * @brief Parses complete MAVLink frames out of a chunk of received bytes
+ *
+ * Instead of feeding the bytes one by one through mavlink_parse_char(), the
+ * start sign is searched with memchr() and every candidate frame is checked
+ * as a whole, with a slicing-by-4 table for the X.25 checksum. A frame which
+ * is cut off at the end of the chunk is kept and completed with the next
+ * chunk. The resynchronization on garbage or corrupt frames is identical to
+ * the one of mavlink_parse_char(): after a failed checksum byte the scan
+ * continues at this byte, after an invalid length byte behind it.
+ *
+ * One parser instance is needed per link, just like one MAVLink channel.
+ */
+class QGCMAVLinkFrameParser
+{
+public:
+    QGCMAVLinkFrameParser();
+
+    /** @brief Set the next chunk of bytes, which must stay valid until next() returns false */
+    void setData(const char* data, int length);
+    /**
+     * @brief Extract the next valid message from the current chunk
+     *
+     * @param message The decoded message is written here
+     * @return true if a message was decoded, false if the chunk is exhausted
+     */
+    bool next(mavlink_message_t* message);
+    /** @brief Skip bytes of the current chunk, e.g. extended payloads */
+    void skip(int count);
+    /** @brief Get the number of corrupt frames seen so far */
+    quint64 getParseErrors() const {
+        return parseErrors;
+    }
+    /** @brief Get the number of valid frames seen so far */
+    quint64 getFramesReceived() const {
+        return framesReceived;
+    }
+
+    /** @brief Accumulate the X.25 checksum over a buffer, equal to crc_accumulate() per byte */
+    static quint16 crcAccumulate(const quint8* data, int length, quint16 crc);
+
+protected:
+    /** @brief Keep the bytes from the current position on for the next chunk */
+    void keepRemainder();
+
+    const quint8* input; ///< Current chunk, either the caller's data or the scratch buffer
+    int inputLength;     ///< Length of the current chunk
+    int position;        ///< Parsing position in the current chunk
+    QByteArray pending;  ///< Start of a frame cut off at the end of the last chunk
+    QByteArray scratch;  ///< Pending bytes joined with the current chunk
+    quint64 parseErrors;
+    quint64 framesReceived;
+};
+
+#endif // QGCMAVLINKFRAMEPARSER_H
@@ -0,0 +1,291 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCMAVLinkLogIndex
+ *
+ */
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#include "QGCMAVLinkLogIndex.h"
+#include "QGCMAVLinkLogWriter.h"
+
+const quint32 QGCMAVLinkLogIndex::stride;
+
+static const char indexMagic[8] = { 'Q', 'G', 'C', 'M', 'A', 'V', 'I', 'X' };
+static const quint32 indexVersion = 2;
+static const quint32 nonMonotonicFlag = 1; ///< Header flag of logs with decreasing timestamps
+
+/** @brief Entries are sorted by time */
+static bool entryTimeLessThan(const QGCMAVLinkLogIndex::Entry& a, const QGCMAVLinkLogIndex::Entry& b)
+{
+    return a.time < b.time;
+}
+
+/**
+ * Moves unread bytes to the front of the buffer and appends the next
+ * block of the file until at least needed bytes are available.
+ *
+ * @return False if the file ended before
+ */
+static bool fillBuffer(QFile& file, QByteArray& buffer, int& pos, int needed)
+{
+    if (buffer.size() - pos >= needed) return true;
+    buffer.remove(0, pos);
+    pos = 0;
+    QByteArray block = file.read(1024*1024);
+    if (block.isEmpty()) return false;
+    buffer.append(block);
+    return (buffer.size() >= needed);
+}
+
+QGCMAVLinkLogIndex::QGCMAVLinkLogIndex(QObject* parent) :
+    QThread(parent),
+    logSize(0),
+    packetCount(0),
+    startTime(0),
+    endTime(0),
+    dataOffset(0),
+    monotonic(true),
+    ready(0),
+    running(false)
+{
+}
+
+QGCMAVLinkLogIndex::~QGCMAVLinkLogIndex()
+{
+    close();
+}
+
+QString QGCMAVLinkLogIndex::sidecarName(const QString& logFileName)
+{
+    return logFileName + ".idx";
+}
+
+/**
+ * If a valid sidecar exists, indexReady() is emitted before this
+ * method returns. Otherwise the index is built in the background.
+ *
+ * @param logFileName The log to index
+ */
+void QGCMAVLinkLogIndex::open(const QString& logFileName)
+{
+    close();
+    this->logFileName = logFileName;
+    logSize = QFileInfo(logFileName).size();
+
+    if (load())
+    {
+        ready.fetchAndStoreRelease(1);
+        emit indexReady();
+    }
+    else
+    {
+        running = true;
+        start(QThread::LowPriority);
+    }
+}
+
+void QGCMAVLinkLogIndex::close()
+{
+    running = false;
+    wait();
+    ready.fetchAndStoreRelease(0);
+    entries.clear();
+    packetCount = 0;
+    startTime = 0;
+    endTime = 0;
+    dataOffset = 0;
+    monotonic = true;
+}
+
+/**
+ * If the timestamps are not monotonic, the entry before the first entry
+ * later than time is returned, i.e. the position where the log first
+ * reaches the time.
+ *
+ * @param time The timestamp to look up in microseconds
+ * @param entry Set to the last indexed record not later than time, or to
+ *              the first record if time lies before the start of the log
+ * @return False if the index is empty
+ */
+bool QGCMAVLinkLogIndex::findTime(quint64 time, Entry* entry) const
+{
+    if (entries.isEmpty()) return false;
+    if (!monotonic)
+    {
+        int i = 0;
+        while (i + 1 < entries.size() && entries.at(i + 1).time <= time) i++;
+        *entry = entries.at(i);
+        return true;
+    }
+    Entry key;
+    key.time = time;
+    QVector<Entry>::const_iterator i = qUpperBound(entries.constBegin(), entries.constEnd(), key, entryTimeLessThan);
+    if (i != entries.constBegin()) --i;
+    *entry = *i;
+    return true;
+}
+
+bool QGCMAVLinkLogIndex::findPacket(quint32 packet, Entry* entry) const
+{
+    if (entries.isEmpty() || packet >= packetCount) return false;
+    *entry = entries.at(packet / stride);
+    return true;
+}
+
+bool QGCMAVLinkLogIndex::load()
+{
+    QFile file(sidecarName(logFileName));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    Header header;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)) return false;
+    if (memcmp(header.magic, indexMagic, sizeof(indexMagic)) != 0 || header.version != indexVersion ||
+            header.stride != stride || header.logSize != logSize)
+    {
+        // Outdated, e.g. the log was appended to after indexing
+        return false;
+    }
+
+    entries.resize(header.entryCount);
+    qint64 length = static_cast<qint64>(header.entryCount) * sizeof(Entry);
+    if (file.read(reinterpret_cast<char*>(entries.data()), length) != length)
+    {
+        entries.clear();
+        return false;
+    }
+    packetCount = header.packetCount;
+    startTime = header.startTime;
+    endTime = header.endTime;
+    dataOffset = header.dataOffset;
+    monotonic = !(header.flags & nonMonotonicFlag);
+    return true;
+}
+
+void QGCMAVLinkLogIndex::store()
+{
+    Header header;
+    memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.stride = stride;
+    header.logSize = logSize;
+    header.dataOffset = dataOffset;
+    header.packetCount = packetCount;
+    header.entryCount = entries.size();
+    header.startTime = startTime;
+    header.endTime = endTime;
+    header.flags = monotonic ? 0 : nonMonotonicFlag;
+    header.reserved = 0;
+
+    // Write to a temporary file first, a reader never sees a partial sidecar
+    QString name = sidecarName(logFileName);
+    QFile file(name + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Could not store the log index" << name;
+        return;
+    }
+    qint64 length = static_cast<qint64>(entries.size()) * sizeof(Entry);
+    bool ok = (file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header) &&
+               file.write(reinterpret_cast<const char*>(entries.constData()), length) == length);
+    file.close();
+    QFile::remove(name);
+    if (!ok || !file.rename(name))
+    {
+        qDebug() << "Could not store the log index" << name;
+        file.remove();
+    }
+}
+
+/**
+ * Walks once over all records. A truncated or corrupted record, e.g. the
+ * partially written last record of a log which was not closed, ends the index.
+ */
+void QGCMAVLinkLogIndex::run()
+{
+    QFile file(logFileName);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    bool variableLength = QGCMAVLinkLogWriter::hasFileHeader(&file);
+    qint64 offset = variableLength ? QGCMAVLinkLogWriter::headerLength : 0;
+    file.seek(offset);
+
+    QVector<Entry> index;
+    QByteArray buffer;
+    int pos = 0;
+    quint32 count = 0;
+    quint64 first = 0;
+    quint64 last = 0;
+    bool increasing = true;
+    const int timeLength = QGCMAVLinkLogWriter::timeLength;
+
+    while (running && fillBuffer(file, buffer, pos, timeLength + 2))
+    {
+        const char* record = buffer.constData() + pos;
+        int length = QGCMAVLinkLogWriter::legacyRecordLength;
+        if (variableLength)
+        {
+            if (static_cast<quint8>(record[timeLength]) != MAVLINK_STX) break;
+            length = timeLength + static_cast<quint8>(record[timeLength + 1]) + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        }
+        if (!fillBuffer(file, buffer, pos, length)) break;
+        record = buffer.constData() + pos;
+
+        quint64 time;
+        memcpy(&time, record, timeLength);
+        if (count % stride == 0)
+        {
+            Entry entry;
+            entry.time = time;
+            entry.offset = offset;
+            entry.packet = count;
+            entry.reserved = 0;
+            index.append(entry);
+        }
+        if (count == 0) first = time;
+        else if (time < last) increasing = false;
+        last = time;
+
+        offset += length;
+        pos += length;
+        count++;
+    }
+
+    if (!running) return;
+
+    entries = index;
+    packetCount = count;
+    startTime = first;
+    endTime = last;
+    dataOffset = variableLength ? QGCMAVLinkLogWriter::headerLength : 0;
+    monotonic = increasing;
+    store();
+
+    ready.fetchAndStoreRelease(1);
+    emit indexReady();
+}
@@ -0,0 +1,151 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class QGCMAVLinkLogIndex
+ *
+ */
+
+#ifndef QGCMAVLINKLOGINDEX_H
+#define QGCMAVLINKLOGINDEX_H
+
+#include <QThread>
+#include <QString>
+#include <QVector>
+#include <QAtomicInt>
+
+/**
+ * @brief Time index of a MAVLink packet log
+ *
+ * The index stores the timestamp and file offset of every stride-th record,
+ * so any timestamp or packet is found with a binary search and a short walk
+ * over at most stride records. It is built in the background the first time
+ * a log is opened and stored next to the log as <logfile>.idx. The sidecar
+ * is rebuilt if the size of the log changed. Both the legacy fixed length
+ * and the variable length record format are supported.
+ *
+ * Logs whose timestamps jump backwards, e.g. after the ground station clock
+ * was reset, are flagged while indexing. The binary search would land on an
+ * arbitrary entry in such a log, so findTime() scans the entries linearly.
+ */
+class QGCMAVLinkLogIndex : public QThread
+{
+    Q_OBJECT
+
+public:
+    /** @brief Index entry, also the on-disk layout of the sidecar */
+    struct Entry
+    {
+        quint64 time;     ///< Timestamp of the record in microseconds
+        qint64 offset;    ///< File offset of the record
+        quint32 packet;   ///< Index of the record in the log
+        quint32 reserved;
+    };
+
+    QGCMAVLinkLogIndex(QObject* parent = 0);
+    ~QGCMAVLinkLogIndex();
+
+    /** @brief Load the sidecar of a log or start building the index */
+    void open(const QString& logFileName);
+    /** @brief Abort building and drop the index */
+    void close();
+    /** @brief Check if the index is complete */
+    bool isReady() {
+        return ready.fetchAndAddAcquire(0) != 0;
+    }
+
+    /** @brief Get the number of complete records, only valid once ready */
+    quint32 getPacketCount() const {
+        return packetCount;
+    }
+    /** @brief Get the timestamp of the first record, only valid once ready */
+    quint64 getStartTime() const {
+        return startTime;
+    }
+    /** @brief Get the timestamp of the last record, only valid once ready */
+    quint64 getEndTime() const {
+        return endTime;
+    }
+    /** @brief Get the offset of the first record, only valid once ready */
+    qint64 getDataOffset() const {
+        return dataOffset;
+    }
+    /** @brief Check if the timestamps never decrease, only valid once ready */
+    bool isMonotonic() const {
+        return monotonic;
+    }
+
+    /** @brief Find the last indexed record at or before a timestamp */
+    bool findTime(quint64 time, Entry* entry) const;
+    /** @brief Find the last indexed record at or before a packet index */
+    bool findPacket(quint32 packet, Entry* entry) const;
+
+    /** @brief Get the file name of the sidecar of a log */
+    static QString sidecarName(const QString& logFileName);
+
+    static const quint32 stride = 256;   ///< Records per index entry
+
+signals:
+    /** @brief The index was loaded or built completely */
+    void indexReady();
+
+protected:
+    void run();
+    /** @brief Load a sidecar matching the current size of the log */
+    bool load();
+    /** @brief Store the index as sidecar, failures are not fatal */
+    void store();
+
+    /** @brief Sidecar file header */
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 stride;
+        qint64 logSize;
+        qint64 dataOffset;
+        quint32 packetCount;
+        quint32 entryCount;
+        quint64 startTime;
+        quint64 endTime;
+        quint32 flags;
+        quint32 reserved;
+    };
+
+    QString logFileName;       ///< Log the index belongs to
+    qint64 logSize;            ///< Size of the log when the index was built
+    QVector<Entry> entries;    ///< Every stride-th record, sorted by packet and time
+    quint32 packetCount;
+    quint64 startTime;
+    quint64 endTime;
+    qint64 dataOffset;
+    bool monotonic;            ///< False if a timestamp is earlier than its predecessor
+    QAtomicInt ready;          ///< Set once the index is complete
+    volatile bool running;     ///< False to abort building
+
+private:
+    Q_DISABLE_COPY(QGCMAVLinkLogIndex)
+};
+
+#endif // QGCMAVLINKLOGINDEX_H
@@ -0,0 +1,241 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCMAVLinkLogReplay
+ *
+ */
+
+#include <QApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStringList>
+#include <QTextStream>
+
+#include "QGCMAVLinkLogReplay.h"
+#include "QGCMAVLinkLogWriter.h"
+#include "QGCMAVLinkFrameParser.h"
+#include "MAVLinkSimulationLink.h"
+#include "MAVLinkDecoder.h"
+#include "LinkManager.h"
+#include "UASManager.h"
+#include "GAudioOutput.h"
+#include "configuration.h"
+#include "QGC.h"
+
+QGCMAVLinkLogReplay::QGCMAVLinkLogReplay(MAVLinkProtocol* protocol, QObject* parent) :
+    QObject(parent),
+    protocol(protocol),
+    decoder(new MAVLinkDecoder(protocol, this)),
+    link(new MAVLinkSimulationLink(""))
+{
+    // The decoder is called per batch so its time can be measured on its own
+    disconnect(protocol, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), decoder, SLOT(receiveMessage(LinkInterface*,MAVLinkMessageHandle)));
+    // Measure the decoder with all fields, as with the line charts open
+    decoder->subscribe("*");
+    memset(&statistics, 0, sizeof(statistics));
+}
+
+QGCMAVLinkLogReplay::~QGCMAVLinkLogReplay()
+{
+    link->disconnect();
+    LinkManager::instance()->removeLink(link);
+    delete link;
+}
+
+/**
+ * Both the legacy fixed length and the variable length log format are
+ * supported. A corrupted variable length record ends the replay, as the
+ * following records cannot be located anymore.
+ *
+ * @param fileName The MAVLink log to replay
+ * @return False if the log could not be read
+ */
+bool QGCMAVLinkLogReplay::replay(const QString& fileName)
+{
+    memset(&statistics, 0, sizeof(statistics));
+    errorString.clear();
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString = tr("Could not open %1").arg(fileName);
+        return false;
+    }
+
+    // Never log the replayed packets again
+    if (protocol->loggingEnabled())
+    {
+        protocol->enableLogging(false);
+    }
+
+    const int timeLength = QGCMAVLinkLogWriter::timeLength;
+    bool variableLength = QGCMAVLinkLogWriter::hasFileHeader(&file);
+    file.seek(variableLength ? QGCMAVLinkLogWriter::headerLength : 0);
+
+    QGCMAVLinkFrameParser parser;
+    MAVLinkMessageBatch batch;
+    QByteArray buffer;
+    QByteArray packets;
+    int pos = 0;
+    bool more = true;
+    quint64 start = QGC::groundTimeUsecs();
+    unsigned int allocations = MAVLinkMessagePool::getAllocations();
+
+    while (more)
+    {
+        quint64 time = QGC::groundTimeUsecs();
+        buffer.remove(0, pos);
+        pos = 0;
+        QByteArray block = file.read(chunkSize);
+        more = !block.isEmpty();
+        buffer.append(block);
+        statistics.bytes += block.size();
+        statistics.readUsecs += QGC::groundTimeUsecs() - time;
+
+        // Strip the record framing, the parser only gets to see the packets
+        time = QGC::groundTimeUsecs();
+        packets.resize(0);
+        while (buffer.size() - pos >= timeLength + 2)
+        {
+            const char* record = buffer.constData() + pos;
+            int packetLength = static_cast<quint8>(record[timeLength + 1]) + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+            int recordLength = variableLength ? timeLength + packetLength : QGCMAVLinkLogWriter::legacyRecordLength;
+            if (buffer.size() - pos < recordLength) break;
+            if (variableLength && static_cast<quint8>(record[timeLength]) != MAVLINK_STX)
+            {
+                errorString = tr("Corrupted record at offset %1 of %2").arg(file.pos() - buffer.size() + pos).arg(fileName);
+                more = false;
+                break;
+            }
+            packets.append(record + timeLength, packetLength);
+            pos += recordLength;
+        }
+        if (packets.isEmpty()) continue;
+
+        protocol->parseBytes(link, &parser, packets.constData(), packets.size(), batch);
+        statistics.parseUsecs += QGC::groundTimeUsecs() - time;
+        statistics.messages += batch.size();
+
+        time = QGC::groundTimeUsecs();
+        protocol->receiveMessages(batch);
+        statistics.uasUsecs += QGC::groundTimeUsecs() - time;
+
+        time = QGC::groundTimeUsecs();
+        foreach (const MAVLinkReceivedMessage& received, batch)
+        {
+            decoder->receiveMessage(received.link, received.message);
+        }
+        statistics.decoderUsecs += QGC::groundTimeUsecs() - time;
+        batch.clear();
+    }
+
+    statistics.totalUsecs = QGC::groundTimeUsecs() - start;
+    statistics.allocations = MAVLinkMessagePool::getAllocations() - allocations;
+    return true;
+}
+
+/** @brief Format a throughput as messages per second */
+static QString rate(quint64 messages, quint64 usecs)
+{
+    if (usecs == 0) return QString("-");
+    return QString::number(messages / (usecs / 1000000.0), 'f', 0);
+}
+
+/**
+ * Usage: qgroundcontrol --replay <logfile> [<logfile> ..]
+ *
+ * No main window is created and no display is needed. The replay uses its
+ * own settings, so the packet log and audio settings of the interactive
+ * application stay untouched.
+ *
+ * @return 0 if all logs were replayed, 1 otherwise
+ */
+int QGCMAVLinkLogReplay::runCommandLine(int& argc, char* argv[])
+{
+    QApplication app(argc, argv, false);
+    app.setApplicationName(QString(QGC_APPLICATION_NAME) + " Replay");
+    app.setApplicationVersion(QGC_APPLICATION_VERSION);
+    app.setOrganizationName(QLatin1String("OPENMAV"));
+    app.setOrganizationDomain("org.qgroundcontrol");
+    QSettings::setDefaultFormat(QSettings::IniFormat);
+
+    QTextStream out(stdout);
+    QStringList files = app.arguments().mid(1);
+    files.removeAll("--replay");
+    if (files.isEmpty())
+    {
+        out << "Usage: " << QFileInfo(app.arguments().first()).fileName() << " --replay <logfile> [<logfile> ..]" << endl;
+        return 1;
+    }
+
+    LinkManager::instance();
+    UASManager::instance();
+    GAudioOutput::instance()->mute(true);
+
+    int result = 0;
+    {
+        MAVLinkProtocol protocol;
+        QGCMAVLinkLogReplay replay(&protocol);
+        Statistics total;
+        memset(&total, 0, sizeof(total));
+
+        foreach (const QString& file, files)
+        {
+            if (!replay.replay(file))
+            {
+                out << replay.getErrorString() << endl;
+                result = 1;
+                continue;
+            }
+            if (!replay.getErrorString().isEmpty())
+            {
+                out << replay.getErrorString() << endl;
+            }
+
+            const Statistics& s = replay.getStatistics();
+            out << file << ": " << s.messages << " messages, " << QString::number(s.bytes / 1000000.0, 'f', 2) << " MB in " << QString::number(s.totalUsecs / 1000000.0, 'f', 2) << " s" << endl;
+            out << "  read " << QString::number(s.readUsecs ? s.bytes / (double)s.readUsecs : 0.0, 'f', 1) << " MB/s"
+                << ", parse " << rate(s.messages, s.parseUsecs) << " msg/s"
+                << ", uas " << rate(s.messages, s.uasUsecs) << " msg/s"
+                << ", decoder " << rate(s.messages, s.decoderUsecs) << " msg/s"
+                << ", total " << rate(s.messages, s.totalUsecs) << " msg/s" << endl;
+            out << "  " << s.allocations << " message allocations, " << rate(s.allocations, s.totalUsecs) << " allocations/s" << endl;
+
+            total.bytes += s.bytes;
+            total.messages += s.messages;
+            total.totalUsecs += s.totalUsecs;
+        }
+
+        if (files.size() > 1)
+        {
+            out << "Total: " << total.messages << " messages, " << QString::number(total.bytes / 1000000.0, 'f', 2) << " MB in " << QString::number(total.totalUsecs / 1000000.0, 'f', 2) << " s, " << rate(total.messages, total.totalUsecs) << " msg/s" << endl;
+        }
+    }
+
+    delete LinkManager::instance();
+    delete UASManager::instance();
+    return result;
+}
@@ -0,0 +1,98 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class QGCMAVLinkLogReplay
+ *
+ */
+
+#ifndef QGCMAVLINKLOGREPLAY_H
+#define QGCMAVLINKLOGREPLAY_H
+
+#include <QObject>
+#include <QString>
+#include "MAVLinkProtocol.h"
+
+class MAVLinkDecoder;
+class MAVLinkSimulationLink;
+
+/**
+ * @brief Replays MAVLink logs as fast as possible, without a user interface
+ *
+ * The log is read in large chunks and the record timestamps are stripped.
+ * The packets are parsed in the calling thread instead of the protocol
+ * worker, so no bytes are dropped no matter how fast the disk is. Each
+ * batch of messages then passes the UAS objects and the decoder. The time
+ * spent in each stage is measured separately. This is meant for the batch
+ * analysis of flight logs, see runCommandLine().
+ */
+class QGCMAVLinkLogReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @brief Throughput of one replay */
+    struct Statistics
+    {
+        quint64 bytes;         ///< Bytes read from the log
+        quint64 messages;      ///< Messages decoded
+        quint64 readUsecs;     ///< Time spent reading the log
+        quint64 parseUsecs;    ///< Time spent parsing the packets
+        quint64 uasUsecs;      ///< Time spent in the protocol dispatch and UAS objects
+        quint64 decoderUsecs;  ///< Time spent in the field decoder
+        quint64 allocations;   ///< Message blocks allocated on the heap, the rest was recycled
+        quint64 totalUsecs;    ///< Wall clock time of the whole replay
+    };
+
+    QGCMAVLinkLogReplay(MAVLinkProtocol* protocol, QObject* parent = 0);
+    ~QGCMAVLinkLogReplay();
+
+    /** @brief Replay one log, returns once the whole file was processed */
+    bool replay(const QString& fileName);
+    /** @brief Get the throughput of the last replay */
+    const Statistics& getStatistics() const {
+        return statistics;
+    }
+    /** @brief Get the reason why the last replay failed */
+    QString getErrorString() const {
+        return errorString;
+    }
+
+    /** @brief Replay the logs given on the command line and print the throughput */
+    static int runCommandLine(int& argc, char* argv[]);
+
+protected:
+    MAVLinkProtocol* protocol;     ///< Protocol parsing and dispatching the messages
+    MAVLinkDecoder* decoder;       ///< Decoder driven by the replay instead of the protocol
+    MAVLinkSimulationLink* link;   ///< Link the replayed messages appear to arrive on
+    Statistics statistics;
+    QString errorString;
+
+    static const int chunkSize = 4*1024*1024; ///< Bytes read from the log per pass
+
+private:
+    Q_DISABLE_COPY(QGCMAVLinkLogReplay)
+};
+
+#endif // QGCMAVLINKLOGREPLAY_H
@@ -0,0 +1,257 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCMAVLinkLogWriter
+ *
+ */
+
+#include <QtEndian>
+
+#include "QGCMAVLinkLogWriter.h"
+
+const int QGCMAVLinkLogWriter::headerLength;
+const quint32 QGCMAVLinkLogWriter::formatVersion;
+const int QGCMAVLinkLogWriter::timeLength;
+const int QGCMAVLinkLogWriter::legacyRecordLength;
+
+QGCMAVLinkLogWriter::QGCMAVLinkLogWriter(QObject* parent) :
+    QThread(parent),
+    ring(ringSize),
+    wakeupPending(0),
+    accepting(0),
+    loggers(0),
+    running(false),
+    failed(false),
+    legacyFormat(false),
+    recordsLogged(0),
+    recordsDropped(0),
+    bytesWritten(0),
+    commits(0),
+    peakFill(0),
+    reportedRecordsDropped(0)
+{
+}
+
+QGCMAVLinkLogWriter::~QGCMAVLinkLogWriter()
+{
+    close();
+}
+
+QByteArray QGCMAVLinkLogWriter::fileHeader()
+{
+    QByteArray header("QGCMAVLG", 8);
+    uchar version[4];
+    qToLittleEndian<quint32>(formatVersion, version);
+    header.append(reinterpret_cast<const char*>(version), sizeof(version));
+    header.append(QByteArray(headerLength - header.size(), '\0'));
+    return header;
+}
+
+/**
+ * The position of the device is restored, the caller skips the header.
+ * The timestamp of a legacy log can never match the magic, it would
+ * lie far in the future.
+ */
+bool QGCMAVLinkLogWriter::hasFileHeader(QIODevice* device)
+{
+    qint64 pos = device->pos();
+    device->seek(0);
+    QByteArray header = device->read(headerLength);
+    device->seek(pos);
+    return (header.size() == headerLength && header.startsWith(QByteArray("QGCMAVLG", 8)));
+}
+
+/**
+ * Existing variable length logs and empty files are continued in the
+ * variable length format, existing legacy logs in the legacy format.
+ *
+ * @param fileName The logfile to append to
+ * @return True if the file could be opened for writing
+ */
+bool QGCMAVLinkLogWriter::open(const QString& fileName)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+
+    legacyFormat = false;
+    if (file.size() == 0)
+    {
+        if (file.write(fileHeader()) != headerLength)
+        {
+            file.close();
+            return false;
+        }
+    }
+    else
+    {
+        legacyFormat = !hasFileHeader(&file);
+    }
+    file.seek(file.size());
+
+    recordsLogged = 0;
+    recordsDropped = 0;
+    bytesWritten = 0;
+    commits = 0;
+    peakFill = 0;
+    reportedRecordsDropped = 0;
+    reportTime = QTime();
+    failed = false;
+    running = true;
+    start(QThread::LowPriority);
+    accepting.fetchAndStoreRelease(1);
+    return true;
+}
+
+void QGCMAVLinkLogWriter::close()
+{
+    // Stop accepting and wait for a concurrent log() call to leave,
+    // afterwards the ring is only accessed by the writer thread
+    accepting.fetchAndStoreOrdered(0);
+    while (loggers.fetchAndAddOrdered(0) != 0)
+    {
+        yieldCurrentThread();
+    }
+
+    if (isRunning())
+    {
+        running = false;
+        wakeup.release();
+        wait();
+    }
+
+    if (file.isOpen())
+    {
+        file.close();
+    }
+}
+
+/**
+ * Serializes the message into the ring. This never blocks, if the writer
+ * does not keep up the record is dropped. Only one thread may log at a time.
+ *
+ * @param time The receive time of the message in microseconds
+ * @param message The message to log
+ * @return True if the record was queued
+ */
+bool QGCMAVLinkLogWriter::log(quint64 time, const mavlink_message_t& message)
+{
+    loggers.ref();
+    if (!accepting.fetchAndAddOrdered(0))
+    {
+        loggers.deref();
+        return false;
+    }
+
+    uint8_t buf[legacyRecordLength];
+    memcpy(buf, &time, timeLength);
+    int length = timeLength + mavlink_msg_to_send_buffer(buf + timeLength, &message);
+    if (legacyFormat)
+    {
+        memset(buf + length, 0, legacyRecordLength - length);
+        length = legacyRecordLength;
+    }
+
+    bool queued = false;
+    int fill = ring.capacity() - ring.space();
+    if (length <= ring.capacity() - fill)
+    {
+        ring.write(reinterpret_cast<const char*>(buf), length);
+        fill += length;
+        recordsLogged++;
+        queued = true;
+    }
+    else
+    {
+        recordsDropped++;
+    }
+    if (fill > peakFill) peakFill = fill;
+
+    // Only wake up the writer early if a large group is ready
+    if (fill > ring.capacity() / 2 && wakeupPending.testAndSetOrdered(0, 1))
+    {
+        wakeup.release();
+    }
+
+    loggers.deref();
+    return queued;
+}
+
+/**
+ * @return False if the file could not be written
+ */
+bool QGCMAVLinkLogWriter::commit()
+{
+    char buffer[chunkSize];
+    int length;
+    while ((length = ring.read(buffer, sizeof(buffer))) > 0)
+    {
+        // Keep draining after a failure so the logging thread never sees a full ring
+        if (failed) continue;
+
+        if (file.write(buffer, length) != length)
+        {
+            failed = true;
+            accepting.fetchAndStoreRelease(0);
+            emit writeFailed(file.fileName());
+            continue;
+        }
+        bytesWritten += length;
+        commits++;
+    }
+    return !failed;
+}
+
+void QGCMAVLinkLogWriter::run()
+{
+    while (running)
+    {
+        wakeup.tryAcquire(1, commitInterval);
+        wakeupPending.fetchAndStoreRelease(0);
+        commit();
+        reportDrops(false);
+    }
+    // Commit the records queued before close() was called
+    commit();
+    reportDrops(true);
+}
+
+/**
+ * @param force Report regardless of the time of the last report
+ */
+void QGCMAVLinkLogWriter::reportDrops(bool force)
+{
+    quint64 dropped = recordsDropped;
+    if (dropped == reportedRecordsDropped) return;
+    if (!force && !reportTime.isNull() && reportTime.elapsed() < 1000) return;
+
+    reportedRecordsDropped = dropped;
+    reportTime.start();
+    emit recordsDroppedChanged(file.fileName(), (int)dropped, peakFill);
+}
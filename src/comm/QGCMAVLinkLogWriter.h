@@ -0,0 +1,150 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class QGCMAVLinkLogWriter
+ *
+ */
+
+#ifndef QGCMAVLINKLOGWRITER_H
+#define QGCMAVLINKLOGWRITER_H
+
+#include <QThread>
+#include <QFile>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QTime>
+#include "QGCByteRing.h"
+#include "QGCMAVLink.h"
+
+/**
+ * @brief Writes the MAVLink packet log in the background
+ *
+ * The protocol worker serializes each message into a lock-free ring and
+ * immediately returns to parsing. The writer thread wakes up periodically
+ * or once the ring is half full and commits all queued records with a few
+ * large writes. If the disk does not keep up and the ring runs full, the
+ * record is dropped and counted instead of stalling the ingest. The drop
+ * count is reported by the writer thread at most once per second.
+ *
+ * New logs start with a 16 byte file header (magic, format version and
+ * reserved bytes), followed by records consisting of the 64 bit receive
+ * timestamp in microseconds and the packet with its real length. The length
+ * is known from the packet header. Logs without the file header are legacy
+ * logs with records of fixed MAVLINK_MAX_PACKET_LEN + 8 bytes. Appending
+ * to an existing legacy log keeps the legacy record format.
+ */
+class QGCMAVLinkLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    QGCMAVLinkLogWriter(QObject* parent = 0);
+    ~QGCMAVLinkLogWriter();
+
+    /** @brief Open the logfile for appending and start the writer thread */
+    bool open(const QString& fileName);
+    /** @brief Write all queued records, stop the thread and close the file */
+    void close();
+    /** @brief Check if records are currently accepted */
+    bool isOpen() {
+        return accepting.fetchAndAddAcquire(0) != 0;
+    }
+    /** @brief Check if records are written in the legacy fixed length format */
+    bool isLegacyFormat() const {
+        return legacyFormat;
+    }
+    /** @brief Queue a message for logging, only called from one thread */
+    bool log(quint64 time, const mavlink_message_t& message);
+
+    /** @brief Get the number of records queued since the file was opened */
+    quint64 getRecordsLogged() const {
+        return recordsLogged;
+    }
+    /** @brief Get the number of records dropped because the ring was full */
+    quint64 getRecordsDropped() const {
+        return recordsDropped;
+    }
+    /** @brief Get the number of bytes written to the file */
+    quint64 getBytesWritten() const {
+        return bytesWritten;
+    }
+    /** @brief Get the number of write calls issued to the file */
+    quint64 getCommits() const {
+        return commits;
+    }
+    /** @brief Get the highest fill level of the ring in bytes */
+    int getPeakFill() const {
+        return peakFill;
+    }
+
+    /** @brief Get the file header of the variable length format */
+    static QByteArray fileHeader();
+    /** @brief Check if a log starts with the file header of the variable length format */
+    static bool hasFileHeader(QIODevice* device);
+
+    static const int headerLength = 16;    ///< Size of the file header in bytes
+    static const quint32 formatVersion = 1; ///< Version stored in the file header
+    static const int timeLength = sizeof(quint64); ///< Size of the record timestamp
+    static const int legacyRecordLength = MAVLINK_MAX_PACKET_LEN + sizeof(quint64); ///< Size of a legacy record
+
+signals:
+    /** @brief Writing to the logfile failed, no further records are accepted */
+    void writeFailed(const QString& fileName);
+    /** @brief Records were dropped because the ring was full, emitted at most once per second */
+    void recordsDroppedChanged(const QString& fileName, int dropped, int peakFill);
+
+protected:
+    void run();
+    /** @brief Write all records queued in the ring, writer thread only */
+    bool commit();
+    /** @brief Report new drops, writer thread only */
+    void reportDrops(bool force);
+
+    static const int ringSize = 1024*1024;  ///< Queue size, about 40000 short records
+    static const int commitInterval = 200;  ///< Maximum time a record stays queued in ms
+    static const int chunkSize = 64*1024;   ///< Maximum size of a single write
+
+    QFile file;                  ///< Logfile, only accessed by the writer thread while running
+    QGCByteRing ring;            ///< Serialized records, written by the logging thread
+    QSemaphore wakeup;           ///< Wakes up the writer before the commit interval elapsed
+    QAtomicInt wakeupPending;    ///< Set once the logging thread requested a wakeup
+    QAtomicInt accepting;        ///< Set while records are accepted
+    QAtomicInt loggers;          ///< Number of threads currently inside log()
+    volatile bool running;       ///< False once close() was called
+    volatile bool failed;        ///< Set once writing to the file failed
+    bool legacyFormat;           ///< Write fixed length records to an existing legacy log
+    volatile quint64 recordsLogged;
+    volatile quint64 recordsDropped;
+    volatile quint64 bytesWritten;
+    volatile quint64 commits;
+    volatile int peakFill;
+    quint64 reportedRecordsDropped; ///< Drop count of the last report, writer thread only
+    QTime reportTime;            ///< Time of the last drop report, writer thread only
+
+private:
+    Q_DISABLE_COPY(QGCMAVLinkLogWriter)
+};
+
+#endif // QGCMAVLINKLOGWRITER_H
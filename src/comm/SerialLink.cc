@@ -386,6 +386,9 @@ void SerialLink::writeSettings()
 /**
  * @brief Runs the thread
  *
+ * The thread blocks on the readiness of the port (select() on the tty file
+ * descriptor, the comm event on Windows) and wakes up as soon as bytes
+ * arrive. The wait timeout only bounds the time until a stop request is seen.
  **/
 void SerialLink::run()
 {
@@ -403,12 +406,20 @@ void SerialLink::run()
 				break;
 			}
 		}
-        // Check if new bytes have arrived, if yes, emit the notification signal
-        checkForBytes();
-        /* Serial data isn't arriving that fast normally, this saves the thread
-                 * from consuming too much processing time
-                 */
-        MG::SLEEP::msleep(SerialLink::poll_interval);
+        // Block until new bytes have arrived, if yes, emit the notification signal
+        if (port && port->isOpen() && port->isWritable())
+        {
+            if (port->waitForReadyRead(SerialLink::stop_check_interval))
+            {
+                readBytes();
+            }
+        }
+        else
+        {
+            checkForBytes();
+            // No port to wait on, do not spin
+            MG::SLEEP::msleep(SerialLink::poll_interval);
+        }
     }
 	if (port) {
         port->flushInBuffer();
@@ -425,14 +436,8 @@ void SerialLink::checkForBytes()
     /* Check if bytes are available */
     if(port && port->isOpen() && port->isWritable())
     {
-        dataMutex.lock();
-        qint64 available = port->bytesAvailable();
-        dataMutex.unlock();
-
-        if(available > 0)
-        {
-            readBytes();
-        }
+        // readBytes() checks the number of available bytes itself
+        readBytes();
     }
     else
     {
@@ -479,28 +484,22 @@ void SerialLink::readBytes()
 {
     dataMutex.lock();
     if(port && port->isOpen()) {
-        const qint64 maxLength = 2048;
-        char data[maxLength];
         qint64 numBytes = port->bytesAvailable();
         //qDebug() << "numBytes: " << numBytes;
 
         if(numBytes > 0) {
-            /* Read as much data in buffer as possible without overflow */
-            if(maxLength < numBytes) numBytes = maxLength;
-
-            port->read(data, numBytes);
-            QByteArray b(data, numBytes);
-            emit bytesReceived(this, b);
-
-            //qDebug() << "SerialLink::readBytes()" << std::hex << data;
-            //            int i;
-            //            for (i=0; i<numBytes; i++){
-            //                unsigned int v=data[i];
-            //
-            //                fprintf(stderr,"%02x ", v);
-            //            }
-            //            fprintf(stderr,"\n");
-            bitsReceivedTotal += numBytes * 8;
+            /* Read all data in buffer, the receive buffer is reused
+             * and only grows if a larger chunk arrives. It is only
+             * copied if a queued receiver still holds the last chunk.
+             */
+            readBuffer.resize(numBytes);
+            numBytes = port->read(readBuffer.data(), numBytes);
+            if (numBytes > 0)
+            {
+                if (numBytes < readBuffer.size()) readBuffer.resize(numBytes);
+                emit bytesReceived(this, readBuffer);
+                bitsReceivedTotal += numBytes * 8;
+            }
         }
     }
     dataMutex.unlock();
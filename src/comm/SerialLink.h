@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QThread>
 #include <QMutex>
 #include <QString>
+#include <QByteArray>
 #include "qserialport.h"
 #include <configuration.h>
 #include "SerialLinkInterface.h"
@@ -67,6 +68,7 @@ public:
     ~SerialLink();
 
     static const int poll_interval = SERIAL_POLL_INTERVAL; ///< Polling interval, defined in configuration.h
+    static const int stop_check_interval = 100; ///< Maximum time in ms to block on the port before checking for a stop request
 
     /** @brief Get a list of the currently available ports */
     QVector<QString>* getCurrentPorts();
@@ -166,6 +168,7 @@ protected:
     quint64 connectionStartTime;
     QMutex statisticsMutex;
     QMutex dataMutex;
+    QByteArray readBuffer; ///< Reused receive buffer
     QVector<QString>* ports;
 
 private:
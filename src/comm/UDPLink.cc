@@ -37,10 +37,24 @@ This file is part of the QGROUNDCONTROL project
 #include "LinkManager.h"
 #include "QGC.h"
 #include <QHostInfo>
-//#include <netinet/in.h>
+#include <QVarLengthArray>
+#ifdef Q_OS_LINUX
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <string.h>
+#endif
 
 UDPLink::UDPLink(QHostAddress host, quint16 port)
-	: socket(NULL)
+	: socket(NULL),
+    datagramsDropped(0),
+    reportedDatagramsDropped(0)
+#ifdef Q_OS_LINUX
+    , stopReceiving(false),
+    receivePool(new char[batchSize * datagramSize]),
+    sendTargetsValid(true)
+#endif
 {
     this->host = host;
     this->port = port;
@@ -55,16 +69,37 @@ UDPLink::UDPLink(QHostAddress host, quint16 port)
 UDPLink::~UDPLink()
 {
     disconnect();
+#ifdef Q_OS_LINUX
+    delete[] receivePool;
+    receivePool = NULL;
+#endif
 	this->deleteLater();
 }
 
 /**
  * @brief Runs the thread
  *
+ * On Linux the thread blocks on the socket and receives the datagrams in
+ * batches, the other platforms receive through the readyRead() signal.
  **/
 void UDPLink::run()
 {
+#ifdef Q_OS_LINUX
+    while (!stopReceiving)
+    {
+        struct pollfd fds;
+        fds.fd = socket ? socket->socketDescriptor() : -1;
+        fds.events = POLLIN;
+        fds.revents = 0;
+        // The timeout only bounds the time until a stop request is seen
+        if (fds.fd >= 0 && poll(&fds, 1, 100) > 0 && (fds.revents & POLLIN))
+        {
+            receiveBatch();
+        }
+    }
+#else
 	exec();
+#endif
 }
 
 void UDPLink::setAddress(QHostAddress host)
@@ -105,6 +140,7 @@ void UDPLink::setPort(int port)
 void UDPLink::addHost(const QString& host)
 {
     //qDebug() << "UDP:" << "ADDING HOST:" << host;
+    QMutexLocker locker(&dataMutex);
     if (host.contains(":"))
     {
         //qDebug() << "HOST: " << host.split(":").first();
@@ -123,10 +159,13 @@ void UDPLink::addHost(const QString& host)
                 }
             }
             hosts.append(address);
-			this->setAddress(address);
             //qDebug() << "Address:" << address.toString();
             // Set port according to user input
             ports.append(host.split(":").last().toInt());
+            rebuildPeerTable();
+            // Reconnecting stops the receive thread, release the hosts first
+            locker.unlock();
+			this->setAddress(address);
 			this->setPort(host.split(":").last().toInt());
         }
     }
@@ -139,6 +178,7 @@ void UDPLink::addHost(const QString& host)
             hosts.append(info.addresses().first());
             // Set port according to default (this port)
             ports.append(port);
+            rebuildPeerTable();
         }
     }
 }
@@ -159,6 +199,7 @@ void UDPLink::removeHost(const QString& hostname)
             address = hostAddresses.at(i);
         }
     }
+    QMutexLocker locker(&dataMutex);
     for (int i = 0; i < hosts.count(); ++i)
     {
         if (hosts.at(i) == address)
@@ -167,10 +208,102 @@ void UDPLink::removeHost(const QString& hostname)
             ports.removeAt(i);
         }
     }
+    rebuildPeerTable();
+}
+
+void UDPLink::rebuildPeerTable()
+{
+    hostIndex.clear();
+#ifdef Q_OS_LINUX
+    sendTargets.clear();
+    sendTargetsValid = true;
+#endif
+    for (int i = 0; i < hosts.size(); i++)
+    {
+        indexPeer(i);
+    }
+}
+
+void UDPLink::indexPeer(int index)
+{
+    quint32 address = hosts.at(index).toIPv4Address();
+    if (address != 0)
+    {
+        hostIndex.insert(peerKey(address, ports.at(index)), index);
+    }
+#ifdef Q_OS_LINUX
+    if (address == 0)
+    {
+        // Non-IPv4 host, sendmmsg() is not used
+        sendTargetsValid = false;
+    }
+    sockaddr_in target;
+    memset(&target, 0, sizeof(target));
+    target.sin_family = AF_INET;
+    target.sin_addr.s_addr = htonl(address);
+    target.sin_port = htons(ports.at(index));
+    sendTargets.append(target);
+#endif
+}
+
+/**
+ * Several vehicles may share one address, e.g. simulated instances on one
+ * host, so each address and port pair is a peer of its own.
+ */
+void UDPLink::learnPeer(const QHostAddress& sender, quint16 senderPort)
+{
+    quint32 address = sender.toIPv4Address();
+    if (address != 0)
+    {
+        if (hostIndex.contains(peerKey(address, senderPort))) return;
+    }
+    else
+    {
+        for (int i = 0; i < hosts.size(); i++)
+        {
+            if (hosts.at(i) == sender && ports.at(i) == senderPort) return;
+        }
+    }
+
+    // Add host to broadcast list, only the new entry is indexed
+    hosts.append(sender);
+    ports.append(senderPort);
+    indexPeer(hosts.size() - 1);
 }
 
 void UDPLink::writeBytes(const char* data, qint64 size)
 {
+    if (!socket) return;
+    QMutexLocker locker(&dataMutex);
+
+#ifdef Q_OS_LINUX
+    // Send the same datagram to all hosts with one system call
+    if (sendTargetsValid && sendTargets.size() > 1)
+    {
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data);
+        iov.iov_len = size;
+        QVarLengthArray<struct mmsghdr, 16> messages(sendTargets.size());
+        memset(messages.data(), 0, sizeof(struct mmsghdr) * messages.size());
+        for (int h = 0; h < sendTargets.size(); h++)
+        {
+            messages[h].msg_hdr.msg_name = &sendTargets[h];
+            messages[h].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            messages[h].msg_hdr.msg_iov = &iov;
+            messages[h].msg_hdr.msg_iovlen = 1;
+        }
+        int sent = 0;
+        while (sent < messages.size())
+        {
+            int result = sendmmsg(socket->socketDescriptor(), messages.data() + sent, messages.size() - sent, 0);
+            if (result <= 0) break;
+            sent += result;
+        }
+        bitsSentTotal += sent * size * 8;
+        return;
+    }
+#endif
+
     // Broadcast to all connected systems
     for (int h = 0; h < hosts.size(); h++)
     {
@@ -204,48 +337,105 @@ void UDPLink::writeBytes(const char* data, qint64 size)
 /**
  * @brief Read a number of bytes from the interface.
  *
- * @param data Pointer to the data byte array to write the bytes to
- * @param maxLength The maximum number of bytes to write
+ * All pending datagrams are joined into one chunk and emitted at once.
  **/
 void UDPLink::readBytes()
 {
+    receiveBuffer.resize(0);
+    QMutexLocker locker(&dataMutex);
     while (socket->hasPendingDatagrams())
     {
-        QByteArray datagram;
-        datagram.resize(socket->pendingDatagramSize());
+        int offset = receiveBuffer.size();
+        receiveBuffer.resize(offset + socket->pendingDatagramSize());
 
         QHostAddress sender;
         quint16 senderPort;
-        socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        qint64 length = socket->readDatagram(receiveBuffer.data() + offset, receiveBuffer.size() - offset, &sender, &senderPort);
+        receiveBuffer.resize(offset + qMax(length, (qint64)0));
 
-        // FIXME TODO Check if this method is better than retrieving the data by individual processes
-        emit bytesReceived(this, datagram);
+        // Only unknown peers need the slow path
+        quint32 address = sender.toIPv4Address();
+        if (address == 0 || !hostIndex.contains(peerKey(address, senderPort)))
+        {
+            learnPeer(sender, senderPort);
+        }
+    }
 
-//        // Echo data for debugging purposes
-//        std::cerr << __FILE__ << __LINE__ << "Received datagram:" << std::endl;
-//        int i;
-//        for (i=0; i<s; i++)
-//        {
-//            unsigned int v=data[i];
-//            fprintf(stderr,"%02x ", v);
-//        }
-//        std::cerr << std::endl;
+    locker.unlock();
 
+    if (receiveBuffer.size() > 0)
+    {
+        // FIXME TODO Check if this method is better than retrieving the data by individual processes
+        emit bytesReceived(this, receiveBuffer);
+        bitsReceivedTotal += receiveBuffer.size() * 8;
+    }
+}
 
-        // Add host to broadcast list if not yet present
-        if (!hosts.contains(sender))
+#ifdef Q_OS_LINUX
+/**
+ * Receives up to batchSize datagrams per recvmmsg() call into the buffer
+ * pool, until the socket is drained. The datagrams are joined into one chunk.
+ */
+void UDPLink::receiveBatch()
+{
+    struct mmsghdr messages[batchSize];
+    struct iovec iovecs[batchSize];
+    sockaddr_in senders[batchSize];
+    int fd = socket->socketDescriptor();
+
+    receiveBuffer.resize(0);
+    int received = batchSize;
+    while (received == batchSize)
+    {
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < batchSize; i++)
         {
-            hosts.append(sender);
-            ports.append(senderPort);
-            //        ports->insert(sender, senderPort);
+            iovecs[i].iov_base = receivePool + i * datagramSize;
+            iovecs[i].iov_len = datagramSize;
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
         }
-        else
+
+        received = recvmmsg(fd, messages, batchSize, MSG_DONTWAIT, NULL);
+        QMutexLocker locker(&dataMutex);
+        for (int i = 0; i < received; i++)
         {
-            int index = hosts.indexOf(sender);
-            ports.replace(index, senderPort);
+            // The slots hold the largest UDP payload, this only guards against oversized IPv6 jumbograms
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC)
+            {
+                datagramsDropped.ref();
+                continue;
+            }
+            receiveBuffer.append(receivePool + i * datagramSize, messages[i].msg_len);
+
+            // Only unknown peers need the slow path
+            quint32 address = ntohl(senders[i].sin_addr.s_addr);
+            quint16 senderPort = ntohs(senders[i].sin_port);
+            if (!hostIndex.contains(peerKey(address, senderPort)))
+            {
+                learnPeer(QHostAddress(address), senderPort);
+            }
         }
     }
+
+    if (receiveBuffer.size() > 0)
+    {
+        emit bytesReceived(this, receiveBuffer);
+        bitsReceivedTotal += receiveBuffer.size() * 8;
+    }
+
+    // Report truncated datagrams at most every ten seconds
+    int dropped = datagramsDropped.fetchAndAddRelaxed(0);
+    if (dropped != reportedDatagramsDropped && (dropReportTime.isNull() || dropReportTime.elapsed() >= 10000))
+    {
+        qDebug() << "UDP link" << getName() << "dropped" << dropped - reportedDatagramsDropped << "datagrams larger than" << datagramSize << "bytes," << dropped << "in total";
+        reportedDatagramsDropped = dropped;
+        dropReportTime.start();
+    }
 }
+#endif
 
 
 /**
@@ -265,6 +455,9 @@ qint64 UDPLink::bytesAvailable()
  **/
 bool UDPLink::disconnect()
 {
+#ifdef Q_OS_LINUX
+    stopReceiving = true;
+#endif
 	this->quit();
 	this->wait();
 
@@ -290,9 +483,15 @@ bool UDPLink::connect()
 {
 	if(this->isRunning())
 	{
+#ifdef Q_OS_LINUX
+        stopReceiving = true;
+#endif
 		this->quit();
 		this->wait();
 	}
+#ifdef Q_OS_LINUX
+    stopReceiving = false;
+#endif
     bool connected = this->hardwareConnect();
     start(HighPriority);
     return connected;
@@ -340,7 +539,10 @@ bool UDPLink::hardwareConnect(void)
     */
 
     //QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
+#ifndef Q_OS_LINUX
+    // Linux receives in batches in run()
     QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
+#endif
 
     emit connected(connectState);
     if (connectState) {
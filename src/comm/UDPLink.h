@@ -34,11 +34,20 @@ This file is part of the QGROUNDCONTROL project
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QMutex>
+#include <QMutexLocker>
 #include <QUdpSocket>
+#include <QTime>
+#include <QAtomicInt>
 #include <LinkInterface.h>
 #include <configuration.h>
 
+#ifdef Q_OS_LINUX
+#include <netinet/in.h>
+#endif
+
 class UDPLink : public LinkInterface
 {
     Q_OBJECT
@@ -66,6 +75,7 @@ public:
     int getDataBitsType();
     int getStopBitsType();
     QList<QHostAddress> getHosts() {
+        QMutexLocker locker(&dataMutex);
         return hosts;
     }
 
@@ -79,6 +89,10 @@ public:
     qint64 getMaxDownstream();
     qint64 getBitsSent();
     qint64 getBitsReceived();
+    /** @brief Get the number of datagrams dropped because they did not fit into a receive buffer */
+    int getDatagramsDropped() {
+        return datagramsDropped.fetchAndAddRelaxed(0);
+    }
 
     void run();
 
@@ -115,6 +129,18 @@ protected:
     bool connectState;
     QList<QHostAddress> hosts;
     QList<quint16> ports;
+    QHash<quint64, int> hostIndex; ///< Index into hosts / ports by IPv4 address and port, see peerKey()
+    QByteArray receiveBuffer;      ///< Reused buffer for the datagrams of one batch
+#ifdef Q_OS_LINUX
+    enum {
+        batchSize = 64,            ///< Datagrams received / sent with one system call
+        datagramSize = 65507       ///< Largest UDP payload, no datagram is truncated
+    };
+    volatile bool stopReceiving;   ///< Stops the receive loop in run()
+    char* receivePool;             ///< Pool of batchSize datagram buffers
+    QVector<sockaddr_in> sendTargets; ///< Socket addresses of all hosts
+    bool sendTargetsValid;         ///< False if a host has no IPv4 address
+#endif
 
     quint64 bitsSentTotal;
     quint64 bitsSentCurrent;
@@ -123,10 +149,27 @@ protected:
     quint64 bitsReceivedCurrent;
     quint64 bitsReceivedMax;
     quint64 connectionStartTime;
+    QAtomicInt datagramsDropped;   ///< Datagrams larger than the receive buffers
+    int reportedDatagramsDropped;  ///< Dropped datagrams at the last report
+    QTime dropReportTime;          ///< Time of the last report of dropped datagrams
     QMutex statisticsMutex;
     QMutex dataMutex;
 
     void setName(QString name);
+    /** @brief Add a sender to the broadcast list if its address and port are new, dataMutex has to be locked */
+    void learnPeer(const QHostAddress& sender, quint16 senderPort);
+    /** @brief Rebuild the lookup tables after hosts were removed or changed, dataMutex has to be locked */
+    void rebuildPeerTable();
+    /** @brief Add the host at this index to the lookup tables, dataMutex has to be locked */
+    void indexPeer(int index);
+    /** @brief Key of a peer in hostIndex */
+    static quint64 peerKey(quint32 address, quint16 port) {
+        return (static_cast<quint64>(address) << 16) | port;
+    }
+#ifdef Q_OS_LINUX
+    /** @brief Receive all pending datagrams in batches with recvmmsg() */
+    void receiveBatch();
+#endif
 
 private:
 	bool hardwareConnect(void);
@@ -31,6 +31,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QtGui/QApplication>
 #include "QGCCore.h"
 #include "MainWindow.h"
+#include "QGCMAVLinkLogReplay.h"
 #include "configuration.h"
 
 
@@ -70,6 +71,12 @@ int main(int argc, char *argv[])
     qInstallMsgHandler( msgHandler );
 #endif
 
+    // Headless replay of MAVLink logs for batch analysis
+    if (argc > 1 && QString(argv[1]) == "--replay")
+    {
+        return QGCMAVLinkLogReplay::runCommandLine(argc, argv);
+    }
+
     QGCCore core(argc, argv);
     return core.exec();
 }
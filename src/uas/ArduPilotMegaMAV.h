@@ -31,9 +31,6 @@ class ArduPilotMegaMAV : public UAS
     Q_OBJECT
 public:
     ArduPilotMegaMAV(MAVLinkProtocol* mavlink, int id = 0);
-public slots:
-    /** @brief Receive a MAVLink message from this MAV */
-    void receiveMessage(LinkInterface* link, mavlink_message_t message);
 };
 
 #endif // ARDUPILOTMAV_H
@@ -26,80 +26,74 @@ This file is part of the QGROUNDCONTROL project
 PxQuadMAV::PxQuadMAV(MAVLinkProtocol* mavlink, int id) :
     UAS(mavlink, id)
 {
+    // Only compile this portion if matching MAVLink packets have been compiled
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    setMessageHandler(MAVLINK_MSG_ID_RAW_AUX, static_cast<MessageHandler>(&PxQuadMAV::handleRawAux));
+    setMessageHandler(MAVLINK_MSG_ID_IMAGE_TRIGGERED, static_cast<MessageHandler>(&PxQuadMAV::handleImageTriggered));
+    setMessageHandler(MAVLINK_MSG_ID_PATTERN_DETECTED, static_cast<MessageHandler>(&PxQuadMAV::handlePatternDetected));
+    setMessageHandler(MAVLINK_MSG_ID_WATCHDOG_HEARTBEAT, static_cast<MessageHandler>(&PxQuadMAV::handleWatchdogHeartbeat));
+    setMessageHandler(MAVLINK_MSG_ID_WATCHDOG_PROCESS_INFO, static_cast<MessageHandler>(&PxQuadMAV::handleWatchdogProcessInfo));
+    setMessageHandler(MAVLINK_MSG_ID_WATCHDOG_PROCESS_STATUS, static_cast<MessageHandler>(&PxQuadMAV::handleWatchdogProcessStatus));
+#endif
 }
 
-/**
- * This function is called by MAVLink once a complete, uncorrupted (CRC check valid)
- * mavlink packet is received.
- *
- * @param link Hardware link the message came from (e.g. /dev/ttyUSB0 or UDP port).
- *             messages can be sent back to the system via this link
- * @param message MAVLink message, as received from the MAVLink protocol stack
- */
-void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
-{
-    // Only compile this portion if matching MAVLink packets have been compiled
 #ifdef MAVLINK_ENABLED_PIXHAWK
-    mavlink_message_t* msg = &message;
-
-    if (message.sysid == uasId)
-    {
-        switch (message.msgid)
-        {
-        case MAVLINK_MSG_ID_RAW_AUX:
-            {
-            mavlink_raw_aux_t raw;
-            mavlink_msg_raw_aux_decode(&message, &raw);
-            quint64 time = getUnixTime(0);
-            emit valueChanged(uasId, "Pressure", "raw", raw.baro, time);
-            emit valueChanged(uasId, "Temperature", "raw", raw.temp, time);
-        }
-        break;
-        case MAVLINK_MSG_ID_IMAGE_TRIGGERED:
-        {
-            // FIXME Kind of a hack to load data from disk
-            mavlink_image_triggered_t img;
-            mavlink_msg_image_triggered_decode(&message, &img);
-            emit imageStarted(img.timestamp);
-        }
-        break;
-        case MAVLINK_MSG_ID_PATTERN_DETECTED:
-        {
-            mavlink_pattern_detected_t detected;
-            mavlink_msg_pattern_detected_decode(&message, &detected);
-            QByteArray b;
-            b.resize(256);
-            mavlink_msg_pattern_detected_get_file(&message, b.data());
-            b.append('\0');
-            QString name = QString(b);
-            if (detected.type == 0)
-                emit patternDetected(uasId, name, detected.confidence, detected.detected);
-            else if (detected.type == 1)
-                emit letterDetected(uasId, name, detected.confidence, detected.detected);
-        }
-        break;
-        case MAVLINK_MSG_ID_WATCHDOG_HEARTBEAT: {
-            mavlink_watchdog_heartbeat_t payload;
-            mavlink_msg_watchdog_heartbeat_decode(msg, &payload);
-
-            emit watchdogReceived(this->uasId, payload.watchdog_id, payload.process_count);
-        }
-        break;
-
-        case MAVLINK_MSG_ID_WATCHDOG_PROCESS_INFO: {
-            mavlink_watchdog_process_info_t payload;
-            mavlink_msg_watchdog_process_info_decode(msg, &payload);
-
-            emit processReceived(this->uasId, payload.watchdog_id, payload.process_id, QString((const char*)payload.name), QString((const char*)payload.arguments), payload.timeout);
-        }
-        break;
-
-        case MAVLINK_MSG_ID_WATCHDOG_PROCESS_STATUS: {
-            mavlink_watchdog_process_status_t payload;
-            mavlink_msg_watchdog_process_status_decode(msg, &payload);
-            emit processChanged(this->uasId, payload.watchdog_id, payload.process_id, payload.state, (payload.muted == 1) ? true : false, payload.crashes, payload.pid);
-        }
-        break;
+void PxQuadMAV::handleRawAux(const mavlink_message_t& message)
+{
+    mavlink_raw_aux_t raw;
+    mavlink_msg_raw_aux_decode(&message, &raw);
+    quint64 time = getUnixTime(0);
+    emit valueChanged(uasId, "Pressure", "raw", raw.baro, time);
+    emit valueChanged(uasId, "Temperature", "raw", raw.temp, time);
+}
+
+void PxQuadMAV::handleImageTriggered(const mavlink_message_t& message)
+{
+    // FIXME Kind of a hack to load data from disk
+    mavlink_image_triggered_t img;
+    mavlink_msg_image_triggered_decode(&message, &img);
+    emit imageStarted(img.timestamp);
+}
+
+void PxQuadMAV::handlePatternDetected(const mavlink_message_t& message)
+{
+    mavlink_pattern_detected_t detected;
+    mavlink_msg_pattern_detected_decode(&message, &detected);
+    QByteArray b;
+    b.resize(256);
+    mavlink_msg_pattern_detected_get_file(&message, b.data());
+    b.append('\0');
+    QString name = QString(b);
+    if (detected.type == 0)
+        emit patternDetected(uasId, name, detected.confidence, detected.detected);
+    else if (detected.type == 1)
+        emit letterDetected(uasId, name, detected.confidence, detected.detected);
+}
+
+void PxQuadMAV::handleWatchdogHeartbeat(const mavlink_message_t& message)
+{
+    mavlink_watchdog_heartbeat_t payload;
+    mavlink_msg_watchdog_heartbeat_decode(&message, &payload);
+
+    emit watchdogReceived(this->uasId, payload.watchdog_id, payload.process_count);
+}
+
+void PxQuadMAV::handleWatchdogProcessInfo(const mavlink_message_t& message)
+{
+    mavlink_watchdog_process_info_t payload;
+    mavlink_msg_watchdog_process_info_decode(&message, &payload);
+
+    emit processReceived(this->uasId, payload.watchdog_id, payload.process_id, QString((const char*)payload.name), QString((const char*)payload.arguments), payload.timeout);
+}
+
+void PxQuadMAV::handleWatchdogProcessStatus(const mavlink_message_t& message)
+{
+    mavlink_watchdog_process_status_t payload;
+    mavlink_msg_watchdog_process_status_decode(&message, &payload);
+    emit processChanged(this->uasId, payload.watchdog_id, payload.process_id, payload.state, (payload.muted == 1) ? true : false, payload.crashes, payload.pid);
+}
+
+// Messages no longer part of the PIXHAWK message set
 //        case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE: {
 //            mavlink_vision_position_estimate_t pos;
 //            mavlink_msg_vision_position_estimate_decode(&message, &pos);
@@ -191,20 +185,7 @@ void PxQuadMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
 //            emit valueChanged(uasId, "Load", "%", ((float)status.load)/10.0f, getUnixTime());
 //        }
 //        break;
-        default:
-            // Let UAS handle the default message set
-            UAS::receiveMessage(link, message);
-            break;
-        }
-    }
-
-#else
-    // Let UAS handle the default message set
-    UAS::receiveMessage(link, message);
-    Q_UNUSED(link);
-    Q_UNUSED(message);
 #endif
-}
 
 #if defined(QGC_PROTOBUF_ENABLED)
 void PxQuadMAV::receiveExtendedMessage(LinkInterface* link, std::tr1::shared_ptr<google::protobuf::Message> message)
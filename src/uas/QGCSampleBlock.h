@@ -0,0 +1,121 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the batched telemetry samples
+ *
+ */
+
+#ifndef QGCSAMPLEBLOCK_H
+#define QGCSAMPLEBLOCK_H
+
+#include <QVector>
+#include <QMetaType>
+
+/**
+ * @brief One value of a telemetry channel
+ *
+ * The channel is an ID of MAVLinkChannelRegistry, which also knows the
+ * name, unit and system of the channel. The original type of the value is
+ * kept, so integers of 64 bit are not rounded.
+ */
+struct QGCSample
+{
+    enum Type {
+        UINT8, INT8, UINT16, INT16, UINT32, INT32, UINT64, INT64, DOUBLE
+    };
+
+    int channel;        ///< Channel ID in MAVLinkChannelRegistry
+    int type;           ///< Original type of the value, see Type
+    quint64 time;       ///< Timestamp in milliseconds
+    union {
+        quint64 u;      ///< Unsigned integer types
+        qint64 i;       ///< Signed integer types
+        double d;       ///< Floating point types
+    } value;
+
+    QGCSample() : channel(-1), type(DOUBLE), time(0) {
+        value.d = 0.0;
+    }
+    QGCSample(int channel, quint8 v, quint64 time) : channel(channel), type(UINT8), time(time) {
+        value.u = v;
+    }
+    QGCSample(int channel, qint8 v, quint64 time) : channel(channel), type(INT8), time(time) {
+        value.i = v;
+    }
+    QGCSample(int channel, quint16 v, quint64 time) : channel(channel), type(UINT16), time(time) {
+        value.u = v;
+    }
+    QGCSample(int channel, qint16 v, quint64 time) : channel(channel), type(INT16), time(time) {
+        value.i = v;
+    }
+    QGCSample(int channel, quint32 v, quint64 time) : channel(channel), type(UINT32), time(time) {
+        value.u = v;
+    }
+    QGCSample(int channel, qint32 v, quint64 time) : channel(channel), type(INT32), time(time) {
+        value.i = v;
+    }
+    QGCSample(int channel, quint64 v, quint64 time) : channel(channel), type(UINT64), time(time) {
+        value.u = v;
+    }
+    QGCSample(int channel, qint64 v, quint64 time) : channel(channel), type(INT64), time(time) {
+        value.i = v;
+    }
+    QGCSample(int channel, double v, quint64 time) : channel(channel), type(DOUBLE), time(time) {
+        value.d = v;
+    }
+
+    /** @brief Get the value converted to double, e.g. for plotting */
+    double toDouble() const {
+        switch (type)
+        {
+        case UINT8:
+        case UINT16:
+        case UINT32:
+        case UINT64:
+            return static_cast<double>(value.u);
+        case INT8:
+        case INT16:
+        case INT32:
+        case INT64:
+            return static_cast<double>(value.i);
+        default:
+            return value.d;
+        }
+    }
+};
+
+Q_DECLARE_TYPEINFO(QGCSample, Q_PRIMITIVE_TYPE);
+
+/**
+ * @brief Samples of one decoded message or one update tick
+ *
+ * The block is implicitly shared, so passing it through queued signals or
+ * to several receivers copies only a pointer.
+ */
+typedef QVector<QGCSample> QGCSampleBlock;
+
+Q_DECLARE_METATYPE(QGCSampleBlock)
+
+#endif // QGCSAMPLEBLOCK_H
@@ -35,124 +35,122 @@ SlugsMAV::SlugsMAV(MAVLinkProtocol* mavlink, int id) :
 
     updateRoundRobin = 0;
     uasId = id;
+
+    setMessageHandler(MAVLINK_MSG_ID_RAW_IMU, static_cast<MessageHandler>(&SlugsMAV::handleRawImu));
+    setMessageHandler(MAVLINK_MSG_ID_BOOT, static_cast<MessageHandler>(&SlugsMAV::handleBoot));
+    setMessageHandler(MAVLINK_MSG_ID_ATTITUDE, static_cast<MessageHandler>(&SlugsMAV::handleSlugsAttitude));
+    setMessageHandler(MAVLINK_MSG_ID_GPS_RAW, static_cast<MessageHandler>(&SlugsMAV::handleGpsRaw));
+    setMessageHandler(MAVLINK_MSG_ID_CPU_LOAD, static_cast<MessageHandler>(&SlugsMAV::handleCpuLoad));
+    setMessageHandler(MAVLINK_MSG_ID_AIR_DATA, static_cast<MessageHandler>(&SlugsMAV::handleAirData));
+    setMessageHandler(MAVLINK_MSG_ID_SENSOR_BIAS, static_cast<MessageHandler>(&SlugsMAV::handleSensorBias));
+    setMessageHandler(MAVLINK_MSG_ID_DIAGNOSTIC, static_cast<MessageHandler>(&SlugsMAV::handleDiagnostic));
+    setMessageHandler(MAVLINK_MSG_ID_SLUGS_NAVIGATION, static_cast<MessageHandler>(&SlugsMAV::handleSlugsNavigation));
+    setMessageHandler(MAVLINK_MSG_ID_DATA_LOG, static_cast<MessageHandler>(&SlugsMAV::handleDataLog));
+    setMessageHandler(MAVLINK_MSG_ID_GPS_DATE_TIME, static_cast<MessageHandler>(&SlugsMAV::handleGpsDateTime));
+    setMessageHandler(MAVLINK_MSG_ID_MID_LVL_CMDS, static_cast<MessageHandler>(&SlugsMAV::handleMidLvlCmds));
+    setMessageHandler(MAVLINK_MSG_ID_CTRL_SRFC_PT, static_cast<MessageHandler>(&SlugsMAV::handleCtrlSrfcPt));
+    setMessageHandler(MAVLINK_MSG_ID_SLUGS_ACTION, static_cast<MessageHandler>(&SlugsMAV::handleSlugsAction));
+    setMessageHandler(MAVLINK_MSG_ID_SCALED_IMU, static_cast<MessageHandler>(&SlugsMAV::handleScaledImu));
+    setMessageHandler(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, static_cast<MessageHandler>(&SlugsMAV::handleServoOutputRaw));
+    setMessageHandler(MAVLINK_MSG_ID_RC_CHANNELS_RAW, static_cast<MessageHandler>(&SlugsMAV::handleSlugsRcChannelsRaw));
 #endif
 }
 
-/**
- * This function is called by MAVLink once a complete, uncorrupted (CRC check valid)
- * mavlink packet is received.
- *
- * @param link Hardware link the message came from (e.g. /dev/ttyUSB0 or UDP port).
- *             messages can be sent back to the system via this link
- * @param message MAVLink message, as received from the MAVLink protocol stack
+#ifdef MAVLINK_ENABLED_SLUGS
+/*
+ * The SLUGS handlers keep the last message of each type, the widgets are
+ * updated from this state by emitSignals(). Messages which UAS handles as
+ * well are passed to the UAS handler first.
  */
-void SlugsMAV::receiveMessage(LinkInterface* link, mavlink_message_t message)
-{
-    UAS::receiveMessage(link, message);// Let UAS handle the default message set
-
-    if (message.sysid == uasId) {
-#ifdef MAVLINK_ENABLED_SLUGS// Handle your special messages mavlink_message_t* msg = &message;
-
-        switch (message.msgid) {
-        case MAVLINK_MSG_ID_RAW_IMU:
-            mavlink_msg_raw_imu_decode(&message, &mlRawImuData);
-            break;
-
-        case MAVLINK_MSG_ID_BOOT:
-            mavlink_msg_boot_decode(&message,&mlBoot);
-            emit slugsBootMsg(uasId, mlBoot);
-            break;
-
-        case MAVLINK_MSG_ID_ATTITUDE:
-            mavlink_msg_attitude_decode(&message, &mlAttitude);
-            break;
-
-        case MAVLINK_MSG_ID_GPS_RAW:
-            mavlink_msg_gps_raw_decode(&message, &mlGpsData);
-            break;
-
-        case MAVLINK_MSG_ID_CPU_LOAD:       //170
-            mavlink_msg_cpu_load_decode(&message,&mlCpuLoadData);
-            break;
-
-        case MAVLINK_MSG_ID_AIR_DATA:       //171
-            mavlink_msg_air_data_decode(&message,&mlAirData);
-            break;
-
-        case MAVLINK_MSG_ID_SENSOR_BIAS:    //172
-            mavlink_msg_sensor_bias_decode(&message,&mlSensorBiasData);
-            break;
-
-        case MAVLINK_MSG_ID_DIAGNOSTIC:     //173
-            mavlink_msg_diagnostic_decode(&message,&mlDiagnosticData);
-            break;
-
-        case MAVLINK_MSG_ID_SLUGS_NAVIGATION://176
-            mavlink_msg_slugs_navigation_decode(&message,&mlNavigation);
-            break;
-
-        case MAVLINK_MSG_ID_DATA_LOG:       //177
-            mavlink_msg_data_log_decode(&message,&mlDataLog);
-            break;
-
-        case MAVLINK_MSG_ID_GPS_DATE_TIME:    //179
-            mavlink_msg_gps_date_time_decode(&message,&mlGpsDateTime);
-            break;
-
-        case MAVLINK_MSG_ID_MID_LVL_CMDS:     //180
-            mavlink_msg_mid_lvl_cmds_decode(&message, &mlMidLevelCommands);
-            break;
-
-        case MAVLINK_MSG_ID_CTRL_SRFC_PT:     //181
-            mavlink_msg_ctrl_srfc_pt_decode(&message, &mlPassthrough);
-            break;
-
-        case MAVLINK_MSG_ID_SLUGS_ACTION:     //183
-            mavlink_msg_slugs_action_decode(&message, &mlAction);
-            break;
-
-        case MAVLINK_MSG_ID_SCALED_IMU:
-            mavlink_msg_scaled_imu_decode(&message, &mlScaled);
-            break;
-
-        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
-            mavlink_msg_servo_output_raw_decode(&message, &mlServo);
-            break;
-
-        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-            mavlink_msg_rc_channels_raw_decode(&message, &mlChannels);
-            break;
-
-            switch (mlAction.actionId) {
-            case SLUGS_ACTION_EEPROM:
-                if (mlAction.actionVal == SLUGS_ACTION_FAIL) {
-                    emit textMessageReceived(message.sysid, message.compid, 255, "EEPROM Write Fail, Data was not saved in Memory!");
-                }
-                break;
-
-            case SLUGS_ACTION_PT_CHANGE:
-                if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
-                    emit textMessageReceived(message.sysid, message.compid, 0, "Passthrough Succesfully Changed");
-                }
-                break;
-
-            case SLUGS_ACTION_MLC_CHANGE:
-                if (mlAction.actionVal == SLUGS_ACTION_SUCCESS) {
-                    emit textMessageReceived(message.sysid, message.compid, 0, "Mid-level Commands Succesfully Changed");
-                }
-                break;
-            }
-
-            //break;
-
-        default:
-            //        qDebug() << "\nSLUGS RECEIVED MESSAGE WITH ID" << message.msgid;
-            break;
-        }
-#endif
-    }
+void SlugsMAV::handleRawImu(const mavlink_message_t& message)
+{
+    mavlink_msg_raw_imu_decode(&message, &mlRawImuData);
+}
+
+void SlugsMAV::handleBoot(const mavlink_message_t& message)
+{
+    mavlink_msg_boot_decode(&message,&mlBoot);
+    emit slugsBootMsg(uasId, mlBoot);
+}
+
+void SlugsMAV::handleSlugsAttitude(const mavlink_message_t& message)
+{
+    handleAttitude(message);
+    mavlink_msg_attitude_decode(&message, &mlAttitude);
+}
+
+void SlugsMAV::handleGpsRaw(const mavlink_message_t& message)
+{
+    mavlink_msg_gps_raw_decode(&message, &mlGpsData);
+}
+
+void SlugsMAV::handleCpuLoad(const mavlink_message_t& message)
+{
+    mavlink_msg_cpu_load_decode(&message,&mlCpuLoadData);
+}
+
+void SlugsMAV::handleAirData(const mavlink_message_t& message)
+{
+    mavlink_msg_air_data_decode(&message,&mlAirData);
+}
+
+void SlugsMAV::handleSensorBias(const mavlink_message_t& message)
+{
+    mavlink_msg_sensor_bias_decode(&message,&mlSensorBiasData);
+}
+
+void SlugsMAV::handleDiagnostic(const mavlink_message_t& message)
+{
+    mavlink_msg_diagnostic_decode(&message,&mlDiagnosticData);
+}
+
+void SlugsMAV::handleSlugsNavigation(const mavlink_message_t& message)
+{
+    mavlink_msg_slugs_navigation_decode(&message,&mlNavigation);
+}
+
+void SlugsMAV::handleDataLog(const mavlink_message_t& message)
+{
+    mavlink_msg_data_log_decode(&message,&mlDataLog);
+}
+
+void SlugsMAV::handleGpsDateTime(const mavlink_message_t& message)
+{
+    mavlink_msg_gps_date_time_decode(&message,&mlGpsDateTime);
+}
+
+void SlugsMAV::handleMidLvlCmds(const mavlink_message_t& message)
+{
+    mavlink_msg_mid_lvl_cmds_decode(&message, &mlMidLevelCommands);
+}
+
+void SlugsMAV::handleCtrlSrfcPt(const mavlink_message_t& message)
+{
+    mavlink_msg_ctrl_srfc_pt_decode(&message, &mlPassthrough);
 }
 
+void SlugsMAV::handleSlugsAction(const mavlink_message_t& message)
+{
+    mavlink_msg_slugs_action_decode(&message, &mlAction);
+}
+
+void SlugsMAV::handleScaledImu(const mavlink_message_t& message)
+{
+    mavlink_msg_scaled_imu_decode(&message, &mlScaled);
+}
+
+void SlugsMAV::handleServoOutputRaw(const mavlink_message_t& message)
+{
+    mavlink_msg_servo_output_raw_decode(&message, &mlServo);
+}
+
+void SlugsMAV::handleSlugsRcChannelsRaw(const mavlink_message_t& message)
+{
+    handleRcChannelsRaw(message);
+    mavlink_msg_rc_channels_raw_decode(&message, &mlChannels);
+}
+#endif
+
 
 
 void SlugsMAV::emitSignals (void)
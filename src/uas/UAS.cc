@@ -26,6 +26,7 @@
 #include "QGCMAVLink.h"
 #include "LinkManager.h"
 #include "SerialLink.h"
+#include "MAVLinkChannelRegistry.h"
 
 #ifdef QGC_PROTOBUF_ENABLED
 #include <google/protobuf/descriptor.h>
@@ -90,13 +91,37 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
     simulation(new QGCFlightGearLink(this)),
     isLocalPositionKnown(false),
     isGlobalPositionKnown(false),
-    systemIsArmed(false)
+    systemIsArmed(false),
+    telemetryChanged(false)
 {
-    for (unsigned int i = 0; i<255;++i)
+    for (unsigned int i = 0; i<256;++i)
     {
         componentID[i] = -1;
         componentMulti[i] = false;
     }
+    initMessageHandlers();
+
+    // Register the values sent to the plots, named like the fields of the generic decoder
+    static const char* sampleNames[SAMPLE_CHANNEL_COUNT][2] = {
+        { "HEARTBEAT.base_mode", "none" },
+        { "HEARTBEAT.system_status", "none" },
+        { "SYS_STATUS.sensors_enabled", "bits" },
+        { "SYS_STATUS.sensors_health", "bits" },
+        { "SYS_STATUS.errors_comm", "-" },
+        { "SYS_STATUS.errors_count1", "-" },
+        { "SYS_STATUS.errors_count2", "-" },
+        { "SYS_STATUS.errors_count3", "-" },
+        { "SYS_STATUS.errors_count4", "-" },
+        { "SYS_STATUS.load", "%" },
+        { "SYS_STATUS.battery_remaining", "%" },
+        { "SYS_STATUS.battery_voltage", "V" },
+        { "SYS_STATUS.battery_current", "A" },
+        { "SYS_STATUS.drop_rate_comm", "%" }
+    };
+    for (int i = 0; i < SAMPLE_CHANNEL_COUNT; ++i)
+    {
+        sampleChannels[i] = MAVLinkChannelRegistry::instance()->add(QString("M%1:%2").arg(uasId).arg(sampleNames[i][0]), sampleNames[i][1], uasId);
+    }
 
     color = UASInterface::getNextColor();
     setBatterySpecs(QString("9V,9.5V,12.6V"));
@@ -186,7 +211,7 @@ bool UAS::getSelected() const
     return (UASManager::instance()->getActiveUAS() == this);
 }
 
-void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
+void UAS::receiveMessage(LinkInterface* link, const mavlink_message_t& message)
 {
     if (!link) return;
     if (!links->contains(link))
@@ -234,12 +259,6 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
     // and we already got one attitude packet
     if (message.sysid == uasId && (!attitudeStamped || (attitudeStamped && (lastAttitude != 0)) || message.msgid == MAVLINK_MSG_ID_ATTITUDE))
     {
-        QString uasState;
-        QString stateDescription;
-
-        bool multiComponentSourceDetected = false;
-        bool wrongComponent = false;
-
         switch (message.compid)
         {
         case MAV_COMP_ID_IMU_2:
@@ -259,799 +278,919 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
         }
         else
         {
-            // Got this message already
+            // Got this message already, the handlers skip
+            // messages of other components with isFromOtherComponent()
             if (componentID[message.msgid] != message.compid)
             {
                 componentMulti[message.msgid] = true;
-                wrongComponent = true;
             }
         }
 
-        if (componentMulti[message.msgid] == true) multiComponentSourceDetected = true;
-
+        // One indexed call, subclasses replaced the handlers
+        // of the messages they treat differently
+        (this->*messageHandlers[message.msgid])(message);
 
-        switch (message.msgid)
+        // Publish the state once per message, not per changed value
+        if (telemetryChanged)
         {
-        case MAVLINK_MSG_ID_HEARTBEAT:
+            telemetryBuffer.write(telemetry);
+            telemetryChanged = false;
+            // Wake up the displays, but only once until one of them read it
+            if (telemetryBuffer.takeReadFlag()) emit telemetryUpdated(this);
+        }
+    }
+}
+
+/**
+ * Fills the handler table with the handlers of the common message set.
+ * Message types without a handler are reported once as unknown,
+ * subclasses replace or add handlers with setMessageHandler().
+ */
+void UAS::initMessageHandlers()
+{
+    for (int i = 0; i < 256; ++i)
+    {
+        messageHandlers[i] = &UAS::handleUnknownMessage;
+    }
+
+    setMessageHandler(MAVLINK_MSG_ID_HEARTBEAT, &UAS::handleHeartbeat);
+    setMessageHandler(MAVLINK_MSG_ID_SYS_STATUS, &UAS::handleSysStatus);
+    setMessageHandler(MAVLINK_MSG_ID_ATTITUDE, &UAS::handleAttitude);
+    setMessageHandler(MAVLINK_MSG_ID_HIL_CONTROLS, &UAS::handleHilControls);
+    setMessageHandler(MAVLINK_MSG_ID_VFR_HUD, &UAS::handleVfrHud);
+    setMessageHandler(MAVLINK_MSG_ID_LOCAL_POSITION_NED, &UAS::handleLocalPositionNed);
+    setMessageHandler(MAVLINK_MSG_ID_GLOBAL_VISION_POSITION_ESTIMATE, &UAS::handleGlobalVisionPositionEstimate);
+    setMessageHandler(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, &UAS::handleGlobalPositionInt);
+    setMessageHandler(MAVLINK_MSG_ID_GPS_RAW_INT, &UAS::handleGpsRawInt);
+    setMessageHandler(MAVLINK_MSG_ID_GPS_STATUS, &UAS::handleGpsStatus);
+    setMessageHandler(MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN, &UAS::handleGpsGlobalOrigin);
+    setMessageHandler(MAVLINK_MSG_ID_RC_CHANNELS_RAW, &UAS::handleRcChannelsRaw);
+    setMessageHandler(MAVLINK_MSG_ID_RC_CHANNELS_SCALED, &UAS::handleRcChannelsScaled);
+    setMessageHandler(MAVLINK_MSG_ID_PARAM_VALUE, &UAS::handleParamValue);
+    setMessageHandler(MAVLINK_MSG_ID_COMMAND_ACK, &UAS::handleCommandAck);
+    setMessageHandler(MAVLINK_MSG_ID_ROLL_PITCH_YAW_THRUST_SETPOINT, &UAS::handleRollPitchYawThrustSetpoint);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_COUNT, &UAS::handleMissionCount);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_ITEM, &UAS::handleMissionItem);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_ACK, &UAS::handleMissionAck);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_REQUEST, &UAS::handleMissionRequest);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_ITEM_REACHED, &UAS::handleMissionItemReached);
+    setMessageHandler(MAVLINK_MSG_ID_MISSION_CURRENT, &UAS::handleMissionCurrent);
+    setMessageHandler(MAVLINK_MSG_ID_LOCAL_POSITION_SETPOINT, &UAS::handleLocalPositionSetpoint);
+    setMessageHandler(MAVLINK_MSG_ID_SET_LOCAL_POSITION_SETPOINT, &UAS::handleSetLocalPositionSetpoint);
+    setMessageHandler(MAVLINK_MSG_ID_STATUSTEXT, &UAS::handleStatusText);
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    setMessageHandler(MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE, &UAS::handleDataTransmissionHandshake);
+    setMessageHandler(MAVLINK_MSG_ID_ENCAPSULATED_DATA, &UAS::handleEncapsulatedData);
+#endif
+#ifdef MAVLINK_ENABLED_UALBERTA
+    setMessageHandler(MAVLINK_MSG_ID_NAV_FILTER_BIAS, &UAS::handleNavFilterBias);
+    setMessageHandler(MAVLINK_MSG_ID_RADIO_CALIBRATION, &UAS::handleRadioCalibration);
+#endif
+
+    // Messages to ignore
+    setMessageHandler(MAVLINK_MSG_ID_RAW_IMU, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_SCALED_IMU, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_RAW_PRESSURE, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_SCALED_PRESSURE, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_SERVO_OUTPUT_RAW, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_OPTICAL_FLOW, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_DEBUG_VECT, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_DEBUG, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &UAS::ignoreMessage);
+    setMessageHandler(MAVLINK_MSG_ID_NAMED_VALUE_INT, &UAS::ignoreMessage);
+}
+
+void UAS::handleHeartbeat(const mavlink_message_t& message)
+{
+    if (isFromOtherComponent(message))
+    {
+        return;
+    }
+    lastHeartbeat = QGC::groundTimeUsecs();
+    emit heartbeat(this);
+    mavlink_heartbeat_t state;
+    mavlink_msg_heartbeat_decode(&message, &state);
+
+    // Send the base_mode and system_status values to the plotter. This uses the ground time
+    // so the Ground Time checkbox must be ticked for these values to display
+    quint64 time = getUnixTime();
+    QGCSampleBlock samples;
+    samples.append(QGCSample(sampleChannels[HEARTBEAT_BASE_MODE], state.base_mode, time));
+    samples.append(QGCSample(sampleChannels[HEARTBEAT_SYSTEM_STATUS], state.system_status, time));
+    emit samplesReady(samples);
+
+    // Set new type if it has changed
+    if (this->type != state.type)
+    {
+        this->type = state.type;
+        if (airframe == 0)
         {
-            if (multiComponentSourceDetected && wrongComponent)
+            switch (type)
             {
+            case MAV_TYPE_FIXED_WING:
+                setAirframe(UASInterface::QGC_AIRFRAME_EASYSTAR);
+                break;
+            case MAV_TYPE_QUADROTOR:
+                setAirframe(UASInterface::QGC_AIRFRAME_CHEETAH);
+                break;
+            case MAV_TYPE_HEXAROTOR:
+                setAirframe(UASInterface::QGC_AIRFRAME_HEXCOPTER);
+                break;
+            default:
+                // Do nothing
                 break;
             }
-            lastHeartbeat = QGC::groundTimeUsecs();
-            emit heartbeat(this);
-            mavlink_heartbeat_t state;
-            mavlink_msg_heartbeat_decode(&message, &state);
-			
-			// Send the base_mode and system_status values to the plotter. This uses the ground time
-			// so the Ground Time checkbox must be ticked for these values to display
-            quint64 time = getUnixTime();
-			QString name = QString("M%1:HEARTBEAT.%2").arg(message.sysid);
-			emit valueChanged(uasId, name.arg("base_mode"), "none", state.base_mode, time);
-			emit valueChanged(uasId, name.arg("system_status"), "none", state.system_status, time);
-			
-            // Set new type if it has changed
-            if (this->type != state.type)
-            {
-                this->type = state.type;
-                if (airframe == 0)
-                {
-                    switch (type)
-                    {
-                    case MAV_TYPE_FIXED_WING:
-                        setAirframe(UASInterface::QGC_AIRFRAME_EASYSTAR);
-                        break;
-                    case MAV_TYPE_QUADROTOR:
-                        setAirframe(UASInterface::QGC_AIRFRAME_CHEETAH);
-                        break;
-                    case MAV_TYPE_HEXAROTOR:
-                        setAirframe(UASInterface::QGC_AIRFRAME_HEXCOPTER);
-                        break;
-                    default:
-                        // Do nothing
-                        break;
-                    }
-                }
-                this->autopilot = state.autopilot;
-                emit systemTypeSet(this, type);
-            }
+        }
+        this->autopilot = state.autopilot;
+        emit systemTypeSet(this, type);
+    }
 
-            bool currentlyArmed = state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
+    bool currentlyArmed = state.base_mode & MAV_MODE_FLAG_DECODE_POSITION_SAFETY;
 
-            if (systemIsArmed != currentlyArmed)
-            {
-                systemIsArmed = currentlyArmed;
-                emit armingChanged(systemIsArmed);
-                if (systemIsArmed)
-                {
-                    emit armed();
-                }
-                else
-                {
-                    emit disarmed();
-                }
-            }
+    if (systemIsArmed != currentlyArmed)
+    {
+        systemIsArmed = currentlyArmed;
+        emit armingChanged(systemIsArmed);
+        if (systemIsArmed)
+        {
+            emit armed();
+        }
+        else
+        {
+            emit disarmed();
+        }
+    }
 
-            QString audiostring = "System " + getUASName();
-            QString stateAudio = "";
-            QString modeAudio = "";
-            QString navModeAudio = "";
-            bool statechanged = false;
-            bool modechanged = false;
+    QString stateAudio;
+    QString modeAudio;
+    QString navModeAudio;
+    bool statechanged = false;
+    bool modechanged = false;
 
 
-            if (state.system_status != this->status)
-            {
-                statechanged = true;
-                this->status = state.system_status;
-                getStatusForCode((int)state.system_status, uasState, stateDescription);
-                emit statusChanged(this, uasState, stateDescription);
-                emit statusChanged(this->status);
+    if (state.system_status != this->status)
+    {
+        statechanged = true;
+        this->status = state.system_status;
+        QString uasState;
+        QString stateDescription;
+        getStatusForCode((int)state.system_status, uasState, stateDescription);
+        emit statusChanged(this, uasState, stateDescription);
+        emit statusChanged(this->status);
 
-                shortStateText = uasState;
+        shortStateText = uasState;
 
-                stateAudio = tr(" changed status to ") + uasState;
-            }
+        stateAudio = tr(" changed status to ") + uasState;
+    }
 
-            if (this->mode != static_cast<int>(state.base_mode))
-            {
-                modechanged = true;
-                this->mode = static_cast<int>(state.base_mode);
-                shortModeText = getShortModeTextFor(this->mode);
+    if (this->mode != static_cast<int>(state.base_mode))
+    {
+        modechanged = true;
+        this->mode = static_cast<int>(state.base_mode);
+        shortModeText = getShortModeTextFor(this->mode);
 
-                emit modeChanged(this->getUASID(), shortModeText, "");
+        emit modeChanged(this->getUASID(), shortModeText, "");
 
-                modeAudio = " is now in " + shortModeText;
-            }
+        modeAudio = " is now in " + shortModeText;
+    }
 
-            if (navMode != state.custom_mode)
-            {
-                emit navModeChanged(uasId, state.custom_mode, getNavModeText(state.custom_mode));
-                navMode = state.custom_mode;
-                navModeAudio = tr(" changed nav mode to ") + tr("FIXME");
-            }
+    if (navMode != state.custom_mode)
+    {
+        emit navModeChanged(uasId, state.custom_mode, getNavModeText(state.custom_mode));
+        navMode = state.custom_mode;
+        navModeAudio = tr(" changed nav mode to ") + tr("FIXME");
+    }
 
-            // AUDIO
-            if (modechanged && statechanged)
-            {
-                // Output both messages
-                audiostring += modeAudio + " and " + stateAudio;
-            }
-            else if (modechanged || statechanged)
-            {
-                // Output the one message
-                audiostring += modeAudio + stateAudio + navModeAudio;
-            }
+    telemetry.heartbeatTime = lastHeartbeat;
+    telemetry.heartbeatGeneration++;
+    telemetry.mode = this->mode;
+    telemetry.navMode = navMode;
+    telemetry.status = this->status;
+    telemetry.armed = systemIsArmed;
+    telemetryChanged = true;
 
-            if ((int)state.system_status == (int)MAV_STATE_CRITICAL || state.system_status == (int)MAV_STATE_EMERGENCY)
-            {
-                GAudioOutput::instance()->startEmergency();
-            }
-            else if (modechanged || statechanged)
-            {
-                GAudioOutput::instance()->stopEmergency();
-                GAudioOutput::instance()->say(audiostring.toLower());
-            }
-        }
+    // AUDIO, only assembled if there is something to say
+    QString audiostring;
+    if (modechanged && statechanged)
+    {
+        // Output both messages
+        audiostring = "System " + getUASName() + modeAudio + " and " + stateAudio;
+    }
+    else if (modechanged || statechanged)
+    {
+        // Output the one message
+        audiostring = "System " + getUASName() + modeAudio + stateAudio + navModeAudio;
+    }
 
-            break;
-        case MAVLINK_MSG_ID_SYS_STATUS:
-        {
-            if (multiComponentSourceDetected && wrongComponent)
-            {
-                break;
-            }
-            mavlink_sys_status_t state;
-            mavlink_msg_sys_status_decode(&message, &state);
-
-			// Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
-            quint64 time = getUnixTime();
-			QString name = QString("M%1:SYS_STATUS.%2").arg(message.sysid);
-			emit valueChanged(uasId, name.arg("sensors_enabled"), "bits", state.onboard_control_sensors_enabled, time);
-			emit valueChanged(uasId, name.arg("sensors_health"), "bits", state.onboard_control_sensors_health, time);
-			emit valueChanged(uasId, name.arg("errors_comm"), "-", state.errors_comm, time);
-			emit valueChanged(uasId, name.arg("errors_count1"), "-", state.errors_count1, time);
-			emit valueChanged(uasId, name.arg("errors_count2"), "-", state.errors_count2, time);
-			emit valueChanged(uasId, name.arg("errors_count3"), "-", state.errors_count3, time);
-			emit valueChanged(uasId, name.arg("errors_count4"), "-", state.errors_count4, time);
-
-			// Process CPU load.
-            emit loadChanged(this,state.load/10.0f);
-			emit valueChanged(uasId, name.arg("load"), "%", state.load/10.0f, time);
-
-			// Battery charge/time remaining/voltage calculations
-            currentVoltage = state.voltage_battery/1000.0f;
-            lpVoltage = filterVoltage(currentVoltage);
-
-            if (startVoltage == 0) startVoltage = currentVoltage;
-            timeRemaining = calculateTimeRemaining();
-            if (!batteryRemainingEstimateEnabled && chargeLevel != -1)
-            {
-                chargeLevel = state.battery_remaining;
-            }
-            emit batteryChanged(this, lpVoltage, getChargeLevel(), timeRemaining);
-			emit valueChanged(uasId, name.arg("battery_remaining"), "%", getChargeLevel(), time);
-            emit voltageChanged(message.sysid, currentVoltage);
-			emit valueChanged(uasId, name.arg("battery_voltage"), "V", currentVoltage, time);
-
-			// And if the battery current draw is measured, log that also.
-			if (state.current_battery != -1)
-			{
-				emit valueChanged(uasId, name.arg("battery_current"), "A", ((double)state.current_battery) / 100.0f, time);
-			}
-
-            // LOW BATTERY ALARM
-            if (lpVoltage < warnVoltage)
-            {
-                startLowBattAlarm();
-            }
-            else
-            {
-                stopLowBattAlarm();
-            }
+    if ((int)state.system_status == (int)MAV_STATE_CRITICAL || state.system_status == (int)MAV_STATE_EMERGENCY)
+    {
+        GAudioOutput::instance()->startEmergency();
+    }
+    else if (modechanged || statechanged)
+    {
+        GAudioOutput::instance()->stopEmergency();
+        GAudioOutput::instance()->say(audiostring.toLower());
+    }
+}
 
-			// Trigger drop rate updates as needed. Here we convert the incoming
-			// drop_rate_comm value from 1/100 of a percent in a uint16 to a true
-			// percentage as a float. We also cap the incoming value at 100% as defined
-			// by the MAVLink specifications.
-			if (state.drop_rate_comm > 10000)
-			{
-				state.drop_rate_comm = 10000;
-			}
-			emit dropRateChanged(this->getUASID(), state.drop_rate_comm/100.0f);
-			emit valueChanged(uasId, name.arg("drop_rate_comm"), "%", state.drop_rate_comm/100.0f, time);
-		}
-            break;
-        case MAVLINK_MSG_ID_ATTITUDE:
-        {
-            if (wrongComponent) break;
-
-            mavlink_attitude_t attitude;
-            mavlink_msg_attitude_decode(&message, &attitude);
-            quint64 time = getUnixReferenceTime(attitude.time_boot_ms);
-            lastAttitude = time;
-            roll = QGC::limitAngleToPMPIf(attitude.roll);
-            pitch = QGC::limitAngleToPMPIf(attitude.pitch);
-            yaw = QGC::limitAngleToPMPIf(attitude.yaw);
-
-            //                // Emit in angles
-
-            //                // Convert yaw angle to compass value
-            //                // in 0 - 360 deg range
-            //                float compass = (yaw/M_PI)*180.0+360.0f;
-            //                if (compass > -10000 && compass < 10000)
-            //                {
-            //                    while (compass > 360.0f) {
-            //                        compass -= 360.0f;
-            //                    }
-            //                }
-            //                else
-            //                {
-            //                    // Set to 0, since it is an invalid value
-            //                    compass = 0.0f;
-            //                }
-
-            attitudeKnown = true;
-            emit attitudeChanged(this, roll, pitch, yaw, time);
-            emit attitudeChanged(this, message.compid, roll, pitch, yaw, time);
-            emit attitudeSpeedChanged(uasId, attitude.rollspeed, attitude.pitchspeed, attitude.yawspeed, time);
-        }
-            break;
-        case MAVLINK_MSG_ID_HIL_CONTROLS:
-        {
-            mavlink_hil_controls_t hil;
-            mavlink_msg_hil_controls_decode(&message, &hil);
-            emit hilControlsChanged(hil.time_usec, hil.roll_ailerons, hil.pitch_elevator, hil.yaw_rudder, hil.throttle, hil.mode, hil.nav_mode);
-        }
-            break;
-        case MAVLINK_MSG_ID_VFR_HUD:
-        {
-            mavlink_vfr_hud_t hud;
-            mavlink_msg_vfr_hud_decode(&message, &hud);
-            quint64 time = getUnixTime();
-            // Display updated values
-            emit thrustChanged(this, hud.throttle/100.0);
+void UAS::handleSysStatus(const mavlink_message_t& message)
+{
+    if (isFromOtherComponent(message))
+    {
+        return;
+    }
+    mavlink_sys_status_t state;
+    mavlink_msg_sys_status_decode(&message, &state);
 
-            if (!attitudeKnown)
-            {
-                yaw = QGC::limitAngleToPMPId((((double)hud.heading-180.0)/360.0)*M_PI);
-                emit attitudeChanged(this, roll, pitch, yaw, time);
-            }
+    // Prepare for sending data to the realtime plotter, which is every field excluding onboard_control_sensors_present.
+    quint64 time = getUnixTime();
+    QGCSampleBlock samples;
+    samples.reserve(SAMPLE_CHANNEL_COUNT);
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_SENSORS_ENABLED], state.onboard_control_sensors_enabled, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_SENSORS_HEALTH], state.onboard_control_sensors_health, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_ERRORS_COMM], state.errors_comm, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_ERRORS_COUNT1], state.errors_count1, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_ERRORS_COUNT2], state.errors_count2, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_ERRORS_COUNT3], state.errors_count3, time));
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_ERRORS_COUNT4], state.errors_count4, time));
 
-            emit altitudeChanged(uasId, hud.alt);
-            emit speedChanged(this, hud.airspeed, 0.0f, hud.climb, time);
-        }
-            break;
-        case MAVLINK_MSG_ID_LOCAL_POSITION_NED:
-            //std::cerr << std::endl;
-            //std::cerr << "Decoded attitude message:" << " roll: " << std::dec << mavlink_msg_attitude_get_roll(message.payload) << " pitch: " << mavlink_msg_attitude_get_pitch(message.payload) << " yaw: " << mavlink_msg_attitude_get_yaw(message.payload) << std::endl;
-        {
-            mavlink_local_position_ned_t pos;
-            mavlink_msg_local_position_ned_decode(&message, &pos);
-            quint64 time = getUnixTime(pos.time_boot_ms);
+    // Process CPU load.
+    emit loadChanged(this,state.load/10.0f);
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_LOAD], state.load/10.0, time));
 
-            // Emit position always with component ID
-            emit localPositionChanged(this, message.compid, pos.x, pos.y, pos.z, time);
+    // Battery charge/time remaining/voltage calculations
+    currentVoltage = state.voltage_battery/1000.0f;
+    lpVoltage = filterVoltage(currentVoltage);
 
-            if (!wrongComponent)
-            {
+    if (startVoltage == 0) startVoltage = currentVoltage;
+    timeRemaining = calculateTimeRemaining();
+    if (!batteryRemainingEstimateEnabled && chargeLevel != -1)
+    {
+        chargeLevel = state.battery_remaining;
+    }
+    emit batteryChanged(this, lpVoltage, getChargeLevel(), timeRemaining);
+    telemetry.batteryTime = time;
+    telemetry.batteryGeneration++;
+    telemetry.batteryVoltage = lpVoltage;
+    telemetry.chargeLevel = getChargeLevel();
+    telemetry.timeRemaining = timeRemaining;
+    telemetryChanged = true;
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_BATTERY_REMAINING], static_cast<double>(getChargeLevel()), time));
+    emit voltageChanged(message.sysid, currentVoltage);
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_BATTERY_VOLTAGE], currentVoltage, time));
 
-                localX = pos.x;
-                localY = pos.y;
-                localZ = pos.z;
+    // And if the battery current draw is measured, log that also.
+    if (state.current_battery != -1)
+    {
+        samples.append(QGCSample(sampleChannels[SYS_STATUS_BATTERY_CURRENT], ((double)state.current_battery) / 100.0, time));
+    }
 
-                // Emit
+    // LOW BATTERY ALARM
+    if (lpVoltage < warnVoltage)
+    {
+        startLowBattAlarm();
+    }
+    else
+    {
+        stopLowBattAlarm();
+    }
 
-                emit localPositionChanged(this, pos.x, pos.y, pos.z, time);
-                emit speedChanged(this, pos.vx, pos.vy, pos.vz, time);
+    // Trigger drop rate updates as needed. Here we convert the incoming
+    // drop_rate_comm value from 1/100 of a percent in a uint16 to a true
+    // percentage as a float. We also cap the incoming value at 100% as defined
+    // by the MAVLink specifications.
+    if (state.drop_rate_comm > 10000)
+    {
+        state.drop_rate_comm = 10000;
+    }
+    emit dropRateChanged(this->getUASID(), state.drop_rate_comm/100.0f);
+    samples.append(QGCSample(sampleChannels[SYS_STATUS_DROP_RATE_COMM], state.drop_rate_comm/100.0, time));
+    emit samplesReady(samples);
+}
 
-                // Set internal state
-                if (!positionLock) {
-                    // If position was not locked before, notify positive
-                    GAudioOutput::instance()->notifyPositive();
-                }
-                positionLock = true;
-                isLocalPositionKnown = true;
-            }
+void UAS::handleAttitude(const mavlink_message_t& message)
+{
+    if (isFromOtherComponent(message)) return;
+
+    mavlink_attitude_t attitude;
+    mavlink_msg_attitude_decode(&message, &attitude);
+    quint64 time = getUnixReferenceTime(attitude.time_boot_ms);
+    lastAttitude = time;
+    roll = QGC::limitAngleToPMPIf(attitude.roll);
+    pitch = QGC::limitAngleToPMPIf(attitude.pitch);
+    yaw = QGC::limitAngleToPMPIf(attitude.yaw);
+
+    //                // Emit in angles
+
+    //                // Convert yaw angle to compass value
+    //                // in 0 - 360 deg range
+    //                float compass = (yaw/M_PI)*180.0+360.0f;
+    //                if (compass > -10000 && compass < 10000)
+    //                {
+    //                    while (compass > 360.0f) {
+    //                        compass -= 360.0f;
+    //                    }
+    //                }
+    //                else
+    //                {
+    //                    // Set to 0, since it is an invalid value
+    //                    compass = 0.0f;
+    //                }
+
+    attitudeKnown = true;
+    telemetry.attitudeTime = time;
+    telemetry.attitudeGeneration++;
+    telemetry.roll = roll;
+    telemetry.pitch = pitch;
+    telemetry.yaw = yaw;
+    telemetry.rollSpeed = attitude.rollspeed;
+    telemetry.pitchSpeed = attitude.pitchspeed;
+    telemetry.yawSpeed = attitude.yawspeed;
+    telemetryChanged = true;
+    emit attitudeChanged(this, roll, pitch, yaw, time);
+    emit attitudeChanged(this, message.compid, roll, pitch, yaw, time);
+    emit attitudeSpeedChanged(uasId, attitude.rollspeed, attitude.pitchspeed, attitude.yawspeed, time);
+}
+
+void UAS::handleHilControls(const mavlink_message_t& message)
+{
+    mavlink_hil_controls_t hil;
+    mavlink_msg_hil_controls_decode(&message, &hil);
+    emit hilControlsChanged(hil.time_usec, hil.roll_ailerons, hil.pitch_elevator, hil.yaw_rudder, hil.throttle, hil.mode, hil.nav_mode);
+}
+
+void UAS::handleVfrHud(const mavlink_message_t& message)
+{
+    mavlink_vfr_hud_t hud;
+    mavlink_msg_vfr_hud_decode(&message, &hud);
+    quint64 time = getUnixTime();
+    // Display updated values
+    emit thrustChanged(this, hud.throttle/100.0);
+    telemetry.thrust = hud.throttle/100.0;
+
+    if (!attitudeKnown)
+    {
+        yaw = QGC::limitAngleToPMPId((((double)hud.heading-180.0)/360.0)*M_PI);
+        telemetry.attitudeTime = time;
+        telemetry.attitudeGeneration++;
+        telemetry.yaw = yaw;
+        emit attitudeChanged(this, roll, pitch, yaw, time);
+    }
+
+    emit altitudeChanged(uasId, hud.alt);
+    emit speedChanged(this, hud.airspeed, 0.0f, hud.climb, time);
+    telemetry.speedTime = time;
+    telemetry.speedGeneration++;
+    telemetry.speedX = hud.airspeed;
+    telemetry.speedY = 0.0;
+    telemetry.speedZ = hud.climb;
+    telemetryChanged = true;
+}
+
+void UAS::handleLocalPositionNed(const mavlink_message_t& message)
+{
+    //std::cerr << std::endl;
+    //std::cerr << "Decoded attitude message:" << " roll: " << std::dec << mavlink_msg_attitude_get_roll(message.payload) << " pitch: " << mavlink_msg_attitude_get_pitch(message.payload) << " yaw: " << mavlink_msg_attitude_get_yaw(message.payload) << std::endl;
+    mavlink_local_position_ned_t pos;
+    mavlink_msg_local_position_ned_decode(&message, &pos);
+    quint64 time = getUnixTime(pos.time_boot_ms);
+
+    // Emit position always with component ID
+    emit localPositionChanged(this, message.compid, pos.x, pos.y, pos.z, time);
+
+    if (!isFromOtherComponent(message))
+    {
+
+        localX = pos.x;
+        localY = pos.y;
+        localZ = pos.z;
+
+        // Emit
+
+        emit localPositionChanged(this, pos.x, pos.y, pos.z, time);
+        emit speedChanged(this, pos.vx, pos.vy, pos.vz, time);
+        telemetry.localPositionTime = time;
+        telemetry.localPositionGeneration++;
+        telemetry.localX = localX;
+        telemetry.localY = localY;
+        telemetry.localZ = localZ;
+        telemetry.speedTime = time;
+        telemetry.speedGeneration++;
+        telemetry.speedX = pos.vx;
+        telemetry.speedY = pos.vy;
+        telemetry.speedZ = pos.vz;
+        telemetryChanged = true;
+
+        // Set internal state
+        if (!positionLock) {
+            // If position was not locked before, notify positive
+            GAudioOutput::instance()->notifyPositive();
         }
-            break;
-        case MAVLINK_MSG_ID_GLOBAL_VISION_POSITION_ESTIMATE:
+        positionLock = true;
+        isLocalPositionKnown = true;
+    }
+}
+
+void UAS::handleGlobalVisionPositionEstimate(const mavlink_message_t& message)
+{
+    mavlink_global_vision_position_estimate_t pos;
+    mavlink_msg_global_vision_position_estimate_decode(&message, &pos);
+    quint64 time = getUnixTime(pos.usec);
+    emit localPositionChanged(this, message.compid, pos.x, pos.y, pos.z, time);
+    emit attitudeChanged(this, message.compid, pos.roll, pos.pitch, pos.yaw, time);
+}
+
+void UAS::handleGlobalPositionInt(const mavlink_message_t& message)
+{
+    //std::cerr << std::endl;
+    //std::cerr << "Decoded attitude message:" << " roll: " << std::dec << mavlink_msg_attitude_get_roll(message.payload) << " pitch: " << mavlink_msg_attitude_get_pitch(message.payload) << " yaw: " << mavlink_msg_attitude_get_yaw(message.payload) << std::endl;
+    mavlink_global_position_int_t pos;
+    mavlink_msg_global_position_int_decode(&message, &pos);
+    quint64 time = getUnixTime();
+    latitude = pos.lat/(double)1E7;
+    longitude = pos.lon/(double)1E7;
+    altitude = pos.alt/1000.0;
+    speedX = pos.vx/100.0;
+    speedY = pos.vy/100.0;
+    speedZ = pos.vz/100.0;
+    emit globalPositionChanged(this, latitude, longitude, altitude, time);
+    emit speedChanged(this, speedX, speedY, speedZ, time);
+    telemetry.globalPositionTime = time;
+    telemetry.globalPositionGeneration++;
+    telemetry.latitude = latitude;
+    telemetry.longitude = longitude;
+    telemetry.altitude = altitude;
+    telemetry.speedTime = time;
+    telemetry.speedGeneration++;
+    telemetry.speedX = speedX;
+    telemetry.speedY = speedY;
+    telemetry.speedZ = speedZ;
+    telemetryChanged = true;
+    // Set internal state
+    if (!positionLock)
+    {
+        // If position was not locked before, notify positive
+        GAudioOutput::instance()->notifyPositive();
+    }
+    positionLock = true;
+    isGlobalPositionKnown = true;
+    //TODO fix this hack for forwarding of global position for patch antenna tracking
+    forwardMessage(message);
+}
+
+void UAS::handleGpsRawInt(const mavlink_message_t& message)
+{
+    mavlink_gps_raw_int_t pos;
+    mavlink_msg_gps_raw_int_decode(&message, &pos);
+
+    // SANITY CHECK
+    // only accept values in a realistic range
+    // quint64 time = getUnixTime(pos.time_usec);
+    quint64 time = getUnixTime(pos.time_usec);
+
+    if (pos.fix_type > 2)
+    {
+        emit globalPositionChanged(this, pos.lat/(double)1E7, pos.lon/(double)1E7, pos.alt/1000.0, time);
+        latitude = pos.lat/(double)1E7;
+        longitude = pos.lon/(double)1E7;
+        altitude = pos.alt/1000.0;
+        positionLock = true;
+        isGlobalPositionKnown = true;
+        telemetry.globalPositionTime = time;
+        telemetry.globalPositionGeneration++;
+        telemetry.latitude = latitude;
+        telemetry.longitude = longitude;
+        telemetry.altitude = altitude;
+        telemetryChanged = true;
+
+        // Check for NaN
+        int alt = pos.alt;
+        if (!isnan(alt) && !isinf(alt))
         {
-            mavlink_global_vision_position_estimate_t pos;
-            mavlink_msg_global_vision_position_estimate_decode(&message, &pos);
-            quint64 time = getUnixTime(pos.usec);
-            emit localPositionChanged(this, message.compid, pos.x, pos.y, pos.z, time);
-            emit attitudeChanged(this, message.compid, pos.roll, pos.pitch, pos.yaw, time);
+            alt = 0;
+            //emit textMessageReceived(uasId, message.compid, 255, "GCS ERROR: RECEIVED NaN or Inf FOR ALTITUDE");
         }
-            break;
-        case MAVLINK_MSG_ID_GLOBAL_POSITION_INT:
-            //std::cerr << std::endl;
-            //std::cerr << "Decoded attitude message:" << " roll: " << std::dec << mavlink_msg_attitude_get_roll(message.payload) << " pitch: " << mavlink_msg_attitude_get_pitch(message.payload) << " yaw: " << mavlink_msg_attitude_get_yaw(message.payload) << std::endl;
+        // FIXME REMOVE LATER emit valueChanged(uasId, "altitude", "m", pos.alt/(double)1E3, time);
+        // Smaller than threshold and not NaN
+
+        float vel = pos.vel/100.0f;
+
+        if (vel < 1000000 && !isnan(vel) && !isinf(vel))
         {
-            mavlink_global_position_int_t pos;
-            mavlink_msg_global_position_int_decode(&message, &pos);
-            quint64 time = getUnixTime();
-            latitude = pos.lat/(double)1E7;
-            longitude = pos.lon/(double)1E7;
-            altitude = pos.alt/1000.0;
-            speedX = pos.vx/100.0;
-            speedY = pos.vy/100.0;
-            speedZ = pos.vz/100.0;
-            emit globalPositionChanged(this, latitude, longitude, altitude, time);
-            emit speedChanged(this, speedX, speedY, speedZ, time);
-            // Set internal state
-            if (!positionLock)
-            {
-                // If position was not locked before, notify positive
-                GAudioOutput::instance()->notifyPositive();
-            }
-            positionLock = true;
-            isGlobalPositionKnown = true;
-            //TODO fix this hack for forwarding of global position for patch antenna tracking
-            forwardMessage(message);
+            // FIXME REMOVE LATER emit valueChanged(uasId, "speed", "m/s", vel, time);
+            //qDebug() << "GOT GPS RAW";
+            // emit speedChanged(this, (double)pos.v, 0.0, 0.0, time);
         }
-            break;
-        case MAVLINK_MSG_ID_GPS_RAW_INT:
+        else
         {
-            mavlink_gps_raw_int_t pos;
-            mavlink_msg_gps_raw_int_decode(&message, &pos);
+            emit textMessageReceived(uasId, message.compid, 255, QString("GCS ERROR: RECEIVED INVALID SPEED OF %1 m/s").arg(vel));
+        }
+    }
+}
 
-            // SANITY CHECK
-            // only accept values in a realistic range
-            // quint64 time = getUnixTime(pos.time_usec);
-            quint64 time = getUnixTime(pos.time_usec);
+void UAS::handleGpsStatus(const mavlink_message_t& message)
+{
+    mavlink_gps_status_t pos;
+    mavlink_msg_gps_status_decode(&message, &pos);
+    for(int i = 0; i < (int)pos.satellites_visible; i++)
+    {
+        emit gpsSatelliteStatusChanged(uasId, (unsigned char)pos.satellite_prn[i], (unsigned char)pos.satellite_elevation[i], (unsigned char)pos.satellite_azimuth[i], (unsigned char)pos.satellite_snr[i], static_cast<bool>(pos.satellite_used[i]));
+    }
+}
 
-            if (pos.fix_type > 2)
-            {
-                emit globalPositionChanged(this, pos.lat/(double)1E7, pos.lon/(double)1E7, pos.alt/1000.0, time);
-                latitude = pos.lat/(double)1E7;
-                longitude = pos.lon/(double)1E7;
-                altitude = pos.alt/1000.0;
-                positionLock = true;
-                isGlobalPositionKnown = true;
-
-                // Check for NaN
-                int alt = pos.alt;
-                if (!isnan(alt) && !isinf(alt))
-                {
-                    alt = 0;
-                    //emit textMessageReceived(uasId, message.compid, 255, "GCS ERROR: RECEIVED NaN or Inf FOR ALTITUDE");
-                }
-                // FIXME REMOVE LATER emit valueChanged(uasId, "altitude", "m", pos.alt/(double)1E3, time);
-                // Smaller than threshold and not NaN
+void UAS::handleGpsGlobalOrigin(const mavlink_message_t& message)
+{
+    mavlink_gps_global_origin_t pos;
+    mavlink_msg_gps_global_origin_decode(&message, &pos);
+    emit homePositionChanged(uasId, pos.latitude, pos.longitude, pos.altitude);
+}
 
-                float vel = pos.vel/100.0f;
+void UAS::handleRcChannelsRaw(const mavlink_message_t& message)
+{
+    mavlink_rc_channels_raw_t channels;
+    mavlink_msg_rc_channels_raw_decode(&message, &channels);
+    emit remoteControlRSSIChanged(channels.rssi/255.0f);
+    emit remoteControlChannelRawChanged(0, channels.chan1_raw);
+    emit remoteControlChannelRawChanged(1, channels.chan2_raw);
+    emit remoteControlChannelRawChanged(2, channels.chan3_raw);
+    emit remoteControlChannelRawChanged(3, channels.chan4_raw);
+    emit remoteControlChannelRawChanged(4, channels.chan5_raw);
+    emit remoteControlChannelRawChanged(5, channels.chan6_raw);
+    emit remoteControlChannelRawChanged(6, channels.chan7_raw);
+    emit remoteControlChannelRawChanged(7, channels.chan8_raw);
+}
 
-                if (vel < 1000000 && !isnan(vel) && !isinf(vel))
-                {
-                    // FIXME REMOVE LATER emit valueChanged(uasId, "speed", "m/s", vel, time);
-                    //qDebug() << "GOT GPS RAW";
-                    // emit speedChanged(this, (double)pos.v, 0.0, 0.0, time);
-                }
-                else
-                {
-                    emit textMessageReceived(uasId, message.compid, 255, QString("GCS ERROR: RECEIVED INVALID SPEED OF %1 m/s").arg(vel));
-                }
-            }
-        }
-            break;
-        case MAVLINK_MSG_ID_GPS_STATUS:
-        {
-            mavlink_gps_status_t pos;
-            mavlink_msg_gps_status_decode(&message, &pos);
-            for(int i = 0; i < (int)pos.satellites_visible; i++)
-            {
-                emit gpsSatelliteStatusChanged(uasId, (unsigned char)pos.satellite_prn[i], (unsigned char)pos.satellite_elevation[i], (unsigned char)pos.satellite_azimuth[i], (unsigned char)pos.satellite_snr[i], static_cast<bool>(pos.satellite_used[i]));
-            }
-        }
-            break;
-        case MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN:
-        {
-            mavlink_gps_global_origin_t pos;
-            mavlink_msg_gps_global_origin_decode(&message, &pos);
-            emit homePositionChanged(uasId, pos.latitude, pos.longitude, pos.altitude);
-        }
-            break;
-        case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-        {
-            mavlink_rc_channels_raw_t channels;
-            mavlink_msg_rc_channels_raw_decode(&message, &channels);
-            emit remoteControlRSSIChanged(channels.rssi/255.0f);
-            emit remoteControlChannelRawChanged(0, channels.chan1_raw);
-            emit remoteControlChannelRawChanged(1, channels.chan2_raw);
-            emit remoteControlChannelRawChanged(2, channels.chan3_raw);
-            emit remoteControlChannelRawChanged(3, channels.chan4_raw);
-            emit remoteControlChannelRawChanged(4, channels.chan5_raw);
-            emit remoteControlChannelRawChanged(5, channels.chan6_raw);
-            emit remoteControlChannelRawChanged(6, channels.chan7_raw);
-            emit remoteControlChannelRawChanged(7, channels.chan8_raw);
-        }
-            break;
-        case MAVLINK_MSG_ID_RC_CHANNELS_SCALED:
-        {
-            mavlink_rc_channels_scaled_t channels;
-            mavlink_msg_rc_channels_scaled_decode(&message, &channels);
-            emit remoteControlRSSIChanged(channels.rssi/255.0f);
-            emit remoteControlChannelScaledChanged(0, channels.chan1_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(1, channels.chan2_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(2, channels.chan3_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(3, channels.chan4_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(4, channels.chan5_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(5, channels.chan6_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(6, channels.chan7_scaled/10000.0f);
-            emit remoteControlChannelScaledChanged(7, channels.chan8_scaled/10000.0f);
-        }
-            break;
-        case MAVLINK_MSG_ID_PARAM_VALUE:
-        {
-            mavlink_param_value_t value;
-            mavlink_msg_param_value_decode(&message, &value);
-            QByteArray bytes(value.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
-            QString parameterName = QString(bytes);
-            int component = message.compid;
-            mavlink_param_union_t val;
-            val.param_float = value.param_value;
-            val.type = value.param_type;
-
-            // Insert component if necessary
-            if (!parameters.contains(component))
-            {
-                parameters.insert(component, new QMap<QString, QVariant>());
-            }
+void UAS::handleRcChannelsScaled(const mavlink_message_t& message)
+{
+    mavlink_rc_channels_scaled_t channels;
+    mavlink_msg_rc_channels_scaled_decode(&message, &channels);
+    emit remoteControlRSSIChanged(channels.rssi/255.0f);
+    emit remoteControlChannelScaledChanged(0, channels.chan1_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(1, channels.chan2_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(2, channels.chan3_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(3, channels.chan4_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(4, channels.chan5_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(5, channels.chan6_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(6, channels.chan7_scaled/10000.0f);
+    emit remoteControlChannelScaledChanged(7, channels.chan8_scaled/10000.0f);
+}
 
-            // Insert parameter into registry
-            if (parameters.value(component)->contains(parameterName)) parameters.value(component)->remove(parameterName);
+void UAS::handleParamValue(const mavlink_message_t& message)
+{
+    mavlink_param_value_t value;
+    mavlink_msg_param_value_decode(&message, &value);
+    QByteArray bytes(value.param_id, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+    QString parameterName = QString(bytes);
+    int component = message.compid;
+    mavlink_param_union_t val;
+    val.param_float = value.param_value;
+    val.type = value.param_type;
 
-            // Insert with correct type
-            switch (value.param_type)
-            {
-            case MAVLINK_TYPE_FLOAT:
-            {
-                // Variant
-                QVariant param(val.param_float);
-                parameters.value(component)->insert(parameterName, param);
-                // Emit change
-                emit parameterChanged(uasId, message.compid, parameterName, param);
-                emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
-                qDebug() << "RECEIVED PARAM:" << param;
-            }
-                break;
-            case MAVLINK_TYPE_UINT32_T:
-            {
-                // Variant
-                QVariant param(val.param_uint32);
-                parameters.value(component)->insert(parameterName, param);
-                // Emit change
-                emit parameterChanged(uasId, message.compid, parameterName, param);
-                emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
-                qDebug() << "RECEIVED PARAM:" << param;
-            }
-                break;
-            case MAVLINK_TYPE_INT32_T:
-            {
-                // Variant
-                QVariant param(val.param_int32);
-                parameters.value(component)->insert(parameterName, param);
-                // Emit change
-                emit parameterChanged(uasId, message.compid, parameterName, param);
-                emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
-                qDebug() << "RECEIVED PARAM:" << param;
-            }
-                break;
-            default:
-                qCritical() << "INVALID DATA TYPE USED AS PARAMETER VALUE: " << value.param_type;
-            }
-        }
-            break;
-        case MAVLINK_MSG_ID_COMMAND_ACK:
-            mavlink_command_ack_t ack;
-            mavlink_msg_command_ack_decode(&message, &ack);
-            if (ack.result == 1)
-            {
-                emit textMessageReceived(uasId, message.compid, 0, tr("SUCCESS: Executed CMD: %1").arg(ack.command));
-            }
-            else
-            {
-                emit textMessageReceived(uasId, message.compid, 0, tr("FAILURE: Rejected CMD: %1").arg(ack.command));
-            }
-            break;
-        case MAVLINK_MSG_ID_ROLL_PITCH_YAW_THRUST_SETPOINT:
-        {
-            mavlink_roll_pitch_yaw_thrust_setpoint_t out;
-            mavlink_msg_roll_pitch_yaw_thrust_setpoint_decode(&message, &out);
-            quint64 time = getUnixTimeFromMs(out.time_boot_ms);
-            emit attitudeThrustSetPointChanged(this, out.roll, out.pitch, out.yaw, out.thrust, time);
-        }
-            break;
-        case MAVLINK_MSG_ID_MISSION_COUNT:
-        {
-            mavlink_mission_count_t wpc;
-            mavlink_msg_mission_count_decode(&message, &wpc);
-            if (wpc.target_system == mavlink->getSystemId())
-            {
-                waypointManager.handleWaypointCount(message.sysid, message.compid, wpc.count);
-            }
-            else
-            {
-                qDebug() << "Got waypoint message, but was not for me";
-            }
-        }
-            break;
+    // Insert component if necessary
+    if (!parameters.contains(component))
+    {
+        parameters.insert(component, new QMap<QString, QVariant>());
+    }
 
-        case MAVLINK_MSG_ID_MISSION_ITEM:
-        {
-            mavlink_mission_item_t wp;
-            mavlink_msg_mission_item_decode(&message, &wp);
-            //qDebug() << "got waypoint (" << wp.seq << ") from ID " << message.sysid << " x=" << wp.x << " y=" << wp.y << " z=" << wp.z;
-            if(wp.target_system == mavlink->getSystemId())
-            {
-                waypointManager.handleWaypoint(message.sysid, message.compid, &wp);
-            }
-            else
-            {
-                qDebug() << "Got waypoint message, but was not for me";
-            }
-        }
-            break;
+    // Insert parameter into registry
+    if (parameters.value(component)->contains(parameterName)) parameters.value(component)->remove(parameterName);
 
-        case MAVLINK_MSG_ID_MISSION_ACK:
-        {
-            mavlink_mission_ack_t wpa;
-            mavlink_msg_mission_ack_decode(&message, &wpa);
-            if(wpa.target_system == mavlink->getSystemId() && wpa.target_component == mavlink->getComponentId())
-            {
-                waypointManager.handleWaypointAck(message.sysid, message.compid, &wpa);
-            }
-        }
-            break;
+    // Insert with correct type
+    switch (value.param_type)
+    {
+    case MAVLINK_TYPE_FLOAT:
+    {
+        // Variant
+        QVariant param(val.param_float);
+        parameters.value(component)->insert(parameterName, param);
+        // Emit change
+        emit parameterChanged(uasId, message.compid, parameterName, param);
+        emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
+        qDebug() << "RECEIVED PARAM:" << param;
+    }
+        break;
+    case MAVLINK_TYPE_UINT32_T:
+    {
+        // Variant
+        QVariant param(val.param_uint32);
+        parameters.value(component)->insert(parameterName, param);
+        // Emit change
+        emit parameterChanged(uasId, message.compid, parameterName, param);
+        emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
+        qDebug() << "RECEIVED PARAM:" << param;
+    }
+        break;
+    case MAVLINK_TYPE_INT32_T:
+    {
+        // Variant
+        QVariant param(val.param_int32);
+        parameters.value(component)->insert(parameterName, param);
+        // Emit change
+        emit parameterChanged(uasId, message.compid, parameterName, param);
+        emit parameterChanged(uasId, message.compid, value.param_count, value.param_index, parameterName, param);
+        qDebug() << "RECEIVED PARAM:" << param;
+    }
+        break;
+    default:
+        qCritical() << "INVALID DATA TYPE USED AS PARAMETER VALUE: " << value.param_type;
+    }
+}
 
-        case MAVLINK_MSG_ID_MISSION_REQUEST:
-        {
-            mavlink_mission_request_t wpr;
-            mavlink_msg_mission_request_decode(&message, &wpr);
-            if(wpr.target_system == mavlink->getSystemId())
-            {
-                waypointManager.handleWaypointRequest(message.sysid, message.compid, &wpr);
-            }
-            else
-            {
-                qDebug() << "Got waypoint message, but was not for me";
-            }
-        }
-            break;
+void UAS::handleCommandAck(const mavlink_message_t& message)
+{
+    mavlink_command_ack_t ack;
+    mavlink_msg_command_ack_decode(&message, &ack);
+    if (ack.result == 1)
+    {
+        emit textMessageReceived(uasId, message.compid, 0, tr("SUCCESS: Executed CMD: %1").arg(ack.command));
+    }
+    else
+    {
+        emit textMessageReceived(uasId, message.compid, 0, tr("FAILURE: Rejected CMD: %1").arg(ack.command));
+    }
+}
 
-        case MAVLINK_MSG_ID_MISSION_ITEM_REACHED:
-        {
-            mavlink_mission_item_reached_t wpr;
-            mavlink_msg_mission_item_reached_decode(&message, &wpr);
-            waypointManager.handleWaypointReached(message.sysid, message.compid, &wpr);
-            QString text = QString("System %1 reached waypoint %2").arg(getUASName()).arg(wpr.seq);
-            GAudioOutput::instance()->say(text);
-            emit textMessageReceived(message.sysid, message.compid, 0, text);
-        }
-            break;
+void UAS::handleRollPitchYawThrustSetpoint(const mavlink_message_t& message)
+{
+    mavlink_roll_pitch_yaw_thrust_setpoint_t out;
+    mavlink_msg_roll_pitch_yaw_thrust_setpoint_decode(&message, &out);
+    quint64 time = getUnixTimeFromMs(out.time_boot_ms);
+    emit attitudeThrustSetPointChanged(this, out.roll, out.pitch, out.yaw, out.thrust, time);
+}
 
-        case MAVLINK_MSG_ID_MISSION_CURRENT:
-        {
-            mavlink_mission_current_t wpc;
-            mavlink_msg_mission_current_decode(&message, &wpc);
-            waypointManager.handleWaypointCurrent(message.sysid, message.compid, &wpc);
-        }
-            break;
+void UAS::handleMissionCount(const mavlink_message_t& message)
+{
+    mavlink_mission_count_t wpc;
+    mavlink_msg_mission_count_decode(&message, &wpc);
+    if (wpc.target_system == mavlink->getSystemId())
+    {
+        waypointManager.handleWaypointCount(message.sysid, message.compid, wpc.count);
+    }
+    else
+    {
+        qDebug() << "Got waypoint message, but was not for me";
+    }
+}
 
-        case MAVLINK_MSG_ID_LOCAL_POSITION_SETPOINT:
-        {
-            if (multiComponentSourceDetected && wrongComponent)
-            {
-                break;
-            }
-            mavlink_local_position_setpoint_t p;
-            mavlink_msg_local_position_setpoint_decode(&message, &p);
-            emit positionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw, QGC::groundTimeUsecs());
-        }
-            break;
-        case MAVLINK_MSG_ID_SET_LOCAL_POSITION_SETPOINT:
-        {
-            mavlink_set_local_position_setpoint_t p;
-            mavlink_msg_set_local_position_setpoint_decode(&message, &p);
-            emit userPositionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw);
-        }
-            break;
-        case MAVLINK_MSG_ID_STATUSTEXT:
-        {
-            QByteArray b;
-            b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
-            mavlink_msg_statustext_get_text(&message, b.data());
-            //b.append('\0');
-            QString text = QString(b);
-            int severity = mavlink_msg_statustext_get_severity(&message);
-            //qDebug() << "RECEIVED STATUS:" << text;false
-            //emit statusTextReceived(severity, text);
-            emit textMessageReceived(uasId, message.compid, severity, text);
-        }
-            break;
-#ifdef MAVLINK_ENABLED_PIXHAWK
-        case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
-        {
-            qDebug() << "RECIEVED ACK TO GET IMAGE";
-            mavlink_data_transmission_handshake_t p;
-            mavlink_msg_data_transmission_handshake_decode(&message, &p);
-            imageSize = p.size;
-            imagePackets = p.packets;
-            imagePayload = p.payload;
-            imageQuality = p.jpg_quality;
-            imageType = p.type;
-            imageWidth = p.width;
-            imageHeight = p.height;
-            imageStart = QGC::groundTimeMilliseconds();
-        }
-            break;
+void UAS::handleMissionItem(const mavlink_message_t& message)
+{
+    mavlink_mission_item_t wp;
+    mavlink_msg_mission_item_decode(&message, &wp);
+    //qDebug() << "got waypoint (" << wp.seq << ") from ID " << message.sysid << " x=" << wp.x << " y=" << wp.y << " z=" << wp.z;
+    if(wp.target_system == mavlink->getSystemId())
+    {
+        waypointManager.handleWaypoint(message.sysid, message.compid, &wp);
+    }
+    else
+    {
+        qDebug() << "Got waypoint message, but was not for me";
+    }
+}
 
-        case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
-        {
-            mavlink_encapsulated_data_t img;
-            mavlink_msg_encapsulated_data_decode(&message, &img);
-            int seq = img.seqnr;
-            int pos = seq * imagePayload;
+void UAS::handleMissionAck(const mavlink_message_t& message)
+{
+    mavlink_mission_ack_t wpa;
+    mavlink_msg_mission_ack_decode(&message, &wpa);
+    if(wpa.target_system == mavlink->getSystemId() && wpa.target_component == mavlink->getComponentId())
+    {
+        waypointManager.handleWaypointAck(message.sysid, message.compid, &wpa);
+    }
+}
 
-            // Check if we have a valid transaction
-            if (imagePackets == 0)
-            {
-                // NO VALID TRANSACTION - ABORT
-                // Restart statemachine
-                imagePacketsArrived = 0;
-            }
+void UAS::handleMissionRequest(const mavlink_message_t& message)
+{
+    mavlink_mission_request_t wpr;
+    mavlink_msg_mission_request_decode(&message, &wpr);
+    if(wpr.target_system == mavlink->getSystemId())
+    {
+        waypointManager.handleWaypointRequest(message.sysid, message.compid, &wpr);
+    }
+    else
+    {
+        qDebug() << "Got waypoint message, but was not for me";
+    }
+}
 
-            for (int i = 0; i < imagePayload; ++i)
-            {
-                if (pos <= imageSize) {
-                    imageRecBuffer[pos] = img.data[i];
-                }
-                ++pos;
-            }
+void UAS::handleMissionItemReached(const mavlink_message_t& message)
+{
+    mavlink_mission_item_reached_t wpr;
+    mavlink_msg_mission_item_reached_decode(&message, &wpr);
+    waypointManager.handleWaypointReached(message.sysid, message.compid, &wpr);
+    QString text = QString("System %1 reached waypoint %2").arg(getUASName()).arg(wpr.seq);
+    GAudioOutput::instance()->say(text);
+    emit textMessageReceived(message.sysid, message.compid, 0, text);
+}
 
-            ++imagePacketsArrived;
+void UAS::handleMissionCurrent(const mavlink_message_t& message)
+{
+    mavlink_mission_current_t wpc;
+    mavlink_msg_mission_current_decode(&message, &wpc);
+    waypointManager.handleWaypointCurrent(message.sysid, message.compid, &wpc);
+}
 
-            // emit signal if all packets arrived
-            if ((imagePacketsArrived >= imagePackets))
-            {
-                // Restart statemachine
-                imagePacketsArrived = 0;
-                emit imageReady(this);
-                qDebug() << "imageReady emitted. all packets arrived";
-            }
+void UAS::handleLocalPositionSetpoint(const mavlink_message_t& message)
+{
+    if (isFromOtherComponent(message))
+    {
+        return;
+    }
+    mavlink_local_position_setpoint_t p;
+    mavlink_msg_local_position_setpoint_decode(&message, &p);
+    emit positionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw, QGC::groundTimeUsecs());
+}
+
+void UAS::handleSetLocalPositionSetpoint(const mavlink_message_t& message)
+{
+    mavlink_set_local_position_setpoint_t p;
+    mavlink_msg_set_local_position_setpoint_decode(&message, &p);
+    emit userPositionSetPointsChanged(uasId, p.x, p.y, p.z, p.yaw);
+}
+
+void UAS::handleStatusText(const mavlink_message_t& message)
+{
+    QByteArray b;
+    b.resize(MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN);
+    mavlink_msg_statustext_get_text(&message, b.data());
+    //b.append('\0');
+    QString text = QString(b);
+    int severity = mavlink_msg_statustext_get_severity(&message);
+    //qDebug() << "RECEIVED STATUS:" << text;false
+    //emit statusTextReceived(severity, text);
+    emit textMessageReceived(uasId, message.compid, severity, text);
+}
+
+#ifdef MAVLINK_ENABLED_PIXHAWK
+void UAS::handleDataTransmissionHandshake(const mavlink_message_t& message)
+{
+    qDebug() << "RECIEVED ACK TO GET IMAGE";
+    mavlink_data_transmission_handshake_t p;
+    mavlink_msg_data_transmission_handshake_decode(&message, &p);
+    imageSize = p.size;
+    imagePackets = p.packets;
+    imagePayload = p.payload;
+    imageQuality = p.jpg_quality;
+    imageType = p.type;
+    imageWidth = p.width;
+    imageHeight = p.height;
+    imageStart = QGC::groundTimeMilliseconds();
+}
+
+void UAS::handleEncapsulatedData(const mavlink_message_t& message)
+{
+    mavlink_encapsulated_data_t img;
+    mavlink_msg_encapsulated_data_decode(&message, &img);
+    int seq = img.seqnr;
+    int pos = seq * imagePayload;
+
+    // Check if we have a valid transaction
+    if (imagePackets == 0)
+    {
+        // NO VALID TRANSACTION - ABORT
+        // Restart statemachine
+        imagePacketsArrived = 0;
+    }
+
+    for (int i = 0; i < imagePayload; ++i)
+    {
+        if (pos <= imageSize) {
+            imageRecBuffer[pos] = img.data[i];
         }
-            break;
+        ++pos;
+    }
+
+    ++imagePacketsArrived;
+
+    // emit signal if all packets arrived
+    if ((imagePacketsArrived >= imagePackets))
+    {
+        // Restart statemachine
+        imagePacketsArrived = 0;
+        emit imageReady(this);
+        qDebug() << "imageReady emitted. all packets arrived";
+    }
+}
+
+    //        case MAVLINK_MSG_ID_OBJECT_DETECTION_EVENT:
+    //        {
+    //            mavlink_object_detection_event_t event;
+    //            mavlink_msg_object_detection_event_decode(&message, &event);
+    //            QString str(event.name);
+    //            emit objectDetected(event.time, event.object_id, event.type, str, event.quality, event.bearing, event.distance);
+    //        }
+    //        break;
+    // WILL BE ENABLED ONCE MESSAGE IS IN COMMON MESSAGE SET
+    //        case MAVLINK_MSG_ID_MEMORY_VECT:
+    //        {
+    //            mavlink_memory_vect_t vect;
+    //            mavlink_msg_memory_vect_decode(&message, &vect);
+    //            QString str("mem_%1");
+    //            quint64 time = getUnixTime(0);
+    //            int16_t *mem0 = (int16_t *)&vect.value[0];
+    //            uint16_t *mem1 = (uint16_t *)&vect.value[0];
+    //            int32_t *mem2 = (int32_t *)&vect.value[0];
+    //            // uint32_t *mem3 = (uint32_t *)&vect.value[0]; causes overload problem
+    //            float *mem4 = (float *)&vect.value[0];
+    //            if ( vect.ver == 0) vect.type = 0, vect.ver = 1; else ;
+    //            if ( vect.ver == 1)
+    //            {
+    //                switch (vect.type) {
+    //                default:
+    //                case 0:
+    //                    for (int i = 0; i < 16; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "i16", mem0[i], time);
+    //                    break;
+    //                case 1:
+    //                    for (int i = 0; i < 16; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "ui16", mem1[i], time);
+    //                    break;
+    //                case 2:
+    //                    for (int i = 0; i < 16; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "Q15", (float)mem0[i]/32767.0, time);
+    //                    break;
+    //                case 3:
+    //                    for (int i = 0; i < 16; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "1Q14", (float)mem0[i]/16383.0, time);
+    //                    break;
+    //                case 4:
+    //                    for (int i = 0; i < 8; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "i32", mem2[i], time);
+    //                    break;
+    //                case 5:
+    //                    for (int i = 0; i < 8; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "i32", mem2[i], time);
+    //                    break;
+    //                case 6:
+    //                    for (int i = 0; i < 8; i++)
+    //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "float", mem4[i], time);
+    //                    break;
+    //                }
+    //            }
+    //        }
+    //        break;
+
 #endif
-            //        case MAVLINK_MSG_ID_OBJECT_DETECTION_EVENT:
-            //        {
-            //            mavlink_object_detection_event_t event;
-            //            mavlink_msg_object_detection_event_decode(&message, &event);
-            //            QString str(event.name);
-            //            emit objectDetected(event.time, event.object_id, event.type, str, event.quality, event.bearing, event.distance);
-            //        }
-            //        break;
-            // WILL BE ENABLED ONCE MESSAGE IS IN COMMON MESSAGE SET
-            //        case MAVLINK_MSG_ID_MEMORY_VECT:
-            //        {
-            //            mavlink_memory_vect_t vect;
-            //            mavlink_msg_memory_vect_decode(&message, &vect);
-            //            QString str("mem_%1");
-            //            quint64 time = getUnixTime(0);
-            //            int16_t *mem0 = (int16_t *)&vect.value[0];
-            //            uint16_t *mem1 = (uint16_t *)&vect.value[0];
-            //            int32_t *mem2 = (int32_t *)&vect.value[0];
-            //            // uint32_t *mem3 = (uint32_t *)&vect.value[0]; causes overload problem
-            //            float *mem4 = (float *)&vect.value[0];
-            //            if ( vect.ver == 0) vect.type = 0, vect.ver = 1; else ;
-            //            if ( vect.ver == 1)
-            //            {
-            //                switch (vect.type) {
-            //                default:
-            //                case 0:
-            //                    for (int i = 0; i < 16; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "i16", mem0[i], time);
-            //                    break;
-            //                case 1:
-            //                    for (int i = 0; i < 16; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "ui16", mem1[i], time);
-            //                    break;
-            //                case 2:
-            //                    for (int i = 0; i < 16; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "Q15", (float)mem0[i]/32767.0, time);
-            //                    break;
-            //                case 3:
-            //                    for (int i = 0; i < 16; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*2)), "1Q14", (float)mem0[i]/16383.0, time);
-            //                    break;
-            //                case 4:
-            //                    for (int i = 0; i < 8; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "i32", mem2[i], time);
-            //                    break;
-            //                case 5:
-            //                    for (int i = 0; i < 8; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "i32", mem2[i], time);
-            //                    break;
-            //                case 6:
-            //                    for (int i = 0; i < 8; i++)
-            //                        // FIXME REMOVE LATER emit valueChanged(uasId, str.arg(vect.address+(i*4)), "float", mem4[i], time);
-            //                    break;
-            //                }
-            //            }
-            //        }
-            //        break;
+
 #ifdef MAVLINK_ENABLED_UALBERTA
-        case MAVLINK_MSG_ID_NAV_FILTER_BIAS:
-        {
-            mavlink_nav_filter_bias_t bias;
-            mavlink_msg_nav_filter_bias_decode(&message, &bias);
-            quint64 time = getUnixTime();
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[0]", "raw", bias.accel_0, time);
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[1]", "raw", bias.accel_1, time);
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[2]", "raw", bias.accel_2, time);
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[0]", "raw", bias.gyro_0, time);
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[1]", "raw", bias.gyro_1, time);
-            // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[2]", "raw", bias.gyro_2, time);
-        }
-            break;
-        case MAVLINK_MSG_ID_RADIO_CALIBRATION:
-        {
-            mavlink_radio_calibration_t radioMsg;
-            mavlink_msg_radio_calibration_decode(&message, &radioMsg);
-            QVector<uint16_t> aileron;
-            QVector<uint16_t> elevator;
-            QVector<uint16_t> rudder;
-            QVector<uint16_t> gyro;
-            QVector<uint16_t> pitch;
-            QVector<uint16_t> throttle;
-
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_AILERON_LEN; ++i)
-                aileron << radioMsg.aileron[i];
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_ELEVATOR_LEN; ++i)
-                elevator << radioMsg.elevator[i];
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_RUDDER_LEN; ++i)
-                rudder << radioMsg.rudder[i];
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_GYRO_LEN; ++i)
-                gyro << radioMsg.gyro[i];
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_PITCH_LEN; ++i)
-                pitch << radioMsg.pitch[i];
-            for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_THROTTLE_LEN; ++i)
-                throttle << radioMsg.throttle[i];
-
-            QPointer<RadioCalibrationData> radioData = new RadioCalibrationData(aileron, elevator, rudder, gyro, pitch, throttle);
-            emit radioCalibrationReceived(radioData);
-            delete radioData;
-        }
-            break;
+void UAS::handleNavFilterBias(const mavlink_message_t& message)
+{
+    mavlink_nav_filter_bias_t bias;
+    mavlink_msg_nav_filter_bias_decode(&message, &bias);
+    quint64 time = getUnixTime();
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[0]", "raw", bias.accel_0, time);
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[1]", "raw", bias.accel_1, time);
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_f[2]", "raw", bias.accel_2, time);
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[0]", "raw", bias.gyro_0, time);
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[1]", "raw", bias.gyro_1, time);
+    // FIXME REMOVE LATER emit valueChanged(uasId, "b_w[2]", "raw", bias.gyro_2, time);
+}
+
+void UAS::handleRadioCalibration(const mavlink_message_t& message)
+{
+    mavlink_radio_calibration_t radioMsg;
+    mavlink_msg_radio_calibration_decode(&message, &radioMsg);
+    QVector<uint16_t> aileron;
+    QVector<uint16_t> elevator;
+    QVector<uint16_t> rudder;
+    QVector<uint16_t> gyro;
+    QVector<uint16_t> pitch;
+    QVector<uint16_t> throttle;
+
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_AILERON_LEN; ++i)
+        aileron << radioMsg.aileron[i];
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_ELEVATOR_LEN; ++i)
+        elevator << radioMsg.elevator[i];
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_RUDDER_LEN; ++i)
+        rudder << radioMsg.rudder[i];
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_GYRO_LEN; ++i)
+        gyro << radioMsg.gyro[i];
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_PITCH_LEN; ++i)
+        pitch << radioMsg.pitch[i];
+    for (int i=0; i<MAVLINK_MSG_RADIO_CALIBRATION_FIELD_THROTTLE_LEN; ++i)
+        throttle << radioMsg.throttle[i];
+
+    QPointer<RadioCalibrationData> radioData = new RadioCalibrationData(aileron, elevator, rudder, gyro, pitch, throttle);
+    emit radioCalibrationReceived(radioData);
+    delete radioData;
+}
 
 #endif
-            // Messages to ignore
-        case MAVLINK_MSG_ID_RAW_IMU:
-        case MAVLINK_MSG_ID_SCALED_IMU:
-        case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
-        case MAVLINK_MSG_ID_RAW_PRESSURE:
-        case MAVLINK_MSG_ID_SCALED_PRESSURE:
-        case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
-        case MAVLINK_MSG_ID_OPTICAL_FLOW:
-        case MAVLINK_MSG_ID_DEBUG_VECT:
-        case MAVLINK_MSG_ID_DEBUG:
-        case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
-        case MAVLINK_MSG_ID_NAMED_VALUE_INT:
-            break;
-        default:
-        {
-            if (!unknownPackets.contains(message.msgid))
-            {
-                unknownPackets.append(message.msgid);
-                QString errString = tr("UNABLE TO DECODE MESSAGE NUMBER %1").arg(message.msgid);
-                GAudioOutput::instance()->say(errString+tr(", please check console for details."));
-                emit textMessageReceived(uasId, message.compid, 255, errString);
-                std::cout << "Unable to decode message from system " << std::dec << static_cast<int>(message.sysid) << " with message id:" << static_cast<int>(message.msgid) << std::endl;
-                //qDebug() << std::cerr << "Unable to decode message from system " << std::dec << static_cast<int>(message.acid) << " with message id:" << static_cast<int>(message.msgid) << std::endl;
-            }
-        }
-            break;
-        }
+
+void UAS::ignoreMessage(const mavlink_message_t& message)
+{
+    Q_UNUSED(message);
+}
+
+void UAS::handleUnknownMessage(const mavlink_message_t& message)
+{
+    if (!unknownPackets.contains(message.msgid))
+    {
+        unknownPackets.append(message.msgid);
+        QString errString = tr("UNABLE TO DECODE MESSAGE NUMBER %1").arg(message.msgid);
+        GAudioOutput::instance()->say(errString+tr(", please check console for details."));
+        emit textMessageReceived(uasId, message.compid, 255, errString);
+        std::cout << "Unable to decode message from system " << std::dec << static_cast<int>(message.sysid) << " with message id:" << static_cast<int>(message.msgid) << std::endl;
+        //qDebug() << std::cerr << "Unable to decode message from system " << std::dec << static_cast<int>(message.acid) << " with message id:" << static_cast<int>(message.msgid) << std::endl;
     }
 }
 
@@ -1413,12 +1552,19 @@ void UAS::setMode(int mode)
 
 void UAS::sendMessage(mavlink_message_t message)
 {
+    // Serialize once, all links get the same bytes
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    int len = mavlink_msg_to_send_buffer(buffer, &message);
+
     // Emit message on all links that are currently connected
     foreach (LinkInterface* link, *links)
     {
         if (link)
         {
-            sendMessage(link, message);
+            if (link->isConnected())
+            {
+                link->writeBytes((const char*)buffer, len);
+            }
         }
         else
         {
@@ -132,6 +132,9 @@ public:
     double getYaw() const {
         return yaw;
     }
+    UASTelemetrySnapshot getTelemetrySnapshot() const {
+        return telemetryBuffer.read();
+    }
     bool getSelected() const;
 
 #if defined(QGC_PROTOBUF_ENABLED) && defined(QGC_USE_PIXHAWK_MESSAGES)
@@ -521,7 +524,7 @@ public slots:
     void removeLink(QObject* object);
 
     /** @brief Receive a message from one of the communication links. */
-    virtual void receiveMessage(LinkInterface* link, mavlink_message_t message);
+    virtual void receiveMessage(LinkInterface* link, const mavlink_message_t& message);
 
 #ifdef QGC_PROTOBUF_ENABLED
     /** @brief Receive a message from one of the communication links. */
@@ -634,6 +637,81 @@ protected:
     int componentID[256];
     bool componentMulti[256];
 
+    /** @brief Values this system computes for the plots */
+    enum SampleChannel {
+        HEARTBEAT_BASE_MODE,
+        HEARTBEAT_SYSTEM_STATUS,
+        SYS_STATUS_SENSORS_ENABLED,
+        SYS_STATUS_SENSORS_HEALTH,
+        SYS_STATUS_ERRORS_COMM,
+        SYS_STATUS_ERRORS_COUNT1,
+        SYS_STATUS_ERRORS_COUNT2,
+        SYS_STATUS_ERRORS_COUNT3,
+        SYS_STATUS_ERRORS_COUNT4,
+        SYS_STATUS_LOAD,
+        SYS_STATUS_BATTERY_REMAINING,
+        SYS_STATUS_BATTERY_VOLTAGE,
+        SYS_STATUS_BATTERY_CURRENT,
+        SYS_STATUS_DROP_RATE_COMM,
+        SAMPLE_CHANNEL_COUNT
+    };
+    int sampleChannels[SAMPLE_CHANNEL_COUNT]; ///< Registry IDs of the values
+
+    UASTelemetrySnapshot telemetry;             ///< State collected by the message handlers
+    UASTelemetrySnapshotBuffer telemetryBuffer; ///< Last published copy of telemetry
+    bool telemetryChanged;                      ///< Publish telemetry after the current message
+
+    /** @brief Handler of one MAVLink message type */
+    typedef void (UAS::*MessageHandler)(const mavlink_message_t& message);
+    /** @brief Install the handler called for all messages with this ID */
+    void setMessageHandler(int msgid, MessageHandler handler) {
+        messageHandlers[msgid & 0xFF] = handler;
+    }
+    /** @brief Check if this message type is already received from another component */
+    bool isFromOtherComponent(const mavlink_message_t& message) const {
+        return componentID[message.msgid] != message.compid;
+    }
+    /** @brief Install the handlers of the common message set */
+    void initMessageHandlers();
+    MessageHandler messageHandlers[256]; ///< Handlers indexed by message ID
+
+    // MESSAGE HANDLERS
+    void handleHeartbeat(const mavlink_message_t& message);
+    void handleSysStatus(const mavlink_message_t& message);
+    void handleAttitude(const mavlink_message_t& message);
+    void handleHilControls(const mavlink_message_t& message);
+    void handleVfrHud(const mavlink_message_t& message);
+    void handleLocalPositionNed(const mavlink_message_t& message);
+    void handleGlobalVisionPositionEstimate(const mavlink_message_t& message);
+    void handleGlobalPositionInt(const mavlink_message_t& message);
+    void handleGpsRawInt(const mavlink_message_t& message);
+    void handleGpsStatus(const mavlink_message_t& message);
+    void handleGpsGlobalOrigin(const mavlink_message_t& message);
+    void handleRcChannelsRaw(const mavlink_message_t& message);
+    void handleRcChannelsScaled(const mavlink_message_t& message);
+    void handleParamValue(const mavlink_message_t& message);
+    void handleCommandAck(const mavlink_message_t& message);
+    void handleRollPitchYawThrustSetpoint(const mavlink_message_t& message);
+    void handleMissionCount(const mavlink_message_t& message);
+    void handleMissionItem(const mavlink_message_t& message);
+    void handleMissionAck(const mavlink_message_t& message);
+    void handleMissionRequest(const mavlink_message_t& message);
+    void handleMissionItemReached(const mavlink_message_t& message);
+    void handleMissionCurrent(const mavlink_message_t& message);
+    void handleLocalPositionSetpoint(const mavlink_message_t& message);
+    void handleSetLocalPositionSetpoint(const mavlink_message_t& message);
+    void handleStatusText(const mavlink_message_t& message);
+#ifdef MAVLINK_ENABLED_PIXHAWK
+    void handleDataTransmissionHandshake(const mavlink_message_t& message);
+    void handleEncapsulatedData(const mavlink_message_t& message);
+#endif
+#ifdef MAVLINK_ENABLED_UALBERTA
+    void handleNavFilterBias(const mavlink_message_t& message);
+    void handleRadioCalibration(const mavlink_message_t& message);
+#endif
+    void ignoreMessage(const mavlink_message_t& message);
+    void handleUnknownMessage(const mavlink_message_t& message);
+
 protected slots:
     /** @brief Write settings to disk */
     void writeSettings();
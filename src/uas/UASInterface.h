@@ -43,6 +43,8 @@ This file is part of the QGROUNDCONTROL project
 #include "UASWaypointManager.h"
 #include "QGCUASParamManager.h"
 #include "RadioCalibration/RadioCalibrationData.h"
+#include "QGCSampleBlock.h"
+#include "UASTelemetrySnapshot.h"
 
 #ifdef QGC_PROTOBUF_ENABLED
 #include <tr1/memory>
@@ -94,6 +96,9 @@ public:
     virtual double getPitch() const = 0;
     virtual double getYaw() const = 0;
 
+    /** @brief Get a consistent copy of the current state, safe to call from any thread */
+    virtual UASTelemetrySnapshot getTelemetrySnapshot() const = 0;
+
     virtual bool getSelected() const = 0;
 
 #if defined(QGC_PROTOBUF_ENABLED) && defined(QGC_USE_PIXHAWK_MESSAGES)
@@ -430,6 +435,8 @@ signals:
     void valueChanged(const int uasId, const QString& name, const QString& unit, const quint64 value, const quint64 msec);
     void valueChanged(const int uasId, const QString& name, const QString& unit, const qint64 value, const quint64 msec);
     void valueChanged(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec);
+    /** @brief Values of one message in one signal, the channels are registered in MAVLinkChannelRegistry */
+    void samplesReady(QGCSampleBlock samples);
 
     void voltageChanged(int uasId, double voltage);
     void waypointUpdated(int uasId, int id, double x, double y, double z, double yaw, bool autocontinue, bool active);
@@ -453,6 +460,8 @@ signals:
     void actuatorChanged(UASInterface*, int actId, double value);
     void thrustChanged(UASInterface*, double thrust);
     void heartbeat(UASInterface* uas);
+    /** @brief The telemetry snapshot changed, emitted at most once until it is read again */
+    void telemetryUpdated(UASInterface* uas);
     void attitudeChanged(UASInterface*, double roll, double pitch, double yaw, quint64 usec);
     void attitudeChanged(UASInterface*, int component, double roll, double pitch, double yaw, quint64 usec);
     void attitudeSpeedChanged(int uas, double rollspeed, double pitchspeed, double yawspeed, quint64 usec);
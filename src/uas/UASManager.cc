@@ -268,6 +268,13 @@ void UASManager::addUAS(UASInterface* uas)
     if (!systems.contains(uas))
     {
         systems.append(uas);
+        // Publish the UAS for lookups by ID, as the list scan did, a later
+        // UAS with the same ID takes precedence
+        int id = uas->getUASID();
+        if (id >= 0 && id < 256)
+        {
+            systemTable[id].fetchAndStoreRelease(uas);
+        }
         connect(uas, SIGNAL(destroyed(QObject*)), this, SLOT(removeUAS(QObject*)));
         // Set home position on UAV if set in UI
         // - this is done on a per-UAV basis
@@ -285,6 +292,17 @@ void UASManager::addUAS(UASInterface* uas)
 
 void UASManager::removeUAS(QObject* uas)
 {
+    // The object may already be partially destroyed,
+    // only compare the addresses
+    for (int i = 0; i < 256; i++)
+    {
+        UASInterface* entry = systemTable[i];
+        if (entry && static_cast<QObject*>(entry) == uas)
+        {
+            systemTable[i].testAndSetRelease(entry, NULL);
+        }
+    }
+
     UASInterface* mav = qobject_cast<UASInterface*>(uas);
 
     if (mav) {
@@ -384,16 +402,9 @@ void UASManager::configureActiveUAS()
 
 UASInterface* UASManager::getUASForId(int id)
 {
-    UASInterface* system = NULL;
-
-    foreach(UASInterface* sys, systems) {
-        if (sys->getUASID() == id) {
-            system = sys;
-        }
-    }
-
     // Return NULL if not found
-    return system;
+    if (id < 0 || id > 255) return NULL;
+    return systemTable[id].fetchAndAddAcquire(0);
 }
 
 void UASManager::setActiveUAS(UASInterface* uas)
@@ -34,6 +34,7 @@ This file is part of the QGROUNDCONTROL project
 #include <QThread>
 #include <QList>
 #include <QMutex>
+#include <QAtomicPointer>
 #include <UASInterface.h>
 #include "Eigen/Eigen"
 #include "QGCGeo.h"
@@ -62,10 +63,11 @@ public:
     /**
      * @brief Get the UAS with this id
      *
-     * Although not enforced by this implementation, the IDs are constrained to be
-     * in the range of 1 - 127 by the MAVLINK protocol.
+     * The lookup is a single read of a table indexed by the system ID and safe
+     * to call from any thread. The UAS object itself may only be used in the
+     * GUI thread, as it could be deleted there at any time.
      *
-     * @param id unique system / aircraft id
+     * @param id unique system / aircraft id, 0 - 255
      * @return UAS with the given ID, NULL pointer else
      **/
     UASInterface* getUASForId(int id);
@@ -243,6 +245,7 @@ public slots:
 protected:
     UASManager();
     QList<UASInterface*> systems;
+    QAtomicPointer<UASInterface> systemTable[256]; ///< UAS per system ID, published once the UAS is added
     UASInterface* activeUAS;
     QMutex activeUASMutex;
     double homeLat;
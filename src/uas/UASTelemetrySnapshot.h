@@ -0,0 +1,207 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Snapshot of the current vehicle state for polling widgets
+ *
+ */
+
+#ifndef UASTELEMETRYSNAPSHOT_H
+#define UASTELEMETRYSNAPSHOT_H
+
+#include <QtGlobal>
+#include <QAtomicInt>
+
+class UASInterface;
+
+/**
+ * @brief The current state of one vehicle, as far as the displays need it
+ *
+ * Plain values only, so the whole struct can be copied with one assignment.
+ * Timestamps are in the same UNIX milliseconds the UAS signals carry,
+ * a timestamp of 0 means the group was not received yet. Each group also
+ * counts its updates, so a reader detects a change even if the vehicle
+ * sends the same timestamp twice or its clock jumps back.
+ */
+struct UASTelemetrySnapshot
+{
+    UASTelemetrySnapshot() :
+        attitudeGeneration(0), attitudeTime(0), roll(0), pitch(0), yaw(0),
+        rollSpeed(0), pitchSpeed(0), yawSpeed(0),
+        localPositionGeneration(0), localPositionTime(0), localX(0), localY(0), localZ(0),
+        globalPositionGeneration(0), globalPositionTime(0), latitude(0), longitude(0), altitude(0),
+        speedGeneration(0), speedTime(0), speedX(0), speedY(0), speedZ(0),
+        thrust(0),
+        batteryGeneration(0), batteryTime(0), batteryVoltage(0), chargeLevel(0), timeRemaining(0),
+        heartbeatGeneration(0), heartbeatTime(0), mode(0), navMode(0), status(0), armed(false)
+    {
+    }
+
+    /** @brief Update method of a display, same signature as the UAS position signals */
+    template<class T>
+    struct Update
+    {
+        typedef void (T::*Method)(UASInterface* uas, double x, double y, double z, quint64 time);
+    };
+
+    /**
+     * @brief Pass the groups which changed since a previous snapshot to a display
+     *
+     * The methods are called like the slots of the matching UAS signals, a
+     * null method skips its group. Attitude rates are not passed on.
+     */
+    template<class T>
+    void forwardChanges(const UASTelemetrySnapshot& previous, UASInterface* uas, T* receiver,
+                        typename Update<T>::Method attitude,
+                        typename Update<T>::Method localPosition,
+                        typename Update<T>::Method globalPosition,
+                        typename Update<T>::Method speed) const
+    {
+        if (attitude && attitudeGeneration != previous.attitudeGeneration)
+        {
+            (receiver->*attitude)(uas, roll, pitch, yaw, attitudeTime);
+        }
+        if (localPosition && localPositionGeneration != previous.localPositionGeneration)
+        {
+            (receiver->*localPosition)(uas, localX, localY, localZ, localPositionTime);
+        }
+        if (globalPosition && globalPositionGeneration != previous.globalPositionGeneration)
+        {
+            (receiver->*globalPosition)(uas, latitude, longitude, altitude, globalPositionTime);
+        }
+        if (speed && speedGeneration != previous.speedGeneration)
+        {
+            (receiver->*speed)(uas, speedX, speedY, speedZ, speedTime);
+        }
+    }
+
+    quint32 attitudeGeneration; ///< Number of attitude updates
+    quint64 attitudeTime;       ///< Time of the last attitude update
+    double roll;
+    double pitch;
+    double yaw;
+    double rollSpeed;
+    double pitchSpeed;
+    double yawSpeed;
+
+    quint32 localPositionGeneration;
+    quint64 localPositionTime;  ///< Time of the last local position update
+    double localX;
+    double localY;
+    double localZ;
+
+    quint32 globalPositionGeneration;
+    quint64 globalPositionTime; ///< Time of the last global position update
+    double latitude;
+    double longitude;
+    double altitude;
+
+    quint32 speedGeneration;
+    quint64 speedTime;          ///< Time of the last speed update
+    double speedX;
+    double speedY;
+    double speedZ;
+
+    double thrust;              ///< Throttle, 0 to 1
+
+    quint32 batteryGeneration;
+    quint64 batteryTime;        ///< Time of the last battery update
+    double batteryVoltage;      ///< Low-pass filtered voltage
+    double chargeLevel;         ///< Charge level in percent
+    int timeRemaining;          ///< Estimated flight time left, in seconds
+
+    quint32 heartbeatGeneration;
+    quint64 heartbeatTime;      ///< Ground time of the last heartbeat, in microseconds
+    int mode;                   ///< MAV_MODE base mode
+    int navMode;                ///< Autopilot specific custom mode
+    int status;                 ///< MAV_STATE system status
+    bool armed;
+};
+
+/**
+ * @brief Sequence lock around one UASTelemetrySnapshot
+ *
+ * One thread writes, any number of threads read without ever blocking the
+ * writer. The sequence is odd while a write is in progress, a reader which
+ * saw it change or odd copies again. Readers are expected to poll at frame
+ * rate while the writer updates at message rate, so retries are rare.
+ *
+ * takeReadFlag() lets the writer notify the readers only about the first
+ * write after a read, so the notifications follow the read rate.
+ */
+class UASTelemetrySnapshotBuffer
+{
+public:
+    UASTelemetrySnapshotBuffer() :
+        sequence(0),
+        readFlag(1)
+    {
+    }
+
+    /** @brief Publish a new snapshot, only ever called by the owning thread */
+    void write(const UASTelemetrySnapshot& snapshot)
+    {
+        sequence.fetchAndAddOrdered(1);
+        data = snapshot;
+        sequence.fetchAndAddOrdered(1);
+    }
+
+    /** @brief Get a consistent copy of the latest snapshot, any thread */
+    UASTelemetrySnapshot read() const
+    {
+        UASTelemetrySnapshot snapshot;
+        int before;
+        int after;
+        do
+        {
+            before = sequence.fetchAndAddOrdered(0);
+            if (before & 1) continue;
+            snapshot = data;
+            after = sequence.fetchAndAddOrdered(0);
+            if (before == after) break;
+        } while (true);
+        readFlag.fetchAndStoreRelease(1);
+        return snapshot;
+    }
+
+    /** @brief Check if the snapshot was read since the last call, writer thread only */
+    bool takeReadFlag() {
+        return readFlag.testAndSetOrdered(1, 0);
+    }
+
+    /** @brief Get the number of completed writes, e.g. to skip repaints */
+    int generation() const {
+        return sequence.fetchAndAddAcquire(0) >> 1;
+    }
+
+protected:
+    mutable QAtomicInt sequence; ///< Twice the number of writes, odd while writing
+    mutable QAtomicInt readFlag; ///< Set by read(), cleared by takeReadFlag()
+    UASTelemetrySnapshot data;
+
+private:
+    Q_DISABLE_COPY(UASTelemetrySnapshotBuffer)
+};
+
+#endif // UASTELEMETRYSNAPSHOT_H
@@ -16,10 +16,11 @@ class senseSoarMAV : public UAS
 public:
 	senseSoarMAV(MAVLinkProtocol* mavlink, int id);
 	~senseSoarMAV(void);
-public slots:
-    /** @brief Receive a MAVLink message from this MAV */
-    void receiveMessage(LinkInterface* link, mavlink_message_t message);
 protected:
+#ifdef MAVLINK_ENABLED_SENSESOAR
+    /** @brief Handle the senseSoar specific messages of this MAV */
+    void handleSenseSoarMessage(const mavlink_message_t& message);
+#endif
 	float m_rotVel[3]; // Rotational velocity in the body frame
 	uint8_t senseSoarState;
 private:
@@ -21,9 +21,12 @@
 #include <qmath.h>
 #include "UASManager.h"
 #include "HDDisplay.h"
+#include "MAVLinkDecoder.h"
+#include "QGCSampleAdapter.h"
 #include "ui_HDDisplay.h"
 #include "MG.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include <QDebug>
 
 HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
@@ -41,13 +44,13 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
     infoColor(QColor(20, 200, 20)),
     fuelColor(criticalColor),
     warningBlinkRate(5),
-    refreshTimer(new QTimer(this)),
     hardwareAcceleration(true),
     strongStrokeWidth(1.5f),
     normalStrokeWidth(1.0f),
     fineStrokeWidth(0.5f),
     acceptList(new QStringList()),
     acceptUnitList(new QStringList()),
+    samples(new QGCSampleAdapter(this)),
     lastPaintTime(0),
     columns(3),
     valuesChanged(true),
@@ -57,6 +60,7 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
     //m_ui->setupUi(this);
 
     setAutoFillBackground(true);
+    samples->connectSlots(this, "updateValue");
 
     // Add all items in accept list to gauge
     if (plotList) {
@@ -113,10 +117,8 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
 
     scalingFactor = this->width()/vwidth;
 
-    // Refresh timer
-    refreshTimer->setInterval(180); //
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(triggerUpdate()));
-    //connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintGL()));
+    // Repainted when new values arrived
+    QGCFrameScheduler::instance()->add(this, "triggerUpdate", updateInterval);
 
     fontDatabase = QFontDatabase();
     const QString fontFileName = ":/general/vera.ttf"; ///< Font file is part of the QRC file and compiled into the app
@@ -135,10 +137,6 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
 HDDisplay::~HDDisplay()
 {
     saveState();
-	if(this->refreshTimer)
-	{
-		delete this->refreshTimer;
-	}
 	if(this->acceptList)
 	{
 		delete this->acceptList;
@@ -246,6 +244,7 @@ void HDDisplay::restoreState()
     settings.sync();
 
     acceptList->clear();
+    updateSubscriptions();
 
     QStringList instruments = settings.value(windowTitle()+"_gauges").toString().split('|');
     for (int i = 0; i < instruments.count(); i++) {
@@ -278,6 +277,7 @@ void HDDisplay::removeItemByAction()
         maxValues.remove(item);
         symmetric.remove(item);
         adjustGaugeAspectRatio();
+        updateSubscriptions();
     }
 }
 
@@ -359,6 +359,7 @@ void HDDisplay::addGauge(const QString& gauge)
         }
     }
     adjustGaugeAspectRatio();
+    updateSubscriptions();
 }
 
 void HDDisplay::createActions()
@@ -844,8 +845,9 @@ void HDDisplay::addSource(QObject* obj)
 {
     //genericSources.append(obj);
     // FIXME XXX HACK
-//    if (plots.size() > 0)
-//    {
+    samples->addSource(obj);
+    if (QGCSampleAdapter::hasValues(obj))
+    {
         connect(obj, SIGNAL(valueChanged(int,QString,QString,qint8,quint64)), this, SLOT(updateValue(int,QString,QString,qint8,quint64)));
         connect(obj, SIGNAL(valueChanged(int,QString,QString,quint8,quint64)), this, SLOT(updateValue(int,QString,QString,quint8,quint64)));
         connect(obj, SIGNAL(valueChanged(int,QString,QString,qint16,quint64)), this, SLOT(updateValue(int,QString,QString,qint16,quint64)));
@@ -855,7 +857,13 @@ void HDDisplay::addSource(QObject* obj)
         connect(obj, SIGNAL(valueChanged(int,QString,QString,quint64,quint64)), this, SLOT(updateValue(int,QString,QString,quint64,quint64)));
         connect(obj, SIGNAL(valueChanged(int,QString,QString,qint64,quint64)), this, SLOT(updateValue(int,QString,QString,qint64,quint64)));
         connect(obj, SIGNAL(valueChanged(int,QString,QString,double,quint64)), this, SLOT(updateValue(int,QString,QString,double,quint64)));
-//    }
+    }
+    MAVLinkDecoder* decoder = qobject_cast<MAVLinkDecoder*>(obj);
+    if (decoder)
+    {
+        decoders.append(decoder);
+        foreach (const QString& field, subscribedFields) decoder->subscribe(field);
+    }
 }
 
 // Disconnect a generic source
@@ -863,8 +871,9 @@ void HDDisplay::removeSource(QObject* obj)
 {
     //genericSources.append(obj);
     // FIXME XXX HACK
-//    if (plots.size() > 0)
-//    {
+    samples->removeSource(obj);
+    if (QGCSampleAdapter::hasValues(obj))
+    {
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,qint8,quint64)), this, SLOT(updateValue(int,QString,QString,qint8,quint64)));
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,quint8,quint64)), this, SLOT(updateValue(int,QString,QString,quint8,quint64)));
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,qint16,quint64)), this, SLOT(updateValue(int,QString,QString,qint16,quint64)));
@@ -874,7 +883,39 @@ void HDDisplay::removeSource(QObject* obj)
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,quint64,quint64)), this, SLOT(updateValue(int,QString,QString,quint64,quint64)));
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,qint64,quint64)), this, SLOT(updateValue(int,QString,QString,qint64,quint64)));
         disconnect(obj, SIGNAL(valueChanged(int,QString,QString,double,quint64)), this, SLOT(updateValue(int,QString,QString,double,quint64)));
-//    }
+    }
+    MAVLinkDecoder* decoder = qobject_cast<MAVLinkDecoder*>(obj);
+    if (decoder && decoders.removeAll(decoder) > 0)
+    {
+        foreach (const QString& field, subscribedFields) decoder->unsubscribe(field);
+    }
+}
+
+/**
+ * Generic decoders only emit the fields somebody asked for. The gauges
+ * request their fields while the display is visible and release them
+ * when it is hidden.
+ */
+void HDDisplay::updateSubscriptions()
+{
+    QStringList fields;
+    if (isVisible()) fields = *acceptList;
+    fields.removeDuplicates();
+
+    foreach (const QPointer<QObject>& source, decoders)
+    {
+        MAVLinkDecoder* decoder = qobject_cast<MAVLinkDecoder*>(source);
+        if (!decoder) continue;
+        foreach (const QString& field, fields)
+        {
+            if (!subscribedFields.contains(field)) decoder->subscribe(field);
+        }
+        foreach (const QString& field, subscribedFields)
+        {
+            if (!fields.contains(field)) decoder->unsubscribe(field);
+        }
+    }
+    subscribedFields = fields;
 }
 
 void HDDisplay::updateValue(const int uasId, const QString& name, const QString& unit, const qint8 value, const quint64 msec)
@@ -939,6 +980,7 @@ void HDDisplay::updateValue(const int uasId, const QString& name, const QString&
     values.insert(name, value);
     units.insert(name, unit);
     lastUpdate.insert(name, msec);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -1010,7 +1052,7 @@ void HDDisplay::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval);
+    updateSubscriptions();
 }
 
 void HDDisplay::hideEvent(QHideEvent* event)
@@ -1018,8 +1060,8 @@ void HDDisplay::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
     saveState();
+    updateSubscriptions();
 }
 
 
@@ -37,12 +37,15 @@ This file is part of the QGROUNDCONTROL project
 #include <QTimer>
 #include <QFontDatabase>
 #include <QMap>
+#include <QPointer>
 #include <QContextMenuEvent>
 #include <QPair>
 #include <cmath>
 
 #include "UASInterface.h"
 
+class QGCSampleAdapter;
+
 namespace Ui
 {
 class HDDisplay;
@@ -124,6 +127,8 @@ protected:
     void contextMenuEvent(QContextMenuEvent* event);
     QList<QAction*> getItemRemoveActions();
     void createActions();
+    /** @brief Request the fields of the gauges from the decoders while visible */
+    void updateSubscriptions();
     float refLineWidthToPen(float line);
     float refToScreenX(float x);
     float refToScreenY(float y);
@@ -192,7 +197,6 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
     static const int updateInterval = 300; ///< Update interval in milliseconds
     QPainter* hudPainter;
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
@@ -205,6 +209,9 @@ protected:
 
     QStringList* acceptList;       ///< Variable names to plot
     QStringList* acceptUnitList;   ///< Unit names to plot
+    QGCSampleAdapter* samples;     ///< Splits the sample blocks of the sources into values
+    QList<QPointer<QObject> > decoders; ///< Generic sources which only decode requested fields
+    QStringList subscribedFields;  ///< Fields currently requested from the decoders
 
     quint64 lastPaintTime;     ///< Last time this widget was refreshed
     int columns;               ///< Number of instrument columns
@@ -38,6 +38,7 @@ This file is part of the QGROUNDCONTROL project
 #include "UASManager.h"
 #include "HSIDisplay.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include "Waypoint.h"
 #include "UASWaypointManager.h"
 #include <qmath.h>
@@ -108,7 +109,9 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
     userSetPointSet(false),
     userXYSetPointSet(false)
 {
-    refreshTimer->setInterval(updateInterval);
+    // Interactive and drawn from many sources, repaint every frame while visible
+    QGCFrameScheduler::instance()->remove(this);
+    QGCFrameScheduler::instance()->add(this, "triggerUpdate", updateInterval, true);
 
     columns = 1;
     this->setAutoFillBackground(true);
@@ -190,6 +193,8 @@ void HSIDisplay::renderOverlay()
 #if (QGC_EVENTLOOP_DEBUG)
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
+    pollTelemetry();
+
     // Center location of the HSI gauge items
 
     //float bottomMargin = 3.0f;
@@ -794,13 +799,9 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
 {
     if (this->uas != NULL) {
         disconnect(this->uas, SIGNAL(gpsSatelliteStatusChanged(int,int,float,float,float,bool)), this, SLOT(updateSatellite(int,int,float,float,float,bool)));
-        disconnect(this->uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-        disconnect(this->uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
         disconnect(this->uas, SIGNAL(attitudeThrustSetPointChanged(UASInterface*,double,double,double,double,quint64)), this, SLOT(updateAttitudeSetpoints(UASInterface*,double,double,double,double,quint64)));
         disconnect(this->uas, SIGNAL(positionSetPointsChanged(int,float,float,float,float,quint64)), this, SLOT(updatePositionSetpoints(int,float,float,float,float,quint64)));
         disconnect(uas, SIGNAL(userPositionSetPointsChanged(int,float,float,float,float)), this, SLOT(updateUserPositionSetpoints(int,float,float,float,float)));
-        disconnect(this->uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
-        disconnect(this->uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateAttitude(UASInterface*,double,double,double,quint64)));
 
         disconnect(this->uas, SIGNAL(attitudeControlEnabled(bool)), this, SLOT(updateAttitudeControllerEnabled(bool)));
         disconnect(this->uas, SIGNAL(positionXYControlEnabled(bool)), this, SLOT(updatePositionXYControllerEnabled(bool)));
@@ -815,13 +816,9 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
     }
 
     connect(uas, SIGNAL(gpsSatelliteStatusChanged(int,int,float,float,float,bool)), this, SLOT(updateSatellite(int,int,float,float,float,bool)));
-    connect(uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
     connect(uas, SIGNAL(attitudeThrustSetPointChanged(UASInterface*,double,double,double,double,quint64)), this, SLOT(updateAttitudeSetpoints(UASInterface*,double,double,double,double,quint64)));
     connect(uas, SIGNAL(positionSetPointsChanged(int,float,float,float,float,quint64)), this, SLOT(updatePositionSetpoints(int,float,float,float,float,quint64)));
     connect(uas, SIGNAL(userPositionSetPointsChanged(int,float,float,float,float)), this, SLOT(updateUserPositionSetpoints(int,float,float,float,float)));
-    connect(uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateAttitude(UASInterface*,double,double,double,quint64)));
 
     connect(uas, SIGNAL(attitudeControlEnabled(bool)), this, SLOT(updateAttitudeControllerEnabled(bool)));
     connect(uas, SIGNAL(positionXYControlEnabled(bool)), this, SLOT(updatePositionXYControllerEnabled(bool)));
@@ -835,10 +832,22 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
     connect(uas, SIGNAL(objectDetected(uint,int,int,QString,int,float,float)), this, SLOT(updateObjectPosition(uint,int,int,QString,int,float,float)));
 
     this->uas = uas;
+    // Attitude, position and speed are polled from the snapshot per frame
+    telemetry = UASTelemetrySnapshot();
 
     resetMAVState();
 }
 
+void HSIDisplay::pollTelemetry()
+{
+    if (!uas) return;
+
+    // Only take over the groups which changed since the last frame
+    const UASTelemetrySnapshot current = uas->getTelemetrySnapshot();
+    current.forwardChanges(telemetry, uas, this, &HSIDisplay::updateAttitude, &HSIDisplay::updateLocalPosition, &HSIDisplay::updateGlobalPosition, &HSIDisplay::updateSpeed);
+    telemetry = current;
+}
+
 void HSIDisplay::updateSpeed(UASInterface* uas, double vx, double vy, double vz, quint64 time)
 {
     Q_UNUSED(uas);
@@ -1368,18 +1377,14 @@ void HSIDisplay::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
-    Q_UNUSED(event) {
-        refreshTimer->start(updateInterval);
-    }
+    Q_UNUSED(event);
 }
 
 void HSIDisplay::hideEvent(QHideEvent* event)
 {
     // React only to internal (post-display)
     // events
-    Q_UNUSED(event) {
-        refreshTimer->stop();
-    }
+    Q_UNUSED(event);
 }
 
 void HSIDisplay::updateJoystick(double roll, double pitch, double yaw, double thrust, int xHat, int yHat)
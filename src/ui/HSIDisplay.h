@@ -295,6 +295,10 @@ protected:
     bool userSetPointSet;     ///< User set X, Y and Z
     bool userXYSetPointSet;   ///< User set the X/Y position already
 
+    UASTelemetrySnapshot telemetry; ///< Vehicle state read for the last frame
+    /** @brief Read the current vehicle state, called once per frame */
+    void pollTelemetry();
+
 private:
 };
 
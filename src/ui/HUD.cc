@@ -45,6 +45,7 @@ This file is part of the QGROUNDCONTROL project
 #include "HUD.h"
 #include "MG.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 
 // Fix for some platforms, e.g. windows
 #ifndef GL_MULTISAMPLE
@@ -90,7 +91,6 @@ HUD::HUD(int width, int height, QWidget* parent)
       infoColor(QColor(20, 200, 20)),
       fuelColor(criticalColor),
       warningBlinkRate(5),
-      refreshTimer(new QTimer(this)),
       noCamera(true),
       hardwareAcceleration(true),
       strongStrokeWidth(1.5f),
@@ -148,9 +148,8 @@ HUD::HUD(int width, int height, QWidget* parent)
 
     glImage = QGLWidget::convertToGLFormat(fill);
 
-    // Refresh timer
-    refreshTimer->setInterval(updateInterval);
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintHUD()));
+    // Repainted every frame while visible, the instruments are low-pass filtered
+    QGCFrameScheduler::instance()->add(this, "paintHUD", updateInterval, true);
 
     // Resize to correct size and fill with image
     resize(this->width(), this->height());
@@ -187,7 +186,6 @@ HUD::HUD(int width, int height, QWidget* parent)
 
 HUD::~HUD()
 {
-    refreshTimer->stop();
 }
 
 QSize HUD::sizeHint() const
@@ -200,7 +198,6 @@ void HUD::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     QGLWidget::showEvent(event);
-    refreshTimer->start(updateInterval);
     emit visibilityChanged(true);
 }
 
@@ -208,7 +205,6 @@ void HUD::hideEvent(QHideEvent* event)
 {
     // React only to internal (pre-display)
     // events
-    refreshTimer->stop();
     QGLWidget::hideEvent(event);
     emit visibilityChanged(false);
 }
@@ -255,15 +251,11 @@ void HUD::setActiveUAS(UASInterface* uas)
 {
     if (this->uas != NULL) {
         // Disconnect any previously connected active MAV
-        disconnect(this->uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateAttitude(UASInterface*, double, double, double, quint64)));
         disconnect(this->uas, SIGNAL(batteryChanged(UASInterface*, double, double, int)), this, SLOT(updateBattery(UASInterface*, double, double, int)));
         disconnect(this->uas, SIGNAL(statusChanged(UASInterface*,QString,QString)), this, SLOT(updateState(UASInterface*,QString)));
         disconnect(this->uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
         disconnect(this->uas, SIGNAL(heartbeat(UASInterface*)), this, SLOT(receiveHeartbeat(UASInterface*)));
 
-        disconnect(this->uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-        disconnect(this->uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
-        disconnect(this->uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
         disconnect(this->uas, SIGNAL(waypointSelected(int,int)), this, SLOT(selectWaypoint(int, int)));
 
         // Try to disconnect the image link
@@ -277,15 +269,11 @@ void HUD::setActiveUAS(UASInterface* uas)
     if (uas) {
         // Now connect the new UAS
         // Setup communication
-        connect(uas, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateAttitude(UASInterface*, double, double, double, quint64)));
         connect(uas, SIGNAL(batteryChanged(UASInterface*, double, double, int)), this, SLOT(updateBattery(UASInterface*, double, double, int)));
         connect(uas, SIGNAL(statusChanged(UASInterface*,QString,QString)), this, SLOT(updateState(UASInterface*,QString)));
         connect(uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
         connect(uas, SIGNAL(heartbeat(UASInterface*)), this, SLOT(receiveHeartbeat(UASInterface*)));
 
-        connect(uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-        connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
-        connect(uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
         connect(uas, SIGNAL(waypointSelected(int,int)), this, SLOT(selectWaypoint(int, int)));
 
         // Try to connect the image link
@@ -298,6 +286,8 @@ void HUD::setActiveUAS(UASInterface* uas)
         // Set new UAS
         this->uas = uas;
     }
+    // Attitude, position and speed are polled from the snapshot per frame
+    telemetry = UASTelemetrySnapshot();
 }
 
 //void HUD::updateAttitudeThrustSetPoint(UASInterface* uas, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 msec)
@@ -334,6 +324,16 @@ void HUD::receiveHeartbeat(UASInterface*)
 {
 }
 
+void HUD::pollTelemetry()
+{
+    if (!uas) return;
+
+    // Only take over the groups which changed since the last frame
+    const UASTelemetrySnapshot current = uas->getTelemetrySnapshot();
+    current.forwardChanges(telemetry, uas, this, &HUD::updateAttitude, &HUD::updateLocalPosition, &HUD::updateGlobalPosition, &HUD::updateSpeed);
+    telemetry = current;
+}
+
 void HUD::updateThrust(UASInterface* uas, double thrust)
 {
     Q_UNUSED(uas);
@@ -601,6 +601,8 @@ void HUD::paintHUD()
         qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
 
+        pollTelemetry();
+
         // Read out most important values to limit hash table lookups
         // Low-pass roll, pitch and yaw
         rollLP = rollLP * 0.2f + 0.8f * roll;
@@ -134,6 +134,8 @@ protected:
     void hideEvent(QHideEvent* event);
     void contextMenuEvent (QContextMenuEvent* event);
     void createActions();
+    /** @brief Read the current vehicle state, called once per frame */
+    void pollTelemetry();
 
     static const int updateInterval = 40;
 
@@ -178,7 +180,6 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
     QPainter* hudPainter;
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
     QFontDatabase fontDatabase;///< Font database, only used to load the TrueType font file (the HUD font is directly loaded from file rather than from the system)
@@ -210,6 +211,7 @@ protected:
     double lon;
     double alt;
     float load;
+    UASTelemetrySnapshot telemetry; ///< Vehicle state read for the last frame
     QString offlineDirectory;
     QString nextOfflineImage;
     bool hudInstrumentsEnabled;
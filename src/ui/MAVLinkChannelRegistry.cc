@@ -0,0 +1,148 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class MAVLinkChannelRegistry
+ *
+ */
+
+#include <QAtomicPointer>
+#include "MAVLinkChannelRegistry.h"
+
+const quint16 MAVLinkChannelRegistry::noNameHandle;
+
+/**
+ * The decoders of several threads may ask for the registry at the same
+ * time, only the first created instance is kept.
+ */
+MAVLinkChannelRegistry* MAVLinkChannelRegistry::instance()
+{
+    static QBasicAtomicPointer<MAVLinkChannelRegistry> _instance = Q_BASIC_ATOMIC_INITIALIZER(0);
+    if (!_instance)
+    {
+        MAVLinkChannelRegistry* registry = new MAVLinkChannelRegistry();
+        if (!_instance.testAndSetOrdered(0, registry))
+        {
+            delete registry;
+        }
+    }
+    return _instance;
+}
+
+MAVLinkChannelRegistry::MAVLinkChannelRegistry()
+{
+}
+
+int MAVLinkChannelRegistry::find(quint64 key) const
+{
+    QReadLocker locker(&lock);
+    return keys.value(key, -1);
+}
+
+int MAVLinkChannelRegistry::find(const QString& name) const
+{
+    QReadLocker locker(&lock);
+    return names.value(name, -1);
+}
+
+int MAVLinkChannelRegistry::add(quint64 key, const QString& name, const QString& unit, int uasId)
+{
+    QWriteLocker locker(&lock);
+    int id = keys.value(key, -1);
+    if (id >= 0) return id;
+
+    id = addName(name, unit, uasId);
+    keys.insert(key, id);
+    return id;
+}
+
+int MAVLinkChannelRegistry::add(const QString& name, const QString& unit, int uasId)
+{
+    QWriteLocker locker(&lock);
+    return addName(name, unit, uasId);
+}
+
+int MAVLinkChannelRegistry::addName(const QString& name, const QString& unit, int uasId)
+{
+    int id = names.value(name, -1);
+    if (id < 0)
+    {
+        id = channels.size();
+        Channel channel;
+        channel.name = name;
+        channel.unit = unit;
+        channel.uasId = uasId;
+        channels.append(channel);
+        names.insert(name, id);
+    }
+    return id;
+}
+
+/**
+ * Handles are limited to 15 bits. Once all are used, further names get
+ * noNameHandle and their channels have to be registered by name with
+ * add(name, unit, uasId) instead of by key.
+ */
+quint16 MAVLinkChannelRegistry::internName(const char* name, int length)
+{
+    // Look up without copying the name, only a new name is stored
+    const QByteArray raw = QByteArray::fromRawData(name, length);
+    {
+        QReadLocker locker(&lock);
+        QHash<QByteArray, quint16>::const_iterator it = payloadNames.constFind(raw);
+        if (it != payloadNames.constEnd()) return it.value();
+    }
+
+    QWriteLocker locker(&lock);
+    QHash<QByteArray, quint16>::const_iterator it = payloadNames.constFind(raw);
+    if (it != payloadNames.constEnd()) return it.value();
+    if (payloadNames.size() >= 0x7FFF) return noNameHandle;
+    quint16 handle = payloadNames.size() + 1;
+    payloadNames.insert(QByteArray(name, length), handle);
+    return handle;
+}
+
+QString MAVLinkChannelRegistry::getName(int id) const
+{
+    QReadLocker locker(&lock);
+    return (id >= 0 && id < channels.size()) ? channels.at(id).name : QString();
+}
+
+QString MAVLinkChannelRegistry::getUnit(int id) const
+{
+    QReadLocker locker(&lock);
+    return (id >= 0 && id < channels.size()) ? channels.at(id).unit : QString();
+}
+
+int MAVLinkChannelRegistry::getUASId(int id) const
+{
+    QReadLocker locker(&lock);
+    return (id >= 0 && id < channels.size()) ? channels.at(id).uasId : -1;
+}
+
+int MAVLinkChannelRegistry::count() const
+{
+    QReadLocker locker(&lock);
+    return channels.size();
+}
@@ -0,0 +1,118 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class MAVLinkChannelRegistry
+ *
+ */
+
+#ifndef MAVLINKCHANNELREGISTRY_H
+#define MAVLINKCHANNELREGISTRY_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include <QReadWriteLock>
+
+/**
+ * @brief Assigns stable integer IDs to decoded telemetry channels
+ *
+ * A channel is one element of one field of one message of one component,
+ * identified by a 64 bit key (see key()). The first time a key is seen,
+ * the decoder formats its display name and unit and registers them here.
+ * Afterwards samples only carry the ID and the name is looked up when
+ * needed. Keys which format to the same name share one ID, so an ID
+ * always stands for exactly one name. IDs are never reused for the
+ * lifetime of the application and are valid in all threads.
+ */
+class MAVLinkChannelRegistry
+{
+public:
+    static MAVLinkChannelRegistry* instance();
+
+    /**
+     * @brief Build the key of a channel
+     *
+     * @param nameHandle Distinguishes channels named by the payload, e.g. NAMED_VALUE_FLOAT, see internName()
+     * @param element Index of an array element plus one, 0 for single values
+     * @param qualified True if the name carries the component ID because several components send the message
+     */
+    static quint64 key(quint8 systemId, quint8 componentId, quint8 msgid, quint8 fieldid, quint16 nameHandle, quint16 element, bool qualified) {
+        return (static_cast<quint64>(systemId) << 56) |
+               (static_cast<quint64>(componentId) << 48) |
+               (static_cast<quint64>(msgid) << 40) |
+               (static_cast<quint64>(fieldid) << 32) |
+               (static_cast<quint64>(qualified ? 1 : 0) << 31) |
+               (static_cast<quint64>(nameHandle & 0x7FFF) << 16) |
+               element;
+    }
+    /** @brief Get the name handle of a key */
+    static quint16 nameHandle(quint64 key) {
+        return (key >> 16) & 0x7FFF;
+    }
+
+    /** @brief Get the ID of a key, -1 if the channel is not registered yet */
+    int find(quint64 key) const;
+    /** @brief Get the ID of a channel name, -1 if the name is unknown */
+    int find(const QString& name) const;
+    /** @brief Register a channel, returns the existing ID if the key or name is known */
+    int add(quint64 key, const QString& name, const QString& unit, int uasId);
+    /** @brief Register a channel without key, e.g. a value computed by a system, returns the existing ID if the name is known */
+    int add(const QString& name, const QString& unit, int uasId);
+    /** @brief Get a small number for a name sent in the payload, 1..32767, or noNameHandle once all are used */
+    quint16 internName(const char* name, int length);
+
+    static const quint16 noNameHandle = 0; ///< The name could not be interned, the channel has to be added by name
+
+    QString getName(int id) const;
+    QString getUnit(int id) const;
+    int getUASId(int id) const;
+    /** @brief Get the number of registered channels, IDs range from 0 to count - 1 */
+    int count() const;
+
+protected:
+    MAVLinkChannelRegistry();
+
+    struct Channel
+    {
+        QString name;
+        QString unit;
+        int uasId;
+    };
+
+    /** @brief Get the ID of a name or add a new channel, the lock has to be held for writing */
+    int addName(const QString& name, const QString& unit, int uasId);
+
+    mutable QReadWriteLock lock;
+    QHash<quint64, int> keys;           ///< Channel ID per key
+    QHash<QString, int> names;          ///< Channel ID per name
+    QVector<Channel> channels;          ///< Channel properties by ID
+    QHash<QByteArray, quint16> payloadNames; ///< Handles of names sent in the payload
+
+private:
+    Q_DISABLE_COPY(MAVLinkChannelRegistry)
+};
+
+#endif // MAVLINKCHANNELREGISTRY_H
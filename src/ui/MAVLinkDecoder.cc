@@ -6,7 +6,6 @@ MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol, QObject *parent) :
 {
     mavlink_message_info_t msg[256] = MAVLINK_MESSAGE_INFO;
     memcpy(messageInfo, msg, sizeof(mavlink_message_info_t)*256);
-    memset(receivedMessages, 0, sizeof(mavlink_message_t)*256);
     for (unsigned int i = 0; i<255;++i)
     {
         componentID[i] = -1;
@@ -39,14 +38,98 @@ MAVLinkDecoder::MAVLinkDecoder(MAVLinkProtocol* protocol, QObject *parent) :
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, false);
     textMessageFilter.insert(MAVLINK_MSG_ID_NAMED_VALUE_INT, false);
 
-    connect(protocol, SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)), this, SLOT(receiveMessage(LinkInterface*,mavlink_message_t)));
+    // Text fields go to the console even if nobody plots the message
+    for (int i = 0; i < 256; ++i)
+    {
+        textFields[i] = 0;
+        if (messageFilter.contains(i) || textMessageFilter.contains(i)) continue;
+        for (unsigned int j = 0; j < messageInfo[i].num_fields && j < 64; ++j)
+        {
+            if (messageInfo[i].fields[j].type == MAVLINK_TYPE_CHAR && messageInfo[i].fields[j].array_length > 0)
+            {
+                textFields[i] |= Q_UINT64_C(1) << j;
+            }
+        }
+    }
+    updateSubscriptions();
+
+    qRegisterMetaType<QGCSampleBlock>("QGCSampleBlock");
+    connect(protocol, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), this, SLOT(receiveMessage(LinkInterface*,MAVLinkMessageHandle)));
 }
 
-void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t message)
+void MAVLinkDecoder::subscribe(const QString& field)
 {
-    Q_UNUSED(link);
-    memcpy(receivedMessages+message.msgid, &message, sizeof(mavlink_message_t));
+    subscriptions.insert(field, subscriptions.value(field, 0) + 1);
+    updateSubscriptions();
+}
+
+void MAVLinkDecoder::unsubscribe(const QString& field)
+{
+    int count = subscriptions.value(field, 0) - 1;
+    if (count > 0)
+    {
+        subscriptions.insert(field, count);
+    }
+    else
+    {
+        subscriptions.remove(field);
+    }
+    updateSubscriptions();
+}
 
+/**
+ * Subscriptions change rarely, so they are resolved to one bit per field
+ * here and receiveMessage() only tests the masks. Fields beyond the 64th
+ * share the last bit.
+ */
+void MAVLinkDecoder::updateSubscriptions()
+{
+    static const int debugMessages[] = { MAVLINK_MSG_ID_DEBUG, MAVLINK_MSG_ID_DEBUG_VECT, MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, MAVLINK_MSG_ID_NAMED_VALUE_INT };
+    memcpy(subscribedFields, textFields, sizeof(subscribedFields));
+
+    foreach (QString pattern, subscriptions.keys())
+    {
+        // Strip the system and component prefixes, e.g. "M1:C200:"
+        while (pattern.length() > 1 && (pattern.at(0) == 'M' || pattern.at(0) == 'C') && pattern.at(1).isDigit() && pattern.contains(':'))
+        {
+            pattern = pattern.section(':', 1);
+        }
+
+        if (pattern == "*")
+        {
+            for (int i = 0; i < 256; ++i) subscribedFields[i] = ~Q_UINT64_C(0);
+            continue;
+        }
+
+        QString messageName = pattern.section('.', 0, 0);
+        QString fieldName = pattern.section('.', 1, 1);
+        bool known = false;
+        for (int i = 0; i < 256; ++i)
+        {
+            if (!messageInfo[i].name || messageName != messageInfo[i].name) continue;
+            known = true;
+            for (unsigned int j = 0; j < messageInfo[i].num_fields; ++j)
+            {
+                if (fieldName == "*" || fieldName.isEmpty() || fieldName == messageInfo[i].fields[j].name)
+                {
+                    subscribedFields[i] |= Q_UINT64_C(1) << qMin(j, 63U);
+                }
+            }
+        }
+        if (!known)
+        {
+            for (unsigned int i = 0; i < sizeof(debugMessages)/sizeof(debugMessages[0]); ++i)
+            {
+                subscribedFields[debugMessages[i]] = ~Q_UINT64_C(0);
+            }
+        }
+    }
+}
+
+void MAVLinkDecoder::receiveMessage(LinkInterface* link, MAVLinkMessageHandle handle)
+{
+    Q_UNUSED(link);
+    const mavlink_message_t& message = *handle;
     uint8_t msgid = message.msgid;
 
     // Handle time sync message
@@ -57,26 +140,25 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t messag
         onboardTimeOffset[message.sysid] = timebase.time_unix_usec/1000 - timebase.time_boot_ms;
         onboardToGCSUnixTimeOffsetAndDelay[message.sysid] = static_cast<qint64>(QGC::groundTimeMilliseconds() - timebase.time_unix_usec/1000);
     }
-    else
+    else if (subscribedFields[msgid])
     {
-
-        QString messageName("%1 (#%2)");
-        messageName = messageName.arg(messageInfo[msgid].name).arg(msgid);
+        const quint64 fields = subscribedFields[msgid];
+        samples.reserve(messageInfo[msgid].num_fields);
 
         // See if first value is a time value
         quint64 time = 0;
         uint8_t fieldid = 0;
-        uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
-        if (QString(messageInfo[msgid].fields[fieldid].name) == QString("time_boot_ms") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
+        const uint8_t* m = ((const uint8_t*)&message)+8;
+        if (qstrcmp(messageInfo[msgid].fields[fieldid].name, "time_boot_ms") == 0 && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT32_T)
         {
             time = *((quint32*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
         }
-        else if (QString(messageInfo[msgid].fields[fieldid].name).contains("usec") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
+        else if (messageInfo[msgid].fields[fieldid].name && strstr(messageInfo[msgid].fields[fieldid].name, "usec") && messageInfo[msgid].fields[fieldid].type == MAVLINK_TYPE_UINT64_T)
         {
             time = *((quint64*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
             time = time/1000; // Scale to milliseconds
         }
-        else
+        else if (fields & 1)
         {
             // First value is not time, send out value 0
             emitFieldValue(&message, fieldid, getUnixTimeFromMs(message.sysid, 0));
@@ -85,10 +167,17 @@ void MAVLinkDecoder::receiveMessage(LinkInterface* link,mavlink_message_t messag
         // Align time to global time
         time = getUnixTimeFromMs(message.sysid, time);
 
-        // Send out field values from 1..n
+        // Send out the subscribed field values from 1..n
         for (unsigned int i = 1; i < messageInfo[msgid].num_fields; ++i)
         {
-            emitFieldValue(&message, i, time);
+            if (fields & (Q_UINT64_C(1) << qMin(i, 63U))) emitFieldValue(&message, i, time);
+        }
+
+        // One signal carries all values of the message
+        if (!samples.isEmpty())
+        {
+            emit samplesReady(samples);
+            samples.clear();
         }
     }
 
@@ -142,10 +231,131 @@ quint64 MAVLinkDecoder::getUnixTimeFromMs(int systemID, quint64 time)
     return ret;
 }
 
-void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time)
+const MAVLinkDecoder::Channel& MAVLinkDecoder::getChannel(const mavlink_message_t* msg, int fieldid, int element, bool qualified, quint64 key)
+{
+    // A name sent in the payload without handle does not make the key unique
+    bool keyed = (msg->msgid != MAVLINK_MSG_ID_DEBUG_VECT &&
+                  msg->msgid != MAVLINK_MSG_ID_NAMED_VALUE_FLOAT &&
+                  msg->msgid != MAVLINK_MSG_ID_NAMED_VALUE_INT) ||
+                 MAVLinkChannelRegistry::nameHandle(key) != MAVLinkChannelRegistry::noNameHandle;
+    if (keyed)
+    {
+        QHash<quint64, Channel>::const_iterator it = channels.constFind(key);
+        if (it != channels.constEnd()) return it.value();
+    }
+
+    // First sample of this channel in this decoder
+    MAVLinkChannelRegistry* registry = MAVLinkChannelRegistry::instance();
+    Channel channel;
+    channel.id = keyed ? registry->find(key) : -1;
+    if (channel.id >= 0)
+    {
+        channel.name = registry->getName(channel.id);
+        channel.unit = registry->getUnit(channel.id);
+    }
+    else
+    {
+        static const char* typeNames[] = { "char", "uint8_t", "int8_t", "uint16_t", "int16_t", "uint32_t", "int32_t", "uint64_t", "int64_t", "float", "double" };
+        uint8_t msgid = msg->msgid;
+        const mavlink_field_info_t& field = messageInfo[msgid].fields[fieldid];
+        QString fieldName(field.name);
+        QString name("%1.%2");
+
+        // Debug messages are named by their payload
+        if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
+        {
+            mavlink_debug_vect_t debug;
+            mavlink_msg_debug_vect_decode(msg, &debug);
+            name = name.arg(QString::fromLatin1(debug.name, qstrnlen(debug.name, sizeof(debug.name))), fieldName);
+        }
+        else if (msgid == MAVLINK_MSG_ID_DEBUG)
+        {
+            mavlink_debug_t debug;
+            mavlink_msg_debug_decode(msg, &debug);
+            name = name.arg(QString("debug")).arg(debug.ind);
+        }
+        else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
+        {
+            mavlink_named_value_float_t debug;
+            mavlink_msg_named_value_float_decode(msg, &debug);
+            name = name.arg(QString::fromLatin1(debug.name, qstrnlen(debug.name, sizeof(debug.name)))).arg(fieldName);
+        }
+        else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
+        {
+            mavlink_named_value_int_t debug;
+            mavlink_msg_named_value_int_decode(msg, &debug);
+            name = name.arg(QString::fromLatin1(debug.name, qstrnlen(debug.name, sizeof(debug.name)))).arg(fieldName);
+        }
+        else
+        {
+            name = name.arg(messageInfo[msgid].name, fieldName);
+        }
+
+        if (qualified) name.prepend(QString("C%1:").arg(msg->compid));
+        name.prepend(QString("M%1:").arg(msg->sysid));
+
+        QString typeName(field.type <= MAVLINK_TYPE_DOUBLE ? typeNames[field.type] : "");
+        if (element >= 0)
+        {
+            name = QString("%1.%2").arg(name).arg(element);
+            channel.unit = QString("%1[%2]").arg(typeName).arg(field.array_length);
+        }
+        else if (field.type == MAVLINK_TYPE_CHAR)
+        {
+            channel.unit = QString("char[%1]").arg(field.array_length);
+        }
+        else
+        {
+            channel.unit = typeName;
+        }
+        channel.name = name;
+        if (keyed)
+        {
+            channel.id = registry->add(key, channel.name, channel.unit, msg->sysid);
+        }
+        else
+        {
+            channel.id = registry->add(channel.name, channel.unit, msg->sysid);
+        }
+        // Keys sharing a name share the ID and therefore also the unit of the first key
+        channel.unit = registry->getUnit(channel.id);
+    }
+    if (!keyed)
+    {
+        // Formatted again for every sample, only happens after 32767 distinct payload names
+        unkeyedChannel = channel;
+        return unkeyedChannel;
+    }
+    return channels.insert(key, channel).value();
+}
+
+template<typename T>
+void MAVLinkDecoder::emitNumericField(const mavlink_message_t* msg, int fieldid, quint64 key, bool qualified, quint64 time)
+{
+    const mavlink_field_info_t& field = messageInfo[msg->msgid].fields[fieldid];
+    const T* values = reinterpret_cast<const T*>(((const uint8_t*)msg)+8+field.wire_offset);
+    if (field.array_length > 0)
+    {
+        for (unsigned int j = 0; j < field.array_length; ++j)
+        {
+            samples.append(QGCSample(getChannel(msg, fieldid, j, qualified, key + j + 1).id, values[j], time));
+        }
+    }
+    else
+    {
+        // Single value
+        samples.append(QGCSample(getChannel(msg, fieldid, -1, qualified, key).id, values[0], time));
+    }
+}
+
+/**
+ * Names and units are looked up by an integer key built from the message
+ * header, so after the first sample of a field no strings are formatted.
+ * The value is added to the sample block of the current message.
+ */
+void MAVLinkDecoder::emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time)
 {
     bool multiComponentSourceDetected = false;
-    bool wrongComponent = false;
 
     // Store component ID
     if (componentID[msg->msgid] == -1)
@@ -158,255 +368,99 @@ void MAVLinkDecoder::emitFieldValue(mavlink_message_t* msg, int fieldid, quint64
         if (componentID[msg->msgid] != msg->compid)
         {
             componentMulti[msg->msgid] = true;
-            wrongComponent = true;
         }
     }
 
     if (componentMulti[msg->msgid] == true) multiComponentSourceDetected = true;
 
-    // Add field tree widget item
     uint8_t msgid = msg->msgid;
     if (messageFilter.contains(msgid)) return;
-    QString fieldName(messageInfo[msgid].fields[fieldid].name);
-    QString fieldType;
-    uint8_t* m = ((uint8_t*)(receivedMessages+msgid))+8;
-    QString name("%1.%2");
-    QString unit("");
+    const mavlink_field_info_t& field = messageInfo[msgid].fields[fieldid];
+    const uint8_t* m = ((const uint8_t*)msg)+8;
+    quint16 nameHandle = 0;
 
-    // Debug vector messages
+    // Debug messages carry their name and time in the payload
     if (msgid == MAVLINK_MSG_ID_DEBUG_VECT)
     {
         mavlink_debug_vect_t debug;
         mavlink_msg_debug_vect_decode(msg, &debug);
-        name = name.arg(QString(debug.name), fieldName);
+        nameHandle = MAVLinkChannelRegistry::instance()->internName(debug.name, qstrnlen(debug.name, sizeof(debug.name)));
         time = debug.time_usec / 1000;
     }
     else if (msgid == MAVLINK_MSG_ID_DEBUG)
     {
         mavlink_debug_t debug;
         mavlink_msg_debug_decode(msg, &debug);
-        name = name.arg(QString("debug")).arg(debug.ind);
+        nameHandle = debug.ind;
         time = debug.time_boot_ms;
     }
     else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_FLOAT)
     {
         mavlink_named_value_float_t debug;
         mavlink_msg_named_value_float_decode(msg, &debug);
-        name = name.arg(debug.name).arg(fieldName);
+        nameHandle = MAVLinkChannelRegistry::instance()->internName(debug.name, qstrnlen(debug.name, sizeof(debug.name)));
         time = debug.time_boot_ms;
     }
     else if (msgid == MAVLINK_MSG_ID_NAMED_VALUE_INT)
     {
         mavlink_named_value_int_t debug;
         mavlink_msg_named_value_int_decode(msg, &debug);
-        name = name.arg(debug.name).arg(fieldName);
+        nameHandle = MAVLinkChannelRegistry::instance()->internName(debug.name, qstrnlen(debug.name, sizeof(debug.name)));
         time = debug.time_boot_ms;
     }
-    else
-    {
-        name = name.arg(messageInfo[msgid].name, fieldName);
-    }
 
-    if (multiComponentSourceDetected) name.prepend(QString("C%1:").arg(msg->compid));
-    name.prepend(QString("M%1:").arg(msg->sysid));
-    switch (messageInfo[msgid].fields[fieldid].type)
+    quint64 key = MAVLinkChannelRegistry::key(msg->sysid, msg->compid, msgid, fieldid, nameHandle, 0, multiComponentSourceDetected);
+
+    switch (field.type)
     {
     case MAVLINK_TYPE_CHAR:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
+        if (field.array_length > 0)
         {
-            char* str = (char*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            // Enforce null termination
-            str[messageInfo[msgid].fields[fieldid].array_length-1] = '\0';
-            QString string(name + ": " + str);
-            if (!textMessageFilter.contains(msgid)) emit textMessageReceived(msg->sysid, msg->compid, 0, string);
+            // The message is shared, read at most up to the last
+            // character instead of enforcing the null termination
+            const char* str = (const char*)(m+field.wire_offset);
+            if (!textMessageFilter.contains(msgid))
+            {
+                const Channel& channel = getChannel(msg, fieldid, -1, multiComponentSourceDetected, key);
+                emit textMessageReceived(msg->sysid, msg->compid, 0, channel.name + ": " + QString::fromAscii(str, qstrnlen(str, field.array_length-1)));
+            }
         }
         else
         {
             // Single char
-            char b = *((char*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            unit = QString("char[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            emit valueChanged(msg->sysid, name, unit, b, time);
+            qint8 b = *((const qint8*)(m+field.wire_offset));
+            samples.append(QGCSample(getChannel(msg, fieldid, -1, multiComponentSourceDetected, key).id, b, time));
         }
         break;
     case MAVLINK_TYPE_UINT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint8_t* nums = m+messageInfo[msgid].fields[fieldid].wire_offset;
-            fieldType = QString("uint8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[fieldid].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint8_t u = *(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = "uint8_t";
-            emit valueChanged(msg->sysid, name, fieldType, u, time);
-        }
+        emitNumericField<quint8>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_INT8_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int8_t* nums = (int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int8_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int8_t n = *((int8_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int8_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
+        emitNumericField<qint8>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_UINT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint16_t* nums = (uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint16_t n = *((uint16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
+        emitNumericField<quint16>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_INT16_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int16_t* nums = (int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int16_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int16_t n = *((int16_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int16_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
+        emitNumericField<qint16>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_UINT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint32_t* nums = (uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            float n = *((uint32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
+        emitNumericField<quint32>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_INT32_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int32_t* nums = (int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int32_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int32_t n = *((int32_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int32_t";
-            emit valueChanged(msg->sysid, name, fieldType, n, time);
-        }
+        emitNumericField<qint32>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_FLOAT:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            float* nums = (float*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("float[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            float f = *((float*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "float";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
+        emitNumericField<float>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_DOUBLE:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            double* nums = (double*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("double[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            double f = *((double*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "double";
-            emit valueChanged(msg->sysid, name, fieldType, f, time);
-        }
+        emitNumericField<double>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_UINT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            uint64_t* nums = (uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("uint64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (quint64) nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            uint64_t n = *((uint64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "uint64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (quint64) n, time);
-        }
+        emitNumericField<quint64>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     case MAVLINK_TYPE_INT64_T:
-        if (messageInfo[msgid].fields[fieldid].array_length > 0)
-        {
-            int64_t* nums = (int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset);
-            fieldType = QString("int64_t[%1]").arg(messageInfo[msgid].fields[fieldid].array_length);
-            for (unsigned int j = 0; j < messageInfo[msgid].fields[j].array_length; ++j)
-            {
-                emit valueChanged(msg->sysid, QString("%1.%2").arg(name).arg(j), fieldType, (qint64) nums[j], time);
-            }
-        }
-        else
-        {
-            // Single value
-            int64_t n = *((int64_t*)(m+messageInfo[msgid].fields[fieldid].wire_offset));
-            fieldType = "int64_t";
-            emit valueChanged(msg->sysid, name, fieldType, (qint64) n, time);
-        }
+        emitNumericField<qint64>(msg, fieldid, key, multiComponentSourceDetected, time);
         break;
     }
 }
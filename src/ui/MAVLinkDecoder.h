@@ -2,7 +2,10 @@
 #define MAVLINKDECODER_H
 
 #include <QObject>
+#include <QHash>
 #include "MAVLinkProtocol.h"
+#include "MAVLinkChannelRegistry.h"
+#include "QGCSampleBlock.h"
 
 class MAVLinkDecoder : public QObject
 {
@@ -10,29 +13,50 @@ class MAVLinkDecoder : public QObject
 public:
     MAVLinkDecoder(MAVLinkProtocol* protocol, QObject *parent = 0);
 
+    /**
+     * @brief Request the values of a field
+     *
+     * Only subscribed fields are decoded and emitted. The field is given as
+     * "ATTITUDE.roll", "ATTITUDE.*" for all fields of a message or "*" for
+     * all messages, a leading system and component prefix is ignored.
+     * Fields of debug messages are named by their payload, a name which is
+     * no known message subscribes all debug messages. Subscriptions are
+     * counted, every call needs a matching unsubscribe().
+     */
+    void subscribe(const QString& field);
+    /** @brief Release a subscription made with subscribe() */
+    void unsubscribe(const QString& field);
+
 signals:
     void textMessageReceived(int uasid, int componentid, int severity, const QString& text);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint8 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint8 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint16 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint16 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint32 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint32 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint64 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint64 value, const quint64 msec);
-    void valueChanged(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec);
+    /** @brief Values of the subscribed fields of one message, see MAVLinkChannelRegistry for the channel names */
+    void samplesReady(QGCSampleBlock samples);
 	
 
 public slots:
-    /** @brief Receive one message from the protocol and decode it */
-    void receiveMessage(LinkInterface* link,mavlink_message_t message);
+    /** @brief Receive one message from the protocol and decode it, the message is read in place */
+    void receiveMessage(LinkInterface* link, MAVLinkMessageHandle handle);
 protected:
     /** @brief Emit the value of one message field */
-    void emitFieldValue(mavlink_message_t* msg, int fieldid, quint64 time);
+    void emitFieldValue(const mavlink_message_t* msg, int fieldid, quint64 time);
+    /** @brief Emit the values of one field of a numeric type */
+    template<typename T> void emitNumericField(const mavlink_message_t* msg, int fieldid, quint64 key, bool qualified, quint64 time);
     /** @brief Shift a timestamp in Unix time if necessary */
     quint64 getUnixTimeFromMs(int systemID, quint64 time);
+    /** @brief Rebuild the field masks from the subscriptions */
+    void updateSubscriptions();
+
+    /** @brief Name, unit and ID of a channel */
+    struct Channel
+    {
+        int id;
+        QString name;
+        QString unit;
+    };
+    /** @brief Get the channel of a field element, its name is only formatted the first time */
+    const Channel& getChannel(const mavlink_message_t* msg, int fieldid, int element, bool qualified, quint64 key);
+    Channel unkeyedChannel; ///< Last channel of a payload name without handle, not cached
 
-    mavlink_message_t receivedMessages[256]; ///< Available / known messages
     mavlink_message_info_t messageInfo[256]; ///< Message information
     QMap<uint16_t, bool> messageFilter;               ///< Message/field names not to emit
     QMap<uint16_t, bool> textMessageFilter;           ///< Message/field names not to emit in text mode
@@ -41,6 +65,11 @@ protected:
     quint64 onboardTimeOffset[256];                   ///< Offset of onboard time from Unix epoch (of the receiving GCS)
     qint64 onboardToGCSUnixTimeOffsetAndDelay[256];   ///< Offset of onboard time and GCS Unix time
     quint64 firstOnboardTime[256];                    ///< First seen onboard time
+    QHash<quint64, Channel> channels;                 ///< Channels seen by this decoder, by registry key
+    QGCSampleBlock samples;                           ///< Samples of the message being decoded
+    QHash<QString, int> subscriptions;                ///< Subscription count per field pattern
+    quint64 subscribedFields[256];                    ///< Bit mask of the fields to decode per message
+    quint64 textFields[256];                          ///< Bit mask of the text fields always sent to the console
 
 };
 
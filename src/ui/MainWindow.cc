@@ -54,6 +54,7 @@ This file is part of the QGROUNDCONTROL project
 #include "QGCMAVLinkMessageSender.h"
 #include "QGCRGBDView.h"
 #include "QGCFirmwareUpdate.h"
+#include "QGCFrameScheduler.h"
 
 #ifdef QGC_OSG_ENABLED
 #include "Q3DWidgetFactory.h"
@@ -337,6 +338,8 @@ void MainWindow::buildCommonWidgets()
     //TODO:  move protocol outside UI
     mavlink     = new MAVLinkProtocol();
     connect(mavlink, SIGNAL(protocolStatusMessage(QString,QString)), this, SLOT(showCriticalMessage(QString,QString)), Qt::QueuedConnection);
+    connect(mavlink, SIGNAL(receiveErrorsChanged(int,int)), this, SLOT(showReceiveErrors(int,int)));
+    connect(mavlink, SIGNAL(logRecordsDropped(QString,int,int)), this, SLOT(showLogRecordsDropped(QString,int,int)));
     // Add generic MAVLink decoder
     mavlinkDecoder = new MAVLinkDecoder(mavlink, this);
 
@@ -822,6 +825,12 @@ void MainWindow::enableAutoReconnect(bool enabled)
     autoReconnect = enabled;
 }
 
+void MainWindow::enableLowPowerMode(bool enabled)
+{
+    lowPowerMode = enabled;
+    QGCFrameScheduler::instance()->setMaxFrameRate(enabled ? 10 : 25);
+}
+
 void MainWindow::loadNativeStyle()
 {
     loadStyle(QGC_MAINWINDOW_STYLE_NATIVE);
@@ -935,6 +944,25 @@ void MainWindow::showStatusMessage(const QString& status)
     statusBar()->showMessage(status, 20000);
 }
 
+/**
+ * @param droppedBytes Bytes dropped since startup because parsing did not keep up
+ * @param parseErrors Corrupt frames received since startup
+ */
+void MainWindow::showReceiveErrors(int droppedBytes, int parseErrors)
+{
+    showStatusMessage(tr("MAVLink receive errors: %1 bytes dropped, %2 corrupt packets").arg(droppedBytes).arg(parseErrors));
+}
+
+/**
+ * @param fileName The MAVLink logfile
+ * @param dropped Records dropped since the logfile was opened
+ * @param peakFill Highest fill of the log queue in bytes
+ */
+void MainWindow::showLogRecordsDropped(const QString& fileName, int dropped, int peakFill)
+{
+    showStatusMessage(tr("MAVLink log %1 dropped %2 packets, the disk did not keep up (peak queue fill %3 KB)").arg(fileName).arg(dropped).arg(peakFill / 1024));
+}
+
 void MainWindow::showCriticalMessage(const QString& title, const QString& message)
 {
     QMessageBox msgBox(this);
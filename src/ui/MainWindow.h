@@ -127,6 +127,10 @@ public slots:
     void showCriticalMessage(const QString& title, const QString& message);
     /** @brief Shows an info message as popup or as widget */
     void showInfoMessage(const QString& title, const QString& message);
+    /** @brief Shows the receive error counts of the protocol on the status bar */
+    void showReceiveErrors(int droppedBytes, int parseErrors);
+    /** @brief Shows the records dropped by the MAVLink logger on the status bar */
+    void showLogRecordsDropped(const QString& fileName, int dropped, int peakFill);
 
     /** @brief Show the application settings */
     void showSettings();
@@ -172,7 +176,7 @@ public slots:
     /** @brief Automatically reconnect last link */
     void enableAutoReconnect(bool enabled);
     /** @brief Save power by reducing update rates */
-    void enableLowPowerMode(bool enabled) { lowPowerMode = enabled; }
+    void enableLowPowerMode(bool enabled);
     /** @brief Switch to native application style */
     void loadNativeStyle();
     /** @brief Switch to indoor mission style */
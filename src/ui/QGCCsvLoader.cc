@@ -0,0 +1,443 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of QGCCsvLoader
+ *
+ */
+
+#include <QFile>
+#include <QList>
+#include <string.h>
+#include <cmath>
+#include "QGCCsvLoader.h"
+
+namespace
+{
+/** @brief Exactly representable powers of ten */
+const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/** @brief Whitespace as removed by QString::trimmed() from ASCII text */
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/** @brief Find the next separator in a line, the end of the line if there is none */
+const char* findSeparator(const char* p, const char* end, const QByteArray& separator)
+{
+    const int length = separator.size();
+    if (length == 0) return end;
+    while (end - p >= length)
+    {
+        const char* hit = static_cast<const char*>(memchr(p, separator.at(0), end - p - length + 1));
+        if (!hit) break;
+        if (memcmp(hit + 1, separator.constData() + 1, length - 1) == 0) return hit;
+        p = hit + 1;
+    }
+    return end;
+}
+
+/** @brief Find the last line break of a piece of the log */
+const char* findLastLineBreak(const char* data, qint64 length)
+{
+    for (const char* p = data + length; p > data; --p)
+    {
+        if (p[-1] == '\n') return p - 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Parses one chunk of whole lines of the log into a block
+ */
+class CsvChunk : public QThread
+{
+public:
+    CsvChunk(const char* begin, const char* end, const QByteArray& separator, int xColumn,
+             const QVector<int>& columns, const QVector<int>& curves, int curveCount) :
+        begin(begin),
+        end(end),
+        separator(separator),
+        xColumn(xColumn),
+        columns(columns),
+        curves(curves),
+        block(new QGCCsvLoader::Block)
+    {
+        block->x.resize(curveCount);
+        block->y.resize(curveCount);
+        block->progress = 0;
+    }
+
+    ~CsvChunk()
+    {
+        delete block;
+    }
+
+    /** @brief Take the parsed values, NULL if the chunk contained none */
+    QGCCsvLoader::Block* takeBlock()
+    {
+        QGCCsvLoader::Block* result = NULL;
+        for (int i = 0; i < block->x.size(); ++i)
+        {
+            if (!block->x.at(i).isEmpty())
+            {
+                result = block;
+                block = NULL;
+                break;
+            }
+        }
+        return result;
+    }
+
+protected:
+    void run();
+
+    const char* begin;
+    const char* end;
+    QByteArray separator;
+    int xColumn;
+    QVector<int> columns;
+    QVector<int> curves;
+    QGCCsvLoader::Block* block;
+};
+
+void CsvChunk::run()
+{
+    // Only the fields up to the last plotted one are split
+    int fieldCount = xColumn + 1;
+    foreach (int column, columns)
+    {
+        fieldCount = qMax(fieldCount, column + 1);
+    }
+    QVector<const char*> fieldBegin(fieldCount);
+    QVector<const char*> fieldEnd(fieldCount);
+
+    const char* p = begin;
+    while (p < end)
+    {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (!eol) eol = end;
+        const char* lineEnd = eol;
+        if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+
+        // Empty fields count, like in QString::split() with KeepEmptyParts
+        int fields = 0;
+        const char* field = p;
+        while (fields < fieldCount)
+        {
+            const char* next = findSeparator(field, lineEnd, separator);
+            fieldBegin[fields] = field;
+            fieldEnd[fields] = next;
+            fields++;
+            if (next == lineEnd) break;
+            field = next + separator.size();
+        }
+        p = eol + 1;
+
+        double x;
+        if (fields <= xColumn || !QGCCsvLoader::parseValue(fieldBegin.at(xColumn), fieldEnd.at(xColumn), &x) || isnan(x) || isinf(x))
+        {
+            continue;
+        }
+
+        for (int i = 0; i < columns.size(); ++i)
+        {
+            const int column = columns.at(i);
+            double y;
+            // Only INF is really an issue for the plot, but NaN is skipped as well
+            if (fields > column && QGCCsvLoader::parseValue(fieldBegin.at(column), fieldEnd.at(column), &y) && !isnan(y) && !isinf(y))
+            {
+                block->x[curves.at(i)].append(x);
+                block->y[curves.at(i)].append(y);
+            }
+        }
+    }
+}
+}
+
+QGCCsvLoader::QGCCsvLoader(QObject* parent) :
+    QThread(parent),
+    offset(0),
+    xColumn(-1),
+    curveCount(0),
+    chunkSize(defaultChunkSize),
+    running(false),
+    done(true)
+{
+}
+
+QGCCsvLoader::~QGCCsvLoader()
+{
+    stop();
+    qDeleteAll(blocks);
+}
+
+void QGCCsvLoader::load(const QString& fileName, qint64 offset, const QByteArray& separator, int xColumn, const QVector<int>& columns, const QVector<int>& curves)
+{
+    stop();
+
+    this->fileName = fileName;
+    this->offset = offset;
+    this->separator = separator;
+    this->xColumn = xColumn;
+    this->columns = columns;
+    this->curves = curves;
+    curveCount = 0;
+    foreach (int curve, curves)
+    {
+        curveCount = qMax(curveCount, curve + 1);
+    }
+
+    blockLock.lock();
+    qDeleteAll(blocks);
+    blocks.clear();
+    done = false;
+    blockLock.unlock();
+
+    running = true;
+    start();
+}
+
+void QGCCsvLoader::stop()
+{
+    running = false;
+    wait();
+}
+
+QGCCsvLoader::Block* QGCCsvLoader::takeBlock()
+{
+    QMutexLocker locker(&blockLock);
+    return blocks.isEmpty() ? NULL : blocks.dequeue();
+}
+
+bool QGCCsvLoader::isDone()
+{
+    QMutexLocker locker(&blockLock);
+    return done;
+}
+
+void QGCCsvLoader::queueBlock(Block* block)
+{
+    QMutexLocker locker(&blockLock);
+    blocks.enqueue(block);
+}
+
+/**
+ * Plain decimal numbers with up to 19 significant digits, a mantissa below
+ * 2^53 and a decimal exponent within +-22 are converted directly, because
+ * both the mantissa and the power of ten are exact doubles and the result
+ * of one multiplication or division is correctly rounded. Everything else
+ * is converted by QString::toDouble(), which yields the same result for
+ * the fast cases.
+ */
+bool QGCCsvLoader::parseValue(const char* begin, const char* end, double* value)
+{
+    while (begin < end && isSpace(*begin)) begin++;
+    while (end > begin && isSpace(end[-1])) end--;
+    if (begin == end) return false;
+
+    const char* p = begin;
+    bool negative = false;
+    if (*p == '+' || *p == '-')
+    {
+        negative = (*p == '-');
+        p++;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool valid = false;
+    bool exact = true;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+        valid = true;
+        if (mantissa == 0 && *p == '0') continue;
+        if (digits++ < 19) mantissa = mantissa * 10 + (*p - '0');
+        else exact = false;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            valid = true;
+            exponent--;
+            if (mantissa == 0 && *p == '0') continue;
+            if (digits++ < 19) mantissa = mantissa * 10 + (*p - '0');
+            else exact = false;
+        }
+    }
+    if (valid && p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '+' || *p == '-'))
+        {
+            negativeExponent = (*p == '-');
+            p++;
+        }
+        int e = 0;
+        int exponentDigits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            if (++exponentDigits > 4) exact = false;
+            else e = e * 10 + (*p - '0');
+        }
+        if (exponentDigits == 0) valid = false;
+        if (exact) exponent += negativeExponent ? -e : e;
+    }
+
+    if (valid && exact && p == end)
+    {
+        if (mantissa == 0)
+        {
+            *value = negative ? -0.0 : 0.0;
+            return true;
+        }
+        if (mantissa <= (Q_UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22)
+        {
+            double result = static_cast<double>(mantissa);
+            if (exponent < 0) result /= powersOfTen[-exponent];
+            else result *= powersOfTen[exponent];
+            *value = negative ? -result : result;
+            return true;
+        }
+    }
+
+    // Other notations, long numbers and non-ASCII text
+    const QString text = QString::fromLocal8Bit(begin, end - begin).trimmed();
+    if (text.isEmpty()) return false;
+    bool ok;
+    *value = text.toDouble(&ok);
+    return ok;
+}
+
+/**
+ * The log is processed in windows of whole lines of one chunk per worker
+ * thread, so only one window is mapped at a time, also for logs larger
+ * than the address space. The blocks of a window are queued once all of
+ * its chunks are parsed.
+ */
+void QGCCsvLoader::run()
+{
+    QFile file(fileName);
+    if (xColumn >= 0 && curveCount > 0 && file.open(QIODevice::ReadOnly))
+    {
+        const qint64 size = file.size();
+        const int workers = qBound(1, QThread::idealThreadCount(), static_cast<int>(maxWorkers));
+        qint64 position = offset;
+
+        while (running && position < size)
+        {
+            // Map the next window, grow it until it contains a line break
+            qint64 windowSize = qMin(size - position, static_cast<qint64>(workers) * chunkSize);
+            qint64 windowEnd = 0;
+            uchar* mapped = NULL;
+            QByteArray buffer;
+            const char* data = NULL;
+            forever
+            {
+                mapped = file.map(position, windowSize);
+                if (mapped)
+                {
+                    data = reinterpret_cast<const char*>(mapped);
+                }
+                else
+                {
+                    // Fall back to reading the window if mapping is not possible
+                    file.seek(position);
+                    buffer = file.read(windowSize);
+                    data = (buffer.size() == windowSize) ? buffer.constData() : NULL;
+                }
+                if (!data) break;
+
+                const char* lineBreak = findLastLineBreak(data, windowSize);
+                if (position + windowSize == size)
+                {
+                    windowEnd = windowSize;
+                    break;
+                }
+                if (lineBreak)
+                {
+                    windowEnd = lineBreak - data + 1;
+                    break;
+                }
+                if (mapped) file.unmap(mapped);
+                windowSize = qMin(size - position, windowSize * 2);
+            }
+            if (!data) break;
+
+            // Split the window into chunks of whole lines and parse them in parallel
+            const int chunkCount = static_cast<int>(qBound(Q_INT64_C(1), windowEnd / qMax(1, chunkSize), static_cast<qint64>(workers)));
+            QList<CsvChunk*> chunks;
+            QList<qint64> chunkEnds;
+            qint64 chunkBegin = 0;
+            for (int i = 0; i < chunkCount; ++i)
+            {
+                qint64 chunkEnd = (i == chunkCount - 1) ? windowEnd : windowEnd * (i + 1) / chunkCount;
+                if (chunkEnd < chunkBegin) chunkEnd = chunkBegin;
+                if (chunkEnd < windowEnd)
+                {
+                    const char* eol = static_cast<const char*>(memchr(data + chunkEnd, '\n', windowEnd - chunkEnd));
+                    chunkEnd = eol ? (eol - data + 1) : windowEnd;
+                }
+                chunks.append(new CsvChunk(data + chunkBegin, data + chunkEnd, separator, xColumn, columns, curves, curveCount));
+                chunkEnds.append(chunkEnd);
+                chunkBegin = chunkEnd;
+            }
+            foreach (CsvChunk* chunk, chunks)
+            {
+                chunk->start();
+            }
+            foreach (CsvChunk* chunk, chunks)
+            {
+                chunk->wait();
+            }
+
+            for (int i = 0; i < chunks.size(); ++i)
+            {
+                Block* block = chunks.at(i)->takeBlock();
+                if (block)
+                {
+                    block->progress = static_cast<int>((position + chunkEnds.at(i)) * 100 / size);
+                    queueBlock(block);
+                }
+            }
+            qDeleteAll(chunks);
+            if (mapped) file.unmap(mapped);
+
+            position += windowEnd;
+            emit blocksLoaded();
+        }
+    }
+
+    blockLock.lock();
+    done = true;
+    blockLock.unlock();
+    emit blocksLoaded();
+}
@@ -0,0 +1,120 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Parallel loader of the numeric columns of CSV logs
+ *
+ */
+
+#ifndef QGCCSVLOADER_H
+#define QGCCSVLOADER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QQueue>
+#include <QVector>
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief Loads the curves of a CSV log in the background
+ *
+ * The log is mapped in windows of whole lines, each window is split into
+ * chunks which are parsed in parallel. Only the x column and the selected
+ * y columns of each line are converted. The values of every chunk are
+ * queued as one block of contiguous arrays per curve, in the order of the
+ * file, so the plot can display them while the rest is still loading.
+ *
+ * A value is accepted under the same conditions as in the former text
+ * stream based loader: QString::trimmed().toDouble() succeeds, and the
+ * result is neither NaN nor infinite. Lines without a valid x value are
+ * skipped.
+ */
+class QGCCsvLoader : public QThread
+{
+    Q_OBJECT
+public:
+    /** @brief Values parsed from one chunk of the log */
+    struct Block
+    {
+        QVector<QVector<double> > x;  ///< X values by curve
+        QVector<QVector<double> > y;  ///< Y values by curve
+        int progress;                 ///< Percentage of the log loaded up to this block
+    };
+
+    QGCCsvLoader(QObject* parent = 0);
+    ~QGCCsvLoader();
+
+    /**
+     * @brief Start loading a log
+     *
+     * @param fileName Log to load
+     * @param offset Offset of the first data line, after the header
+     * @param separator Separator of the fields of a line
+     * @param xColumn Field of the x value, the log is not loaded if negative
+     * @param columns Field of each plotted y value
+     * @param curves Curve of each plotted y value, the same curve can be filled from several entries
+     */
+    void load(const QString& fileName, qint64 offset, const QByteArray& separator, int xColumn, const QVector<int>& columns, const QVector<int>& curves);
+    /** @brief Stop loading and wait for the worker threads */
+    void stop();
+    /** @brief Take the next loaded block, NULL if there is none. The caller owns the block */
+    Block* takeBlock();
+    /** @brief Check if all blocks of the log have been queued */
+    bool isDone();
+    /** @brief Set the size of the chunks parsed by one worker thread */
+    void setChunkSize(int bytes) {
+        chunkSize = bytes;
+    }
+
+    /** @brief Parse a field like QString::trimmed().toDouble(), empty fields are invalid */
+    static bool parseValue(const char* begin, const char* end, double* value);
+
+    static const int maxWorkers = 8;                ///< Maximum number of threads parsing the log
+    static const int defaultChunkSize = 4*1024*1024; ///< Bytes parsed by one thread per block
+
+signals:
+    /** @brief Emitted whenever blocks can be taken, and once more after the last block */
+    void blocksLoaded();
+
+protected:
+    void run();
+    /** @brief Queue a block for the GUI thread */
+    void queueBlock(Block* block);
+
+    QString fileName;
+    qint64 offset;
+    QByteArray separator;
+    int xColumn;
+    QVector<int> columns;
+    QVector<int> curves;
+    int curveCount;
+    int chunkSize;
+    volatile bool running;
+    bool done;
+    QMutex blockLock;      ///< Protects blocks and done
+    QQueue<Block*> blocks; ///< Loaded blocks in the order of the log
+};
+
+#endif // QGCCSVLOADER_H
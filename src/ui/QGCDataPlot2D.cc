@@ -49,6 +49,9 @@ QGCDataPlot2D::QGCDataPlot2D(QWidget *parent) :
     QWidget(parent),
     plot(new IncrementalPlot()),
     logFile(NULL),
+    csvLoader(new QGCCsvLoader(this)),
+    csvLoading(false),
+    csvRedrawInterval(250),
     ui(new Ui::QGCDataPlot2D)
 {
     ui->setupUi(this);
@@ -70,6 +73,7 @@ QGCDataPlot2D::QGCDataPlot2D(QWidget *parent) :
     connect(ui->gridCheckBox, SIGNAL(clicked(bool)), plot, SLOT(showGrid(bool)));
     connect(ui->regressionButton, SIGNAL(clicked()), this, SLOT(calculateRegression()));
     connect(ui->style, SIGNAL(currentIndexChanged(QString)), plot, SLOT(setStyleText(QString)));
+    connect(csvLoader, SIGNAL(blocksLoaded()), this, SLOT(appendCsvData()));
 }
 
 void QGCDataPlot2D::reloadFile()
@@ -322,7 +326,7 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
     logFile = new QFile(file);
 
     // Load CSV data
-    if (!logFile->open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!logFile->open(QIODevice::ReadOnly))
         return;
 
     // Set plot title
@@ -332,12 +336,13 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
 
     // Extract header
 
-    // Read in values
-    // Find all keys
-    QTextStream in(logFile);
-
-    // First line is header
-    QString header = in.readLine();
+    // First line is header, the values are loaded in the background
+    QByteArray headerLine = logFile->readLine();
+    const qint64 dataOffset = logFile->pos();
+    if (headerLine.startsWith("\xEF\xBB\xBF")) headerLine.remove(0, 3);
+    if (headerLine.endsWith('\n')) headerLine.chop(1);
+    if (headerLine.endsWith('\r')) headerLine.chop(1);
+    QString header = QString::fromLocal8Bit(headerLine);
 
     bool charRead = false;
     QString separator = "";
@@ -369,14 +374,15 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
 
     QString out = separator;
     out.replace("\t", "<tab>");
-    ui->filenameLabel->setText(file.split("/").last().split("\\").last()+" Separator: \""+out+"\"");
+    csvLabel = file.split("/").last().split("\\").last()+" Separator: \""+out+"\"";
+    ui->filenameLabel->setText(csvLabel);
     //qDebug() << "READING CSV:" << header;
 
     // Clear plot
+    csvLoader->stop();
     plot->removeData();
 
-    QMap<QString, QVector<double>* > xValues;
-    QMap<QString, QVector<double>* > yValues;
+    QStringList yValues;
 
     curveNames.append(header.split(separator, QString::SkipEmptyParts));
 
@@ -448,8 +454,7 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
         ui->yRegressionComboBox->addItem(curveName);
         if (curveName != xAxisFilter) {
             if ((yAxisFilter == "") || yCurves.contains(curveName)) {
-                yValues.insert(curveName, new QVector<double>());
-                xValues.insert(curveName, new QVector<double>());
+                if (!yValues.contains(curveName)) yValues.append(curveName);
                 // Add separator starting with second item
                 if (curveNameIndex > 0 && curveNameIndex < curveNames.count()) {
                     ui->yAxis->setText(ui->yAxis->text()+"|");
@@ -468,86 +473,67 @@ void QGCDataPlot2D::loadCsvLog(QString file, QString xAxisName, QString yAxisFil
     // Select current axis in UI
     ui->xAxis->setCurrentIndex(curveNames.indexOf(xAxisFilter));
 
-    // Read data
-
-    double x = 0;
-    double y = 0;
-
-    while (!in.atEnd())
-    {
-        QString line = in.readLine();
-
-        // Keep empty parts here - we still have to act on them
-        QStringList values = line.split(separator, QString::KeepEmptyParts);
-
-        bool headerfound = false;
+    // Create the curves in the order of their names, the data
+    // arrives in blocks of lines while the file is loading
+    yValues.sort();
+    csvCurves.clear();
+    foreach (const QString& key, yValues) {
+        csvCurves.append(renaming.value(key, key));
+        plot->storeData(csvCurves.last(), NULL, NULL, 0);
+    }
 
-        // First get header - ORDER MATTERS HERE!
-        foreach(curveName, curveNames)
-        {
-            if (curveName == xAxisFilter)
-            {
-                // X  AXIS HANDLING
-
-                // Take this value as x if it is selected
-                QString text = values.at(curveNames.indexOf(curveName));
-                text = text.trimmed();
-                if (text.length() > 0 && text != " " && text != "\n" && text != "\r" && text != "\t")
-                {
-                    bool okx = true;
-                    x = text.toDouble(&okx);
-                    if (okx && !isnan(x) && !isinf(x))
-                    {
-                        headerfound = true;
-                    }
-                }
-            }
+    // Columns are split like QString::split() with KeepEmptyParts
+    QVector<int> columns;
+    QVector<int> curves;
+    foreach(curveName, curveNames) {
+        // Only plot non-x curves and those selected in the yAxisFilter (or all if the filter is not set)
+        if (curveName != xAxisFilter && (yAxisFilter == "" || yCurves.contains(curveName))) {
+            columns.append(curveNames.indexOf(curveName));
+            curves.append(yValues.indexOf(curveName));
         }
+    }
 
-        if (headerfound)
-        {
-            // Search again from start for values - ORDER MATTERS HERE!
-            foreach(curveName, curveNames)
-            {
-                // Y  AXIS HANDLING
-                // Only plot non-x curver and those selected in the yAxisFilter (or all if the filter is not set)
-                if(curveName != xAxisFilter && (yAxisFilter == "" || yCurves.contains(curveName)))
-                {
-                    bool oky;
-                    int curveNameIndex = curveNames.indexOf(curveName);
-                    if (values.count() > curveNameIndex)
-                    {
-                        QString text(values.at(curveNameIndex));
-                        text = text.trimmed();
-                        y = text.toDouble(&oky);
-                        // Only INF is really an issue for the plot
-                        // NaN is fine
-                        if (oky && !isnan(y) && !isinf(y) && text.length() > 0 && text != " " && text != "\n" && text != "\r" && text != "\t")
-                        {
-                            // Only append definitely valid values
-                            xValues.value(curveName)->append(x);
-                            yValues.value(curveName)->append(y);
-                        }
-                    }
-                }
+    csvLoading = true;
+    csvRedrawTime.start();
+    csvRedrawInterval = 250;
+    csvLoader->load(file, dataOffset, separator.toLatin1(), curveNames.indexOf(xAxisFilter), columns, curves);
+}
+
+/**
+ * Takes the blocks loaded so far and adds them to the plot. While loading,
+ * the plot is redrawn at most every csvRedrawInterval milliseconds, the
+ * interval grows with the time a redraw of all loaded points takes.
+ */
+void QGCDataPlot2D::appendCsvData()
+{
+    if (!csvLoading) return;
+
+    // All blocks are queued once the loader is done
+    const bool done = csvLoader->isDone();
+    int progress = -1;
+    QGCCsvLoader::Block* block;
+    while ((block = csvLoader->takeBlock()) != NULL) {
+        for (int i = 0; i < block->x.size(); ++i) {
+            if (!block->x.at(i).isEmpty()) {
+                plot->storeData(csvCurves.at(i), block->x[i].data(), block->y[i].data(), block->x.at(i).count());
             }
         }
+        progress = block->progress;
+        delete block;
     }
 
-    // Add data array of each curve to the plot at once (fast)
-    // Iterates through all x-y curve combinations
-    for (int i = 0; i < yValues.count(); i++) {
-        if (renaming.contains(yValues.keys().at(i)))
-        {
-            plot->appendData(renaming.value(yValues.keys().at(i)), xValues.values().at(i)->data(), yValues.values().at(i)->data(), xValues.values().at(i)->count());
-        }
-        else
-        {
-            plot->appendData(yValues.keys().at(i), xValues.values().at(i)->data(), yValues.values().at(i)->data(), xValues.values().at(i)->count());
-        }
+    if (done) {
+        csvLoading = false;
+        ui->filenameLabel->setText(csvLabel);
+        plot->updateScale();
+        plot->setStyleText(ui->style->currentText());
+    } else if (progress >= 0 && csvRedrawTime.elapsed() >= csvRedrawInterval) {
+        ui->filenameLabel->setText(csvLabel + tr(" Loading: %1%").arg(progress));
+        csvRedrawTime.restart();
+        plot->updateScale();
+        csvRedrawInterval = qMax(250, 4 * csvRedrawTime.elapsed());
+        csvRedrawTime.restart();
     }
-    plot->updateScale();
-    plot->setStyleText(ui->style->currentText());
 }
 
 bool QGCDataPlot2D::calculateRegression()
@@ -568,6 +554,9 @@ bool QGCDataPlot2D::calculateRegression(QString xName, QString yName, QString me
     if (xName != yName) {
         if (QFileInfo(fileName).isReadable()) {
             loadCsvLog(fileName, xName, yName);
+            // The regression needs all values
+            csvLoader->wait();
+            appendCsvData();
             ui->xRegressionComboBox->setCurrentIndex(curveNames.indexOf(xName));
             ui->yRegressionComboBox->setCurrentIndex(curveNames.indexOf(yName));
         }
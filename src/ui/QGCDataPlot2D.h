@@ -3,8 +3,10 @@
 
 #include <QWidget>
 #include <QFile>
+#include <QTime>
 #include "IncrementalPlot.h"
 #include "LogCompressor.h"
+#include "QGCCsvLoader.h"
 
 namespace Ui
 {
@@ -45,6 +47,8 @@ public slots:
     void print();
     /** @brief Calculate and display regression function*/
     bool calculateRegression();
+    /** @brief Plot the values loaded so far from the CSV file */
+    void appendCsvData();
 
 signals:
     void visibilityChanged(bool visible);
@@ -68,6 +72,12 @@ protected:
     QFile* logFile;
     QString fileName;
     QStringList curveNames;
+    QGCCsvLoader* csvLoader;   ///< Loads the CSV file in the background
+    QStringList csvCurves;     ///< Plotted name of each curve of the loader
+    QString csvLabel;          ///< File label without loading progress
+    bool csvLoading;           ///< True until the CSV file has been plotted completely
+    QTime csvRedrawTime;       ///< Time since the last redraw while loading
+    int csvRedrawInterval;     ///< Minimum time between redraws while loading, in ms
 
 private:
     Ui::QGCDataPlot2D *ui;
@@ -0,0 +1,227 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCFrameScheduler
+ *
+ */
+
+#include <QWidget>
+#include <QEvent>
+#include <QMetaObject>
+
+#include "QGCFrameScheduler.h"
+
+QGCFrameScheduler* QGCFrameScheduler::instance()
+{
+    static QGCFrameScheduler* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new QGCFrameScheduler();
+    }
+    return _instance;
+}
+
+QGCFrameScheduler::QGCFrameScheduler() :
+    QObject(),
+    maxFrameRate(25),
+    inFrame(false)
+{
+    clock.start();
+    timer.setInterval(1000 / maxFrameRate);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(frame()));
+}
+
+void QGCFrameScheduler::add(QWidget* widget, const char* member, int interval, bool continuous)
+{
+    if (!widget || clients.contains(widget)) return;
+
+    Client* client = new Client();
+    client->widget = widget;
+    client->member = member;
+    client->interval = interval;
+    client->continuous = continuous;
+    client->dirty = true;
+    client->queued = false;
+    client->removed = false;
+    client->lastRefresh = -interval;
+    clients.insert(widget, client);
+
+    connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)));
+    widget->installEventFilter(this);
+    enqueue(client);
+}
+
+void QGCFrameScheduler::remove(QWidget* widget)
+{
+    Client* client = clients.take(widget);
+    if (!client) return;
+
+    disconnect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(widgetDestroyed(QObject*)));
+    widget->removeEventFilter(this);
+    queue.removeAll(client);
+    if (inFrame)
+    {
+        // The frame may still hold the client
+        client->removed = true;
+        removedClients.append(client);
+    }
+    else
+    {
+        delete client;
+    }
+}
+
+void QGCFrameScheduler::widgetDestroyed(QObject* object)
+{
+    // The widget part is already destroyed, only forget about it
+    Client* client = clients.take(object);
+    if (!client) return;
+
+    queue.removeAll(client);
+    if (inFrame)
+    {
+        client->removed = true;
+        removedClients.append(client);
+    }
+    else
+    {
+        delete client;
+    }
+}
+
+void QGCFrameScheduler::setInterval(QWidget* widget, int interval)
+{
+    Client* client = clients.value(widget, NULL);
+    if (client) client->interval = interval;
+}
+
+void QGCFrameScheduler::markDirty(QWidget* widget)
+{
+    Client* client = clients.value(widget, NULL);
+    if (!client) return;
+
+    client->dirty = true;
+    enqueue(client);
+}
+
+void QGCFrameScheduler::setMaxFrameRate(int rate)
+{
+    maxFrameRate = qBound(1, rate, 1000);
+    timer.setInterval(1000 / maxFrameRate);
+}
+
+QGCFrameScheduler::Statistics QGCFrameScheduler::getStatistics(QWidget* widget) const
+{
+    Client* client = clients.value(widget, NULL);
+    if (client) return client->statistics;
+    return Statistics();
+}
+
+QHash<QWidget*, QGCFrameScheduler::Statistics> QGCFrameScheduler::getStatistics() const
+{
+    QHash<QWidget*, Statistics> statistics;
+    foreach (Client* client, clients)
+    {
+        statistics.insert(client->widget, client->statistics);
+    }
+    return statistics;
+}
+
+void QGCFrameScheduler::resetStatistics()
+{
+    foreach (Client* client, clients)
+    {
+        client->statistics = Statistics();
+    }
+}
+
+void QGCFrameScheduler::enqueue(Client* client)
+{
+    if (client->queued) return;
+    client->queued = true;
+    queue.append(client);
+    if (!timer.isActive()) timer.start();
+}
+
+bool QGCFrameScheduler::eventFilter(QObject* object, QEvent* event)
+{
+    if (event->type() == QEvent::Show || event->type() == QEvent::Paint)
+    {
+        Client* client = clients.value(object, NULL);
+        if (client && !client->queued && (client->dirty || client->continuous))
+        {
+            enqueue(client);
+        }
+    }
+    return false;
+}
+
+void QGCFrameScheduler::frame()
+{
+    const qint64 now = clock.elapsed();
+
+    // Clients queued by the refresh slots are checked in the next frame
+    QList<Client*> due;
+    due.swap(queue);
+    inFrame = true;
+
+    foreach (Client* client, due)
+    {
+        if (client->removed) continue;
+        client->queued = false;
+
+        if (!client->widget->isVisible() || client->widget->visibleRegion().isEmpty())
+        {
+            // Stays dirty, the next show or paint event queues it again
+            client->statistics.skipped++;
+            continue;
+        }
+
+        if (now - client->lastRefresh < client->interval)
+        {
+            enqueue(client);
+            continue;
+        }
+
+        client->dirty = false;
+        client->lastRefresh = now;
+        const qint64 start = clock.nsecsElapsed();
+        QMetaObject::invokeMethod(client->widget, client->member.constData(), Qt::DirectConnection);
+        const qint64 duration = clock.nsecsElapsed() - start;
+
+        if (client->removed) continue;
+        client->statistics.refreshes++;
+        client->statistics.totalNsecs += duration;
+        if (duration > client->statistics.maxNsecs) client->statistics.maxNsecs = duration;
+
+        if (client->continuous) enqueue(client);
+    }
+
+    inFrame = false;
+    qDeleteAll(removedClients);
+    removedClients.clear();
+
+    if (queue.isEmpty()) timer.stop();
+}
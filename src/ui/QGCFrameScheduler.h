@@ -0,0 +1,140 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class QGCFrameScheduler
+ *
+ */
+
+#ifndef QGCFRAMESCHEDULER_H
+#define QGCFRAMESCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QByteArray>
+
+class QWidget;
+
+/**
+ * @brief One timer for the periodic refresh of all displays
+ *
+ * Widgets register a refresh slot and a minimum interval and then mark
+ * themselves dirty whenever their data changed. Once per frame the
+ * scheduler calls the refresh slot of every dirty widget whose interval
+ * elapsed, so any number of changes between two frames cost one refresh.
+ * Hidden and fully covered widgets are not refreshed, they stay dirty
+ * and are refreshed once they are shown or exposed again. Continuous
+ * widgets, e.g. animated instruments, are refreshed every interval while
+ * visible without being marked. The timer only runs while something is
+ * due, so idle widgets cost nothing. The time spent in the refresh slot
+ * of each widget is measured, the MAVLink inspector shows it.
+ *
+ * All functions have to be called from the GUI thread.
+ */
+class QGCFrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static QGCFrameScheduler* instance();
+
+    /** @brief Refresh statistics of one widget */
+    struct Statistics
+    {
+        Statistics() : refreshes(0), skipped(0), totalNsecs(0), maxNsecs(0) {}
+        int refreshes;          ///< Number of calls of the refresh slot
+        int skipped;            ///< Number of frames the widget was due but hidden or covered
+        qint64 totalNsecs;      ///< Time spent in the refresh slot
+        qint64 maxNsecs;        ///< Longest single refresh
+    };
+
+    /**
+     * @brief Register a widget, it is unregistered automatically when destroyed
+     *
+     * @param widget The widget to refresh
+     * @param member Name of the refresh slot without parameters, e.g. "triggerUpdate"
+     * @param interval Minimum time between two refreshes in milliseconds
+     * @param continuous Refresh every interval while visible, not only when dirty
+     */
+    void add(QWidget* widget, const char* member, int interval, bool continuous = false);
+    /** @brief Unregister a widget */
+    void remove(QWidget* widget);
+    /** @brief Change the minimum refresh interval of a widget in milliseconds */
+    void setInterval(QWidget* widget, int interval);
+    /** @brief Refresh the widget with the next frame its interval allows */
+    void markDirty(QWidget* widget);
+
+    /** @brief Set the upper limit of frames per second */
+    void setMaxFrameRate(int rate);
+    int getMaxFrameRate() const {
+        return maxFrameRate;
+    }
+
+    /** @brief Get the refresh statistics of a widget */
+    Statistics getStatistics(QWidget* widget) const;
+    /** @brief Get the refresh statistics of all registered widgets */
+    QHash<QWidget*, Statistics> getStatistics() const;
+    void resetStatistics();
+
+protected slots:
+    /** @brief Refresh all due widgets */
+    void frame();
+    void widgetDestroyed(QObject* object);
+
+protected:
+    QGCFrameScheduler();
+
+    struct Client
+    {
+        QWidget* widget;
+        QByteArray member;
+        int interval;
+        bool continuous;
+        bool dirty;             ///< Needs a refresh
+        bool queued;            ///< Checked in the next frame
+        bool removed;           ///< Unregistered during a frame, deleted afterwards
+        qint64 lastRefresh;     ///< Time of the last refresh in milliseconds, see clock
+        Statistics statistics;
+    };
+
+    /** @brief Check the client in the next frame and start the timer if needed */
+    void enqueue(Client* client);
+    /** @brief Pick up dirty widgets when they are shown or exposed again */
+    bool eventFilter(QObject* object, QEvent* event);
+
+    QHash<QObject*, Client*> clients;
+    QList<Client*> queue;       ///< Clients to check in the next frame
+    QList<Client*> removedClients; ///< Clients removed during a frame
+    QTimer timer;
+    QElapsedTimer clock;
+    int maxFrameRate;
+    bool inFrame;
+
+private:
+    Q_DISABLE_COPY(QGCFrameScheduler)
+};
+
+#endif // QGCFRAMESCHEDULER_H
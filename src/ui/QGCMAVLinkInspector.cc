@@ -2,7 +2,9 @@
 
 #include "QGCMAVLink.h"
 #include "QGCMAVLinkInspector.h"
+#include "MAVLinkMessagePool.h"
 #include "UASManager.h"
+#include "QGCFrameScheduler.h"
 #include "ui_QGCMAVLinkInspector.h"
 
 #include <QDebug>
@@ -12,6 +14,8 @@ const unsigned int QGCMAVLinkInspector::updateInterval = 1000U;
 
 QGCMAVLinkInspector::QGCMAVLinkInspector(MAVLinkProtocol* protocol, QWidget *parent) :
     QWidget(parent),
+    protocol(protocol),
+    receiving(false),
     selectedSystemID(0),
     selectedComponentID(0),
     ui(new Ui::QGCMAVLinkInspector)
@@ -26,14 +30,11 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(MAVLinkProtocol* protocol, QWidget *par
     memcpy(messageInfo, msg, sizeof(mavlink_message_info_t)*256);
     memset(receivedMessages, 0xFF, sizeof(mavlink_message_t)*256);
 
-    connect(protocol, SIGNAL(messageReceived(LinkInterface*,mavlink_message_t)), this, SLOT(receiveMessage(LinkInterface*,mavlink_message_t)));
     QStringList header;
     header << tr("Name");
     header << tr("Value");
     header << tr("Type");
     ui->treeWidget->setHeaderLabels(header);
-    connect(&updateTimer, SIGNAL(timeout()), this, SLOT(refreshView()));
-
 
     // ARM UI
     connect(ui->systemComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(selectDropDownMenuSystem(int)));
@@ -42,8 +43,9 @@ QGCMAVLinkInspector::QGCMAVLinkInspector(MAVLinkProtocol* protocol, QWidget *par
     // ARM external connections
     connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)), this, SLOT(addSystem(UASInterface*)));
 
-    // Start
-    updateTimer.start(updateInterval);
+    // Start, only update at 1 Hz to not overload the GUI
+    refreshClock.start();
+    QGCFrameScheduler::instance()->add(this, "refreshView", updateInterval);
 }
 
 void QGCMAVLinkInspector::addSystem(UASInterface* uas)
@@ -89,16 +91,67 @@ void QGCMAVLinkInspector::addComponent(int uas, int component, const QString& na
     rebuildComponentList();
 }
 
+/**
+ * The label shows the total and the slowest widget since the last refresh,
+ * its tooltip the paint time of every widget.
+ */
+void QGCMAVLinkInspector::updateRefreshStatistics()
+{
+    QGCFrameScheduler* scheduler = QGCFrameScheduler::instance();
+    const QHash<QWidget*, QGCFrameScheduler::Statistics> statistics = scheduler->getStatistics();
+    scheduler->resetStatistics();
+
+    qint64 totalNsecs = 0;
+    qint64 slowestNsecs = 0;
+    QString slowest;
+    QStringList lines;
+    QHash<QWidget*, QGCFrameScheduler::Statistics>::const_iterator it;
+    for (it = statistics.constBegin(); it != statistics.constEnd(); ++it)
+    {
+        const QGCFrameScheduler::Statistics& s = it.value();
+        QString name = it.key()->objectName();
+        if (name.isEmpty()) name = it.key()->metaObject()->className();
+        totalNsecs += s.totalNsecs;
+        if (s.maxNsecs > slowestNsecs)
+        {
+            slowestNsecs = s.maxNsecs;
+            slowest = name;
+        }
+        const double average = (s.refreshes > 0) ? s.totalNsecs / (1e6 * s.refreshes) : 0.0;
+        lines.append(tr("%1: %2 refreshes, %3 skipped, %4 ms average, %5 ms max").arg(name).arg(s.refreshes).arg(s.skipped).arg(average, 0, 'f', 2).arg(s.maxNsecs / 1e6, 0, 'f', 2));
+    }
+    lines.sort();
+
+    QString text = tr("UI refresh: %1 widgets, %2 ms painting").arg(statistics.size()).arg(totalNsecs / 1e6, 0, 'f', 1);
+    if (!slowest.isEmpty()) text += tr(", slowest %1 (%2 ms)").arg(slowest).arg(slowestNsecs / 1e6, 0, 'f', 2);
+    ui->refreshLabel->setText(text);
+    ui->refreshLabel->setToolTip(lines.join("\n"));
+}
+
 void QGCMAVLinkInspector::refreshView()
 {
+    // Refreshes are skipped while nothing arrives, measure the real interval
+    float elapsed = refreshClock.restart()/1000.0f;
+    if (elapsed <= 0.0f) elapsed = updateInterval/1000.0f;
+
+    // Messages are recycled, a steady allocation rate means a listener holds on to them
+    ui->poolLabel->setText(tr("Message pool: %1 heap allocations/s").arg(MAVLinkMessagePool::getAllocationRate(), 0, 'f', 1));
+    updateRefreshStatistics();
+
     for (int i = 0; i < 256; ++i)//mavlink_message_t msg, receivedMessages)
     {
+        // Copy only the messages which are displayed, once per refresh
+        if (!latestMessages[i].isNull())
+        {
+            memcpy(receivedMessages+i, latestMessages[i].constData(), sizeof(mavlink_message_t));
+            latestMessages[i] = MAVLinkMessageHandle();
+        }
         mavlink_message_t* msg = receivedMessages+i;
         // Ignore NULL values
         if (msg->msgid == 0xFF) continue;
         // Update the tree view
         QString messageName("%1 (%2 Hz, #%3)");
-        float msgHz = (1.0f-updateHzLowpass)*messagesHz.value(msg->msgid, 0) + updateHzLowpass*((float)messageCount.value(msg->msgid, 0))/((float)updateInterval/1000.0f);
+        float msgHz = (1.0f-updateHzLowpass)*messagesHz.value(msg->msgid, 0) + updateHzLowpass*((float)messageCount.value(msg->msgid, 0))/elapsed;
         messagesHz.insert(msg->msgid, msgHz);
         messageName = messageName.arg(messageInfo[msg->msgid].name).arg(msgHz, 3, 'f', 1).arg(msg->msgid);
         messageCount.insert(msg->msgid, 0);
@@ -130,13 +183,15 @@ void QGCMAVLinkInspector::refreshView()
     }
 }
 
-void QGCMAVLinkInspector::receiveMessage(LinkInterface* link,mavlink_message_t message)
+void QGCMAVLinkInspector::receiveMessage(LinkInterface* link, MAVLinkMessageHandle handle)
 {
     Q_UNUSED(link);
+    const mavlink_message_t& message = *handle;
     if (selectedSystemID != 0 && selectedSystemID != message.sysid) return;
     if (selectedComponentID != 0 && selectedComponentID != message.compid) return;
-    // Only overwrite if system filter is set
-    memcpy(receivedMessages+message.msgid, &message, sizeof(mavlink_message_t));
+    // Only overwrite if system filter is set, keeping a reference is enough
+    // until the view is refreshed
+    latestMessages[message.msgid] = handle;
 
     quint64 receiveTime = QGC::groundTimeMilliseconds();
     if (lastMessageUpdate.contains(message.msgid))
@@ -146,6 +201,7 @@ void QGCMAVLinkInspector::receiveMessage(LinkInterface* link,mavlink_message_t m
     }
 
     lastMessageUpdate.insert(message.msgid, receiveTime);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 QGCMAVLinkInspector::~QGCMAVLinkInspector()
@@ -153,6 +209,40 @@ QGCMAVLinkInspector::~QGCMAVLinkInspector()
     delete ui;
 }
 
+void QGCMAVLinkInspector::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+    setReceiving(true);
+}
+
+void QGCMAVLinkInspector::hideEvent(QHideEvent* event)
+{
+    QWidget::hideEvent(event);
+    setReceiving(false);
+}
+
+/**
+ * The inspector shows the raw messages of all IDs, so it listens to the
+ * protocol instead of subscribing fields of the decoder. While hidden it
+ * is disconnected and releases the messages it kept.
+ */
+void QGCMAVLinkInspector::setReceiving(bool enabled)
+{
+    if (enabled == receiving) return;
+    receiving = enabled;
+    if (enabled)
+    {
+        connect(protocol, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), this, SLOT(receiveMessage(LinkInterface*,MAVLinkMessageHandle)));
+    }
+    else
+    {
+        disconnect(protocol, SIGNAL(messageReceived(LinkInterface*,MAVLinkMessageHandle)), this, SLOT(receiveMessage(LinkInterface*,MAVLinkMessageHandle)));
+        for (int i = 0; i < 256; ++i) latestMessages[i] = MAVLinkMessageHandle();
+        lastMessageUpdate.clear();
+        messageCount.clear();
+    }
+}
+
 void QGCMAVLinkInspector::updateField(int msgid, int fieldid, QTreeWidgetItem* item)
 {
     // Add field tree widget item
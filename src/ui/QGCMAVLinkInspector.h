@@ -3,7 +3,7 @@
 
 #include <QWidget>
 #include <QMap>
-#include <QTimer>
+#include <QElapsedTimer>
 
 #include "MAVLinkProtocol.h"
 
@@ -23,7 +23,7 @@ public:
     ~QGCMAVLinkInspector();
 
 public slots:
-    void receiveMessage(LinkInterface* link,mavlink_message_t message);
+    void receiveMessage(LinkInterface* link, MAVLinkMessageHandle handle);
     void refreshView();
     void addSystem(UASInterface* uas);
     void addComponent(int uas, int component, const QString& name);
@@ -33,20 +33,31 @@ public slots:
     void selectDropDownMenuComponent(int dropdownid);
 
 protected:
+    /** @brief Receive messages only while shown */
+    void showEvent(QShowEvent* event);
+    void hideEvent(QHideEvent* event);
+    /** @brief Connect to or disconnect from the protocol */
+    void setReceiving(bool enabled);
+
+    MAVLinkProtocol* protocol;
+    bool receiving;                ///< True while connected to the protocol
     int selectedSystemID;          ///< Currently selected system
     int selectedComponentID;       ///< Currently selected component
     QMap<int, quint64> lastMessageUpdate; ///< Used to switch between highlight and non-highlighting color
     QMap<int, float> messagesHz; ///< Used to store update rate in Hz
     QMap<int, unsigned int> messageCount; ///< Used to store the message count
-    mavlink_message_t receivedMessages[256]; ///< Available / known messages
+    MAVLinkMessageHandle latestMessages[256]; ///< Last received message per ID, shared with the protocol
+    mavlink_message_t receivedMessages[256]; ///< Available / known messages, copied from latestMessages on refresh
     QMap<int, QTreeWidgetItem*> treeWidgetItems;   ///< Available tree widget items
-    QTimer updateTimer; ///< Only update at 1 Hz to not overload the GUI
+    QElapsedTimer refreshClock; ///< Time since the last refresh, for the message rates
     mavlink_message_info_t messageInfo[256];
 
     // Update one message field
     void updateField(int msgid, int fieldid, QTreeWidgetItem* item);
     /** @brief Rebuild the list of components */
     void rebuildComponentList();
+    /** @brief Show the paint time of the widgets refreshed by the frame scheduler */
+    void updateRefreshStatistics();
 
     static const unsigned int updateInterval;
     static const float updateHzLowpass;
@@ -4,6 +4,7 @@
 
 #include "MainWindow.h"
 #include "QGCMAVLinkLogPlayer.h"
+#include "QGCMAVLinkLogWriter.h"
 #include "QGC.h"
 #include "ui_QGCMAVLinkLogPlayer.h"
 
@@ -19,9 +20,12 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(MAVLinkProtocol* mavlink, QWidget *pare
     logLink(NULL),
     loopCounter(0),
     mavlinkLogFormat(true),
+    variableLengthFormat(false),
+    dataOffset(0),
     binaryBaudRate(57600),
     isPlaying(false),
     currPacketCount(0),
+    nextTime(0),
     ui(new Ui::QGCMAVLinkLogPlayer)
 {
     ui->setupUi(this);
@@ -33,6 +37,9 @@ QGCMAVLinkLogPlayer::QGCMAVLinkLogPlayer(MAVLinkProtocol* mavlink, QWidget *pare
     // Setup timer
     connect(&loopTimer, SIGNAL(timeout()), this, SLOT(logLoop()));
 
+    // Update the log statistics once the time index is built
+    connect(&index, SIGNAL(indexReady()), this, SLOT(indexReady()));
+
     // Setup buttons
     connect(ui->selectFileButton, SIGNAL(clicked()), this, SLOT(selectLogFile()));
     connect(ui->playButton, SIGNAL(clicked()), this, SLOT(playPauseToggle()));
@@ -136,26 +143,30 @@ void QGCMAVLinkLogPlayer::pause()
 
 bool QGCMAVLinkLogPlayer::reset(int packetIndex)
 {
-    // Reset only for valid values
-    const unsigned int packetSize = timeLen + packetLen;
-    if (packetIndex >= 0 && packetIndex*packetSize <= logFile.size() - packetSize)
+    // Reset only for valid values, the start is always valid
+    // even if the records are not counted yet
+    if (packetIndex == 0 || (packetIndex > 0 && packetIndex < static_cast<int>(currPacketCount)))
     {
         bool result = true;
         pause();
         loopCounter = 0;
         logFile.reset();
 
-        if (!logFile.seek(packetIndex*packetSize))
+        if (!seekPacket(packetIndex))
         {
             // Fallback: Start from scratch
-            logFile.reset();
+            logFile.seek(dataOffset);
             ui->logStatsLabel->setText(tr("Changing packet index failed, back to start."));
             result = false;
         }
 
         ui->playButton->setIcon(QIcon(":images/actions/media-playback-start.svg"));
         ui->positionSlider->blockSignals(true);
-        int sliderVal = (packetIndex / (double)(logFile.size()/packetSize)) * (ui->positionSlider->maximum() - ui->positionSlider->minimum());
+        int sliderVal = 0;
+        if (currPacketCount > 0)
+        {
+            sliderVal = (packetIndex / (double)currPacketCount) * (ui->positionSlider->maximum() - ui->positionSlider->minimum());
+        }
         ui->positionSlider->setValue(sliderVal);
         ui->positionSlider->blockSignals(false);
         startTime = 0;
@@ -248,34 +259,40 @@ bool QGCMAVLinkLogPlayer::loadLogFile(const QString& file)
 
         // Select if binary or MAVLink log format is used
         mavlinkLogFormat = file.endsWith(".mavlink");
+        variableLengthFormat = mavlinkLogFormat && QGCMAVLinkLogWriter::hasFileHeader(&logFile);
+        dataOffset = variableLengthFormat ? QGCMAVLinkLogWriter::headerLength : 0;
 
         if (mavlinkLogFormat)
         {
-            // Get the time interval from the logfile
-            QByteArray timestamp = logFile.read(timeLen);
+            if (variableLengthFormat)
+            {
+                // Records differ in size, they are counted
+                // while the time index is built
+                currPacketCount = 0;
+                ui->logStatsLabel->setText(tr("%1 MB, indexing..").arg(logFileInfo.size()/1000000.0f, 0, 'f', 2));
+            }
+            else
+            {
+                // Get the time interval from the logfile
+                QByteArray timestamp = logFile.read(timeLen);
 
-            // First timestamp
-            quint64 starttime = *((quint64*)(timestamp.constData()));
+                // First timestamp
+                quint64 starttime = *((quint64*)(timestamp.constData()));
 
-            // Last timestamp
-            logFile.seek(logFile.size()-packetLen-timeLen);
-            QByteArray timestamp2 = logFile.read(timeLen);
-            quint64 endtime = *((quint64*)(timestamp2.constData()));
-            // Reset everything
-            logFile.reset();
+                // Last timestamp
+                logFile.seek(logFile.size()-packetLen-timeLen);
+                QByteArray timestamp2 = logFile.read(timeLen);
+                quint64 endtime = *((quint64*)(timestamp2.constData()));
+                currPacketCount = logFileInfo.size()/(packetLen+timeLen);
 
-            qDebug() << "Starttime:" << starttime << "End:" << endtime;
-
-            // WARNING: Order matters in this computation
-            int seconds = (endtime - starttime)/1000000;
-            int minutes = seconds / 60;
-            int hours = minutes / 60;
-            seconds -= 60*minutes;
-            minutes -= 60*hours;
+                qDebug() << "Starttime:" << starttime << "End:" << endtime;
+                showLogStats(starttime, endtime);
+            }
+            // Reset everything
+            logFile.seek(dataOffset);
 
-            QString timelabel = tr("%1h:%2m:%3s").arg(hours, 2).arg(minutes, 2).arg(seconds, 2);
-            currPacketCount = logFileInfo.size()/(MAVLINK_MAX_PACKET_LEN+sizeof(quint64));
-            ui->logStatsLabel->setText(tr("%2 MB, %3 packets, %4").arg(logFileInfo.size()/1000000.0f, 0, 'f', 2).arg(currPacketCount).arg(timelabel));
+            // Load the sidecar index or build it in the background
+            index.open(file);
         }
         else
         {
@@ -296,6 +313,11 @@ bool QGCMAVLinkLogPlayer::loadLogFile(const QString& file)
                 }
             }
 
+            index.close();
+
+            // Binary logs are jumped through in steps of the legacy record size
+            currPacketCount = logFileInfo.size()/(packetLen+timeLen);
+
             int seconds = logFileInfo.size() / (binaryBaudRate / 10);
             int minutes = seconds / 60;
             int hours = minutes / 60;
@@ -313,16 +335,52 @@ bool QGCMAVLinkLogPlayer::loadLogFile(const QString& file)
     }
 }
 
+void QGCMAVLinkLogPlayer::indexReady()
+{
+    if (!mavlinkLogFormat || !index.isReady()) return;
+
+    currPacketCount = index.getPacketCount();
+    if (!isPlaying)
+    {
+        showLogStats(index.getStartTime(), index.getEndTime());
+    }
+}
+
+void QGCMAVLinkLogPlayer::showLogStats(quint64 starttime, quint64 endtime)
+{
+    // WARNING: Order matters in this computation
+    int seconds = (endtime - starttime)/1000000;
+    int minutes = seconds / 60;
+    int hours = minutes / 60;
+    seconds -= 60*minutes;
+    minutes -= 60*hours;
+
+    QString timelabel = tr("%1h:%2m:%3s").arg(hours, 2).arg(minutes, 2).arg(seconds, 2);
+    ui->logStatsLabel->setText(tr("%2 MB, %3 packets, %4").arg(logFile.size()/1000000.0f, 0, 'f', 2).arg(currPacketCount).arg(timelabel));
+}
+
 /**
- * Jumps to the current percentage of the position slider
+ * Jumps to the current percentage of the position slider. With the time
+ * index the slider covers the duration of the log, otherwise the packets.
  */
 void QGCMAVLinkLogPlayer::jumpToSliderVal(int slidervalue)
 {
     loopTimer.stop();
+    double fraction = slidervalue / (double)(ui->positionSlider->maximum() - ui->positionSlider->minimum());
+
+    if (mavlinkLogFormat && index.isReady() && index.getPacketCount() > 0)
+    {
+        quint64 time = index.getStartTime() + static_cast<quint64>((index.getEndTime() - index.getStartTime()) * fraction);
+        if (seekTime(time))
+        {
+            ui->logStatsLabel->setText(tr("Jumped to %1 s").arg((time - index.getStartTime())/1000000.0, 0, 'f', 1));
+        }
+        return;
+    }
+
     // Set the logfile to the correct percentage and
     // align to the timestamp values
-    int packetCount = logFile.size() / (packetLen + timeLen);
-    int packetIndex = (packetCount - 1) * (slidervalue / (double)(ui->positionSlider->maximum() - ui->positionSlider->minimum()));
+    int packetIndex = (static_cast<int>(currPacketCount) - 1) * fraction;
 
     // Do only accept valid jumps
     if (reset(packetIndex))
@@ -346,98 +404,60 @@ void QGCMAVLinkLogPlayer::logLoop()
 {
     if (mavlinkLogFormat)
     {
-        bool ok;
-
         // First check initialization
         if (startTime == 0)
         {
-            QByteArray startBytes = logFile.read(timeLen);
-
-            // Check if the correct number of bytes could be read
-            if (startBytes.length() != timeLen)
+            // Check if the first record could be read
+            if (!readPacket(&nextTime, &nextPacket))
             {
-                ui->logStatsLabel->setText(tr("Error reading first %1 bytes").arg(timeLen));
-                MainWindow::instance()->showCriticalMessage(tr("Failed loading MAVLink Logfile"), tr("Error reading first %1 bytes from logfile. Got %2 instead of %1 bytes. Is the logfile readable?").arg(timeLen).arg(startBytes.length()));
+                ui->logStatsLabel->setText(tr("Error reading first packet"));
+                MainWindow::instance()->showCriticalMessage(tr("Failed loading MAVLink Logfile"), tr("Error reading the first packet from logfile %1. Is the logfile readable?").arg(logFile.fileName()));
                 reset();
                 return;
             }
 
-            // Convert data to timestamp
-            startTime = *((quint64*)(startBytes.constData()));
+            startTime = nextTime;
             currentStartTime = QGC::groundTimeUsecs();
-            ok = true;
 
             //qDebug() << "START TIME: " << startTime;
-
-            // Check if these bytes could be correctly decoded
-            if (!ok)
-            {
-                ui->logStatsLabel->setText(tr("Error decoding first timestamp, aborting."));
-                MainWindow::instance()->showCriticalMessage(tr("Failed loading MAVLink Logfile"), tr("Could not load initial timestamp from file %1. Is the file corrupted?").arg(logFile.fileName()));
-                reset();
-                return;
-            }
-        }
-
-
-        // Initialization seems fine, load next chunk
-        QByteArray chunk = logFile.read(timeLen+packetLen);
-        QByteArray packet = chunk.mid(0, packetLen);
-
-        // Emit this packet
-        emit bytesReady(logLink, packet);
-
-        // Check if reached end of file before reading next timestamp
-        if (chunk.length() < timeLen+packetLen || logFile.atEnd())
-        {
-            // Reached end of file
-            reset();
-
-            QString status = tr("Reached end of MAVLink log file.");
-            ui->logStatsLabel->setText(status);
-            MainWindow::instance()->showStatusMessage(status);
-            return;
         }
 
-        // End of file not reached, read next timestamp
-        QByteArray rawTime = chunk.mid(packetLen);
-
-        // This is the timestamp of the next packet
-        quint64 time = *((quint64*)(rawTime.constData()));
-        ok = true;
-        if (!ok)
-        {
-            // Convert it to 64bit number
-            QString status = tr("Time conversion error during log replay. Continuing..");
-            ui->logStatsLabel->setText(status);
-            MainWindow::instance()->showStatusMessage(status);
-        }
-        else
+        // Collect all packets which are due within
+        // the next 2 ms and emit them at once
+        qint64 now = QGC::groundTimeUsecs();
+        int nextExecutionTime = 0;
+        QByteArray batch;
+        do
         {
-            // Normal processing, passed all checks
-            // start timer to match time offset between
-            // this and next packet
+            batch.append(nextPacket);
 
+            // Load the next packet and its timestamp
+            if (!readPacket(&nextTime, &nextPacket))
+            {
+                emit bytesReady(logLink, batch);
 
-            // Offset in ms
-            qint64 timediff = (time - startTime)/accelerationFactor;
+                // Reached end of file
+                reset();
 
-            // Immediately load any data within
-            // a 3 ms interval
+                QString status = tr("Reached end of MAVLink log file.");
+                ui->logStatsLabel->setText(status);
+                MainWindow::instance()->showStatusMessage(status);
+                return;
+            }
 
-            int nextExecutionTime = (((qint64)currentStartTime + (qint64)timediff) - (qint64)QGC::groundTimeUsecs())/1000;
+            // Offset of the next packet to the log start, scaled to replay time
+            qint64 timediff = (nextTime - startTime)/accelerationFactor;
+            nextExecutionTime = (((qint64)currentStartTime + timediff) - now)/1000;
 
             //qDebug() << "nextExecutionTime:" << nextExecutionTime << "QGC START TIME:" << currentStartTime << "LOG START TIME:" << startTime;
-
-            if (nextExecutionTime < 2)
-            {
-                logLoop();
-            }
-            else
-            {
-                loopTimer.start(nextExecutionTime);
-            }
         }
+        while (nextExecutionTime < 2 && batch.size() < maxBatchBytes);
+
+        emit bytesReady(logLink, batch);
+
+        // Continue immediately if the batch was cut
+        // short, else in time for the next packet
+        loopTimer.start(qMax(0, nextExecutionTime));
     }
     else
     {
@@ -469,6 +489,11 @@ void QGCMAVLinkLogPlayer::logLoop()
     {
         QFileInfo logFileInfo(logFile);
         int progress = (ui->positionSlider->maximum()-ui->positionSlider->minimum())*(logFile.pos()/static_cast<float>(logFileInfo.size()));
+        if (mavlinkLogFormat && index.isReady() && index.getEndTime() > index.getStartTime())
+        {
+            // The slider covers the duration of the log
+            progress = (ui->positionSlider->maximum()-ui->positionSlider->minimum())*((nextTime - index.getStartTime())/static_cast<double>(index.getEndTime() - index.getStartTime()));
+        }
         //qDebug() << "Progress:" << progress;
         ui->positionSlider->blockSignals(true);
         ui->positionSlider->setValue(progress);
@@ -477,6 +502,110 @@ void QGCMAVLinkLogPlayer::logLoop()
     loopCounter++;
 }
 
+/**
+ * Legacy records are always MAVLINK_MAX_PACKET_LEN bytes long and emitted
+ * including the padding. Variable length records end with the packet, its
+ * length is taken from the packet header.
+ *
+ * @param time The receive timestamp of the packet in microseconds
+ * @param packet The packet bytes
+ * @return False at the end of the file or on a corrupted record
+ */
+bool QGCMAVLinkLogPlayer::readPacket(quint64* time, QByteArray* packet)
+{
+    if (variableLengthFormat)
+    {
+        char header[timeLen + 2];
+        if (logFile.read(header, sizeof(header)) != sizeof(header) || static_cast<quint8>(header[timeLen]) != MAVLINK_STX)
+        {
+            return false;
+        }
+        int length = static_cast<quint8>(header[timeLen + 1]) + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+        memcpy(time, header, timeLen);
+        packet->resize(length);
+        memcpy(packet->data(), header + timeLen, 2);
+        return (logFile.read(packet->data() + 2, length - 2) == length - 2);
+    }
+    else
+    {
+        QByteArray chunk = logFile.read(timeLen + packetLen);
+        if (chunk.length() < timeLen + packetLen)
+        {
+            return false;
+        }
+        memcpy(time, chunk.constData(), timeLen);
+        *packet = chunk.mid(timeLen);
+        return true;
+    }
+}
+
+bool QGCMAVLinkLogPlayer::seekPacket(int packetIndex)
+{
+    if (!variableLengthFormat)
+    {
+        return logFile.seek(dataOffset + static_cast<qint64>(packetIndex) * (timeLen + packetLen));
+    }
+
+    // Variable length records can only be skipped one by one,
+    // starting at the closest indexed record if available
+    QGCMAVLinkLogIndex::Entry entry;
+    qint64 offset = dataOffset;
+    int skip = packetIndex;
+    if (index.isReady() && index.findPacket(packetIndex, &entry))
+    {
+        offset = entry.offset;
+        skip = packetIndex - entry.packet;
+    }
+    if (!logFile.seek(offset))
+    {
+        return false;
+    }
+    quint64 time;
+    QByteArray packet;
+    for (int i = 0; i < skip; i++)
+    {
+        if (!readPacket(&time, &packet))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Looks up the closest indexed record and walks at most one
+ * index stride forward to the first record at or after the time.
+ *
+ * @param time The timestamp to jump to in microseconds
+ * @return False if the index is not ready or the file could not be positioned
+ */
+bool QGCMAVLinkLogPlayer::seekTime(quint64 time)
+{
+    QGCMAVLinkLogIndex::Entry entry;
+    if (!index.isReady() || !index.findTime(time, &entry))
+    {
+        return false;
+    }
+
+    pause();
+    loopCounter = 0;
+    startTime = 0;
+    if (!logFile.seek(entry.offset))
+    {
+        logFile.seek(dataOffset);
+        return false;
+    }
+
+    qint64 pos = entry.offset;
+    quint64 recordTime;
+    QByteArray packet;
+    while (readPacket(&recordTime, &packet) && recordTime < time)
+    {
+        pos = logFile.pos();
+    }
+    return logFile.seek(pos);
+}
+
 void QGCMAVLinkLogPlayer::changeEvent(QEvent *e)
 {
     QWidget::changeEvent(e);
@@ -7,6 +7,7 @@
 #include "MAVLinkProtocol.h"
 #include "LinkInterface.h"
 #include "MAVLinkSimulationLink.h"
+#include "QGCMAVLinkLogIndex.h"
 
 namespace Ui
 {
@@ -58,6 +59,8 @@ public slots:
     void logLoop();
     /** @brief Set acceleration factor in percent */
     void setAccelerationFactorInt(int factor);
+    /** @brief The time index of the log is complete */
+    void indexReady();
 
 signals:
     /** @brief Send ready bytes */
@@ -76,12 +79,26 @@ protected:
     QTimer loopTimer;
     int loopCounter;
     bool mavlinkLogFormat;
+    bool variableLengthFormat;  ///< Log written with the file header and variable length records
+    qint64 dataOffset;          ///< Position of the first record
     int binaryBaudRate;
     bool isPlaying;
     unsigned int currPacketCount;
+    QByteArray nextPacket;      ///< Packet read ahead, emitted on the next loop iteration
+    quint64 nextTime;           ///< Timestamp of the packet read ahead
+    QGCMAVLinkLogIndex index;   ///< Time index of the MAVLink log
+    static const int maxBatchBytes = 16*1024; ///< Upper limit of the bytes emitted per loop iteration
     static const int packetLen = MAVLINK_MAX_PACKET_LEN;
     static const int timeLen = sizeof(quint64);
     void changeEvent(QEvent *e);
+    /** @brief Read the next record of a MAVLink log, in either record format */
+    bool readPacket(quint64* time, QByteArray* packet);
+    /** @brief Move the file to the record with the given index */
+    bool seekPacket(int packetIndex);
+    /** @brief Move the file to the first record at or after a timestamp, needs the index */
+    bool seekTime(quint64 time);
+    /** @brief Show size, packet count and duration of the MAVLink log */
+    void showLogStats(quint64 starttime, quint64 endtime);
 
 private:
     Ui::QGCMAVLinkLogPlayer *ui;
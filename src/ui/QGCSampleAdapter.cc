@@ -0,0 +1,140 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCSampleAdapter
+ *
+ */
+
+#include "QGCSampleAdapter.h"
+#include "MAVLinkChannelRegistry.h"
+
+/** @brief Argument types of the typed valueChanged() signals */
+static const char* valueTypes[] = {
+    "quint8", "qint8", "quint16", "qint16", "quint32", "qint32", "quint64", "qint64", "double"
+};
+
+QGCSampleAdapter::QGCSampleAdapter(QObject* parent) :
+    QObject(parent)
+{
+    qRegisterMetaType<QGCSampleBlock>("QGCSampleBlock");
+}
+
+bool QGCSampleAdapter::hasSamples(QObject* source)
+{
+    return source && source->metaObject()->indexOfSignal("samplesReady(QGCSampleBlock)") >= 0;
+}
+
+bool QGCSampleAdapter::hasValues(QObject* source)
+{
+    return source && source->metaObject()->indexOfSignal("valueChanged(int,QString,QString,double,quint64)") >= 0;
+}
+
+void QGCSampleAdapter::addSource(QObject* source)
+{
+    if (hasSamples(source))
+    {
+        connect(source, SIGNAL(samplesReady(QGCSampleBlock)), this, SLOT(receiveSamples(QGCSampleBlock)));
+    }
+}
+
+void QGCSampleAdapter::removeSource(QObject* source)
+{
+    if (hasSamples(source))
+    {
+        disconnect(source, SIGNAL(samplesReady(QGCSampleBlock)), this, SLOT(receiveSamples(QGCSampleBlock)));
+    }
+}
+
+void QGCSampleAdapter::connectSlots(QObject* receiver, const char* slot)
+{
+    for (unsigned int i = 0; i < sizeof(valueTypes)/sizeof(valueTypes[0]); ++i)
+    {
+        QByteArray arguments = QByteArray("(int,QString,QString,") + valueTypes[i] + ",quint64)";
+        QByteArray signal = QByteArray::number(QSIGNAL_CODE) + "valueChanged" + arguments;
+        QByteArray method = QByteArray::number(QSLOT_CODE) + slot + arguments;
+        connect(this, signal.constData(), receiver, method.constData());
+    }
+}
+
+void QGCSampleAdapter::disconnectSlots(QObject* receiver, const char* slot)
+{
+    for (unsigned int i = 0; i < sizeof(valueTypes)/sizeof(valueTypes[0]); ++i)
+    {
+        QByteArray arguments = QByteArray("(int,QString,QString,") + valueTypes[i] + ",quint64)";
+        QByteArray signal = QByteArray::number(QSIGNAL_CODE) + "valueChanged" + arguments;
+        QByteArray method = QByteArray::number(QSLOT_CODE) + slot + arguments;
+        disconnect(this, signal.constData(), receiver, method.constData());
+    }
+}
+
+void QGCSampleAdapter::receiveSamples(QGCSampleBlock samples)
+{
+    for (int i = 0; i < samples.size(); ++i)
+    {
+        const QGCSample& sample = samples.at(i);
+        if (sample.channel < 0) continue;
+        if (sample.channel >= channels.size()) channels.resize(sample.channel + 1);
+        Channel& channel = channels[sample.channel];
+        if (!channel.known)
+        {
+            MAVLinkChannelRegistry* registry = MAVLinkChannelRegistry::instance();
+            channel.known = true;
+            channel.uasId = registry->getUASId(sample.channel);
+            channel.name = registry->getName(sample.channel);
+            channel.unit = registry->getUnit(sample.channel);
+        }
+
+        switch (sample.type)
+        {
+        case QGCSample::UINT8:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<quint8>(sample.value.u), sample.time);
+            break;
+        case QGCSample::INT8:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<qint8>(sample.value.i), sample.time);
+            break;
+        case QGCSample::UINT16:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<quint16>(sample.value.u), sample.time);
+            break;
+        case QGCSample::INT16:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<qint16>(sample.value.i), sample.time);
+            break;
+        case QGCSample::UINT32:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<quint32>(sample.value.u), sample.time);
+            break;
+        case QGCSample::INT32:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, static_cast<qint32>(sample.value.i), sample.time);
+            break;
+        case QGCSample::UINT64:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, sample.value.u, sample.time);
+            break;
+        case QGCSample::INT64:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, sample.value.i, sample.time);
+            break;
+        default:
+            emit valueChanged(channel.uasId, channel.name, channel.unit, sample.value.d, sample.time);
+            break;
+        }
+    }
+}
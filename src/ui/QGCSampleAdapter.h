@@ -0,0 +1,95 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of class QGCSampleAdapter
+ *
+ */
+
+#ifndef QGCSAMPLEADAPTER_H
+#define QGCSAMPLEADAPTER_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include "QGCSampleBlock.h"
+
+/**
+ * @brief Feeds sample blocks to slots written for the single value signals
+ *
+ * Sources emit samplesReady() once per message. The adapter lives in the
+ * thread of the receivers and splits the block into the typed
+ * valueChanged() signals, so existing slots keep working while only one
+ * signal per block crosses the thread boundary.
+ */
+class QGCSampleAdapter : public QObject
+{
+    Q_OBJECT
+public:
+    QGCSampleAdapter(QObject* parent = 0);
+
+    /** @brief Receive the blocks of a source emitting samplesReady() */
+    void addSource(QObject* source);
+    void removeSource(QObject* source);
+    /**
+     * @brief Connect all typed valueChanged() signals to the overloaded slot of a receiver
+     *
+     * @param slot Slot name without signature, e.g. "appendData"
+     */
+    void connectSlots(QObject* receiver, const char* slot);
+    void disconnectSlots(QObject* receiver, const char* slot);
+
+    /** @brief Check if an object emits samplesReady() */
+    static bool hasSamples(QObject* source);
+    /** @brief Check if an object emits the typed valueChanged() signals */
+    static bool hasValues(QObject* source);
+
+public slots:
+    void receiveSamples(QGCSampleBlock samples);
+
+signals:
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint8 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint8 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint16 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint16 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint32 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint32 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const quint64 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const qint64 value, const quint64 msec);
+    void valueChanged(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec);
+
+protected:
+    /** @brief Names of a channel, copied once from the registry */
+    struct Channel
+    {
+        Channel() : known(false), uasId(-1) {}
+        bool known;
+        int uasId;
+        QString name;
+        QString unit;
+    };
+    QVector<Channel> channels; ///< Channels by ID
+};
+
+#endif // QGCSAMPLEADAPTER_H
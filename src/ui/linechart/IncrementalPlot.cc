@@ -52,6 +52,8 @@ void CurveData::append(double *x, double *y, int count)
 {
     int newSize = ( (d_count + count) / 1000 + 1 ) * 1000;
     if ( newSize > size() ) {
+        // Grow geometrically, large logs are appended in many pieces
+        newSize = qMax(newSize, 2 * size());
         d_x.resize(newSize);
         d_y.resize(newSize);
     }
@@ -298,6 +300,46 @@ void IncrementalPlot::appendData(QString key, double x, double y)
 }
 
 void IncrementalPlot::appendData(QString key, double *x, double *y, int size)
+{
+    if (storeData(key, x, y, size)) {
+        updateScale();
+    } else {
+        QwtPlotCurve* curve = d_curve.value(key);
+
+        const bool cacheMode =
+            canvas()->testPaintAttribute(QwtPlotCanvas::PaintCached);
+
+#if QT_VERSION >= 0x040000 && defined(Q_WS_X11)
+        // Even if not recommended by TrollTech, Qt::WA_PaintOutsidePaintEvent
+        // works on X11. This has an tremendous effect on the performance..
+
+        canvas()->setAttribute(Qt::WA_PaintOutsidePaintEvent, true);
+#endif
+
+        canvas()->setPaintAttribute(QwtPlotCanvas::PaintCached, false);
+        // FIXME Check if here all curves should be drawn
+        //        QwtPlotCurve* plotCurve;
+        //        foreach(plotCurve, d_curve)
+        //        {
+        //            plotCurve->draw(0, curve->dataSize()-1);
+        //        }
+
+        curve->draw(curve->dataSize() - size, curve->dataSize() - 1);
+        canvas()->setPaintAttribute(QwtPlotCanvas::PaintCached, cacheMode);
+
+#if QT_VERSION >= 0x040000 && defined(Q_WS_X11)
+        canvas()->setAttribute(Qt::WA_PaintOutsidePaintEvent, false);
+#endif
+    }
+}
+
+/**
+ * The points are only drawn with the next replot, so many pieces of data
+ * can be added at the cost of a single redraw.
+ *
+ * @return true if the points are outside of the current scale
+ */
+bool IncrementalPlot::storeData(QString key, double *x, double *y, int size)
 {
     CurveData* data;
     QwtPlotCurve* curve;
@@ -348,44 +390,7 @@ void IncrementalPlot::appendData(QString key, double *x, double *y, int size)
             scaleChanged = true;
         }
     }
-    //    setAxisScale(xBottom, xmin+xmin*0.05, xmax+xmax*0.05);
-    //    setAxisScale(yLeft, ymin+ymin*0.05, ymax+ymax*0.05);
-
-    //#ifdef __GNUC__
-    //#warning better use QwtData
-    //#endif
-
-    //replot();
-
-    if(scaleChanged) {
-        updateScale();
-    } else {
-
-        const bool cacheMode =
-            canvas()->testPaintAttribute(QwtPlotCanvas::PaintCached);
-
-#if QT_VERSION >= 0x040000 && defined(Q_WS_X11)
-        // Even if not recommended by TrollTech, Qt::WA_PaintOutsidePaintEvent
-        // works on X11. This has an tremendous effect on the performance..
-
-        canvas()->setAttribute(Qt::WA_PaintOutsidePaintEvent, true);
-#endif
-
-        canvas()->setPaintAttribute(QwtPlotCanvas::PaintCached, false);
-        // FIXME Check if here all curves should be drawn
-        //        QwtPlotCurve* plotCurve;
-        //        foreach(plotCurve, d_curve)
-        //        {
-        //            plotCurve->draw(0, curve->dataSize()-1);
-        //        }
-
-        curve->draw(curve->dataSize() - size, curve->dataSize() - 1);
-        canvas()->setPaintAttribute(QwtPlotCanvas::PaintCached, cacheMode);
-
-#if QT_VERSION >= 0x040000 && defined(Q_WS_X11)
-        canvas()->setAttribute(Qt::WA_PaintOutsidePaintEvent, false);
-#endif
-    }
+    return scaleChanged;
 }
 
 /**
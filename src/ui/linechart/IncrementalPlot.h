@@ -96,6 +96,9 @@ public:
     /** @brief Read out data from a curve */
     int data(QString key, double* r_x, double* r_y, int maxSize);
 
+    /** @brief Append multiple data points without drawing them */
+    bool storeData(QString key, double* x, double* y, int size);
+
     float symbolWidth;
     float curveWidth;
     float gridWidth;
@@ -11,6 +11,7 @@
 
 #include "float.h"
 #include <QDebug>
+#include <QStringList>
 #include <QTimer>
 #include <qwt_plot.h>
 #include <qwt_plot_canvas.h>
@@ -49,12 +50,12 @@ LinechartPlot::LinechartPlot(QWidget *parent, int plotid, quint64 interval): Qwt
 
     maxValue = DBL_MIN;
     minValue = DBL_MAX;
+    averageWindowSize = 50;
 
     //lastMaxTimeAdded = QTime();
 
     curves = QMap<QString, QwtPlotCurve*>();
     data = QMap<QString, TimeSeriesData*>();
-    scaleMaps = QMap<QString, QwtScaleMap*>();
 
     yScaleEngine = new QwtLinearScaleEngine();
     setAxisScaleEngine(QwtPlot::yLeft, yScaleEngine);
@@ -206,6 +207,14 @@ double LinechartPlot::getVariance(QString id)
     return data.value(id)->getVariance();
 }
 
+/**
+ * @param id curve identifier
+ */
+qint64 LinechartPlot::getMemoryUsage(QString id)
+{
+    return data.value(id)->getMemoryUsage();
+}
+
 int LinechartPlot::getAverageWindow()
 {
     return averageWindowSize;
@@ -228,31 +237,44 @@ void LinechartPlot::setActive(bool active)
 
 void LinechartPlot::removeTimedOutCurves()
 {
-    foreach(QString key, lastUpdate.keys())
+    QStringList removed;
+
+    datalock.lock();
+    foreach(QString key, handles.keys())
     {
-        quint64 time = lastUpdate.value(key);
+        quint64 time = data.value(key)->getLastUpdate();
         if (QGC::groundTimeMilliseconds() - time > 10000)
         {
             // Remove this curve
-            // Delete curves
-            QwtPlotCurve* curve = curves.take(key);
-            // Delete the object
-            delete curve;
-            // Set the pointer null
-            curve = NULL;
-
-            // Notify connected components about the removal
-            emit curveRemoved(key);
-
-            // Remove from data list
-            TimeSeriesData* d = data.take(key);
-            // Delete the object
-            delete d;
-            // Set the pointer null
-            d = NULL;
-            emit curveRemoved(key);
+            deleteCurve(key);
+            removed.append(key);
         }
     }
+    datalock.unlock();
+
+    // Notify connected components about the removal
+    foreach(QString key, removed)
+    {
+        emit curveRemoved(key);
+    }
+}
+
+/**
+ * @brief Delete a curve and its dataset
+ *
+ * The handle of the curve is invalidated, but not reused. The caller has to
+ * hold the data lock.
+ *
+ * @param id The id of the curve
+ **/
+void LinechartPlot::deleteCurve(const QString& id)
+{
+    int handle = handles.take(id);
+    handleData[handle] = NULL;
+    handleCurves[handle] = NULL;
+
+    delete curves.take(id);
+    delete data.take(id);
 }
 
 /**
@@ -264,29 +286,66 @@ void LinechartPlot::removeTimedOutCurves()
  **/
 void LinechartPlot::setZeroValue(QString id, double zeroValue)
 {
+    QMutexLocker locker(&datalock);
     if(data.contains(id)) {
         data.value(id)->setZeroValue(zeroValue);
     } else {
-        data.insert(id, new TimeSeriesData(this, id, maxInterval, zeroValue));
+        data.insert(id, new TimeSeriesData(this, id, plotInterval, maxInterval, zeroValue));
     }
 }
 
 void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
+{
+    appendData(getCurveHandle(dataname), ms, value);
+}
+
+/**
+ * @param id The id of the curve
+ * @return The handle of the curve, the curve is added to the plot if necessary
+ **/
+int LinechartPlot::getCurveHandle(const QString& id)
 {
     /* Lock resource to ensure data integrity */
     datalock.lock();
 
     /* Check if dataset identifier already exists */
-    if(!data.contains(dataname)) {
-        addCurve(dataname);
+    int handle = handles.value(id, -1);
+    if (handle < 0) {
+        handle = addCurve(id);
         enforceGroundTime(m_groundTime);
-        qDebug() << "ADDING CURVE WITH" << dataname << ms << value;
-        qDebug() << "MINTIME:" << minTime << "MAXTIME:" << maxTime;
-        qDebug() << "LASTTIME:" << lastTime;
     }
 
-    // Add new value
-    TimeSeriesData* dataset = data.value(dataname);
+    datalock.unlock();
+    return handle;
+}
+
+/**
+ * @param id The id of the curve
+ * @return The handle of the curve, -1 if the curve doesn't exist
+ **/
+int LinechartPlot::findCurveHandle(const QString& id)
+{
+    QMutexLocker locker(&datalock);
+    return handles.value(id, -1);
+}
+
+/**
+ * @param handle The handle of the curve, as returned by getCurveHandle()
+ * @param ms The time of the data point, in milliseconds
+ * @param value The value of the data point
+ * @return true if the data point was appended, false if the handle is not valid
+ **/
+bool LinechartPlot::appendData(int handle, quint64 ms, double value)
+{
+    /* Lock resource to ensure data integrity */
+    datalock.lock();
+
+    TimeSeriesData* dataset = (handle >= 0 && handle < handleData.size()) ? handleData[handle] : NULL;
+    if (!dataset)
+    {
+        datalock.unlock();
+        return false;
+    }
 
     quint64 time;
 
@@ -302,8 +361,6 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     }
     dataset->append(time, value);
 
-    lastUpdate.insert(dataname, time);
-
     // Scaling values
     if(ms < minTime) minTime = ms;
     if(ms > maxTime) maxTime = ms;
@@ -320,13 +377,10 @@ void LinechartPlot::appendData(QString dataname, quint64 ms, double value)
     if (value > maxValue) maxValue = value;
     valueInterval = maxValue - minValue;
 
-    // Assign dataset to curve
-    QwtPlotCurve* curve = curves.value(dataname);
-    curve->setRawData(dataset->getPlotX(), dataset->getPlotY(), dataset->getPlotCount());
-
     //    qDebug() << "mintime" << minTime << "maxtime" << maxTime << "last max time" << "window position" << getWindowPosition();
 
     datalock.unlock();
+    return true;
 }
 
 /**
@@ -359,7 +413,13 @@ bool LinechartPlot::groundTime()
     return m_groundTime;
 }
 
-void LinechartPlot::addCurve(QString id)
+/**
+ * @brief Add a new curve and its dataset to the plot
+ *
+ * @param id The id of the curve
+ * @return The handle of the new curve
+ **/
+int LinechartPlot::addCurve(QString id)
 {
     QColor currentColor = getNextColor();
 
@@ -389,12 +449,29 @@ void LinechartPlot::addCurve(QString id)
 
     // Create dataset
     TimeSeriesData* dataset = new TimeSeriesData(this, id, this->plotInterval, maxInterval);
+    dataset->setAverageWindowSize(averageWindowSize);
+    // The curve reads the plot window of the dataset at the resolution of the canvas
+    curve->setData(QGCSeriesPlotData(&dataset->getStore(), canvas()));
 
-    // Add dataset to list
+    // Add dataset to list, a dataset created by setZeroValue() is replaced but keeps its zero value
+    TimeSeriesData* previous = data.take(id);
+    if (previous)
+    {
+        dataset->setZeroValue(previous->getZeroValue());
+        delete previous;
+    }
     data.insert(id, dataset);
 
+    // Hand out the next handle, handles are never reused
+    int handle = handleData.size();
+    handleData.append(dataset);
+    handleCurves.append(curve);
+    handles.insert(id, handle);
+
     // Notify connected components about new curve
     emit curveAdded(id);
+
+    return handle;
 }
 
 QColor LinechartPlot::getNextColor()
@@ -544,6 +621,16 @@ bool LinechartPlot::isVisible(QString id)
     return curves.value(id)->isVisible();
 }
 
+/**
+ * @param handle The handle of the curve
+ * @return true if the curve exists and is visible
+ **/
+bool LinechartPlot::isVisible(int handle)
+{
+    QwtPlotCurve* curve = (handle >= 0 && handle < handleCurves.size()) ? handleCurves[handle] : NULL;
+    return curve && curve->isVisible();
+}
+
 /**
  * @return The visibility, true if it is visible, false otherwise
  **/
@@ -770,33 +857,23 @@ void LinechartPlot::paintRealtime()
 void LinechartPlot::removeAllData()
 {
     datalock.lock();
-    // Delete curves
-    QMap<QString, QwtPlotCurve*>::iterator i;
-    for(i = curves.begin(); i != curves.end(); ++i)
+    // Delete curves and data
+    QStringList removed = handles.keys();
+    foreach(QString key, removed)
     {
-        // Remove from curve list
-        QwtPlotCurve* curve = curves.take(i.key());
-        // Delete the object
-        delete curve;
-        // Set the pointer null
-        curve = NULL;
-
-        // Notify connected components about the removal
-        emit curveRemoved(i.key());
+        deleteCurve(key);
     }
 
-    // Delete data
-    QMap<QString, TimeSeriesData*>::iterator j;
-    for(j = data.begin(); j != data.end(); ++j)
+    // Delete data without a curve, created by setZeroValue()
+    qDeleteAll(data);
+    data.clear();
+    datalock.unlock();
+
+    // Notify connected components about the removal
+    foreach(QString key, removed)
     {
-        // Remove from data list
-        TimeSeriesData* d = data.take(j.key());
-        // Delete the object
-        delete d;
-        // Set the pointer null
-        d = NULL;
+        emit curveRemoved(key);
     }
-    datalock.unlock();
     replot();
 }
 
@@ -805,11 +882,9 @@ TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plot
     minValue(DBL_MAX),
     maxValue(DBL_MIN),
     zeroValue(0),
+    lastUpdate(0),
     count(0),
-    mean(0.0),
-    median(0.0),
-    variance(0.0),
-    averageWindow(50)
+    statistics(50)
 {
     this->plot = plot;
     this->friendlyName = friendlyName;
@@ -821,7 +896,6 @@ TimeSeriesData::TimeSeriesData(QwtPlot* plot, QString friendlyName, quint64 plot
     startTime = QUINT64_MAX;
     stopTime = QUINT64_MIN;
 
-    plotCount = 0;
 }
 
 TimeSeriesData::~TimeSeriesData()
@@ -831,12 +905,18 @@ TimeSeriesData::~TimeSeriesData()
 
 void TimeSeriesData::setInterval(quint64 ms)
 {
+    dataMutex.lock();
     plotInterval = ms;
+    // The next append moves the window start forward again
+    store.resetWindow();
+    dataMutex.unlock();
 }
 
 void TimeSeriesData::setAverageWindowSize(int windowSize)
 {
-    this->averageWindow = windowSize;
+    dataMutex.lock();
+    statistics.setWindowSize(windowSize);
+    dataMutex.unlock();
 }
 
 /**
@@ -848,74 +928,28 @@ void TimeSeriesData::setAverageWindowSize(int windowSize)
 void TimeSeriesData::append(quint64 ms, double value)
 {
     dataMutex.lock();
-    // Pre- allocate new space
-    // FIXME Check this for validity
-    if(static_cast<quint64>(size()) < (count + 100)) {
-        this->ms.resize(size() + 10000);
-        this->value.resize(size() + 10000);
-    }
-    this->ms[count] = ms;
-    this->value[count] = value;
+    store.append(ms, value);
     this->lastValue = value;
-    this->mean = 0;
-    //QList<double> medianList = QList<double>();
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->mean += this->value[count-i];
-        //medianList.append(this->value[count-i]);
-    }
-    this->mean = mean / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-    this->variance = 0;
-    for (unsigned int i = 0; (i < averageWindow) && (((int)count - (int)i) >= 0); ++i) {
-        this->variance += (this->value[count-i] - mean) * (this->value[count-i] - mean);
-    }
-    this->variance = this->variance / static_cast<double>(qMin(averageWindow,static_cast<unsigned int>(count)));
-
-//    qSort(medianList);
-
-//    if (medianList.count() > 2)
-//    {
-//        if (medianList.count() % 2 == 0)
-//        {
-//            median = (medianList.at(medianList.count()/2) + medianList.at(medianList.count()/2+1)) / 2.0;
-//        }
-//        else
-//        {
-//            median = medianList.at(medianList.count()/2+1);
-//        }
-//    }
+    this->lastUpdate = ms;
+    statistics.append(value);
 
     // Update statistical values
     if(ms < startTime) startTime = ms;
     if(ms > stopTime) stopTime = ms;
     interval = stopTime - startTime;
 
-    if (interval > plotInterval) {
-        while (this->ms[count - plotCount] < stopTime - plotInterval) {
-            plotCount--;
-        }
-    }
+    // Move the plot window forward, it stays at full resolution
+    store.setKeepFrom(static_cast<double>(stopTime) - static_cast<double>(plotInterval));
 
     count++;
-    plotCount++;
 
     if(minValue > value) minValue = value;
     if(maxValue < value) maxValue = value;
 
-    // Trim dataset if necessary
+    // Retire old samples to the downsampled history if necessary
     if(maxInterval > 0) {
-        // maxInterval = 0 means infinite
-
-        if(interval > maxInterval && !this->ms.isEmpty() && !this->value.isEmpty()) {
-            // The time at which this time series should be cut
-            double minTime = stopTime - maxInterval;
-            // Delete elements from the start of the list as long the time
-            // value of this elements is before the cut time
-            while(this->ms.first() < minTime) {
-                this->ms.pop_front();
-                this->value.pop_front();
-            }
-        }
+        // maxInterval = 0 means only the memory budget limits the dataset
+        store.retireBefore(static_cast<double>(stopTime) - static_cast<double>(maxInterval));
     }
     dataMutex.unlock();
 }
@@ -955,7 +989,8 @@ double TimeSeriesData::getMaxValue()
  */
 double TimeSeriesData::getMean()
 {
-    return mean;
+    QMutexLocker locker(&dataMutex);
+    return statistics.getMean();
 }
 
 /**
@@ -963,7 +998,8 @@ double TimeSeriesData::getMean()
  */
 double TimeSeriesData::getMedian()
 {
-    return median;
+    QMutexLocker locker(&dataMutex);
+    return statistics.getMedian();
 }
 
 /**
@@ -971,7 +1007,8 @@ double TimeSeriesData::getMedian()
  */
 double TimeSeriesData::getVariance()
 {
-    return variance;
+    QMutexLocker locker(&dataMutex);
+    return statistics.getVariance();
 }
 
 double TimeSeriesData::getCurrentValue()
@@ -1018,48 +1055,15 @@ int TimeSeriesData::getCount() const
  **/
 int TimeSeriesData::getPlotCount() const
 {
-    return plotCount;
-}
-
-/**
- * @brief Get the data array size
- * The data array size is \e NOT equal to the number of items in the data set, as
- * array space is pre-allocated. Use getCount() to get the number of data points.
- *
- * @return The data array size
- * @see getCount()
- **/
-int TimeSeriesData::size() const
-{
-    return ms.size();
+    return static_cast<int>(store.endIndex() - store.windowIndex());
 }
 
 /**
- * @brief Get the X (time) values
+ * @brief Get the memory used by this data set
  *
- * @return The x values
+ * @return The size of the sample chunks in bytes, including the downsampled history
  **/
-const double* TimeSeriesData::getX() const
-{
-    return ms.data();
-}
-
-const double* TimeSeriesData::getPlotX() const
-{
-    return ms.data() + (count - plotCount);
-}
-
-/**
- * @brief Get the Y (data) values
- *
- * @return The y values
- **/
-const double* TimeSeriesData::getY() const
-{
-    return value.data();
-}
-
-const double* TimeSeriesData::getPlotY() const
+qint64 TimeSeriesData::getMemoryUsage() const
 {
-    return value.data() + (count - plotCount);
+    return store.getMemoryUsage();
 }
@@ -36,6 +36,7 @@ This file is part of the PIXHAWK project
 #define QUINT64_MAX Q_UINT64_C(18446744073709551615)
 
 #include <QMap>
+#include <QVector>
 #include <QList>
 #include <QMutex>
 #include <QTime>
@@ -49,6 +50,9 @@ This file is part of the PIXHAWK project
 #include <qwt_plot.h>
 #include <ScrollZoomer.h>
 #include "MG.h"
+#include "QGCRollingStatistics.h"
+#include "QGCSeriesStore.h"
+#include "QGCSeriesPlotData.h"
 
 class TimeScaleDraw: public QwtScaleDraw
 {
@@ -115,13 +119,22 @@ public:
     QwtScaleMap* getScaleMap();
 
     int getCount() const;
-    int size() const;
-    const double* getX() const;
-    const double* getY() const;
+    /** @brief Get the memory used by the samples in bytes */
+    qint64 getMemoryUsage() const;
 
-    const double* getPlotX() const;
-    const double* getPlotY() const;
+    /** @brief Get the time of a sample in the plot window */
+    double getPlotX(int i) const {
+        return store.time(store.windowIndex() + i);
+    }
+    /** @brief Get the value of a sample in the plot window */
+    double getPlotY(int i) const {
+        return store.value(store.windowIndex() + i);
+    }
     int getPlotCount() const;
+    /** @brief Get the sample storage, including the downsampled history */
+    const QGCSeriesStore& getStore() const {
+        return store;
+    }
 
     int getID();
     QString getFriendlyName();
@@ -136,6 +149,10 @@ public:
     double getVariance();
     /** @brief Get the current value */
     double getCurrentValue();
+    /** @brief Get the timestamp of the last appended sample */
+    quint64 getLastUpdate() const {
+        return lastUpdate;
+    }
     void setZeroValue(double zeroValue);
     void setInterval(quint64 ms);
     void setAverageWindowSize(int windowSize);
@@ -148,10 +165,10 @@ protected:
     quint64 plotInterval;
     quint64 maxInterval;
     int id;
-    quint64 plotCount;
     QString friendlyName;
 
     double lastValue; ///< The last inserted value
+    quint64 lastUpdate; ///< The timestamp of the last inserted value
     double minValue;  ///< The smallest value in the dataset
     double maxValue;  ///< The largest value in the dataset
     double zeroValue; ///< The expected value in the dataset
@@ -164,20 +181,10 @@ protected:
 
 private:
     quint64 count;
-    QwtArray<double> ms;
-    QwtArray<double> value;
-    double mean;
-    double median;
-    double variance;
-    unsigned int averageWindow;
-    QwtArray<double> outputMs;
-    QwtArray<double> outputValue;
+    QGCSeriesStore store; ///< Samples in fixed size chunks within the global memory budget
+    QGCRollingStatistics statistics; ///< Short-term mean, median and variance
 };
 
-
-
-
-
 /**
  * @brief Time series plot
  **/
@@ -193,6 +200,24 @@ public:
 
     QList<QwtPlotCurve*> getCurves();
     bool isVisible(QString id);
+    /** @brief Check if the curve with the given handle is visible */
+    bool isVisible(int handle);
+    /**
+     * @brief Get the handle of a curve, creating the curve if it doesn't exist yet
+     *
+     * Handles are small integers which stay valid until the curve is removed and
+     * are never reused, so appending through a handle needs no string lookup.
+     */
+    int getCurveHandle(const QString& id);
+    /** @brief Get the handle of an existing curve, -1 if there is no such curve */
+    int findCurveHandle(const QString& id);
+    /**
+     * @brief Append data to the curve with the given handle
+     *
+     * @return false if the handle doesn't refer to a curve (anymore), in this
+     *         case the caller has to get a new handle by name
+     */
+    bool appendData(int handle, quint64 ms, double value);
     /** @brief Check if any curve is visible */
     bool anyCurveVisible();
 
@@ -215,6 +240,8 @@ public:
     double getVariance(QString id);
     /** @brief Get the last inserted value */
     double getCurrentValue(QString id);
+    /** @brief Get the memory used by the samples of a curve in bytes */
+    qint64 getMemoryUsage(QString id);
 
     static const int SCALE_ABSOLUTE = 0;
     static const int SCALE_BEST_FIT = 1;
@@ -286,15 +313,16 @@ public slots:
 protected:
     QMap<QString, QwtPlotCurve*> curves;
     QMap<QString, TimeSeriesData*> data;
-    QMap<QString, QwtScaleMap*> scaleMaps;
-    QMap<QString, quint64> lastUpdate;
+    QMap<QString, int> handles;             ///< Curve handles by id, only used for UI operations
+    QVector<TimeSeriesData*> handleData;    ///< Datasets by curve handle, NULL once removed
+    QVector<QwtPlotCurve*> handleCurves;    ///< Curves by curve handle, NULL once removed
     ScrollZoomer* zoomer;
 
     QList<QColor> colors;
     int nextColor;
 
     //static const quint64 MAX_STORAGE_INTERVAL = Q_UINT64_C(300000);
-    static const quint64 MAX_STORAGE_INTERVAL = Q_UINT64_C(0);  ///< The maximum interval which is stored
+    static const quint64 MAX_STORAGE_INTERVAL = Q_UINT64_C(0);  ///< The maximum interval stored at full resolution, 0 leaves it to the memory budget
     // TODO CHECK THIS!!!
     int scaling;
     QwtScaleEngine* yScaleEngine;
@@ -324,7 +352,9 @@ protected:
     QTimer timeoutTimer;
 
     // Methods
-    void addCurve(QString id);
+    int addCurve(QString id);
+    /** @brief Delete a curve and its data and invalidate its handle */
+    void deleteCurve(const QString& id);
     QColor getNextColor();
     void showEvent(QShowEvent* event);
     void hideEvent(QHideEvent* event);
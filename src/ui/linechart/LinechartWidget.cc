@@ -43,11 +43,14 @@ This file is part of the PIXHAWK project
 #include <QColor>
 #include <QPalette>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QDesktopServices>
 #include <QMessageBox>
 
 #include "LinechartWidget.h"
 #include "LinechartPlot.h"
+#include "QGCSeriesStore.h"
+#include "MAVLinkChannelRegistry.h"
 #include "LogCompressor.h"
 #include "MainWindow.h"
 #include "QGC.h"
@@ -67,7 +70,9 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     curveMedians(new QMap<QString, QLabel*>()),
     curveVariances(new QMap<QString, QLabel*>()),
     curveMenu(new QMenu(this)),
-    logFile(new QFile()),
+    recorder(new QGCSampleRecorder(this)),
+    logSession(0),
+    logFill(false),
     logindex(1),
     logging(false),
     logStartTime(0),
@@ -93,8 +98,9 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     curvesWidgetLayout->setColumnStretch(3, 50);
     curvesWidgetLayout->setColumnStretch(4, 50);
     curvesWidgetLayout->setColumnStretch(5, 50);
-//    horizontalLayout->setColumnStretch(median, 50);
     curvesWidgetLayout->setColumnStretch(6, 50);
+    curvesWidgetLayout->setColumnStretch(7, 50);
+    curvesWidgetLayout->setColumnStretch(8, 30);
 
     curvesWidget->setLayout(curvesWidgetLayout);
 
@@ -102,6 +108,7 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     QLabel* label;
     QLabel* value;
     QLabel* mean;
+    QLabel* median;
     QLabel* variance;
 
     connect(ui.recolorButton, SIGNAL(clicked()), this, SLOT(recolor()));
@@ -130,10 +137,20 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
     mean->setText("Mean");
     curvesWidgetLayout->addWidget(mean, labelRow, 5);
 
+    // Median
+    median = new QLabel(this);
+    median->setText("Median");
+    curvesWidgetLayout->addWidget(median, labelRow, 6);
+
     // Variance
     variance = new QLabel(this);
     variance->setText("Variance");
-    curvesWidgetLayout->addWidget(variance, labelRow, 6);
+    curvesWidgetLayout->addWidget(variance, labelRow, 7);
+
+    // Memory
+    label = new QLabel(this);
+    label->setText("Memory");
+    curvesWidgetLayout->addWidget(label, labelRow, 8);
 
     // Add and customize plot elements (right side)
 
@@ -146,6 +163,10 @@ LinechartWidget::LinechartWidget(int systemid, QWidget *parent) : QWidget(parent
 
     updateTimer->setInterval(updateInterval);
     connect(updateTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    connect(recorder, SIGNAL(exported(QString)), this, SLOT(compressLog(QString)));
+    connect(recorder, SIGNAL(exportFailed(QString)), this, SLOT(exportFailed(QString)));
+    connect(recorder, SIGNAL(writeFailed(QString)), this, SLOT(recordingFailed(QString)));
+    connect(recorder, SIGNAL(valuesDroppedOnClose(QString,int,int)), this, SLOT(showDroppedValues(QString,int,int)));
     readSettings();
 }
 
@@ -174,6 +195,7 @@ void LinechartWidget::writeSettings()
     if (timeButton) settings.setValue("ENFORCE_GROUNDTIME", timeButton->isChecked());
     if (unitsCheckBox) settings.setValue("SHOW_UNITS", unitsCheckBox->isChecked());
     if (ui.shortNameCheckBox) settings.setValue("SHORT_NAMES", ui.shortNameCheckBox->isChecked());
+    settings.setValue("MEMORY_BUDGET_MB", QGCSeriesMemoryBudget::instance()->getBudget() / (1024 * 1024));
     settings.endGroup();
     settings.sync();
 }
@@ -190,6 +212,9 @@ void LinechartWidget::readSettings()
     }
     if (unitsCheckBox) unitsCheckBox->setChecked(settings.value("SHOW_UNITS", unitsCheckBox->isChecked()).toBool());
     if (ui.shortNameCheckBox) ui.shortNameCheckBox->setChecked(settings.value("SHORT_NAMES", ui.shortNameCheckBox->isChecked()).toBool());
+    // The budget is shared by the linecharts of all systems
+    qint64 budget = settings.value("MEMORY_BUDGET_MB", QGCSeriesMemoryBudget::instance()->getBudget() / (1024 * 1024)).toLongLong();
+    if (budget > 0) QGCSeriesMemoryBudget::instance()->setBudget(budget * 1024 * 1024);
     settings.endGroup();
 }
 
@@ -213,7 +238,7 @@ void LinechartWidget::createLayout()
     //    activePlot = getPlot(0);
     //    plotContainer->setPlot(activePlot);
 
-    layout->addWidget(activePlot, 0, 0, 1, 6);
+    layout->addWidget(activePlot, 0, 0, 1, 7);
     layout->setRowStretch(0, 10);
     layout->setRowStretch(1, 1);
 
@@ -274,6 +299,12 @@ void LinechartWidget::createLayout()
     layout->addWidget(unitsCheckBox, 1, 5);
     connect(unitsCheckBox, SIGNAL(clicked()), this, SLOT(writeSettings()));
 
+    // Memory of the curve data
+    memoryLabel = new QLabel(this);
+    memoryLabel->setToolTip(tr("Memory used by the curve data of all plots. Old data is downsampled when the budget is reached."));
+    memoryLabel->setWhatsThis(tr("Memory used by the curve data of all plots. Old data is downsampled when the budget is reached."));
+    layout->addWidget(memoryLabel, 1, 6);
+
     ui.diagramGroupBox->setLayout(layout);
 
     // Add actions
@@ -326,106 +357,181 @@ void LinechartWidget::appendData(int uasId, const QString& curve, const QString&
 
 void LinechartWidget::appendData(int uasId, const QString& curve, const QString& unit, qint64 value, quint64 usec)
 {
-    if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
-    {
-        // Order matters here, first append to plot, then update curve list
-        activePlot->appendData(curve+unit, usec, value);
-        // Store data
-        QLabel* label = curveLabels->value(curve+unit, NULL);
-        // Make sure the curve will be created if it does not yet exist
-        if(!label)
-        {
-            intData.insert(curve+unit, 0);
-            addCurve(curve, unit);
-        }
-
-        // Add int data
-        intData.insert(curve+unit, value);
-    }
+    int handle = appendValue(uasId, curve, unit, value, usec);
+    if (handle >= 0) setIntData(handle, value);
 
     // Log data
     if (logging)
     {
-        if (activePlot->isVisible(curve+unit))
+        if (activePlot->isVisible(activePlot->findCurveHandle(curve+unit)))
         {
-            if (usec == 0) usec = QGC::groundTimeMilliseconds();
-            if (logStartTime == 0) logStartTime = usec;
-            qint64 time = usec - logStartTime;
-            if (time < 0) time = 0;
-
-            logFile->write(QString(QString::number(time) + "\t" + QString::number(uasId) + "\t" + curve + "\t" + QString::number(value) + "\n").toLatin1());
-            logFile->flush();
+            recorder->record(getLogChannel(uasId, curve, QGCSampleRecorder::INTEGER), getLogTime(usec), value);
         }
     }
 }
 
 void LinechartWidget::appendData(int uasId, const QString& curve, const QString& unit, quint64 value, quint64 usec)
 {
-    if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
+    int handle = appendValue(uasId, curve, unit, value, usec);
+    if (handle >= 0) setIntData(handle, value);
+
+    // Log data
+    if (logging)
     {
-        // Order matters here, first append to plot, then update curve list
-        activePlot->appendData(curve+unit, usec, value);
-        // Store data
-        QLabel* label = curveLabels->value(curve+unit, NULL);
-        // Make sure the curve will be created if it does not yet exist
-        if(!label)
+        if (activePlot->isVisible(activePlot->findCurveHandle(curve+unit)))
         {
-            intData.insert(curve+unit, 0);
-            addCurve(curve, unit);
+            recorder->record(getLogChannel(uasId, curve, QGCSampleRecorder::UNSIGNED), getLogTime(usec), value);
         }
-
-        // Add int data
-        intData.insert(curve+unit, value);
     }
+}
+
+void LinechartWidget::appendData(int uasId, const QString& curve, const QString& unit, double value, quint64 usec)
+{
+    appendValue(uasId, curve, unit, value, usec);
 
     // Log data
     if (logging)
     {
-        if (activePlot->isVisible(curve+unit))
+        if (activePlot->isVisible(activePlot->findCurveHandle(curve+unit)))
         {
-            if (usec == 0) usec = QGC::groundTimeMilliseconds();
-            if (logStartTime == 0) logStartTime = usec;
-            qint64 time = usec - logStartTime;
-            if (time < 0) time = 0;
-
-            logFile->write(QString(QString::number(time) + "\t" + QString::number(uasId) + "\t" + curve + "\t" + QString::number(value) + "\n").toLatin1());
-            logFile->flush();
+            recorder->record(getLogChannel(uasId, curve, QGCSampleRecorder::DOUBLE), getLogTime(usec), value);
         }
     }
 }
 
-void LinechartWidget::appendData(int uasId, const QString& curve, const QString& unit, double value, quint64 usec)
+/**
+ * The names of a channel are copied once from the registry, afterwards the
+ * values go to the plot by curve handle without any string operation.
+ */
+void LinechartWidget::appendSamples(QGCSampleBlock samples)
 {
-    if ((selectedMAV == -1 && isVisible()) || (selectedMAV == uasId && isVisible()))
+    const bool visible = isVisible();
+
+    for (int i = 0; i < samples.size(); ++i)
     {
-        // Order matters here, first append to plot, then update curve list
-        activePlot->appendData(curve+unit, usec, value);
-        // Store data
-        QLabel* label = curveLabels->value(curve+unit, NULL);
-        // Make sure the curve will be created if it does not yet exist
-        if(!label)
+        const QGCSample& sample = samples.at(i);
+        if (sample.channel < 0) continue;
+        if (sample.channel >= channels.size()) channels.resize(sample.channel + 1);
+        Channel& channel = channels[sample.channel];
+        if (!channel.known)
         {
-            //qDebug() << "ADDING CURVE IN APPENDDATE DOUBLE";
-            addCurve(curve, unit);
+            MAVLinkChannelRegistry* registry = MAVLinkChannelRegistry::instance();
+            channel.known = true;
+            channel.integer = (sample.type != QGCSample::DOUBLE);
+            channel.uasId = registry->getUASId(sample.channel);
+            channel.curve = registry->getName(sample.channel);
+            channel.unit = registry->getUnit(sample.channel);
         }
-    }
 
-    // Log data
-    if (logging)
-    {
-        if (activePlot->isVisible(curve+unit))
+        if (visible && (selectedMAV == -1 || selectedMAV == channel.uasId))
         {
-            if (usec == 0) usec = QGC::groundTimeMilliseconds();
-            if (logStartTime == 0) logStartTime = usec;
-            qint64 time = usec - logStartTime;
-            if (time < 0) time = 0;
+            if (!activePlot->appendData(channel.handle, sample.time, sample.toDouble()))
+            {
+                // First value or the curve has been removed, take the slow path once
+                channel.handle = appendValue(channel.uasId, channel.curve, channel.unit, sample.toDouble(), sample.time);
+            }
+            if (channel.integer)
+            {
+                setIntData(channel.handle, (sample.type == QGCSample::UINT64) ? static_cast<qint64>(sample.value.u) : sample.value.i);
+            }
+        }
 
-            logFile->write(QString(QString::number(time) + "\t" + QString::number(uasId) + "\t" + curve + "\t" + QString::number(value,'g',18) + "\n").toLatin1());
-            logFile->flush();
+        // Log data
+        if (logging)
+        {
+            int handle = (channel.handle >= 0) ? channel.handle : activePlot->findCurveHandle(channel.curve+channel.unit);
+            if (activePlot->isVisible(handle))
+            {
+                QGCSampleRecorder::Type type;
+                switch (sample.type)
+                {
+                case QGCSample::DOUBLE:
+                    type = QGCSampleRecorder::DOUBLE;
+                    break;
+                case QGCSample::UINT8:
+                case QGCSample::UINT16:
+                case QGCSample::UINT32:
+                case QGCSample::UINT64:
+                    type = QGCSampleRecorder::UNSIGNED;
+                    break;
+                default:
+                    type = QGCSampleRecorder::INTEGER;
+                    break;
+                }
+                // The channel is added to each recording once
+                if (channel.logSession != logSession)
+                {
+                    channel.logChannel = recorder->addChannel(channel.uasId, channel.curve, type);
+                    if (channel.logChannel >= 0) channel.logSession = logSession;
+                }
+                if (type == QGCSampleRecorder::DOUBLE)
+                {
+                    recorder->record(channel.logChannel, getLogTime(sample.time), sample.value.d);
+                }
+                else if (type == QGCSampleRecorder::UNSIGNED)
+                {
+                    recorder->record(channel.logChannel, getLogTime(sample.time), sample.value.u);
+                }
+                else
+                {
+                    recorder->record(channel.logChannel, getLogTime(sample.time), sample.value.i);
+                }
+            }
         }
     }
 }
 
+int LinechartWidget::appendValue(int uasId, const QString& curve, const QString& unit, double value, quint64 usec)
+{
+    if (!isVisible() || (selectedMAV != -1 && selectedMAV != uasId)) return -1;
+
+    // Order matters here, first append to plot, then update curve list
+    int handle = activePlot->getCurveHandle(curve+unit);
+    activePlot->appendData(handle, usec, value);
+    // Make sure the curve will be created if it does not yet exist
+    if (!curveLabels->contains(curve+unit))
+    {
+        addCurve(curve, unit);
+    }
+    return handle;
+}
+
+void LinechartWidget::setIntData(int handle, qint64 value)
+{
+    if (handle < 0) return;
+    if (handle >= intData.size())
+    {
+        intData.resize(handle + 1);
+        intCurves.resize(handle + 1);
+    }
+    intData[handle] = value;
+    intCurves[handle] = true;
+}
+
+/**
+ * @return The recorder channel, -1 if the recorder could not take it
+ */
+int LinechartWidget::getLogChannel(int uasId, const QString& curve, QGCSampleRecorder::Type type)
+{
+    QString key = QString::number(uasId) + "\t" + QString::number(type) + "\t" + curve;
+    int channel = logChannels.value(key, -1);
+    if (channel < 0)
+    {
+        channel = recorder->addChannel(uasId, curve, type);
+        if (channel >= 0) logChannels.insert(key, channel);
+    }
+    return channel;
+}
+
+quint64 LinechartWidget::getLogTime(quint64 usec)
+{
+    if (usec == 0) usec = QGC::groundTimeMilliseconds();
+    if (logStartTime == 0) logStartTime = usec;
+    qint64 time = usec - logStartTime;
+    if (time < 0) time = 0;
+    return time;
+}
+
 void LinechartWidget::refresh()
 {
     setUpdatesEnabled(false);
@@ -433,8 +539,9 @@ void LinechartWidget::refresh()
     // Value
     QMap<QString, QLabel*>::iterator i;
     for (i = curveLabels->begin(); i != curveLabels->end(); ++i) {
-        if (intData.contains(i.key())) {
-            str.sprintf("% 11i", intData.value(i.key()));
+        int handle = activePlot->findCurveHandle(i.key());
+        if (handle >= 0 && handle < intCurves.size() && intCurves[handle]) {
+            str.sprintf("% 11lli", intData[handle]);
         } else {
             double val = activePlot->getCurrentValue(i.key());
             int intval = static_cast<int>(val);
@@ -467,19 +574,36 @@ void LinechartWidget::refresh()
         }
         j.value()->setText(str);
     }
-//    QMap<QString, QLabel*>::iterator k;
-//    for (k = curveMedians->begin(); k != curveMedians->end(); ++k)
-//    {
-//        // Median
-//        str.sprintf("%+.2f", activePlot->getMedian(k.key()));
-//        k.value()->setText(str);
-//    }
+    QMap<QString, QLabel*>::iterator k;
+    for (k = curveMedians->begin(); k != curveMedians->end(); ++k) {
+        // Median
+        double val = activePlot->getMedian(k.key());
+        int intval = static_cast<int>(val);
+        if (intval >= 100000 || intval <= -100000) {
+            str.sprintf("% 11i", intval);
+        } else if (intval >= 10000 || intval <= -10000) {
+            str.sprintf("% 11.2f", val);
+        } else if (intval >= 1000 || intval <= -1000) {
+            str.sprintf("% 11.4f", val);
+        } else {
+            str.sprintf("% 11.6f", val);
+        }
+        k.value()->setText(str);
+    }
     QMap<QString, QLabel*>::iterator l;
     for (l = curveVariances->begin(); l != curveVariances->end(); ++l) {
         // Variance
         str.sprintf("% 8.3e", activePlot->getVariance(l.key()));
         l.value()->setText(str);
     }
+    QMap<QString, QLabel*>::iterator m;
+    for (m = curveMemory.begin(); m != curveMemory.end(); ++m) {
+        // Memory
+        str.sprintf("% 7.1f kB", activePlot->getMemoryUsage(m.key()) / 1024.0);
+        m.value()->setText(str);
+    }
+    QGCSeriesMemoryBudget* budget = QGCSeriesMemoryBudget::instance();
+    memoryLabel->setText(tr("%1 of %2 MB").arg(budget->getUsed() / (1024.0 * 1024.0), 0, 'f', 1).arg(budget->getBudget() / (1024 * 1024)));
     setUpdatesEnabled(true);
 }
 
@@ -526,8 +650,12 @@ void LinechartWidget::startLogging()
 
     // Check if the user did not abort the file save dialog
     if (!abort && fileName != "") {
-        logFile = new QFile(fileName);
-        if (logFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
+        // Record in the background next to the text log, it is exported once logging stops
+        QFileInfo info(fileName);
+        if (recorder->open(info.absolutePath() + "/" + info.completeBaseName() + ".qgcrec")) {
+            logFileName = fileName;
+            logChannels.clear();
+            logSession++;
             logging = true;
             logStartTime = 0;
             curvesWidget->setEnabled(false);
@@ -543,14 +671,7 @@ void LinechartWidget::stopLogging()
 {
     logging = false;
     curvesWidget->setEnabled(true);
-    if (logFile->isOpen()) {
-        logFile->flush();
-        logFile->close();
-        // Postprocess log file
-        compressor = new LogCompressor(logFile->fileName(), logFile->fileName());
-        connect(compressor, SIGNAL(finishedFile(QString)), this, SIGNAL(logfileWritten(QString)));
-        connect(compressor, SIGNAL(logProcessingStatusChanged(QString)), MainWindow::instance(), SLOT(showStatusMessage(QString)));
-
+    if (recorder->isOpen()) {
         QMessageBox msgBox;
         msgBox.setIcon(QMessageBox::Question);
         msgBox.setText(tr("Starting Log Compression"));
@@ -558,23 +679,71 @@ void LinechartWidget::stopLogging()
         msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
         msgBox.setDefaultButton(QMessageBox::No);
         int ret = msgBox.exec();
-        bool fill;
         if (ret == QMessageBox::Yes)
         {
-            fill = true;
+            logFill = true;
         }
         else
         {
-            fill = false;
+            logFill = false;
         }
 
-        compressor->startCompression(fill);
+        // Export the recording to the text log in the background, compressLog() continues
+        recorder->close(logFileName);
     }
     logButton->setText(tr("Start logging"));
     disconnect(logButton, SIGNAL(clicked()), this, SLOT(stopLogging()));
     connect(logButton, SIGNAL(clicked()), this, SLOT(startLogging()));
 }
 
+/**
+ * Called once the recording has been exported to the text log
+ *
+ * @param fileName The exported text log
+ */
+void LinechartWidget::compressLog(const QString& fileName)
+{
+    // Postprocess log file
+    compressor = new LogCompressor(fileName, fileName);
+    connect(compressor, SIGNAL(finishedFile(QString)), this, SIGNAL(logfileWritten(QString)));
+    connect(compressor, SIGNAL(logProcessingStatusChanged(QString)), MainWindow::instance(), SLOT(showStatusMessage(QString)));
+    compressor->startCompression(logFill);
+}
+
+/**
+ * The recorder accepts no further values, so logging is stopped without
+ * exporting the incomplete recording.
+ *
+ * @param fileName The recording which could not be written
+ */
+void LinechartWidget::recordingFailed(const QString& fileName)
+{
+    if (logging)
+    {
+        recorder->close();
+        stopLogging();
+    }
+    MainWindow::instance()->showCriticalMessage(tr("Logging stopped"), tr("Could not write the recording %1, check the free disk space.").arg(fileName));
+}
+
+/**
+ * @param fileName The text log which could not be written
+ */
+void LinechartWidget::exportFailed(const QString& fileName)
+{
+    MainWindow::instance()->showCriticalMessage(tr("Log export failed"), tr("Could not export the recording to %1.").arg(fileName));
+}
+
+/**
+ * @param fileName The recording
+ * @param dropped Number of values which were not logged
+ * @param total Number of values which were logged or dropped
+ */
+void LinechartWidget::showDroppedValues(const QString& fileName, int dropped, int total)
+{
+    MainWindow::instance()->showStatusMessage(tr("Logging could not keep up, %1 of %2 values are missing in %3").arg(dropped).arg(total).arg(QFileInfo(fileName).fileName()));
+}
+
 /**
  * The average window size defines the width of the sliding average
  * filter. It also defines the width of the sliding median filter.
@@ -607,6 +776,7 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     QLabel* value;
     QLabel* unitLabel;
     QLabel* mean;
+    QLabel* median;
     QLabel* variance;
 
     curveNames.insert(curve+unit, curve);
@@ -671,11 +841,14 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     curveMeans->insert(curve+unit, mean);
     curvesWidgetLayout->addWidget(mean, labelRow, 5);
 
-//    // Median
-//    median = new QLabel(form);
-//    value->setNum(0.00);
-//    curveMedians->insert(curve, median);
-//    horizontalLayout->addWidget(median);
+    // Median
+    median = new QLabel(this);
+    median->setNum(0.00);
+    median->setStyleSheet(QString("QLabel {font-family:\"Courier\"; font-weight: bold;}"));
+    median->setToolTip(tr("Median of %1 in %2 units").arg(curve, unit));
+    median->setWhatsThis(tr("Median of %1 in %2 units").arg(curve, unit));
+    curveMedians->insert(curve+unit, median);
+    curvesWidgetLayout->addWidget(median, labelRow, 6);
 
     // Variance
     variance = new QLabel(this);
@@ -684,7 +857,15 @@ void LinechartWidget::addCurve(const QString& curve, const QString& unit)
     variance->setToolTip(tr("Variance of %1 in (%2)^2 units").arg(curve, unit));
     variance->setWhatsThis(tr("Variance of %1 in (%2)^2 units").arg(curve, unit));
     curveVariances->insert(curve+unit, variance);
-    curvesWidgetLayout->addWidget(variance, labelRow, 6);
+    curvesWidgetLayout->addWidget(variance, labelRow, 7);
+
+    // Memory
+    QLabel* memory = new QLabel(this);
+    memory->setStyleSheet(QString("QLabel {font-family:\"Courier\";}"));
+    memory->setToolTip(tr("Memory used by the samples of %1, including the downsampled history").arg(curve));
+    memory->setWhatsThis(tr("Memory used by the samples of %1, including the downsampled history").arg(curve));
+    curveMemory.insert(curve+unit, memory);
+    curvesWidgetLayout->addWidget(memory, labelRow, 8);
 
     /* Color picker
     QColor color = QColorDialog::getColor(Qt::green, this);
@@ -734,10 +915,12 @@ void LinechartWidget::removeCurve(QString curve)
     widget = curveVariances->take(curve);
     curvesWidgetLayout->removeWidget(widget);
     widget->deleteLater();
+    widget = curveMemory.take(curve);
+    curvesWidgetLayout->removeWidget(widget);
+    widget->deleteLater();
 //    widget = colorIcons->take(curve);
 //    curvesWidgetLayout->removeWidget(colorIcons->take(curve));
     widget->deleteLater();
-//    intData->remove(curve);
 }
 
 void LinechartWidget::recolor()
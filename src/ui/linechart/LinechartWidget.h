@@ -40,6 +40,8 @@ This file is part of the PIXHAWK project
 #include <QScrollBar>
 #include <QSpinBox>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QString>
 #include <QAction>
 #include <QIcon>
@@ -51,6 +53,8 @@ This file is part of the PIXHAWK project
 
 #include "LinechartPlot.h"
 #include "UASInterface.h"
+#include "QGCSampleBlock.h"
+#include "QGCSampleRecorder.h"
 #include "ui_Linechart.h"
 
 #include "LogCompressor.h"
@@ -95,6 +99,8 @@ public slots:
     void appendData(int uasId, const QString& curve, const QString& unit, quint64 value, quint64 usec);
     /** @brief Append double data to the given curve. */
     void appendData(int uasId, const QString& curve, const QString& unit, double value, quint64 usec);
+    /** @brief Append a block of samples, the curves are found by channel ID */
+    void appendSamples(QGCSampleBlock samples);
 	
     void takeButtonClick(bool checked);
     void setPlotWindowPosition(int scrollBarValue);
@@ -116,6 +122,14 @@ public slots:
     void startLogging();
     /** @brief Stop logging to file */
     void stopLogging();
+    /** @brief Compress the text log exported from the recording */
+    void compressLog(const QString& fileName);
+    /** @brief Stop logging after the recording could not be written */
+    void recordingFailed(const QString& fileName);
+    /** @brief Report a recording which could not be exported to the text log */
+    void exportFailed(const QString& fileName);
+    /** @brief Report the values which were not logged */
+    void showDroppedValues(const QString& fileName, int dropped, int total);
     /** @brief Refresh the view */
     void refresh();
     /** @brief Write the current configuration to disk */
@@ -133,6 +147,18 @@ protected:
     void createLayout();
     /** @brief Get the name for a curve key */
     QString getCurveName(const QString& key, bool shortEnabled);
+    /**
+     * @brief Append a value to the plot and create the curve if necessary
+     *
+     * @return The handle of the curve, -1 if the value was not accepted
+     */
+    int appendValue(int uasId, const QString& curve, const QString& unit, double value, quint64 usec);
+    /** @brief Store the current value of an integer-valued curve */
+    void setIntData(int handle, qint64 value);
+    /** @brief Get the recorder channel of a curve, added to the recording if necessary */
+    int getLogChannel(int uasId, const QString& curve, QGCSampleRecorder::Type type);
+    /** @brief Get the log timestamp, relative to the first logged value */
+    quint64 getLogTime(quint64 usec);
 
     int sysid;                            ///< ID of the unmanned system this plot belongs to
     LinechartPlot* activePlot;            ///< Plot for this system
@@ -148,7 +174,24 @@ protected:
     QMap<QString, QLabel*>* curveMeans;   ///< References to the curve means
     QMap<QString, QLabel*>* curveMedians; ///< References to the curve medians
     QMap<QString, QLabel*>* curveVariances; ///< References to the curve variances
-    QMap<QString, int> intData;           ///< Current values for integer-valued curves
+    QMap<QString, QLabel*> curveMemory;   ///< References to the curve memory usage labels
+    QVector<qint64> intData;              ///< Current values of integer-valued curves, by curve handle
+    QVector<bool> intCurves;              ///< True for integer-valued curves, by curve handle
+
+    /** @brief Curve of a channel, resolved once from the registry */
+    struct Channel
+    {
+        Channel() : known(false), integer(false), uasId(-1), handle(-1), logChannel(-1), logSession(0) {}
+        bool known;
+        bool integer;
+        int uasId;
+        int handle;                       ///< Curve handle of the plot, -1 until the first value
+        int logChannel;                   ///< Channel of the recorder
+        int logSession;                   ///< Recording the log channel belongs to
+        QString curve;
+        QString unit;
+    };
+    QVector<Channel> channels;            ///< Curves by channel ID of MAVLinkChannelRegistry
     QMap<QString, QWidget*> colorIcons;    ///< Reference to color icons
 
     QWidget* curvesWidget;                ///< The QWidget containing the curve selection button
@@ -168,8 +211,13 @@ protected:
     QToolButton* logButton;
     QPointer<QCheckBox> unitsCheckBox;
     QPointer<QCheckBox> timeButton;
+    QLabel* memoryLabel;                  ///< Memory of all linecharts compared to the budget
 
-    QFile* logFile;
+    QGCSampleRecorder* recorder;          ///< Records the logged values in the background
+    QString logFileName;                  ///< Text file the recording is exported to
+    QHash<QString, int> logChannels;      ///< Recorder channels of the single value slots
+    int logSession;                       ///< Counts the recordings, 0 before the first one
+    bool logFill;                         ///< Fill holes when compressing the exported log
     unsigned int logindex;
     bool logging;
     quint64 logStartTime;
@@ -4,12 +4,16 @@
 #include "UASManager.h"
 
 #include "MainWindow.h"
+#include "MAVLinkDecoder.h"
+#include "QGCSampleAdapter.h"
 
 Linecharts::Linecharts(QWidget *parent) :
     QStackedWidget(parent),
     plots(),
-    active(true)
+    active(true),
+    subscribed(false)
 {
+    qRegisterMetaType<QGCSampleBlock>("QGCSampleBlock");
     this->setVisible(false);
     // Get current MAV list
     QList<UASInterface*> systems = UASManager::instance()->getUASList();
@@ -40,6 +44,7 @@ void Linecharts::showEvent(QShowEvent* event)
             chart->setActive(true);
         }
     }
+    setSubscribed(true);
     QWidget::showEvent(event);
     emit visibilityChanged(true);
 }
@@ -57,6 +62,7 @@ void Linecharts::hideEvent(QHideEvent* event)
             chart->setActive(false);
         }
     }
+    setSubscribed(false);
     QWidget::hideEvent(event);
     emit visibilityChanged(false);
 }
@@ -104,6 +110,11 @@ void Linecharts::addSystem(UASInterface* uas)
 		connect(uas, SIGNAL(valueChanged(int,QString,QString,quint64,quint64)), widget, SLOT(appendData(int,QString,QString,quint64,quint64)));
 		connect(uas, SIGNAL(valueChanged(int,QString,QString,qint64,quint64)), widget, SLOT(appendData(int,QString,QString,qint64,quint64)));
 		connect(uas, SIGNAL(valueChanged(int,QString,QString,double,quint64)), widget, SLOT(appendData(int,QString,QString,double,quint64)));
+        // Connect values sent in blocks, they are appended through curve handles
+        if (QGCSampleAdapter::hasSamples(uas))
+        {
+            connect(uas, SIGNAL(samplesReady(QGCSampleBlock)), widget, SLOT(appendSamples(QGCSampleBlock)));
+        }
 
         connect(widget, SIGNAL(logfileWritten(QString)), this, SIGNAL(logfileWritten(QString)));
         // Set system active if this is the only system
@@ -115,6 +126,11 @@ void Linecharts::addSystem(UASInterface* uas)
                 // Connect generic sources
                 for (int i = 0; i < genericSources.count(); ++i)
                 {
+                    if (QGCSampleAdapter::hasSamples(genericSources[i]))
+                    {
+                        connect(genericSources[i], SIGNAL(samplesReady(QGCSampleBlock)), plots.values().first(), SLOT(appendSamples(QGCSampleBlock)));
+                    }
+                    if (!QGCSampleAdapter::hasValues(genericSources[i])) continue;
 					connect(genericSources[i], SIGNAL(valueChanged(int,QString,QString,quint8,quint64)), plots.values().first(), SLOT(appendData(int,QString,QString,quint8,quint64)));
 					connect(genericSources[i], SIGNAL(valueChanged(int,QString,QString,qint8,quint64)), plots.values().first(), SLOT(appendData(int,QString,QString,qint8,quint64)));
 					connect(genericSources[i], SIGNAL(valueChanged(int,QString,QString,quint16,quint64)), plots.values().first(), SLOT(appendData(int,QString,QString,quint16,quint64)));
@@ -132,11 +148,40 @@ void Linecharts::addSystem(UASInterface* uas)
     }
 }
 
+/**
+ * The plots offer every field they receive, so they request all of them,
+ * but only while they are shown.
+ */
+void Linecharts::setSubscribed(bool subscribe)
+{
+    if (subscribe == subscribed) return;
+    subscribed = subscribe;
+    foreach (QObject* source, genericSources)
+    {
+        MAVLinkDecoder* decoder = qobject_cast<MAVLinkDecoder*>(source);
+        if (!decoder) continue;
+        if (subscribe)
+        {
+            decoder->subscribe("*");
+        }
+        else
+        {
+            decoder->unsubscribe("*");
+        }
+    }
+}
+
 void Linecharts::addSource(QObject* obj)
 {
     genericSources.append(obj);
+    MAVLinkDecoder* decoder = qobject_cast<MAVLinkDecoder*>(obj);
+    if (decoder && subscribed) decoder->subscribe("*");
     // FIXME XXX HACK
-    if (plots.size() > 0)
+    if (plots.size() > 0 && QGCSampleAdapter::hasSamples(obj))
+    {
+        connect(obj, SIGNAL(samplesReady(QGCSampleBlock)), plots.values().first(), SLOT(appendSamples(QGCSampleBlock)));
+    }
+    if (plots.size() > 0 && QGCSampleAdapter::hasValues(obj))
     {
         // Connect generic source
         connect(obj, SIGNAL(valueChanged(int,QString,QString,quint8,quint64)), plots.values().first(), SLOT(appendData(int,QString,QString,quint8,quint64)));
@@ -32,6 +32,9 @@ protected:
     QMap<int, LinechartWidget*> plots;
     QVector<QObject*> genericSources;
     bool active;
+    bool subscribed;    ///< True while all decoder fields are requested
+    /** @brief Request all decoder fields while the plots are visible */
+    void setSubscribed(bool subscribe);
     /** @brief Start updating widget */
     void showEvent(QShowEvent* event);
     /** @brief Stop updating widget */
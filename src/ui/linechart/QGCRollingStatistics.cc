@@ -0,0 +1,202 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the sliding window statistics
+ *
+ */
+
+#include <qnumeric.h>
+
+#include "QGCRollingStatistics.h"
+
+QGCRollingQuantile::QGCRollingQuantile(double quantile) :
+    quantile(qBound(0.0, quantile, 1.0)),
+    lowerCount(0),
+    upperCount(0)
+{
+}
+
+void QGCRollingQuantile::insert(QMap<double, int>& map, double value)
+{
+    map[value]++;
+}
+
+void QGCRollingQuantile::take(QMap<double, int>& map, double value)
+{
+    QMap<double, int>::iterator it = map.find(value);
+    if (it == map.end()) return;
+    if (--it.value() == 0) map.erase(it);
+}
+
+void QGCRollingQuantile::add(double value)
+{
+    if (lowerCount > 0 && value <= (lower.end() - 1).key())
+    {
+        insert(lower, value);
+        lowerCount++;
+    }
+    else
+    {
+        insert(upper, value);
+        upperCount++;
+    }
+    balance();
+}
+
+void QGCRollingQuantile::remove(double value)
+{
+    if (lower.contains(value))
+    {
+        take(lower, value);
+        lowerCount--;
+    }
+    else if (upper.contains(value))
+    {
+        take(upper, value);
+        upperCount--;
+    }
+    balance();
+}
+
+void QGCRollingQuantile::clear()
+{
+    lower.clear();
+    upper.clear();
+    lowerCount = 0;
+    upperCount = 0;
+}
+
+void QGCRollingQuantile::balance()
+{
+    const int n = lowerCount + upperCount;
+    // The lower half ends with the rank just below the quantile position
+    const int target = (n > 0) ? static_cast<int>(quantile * (n - 1)) + 1 : 0;
+
+    while (lowerCount > target)
+    {
+        QMap<double, int>::iterator last = lower.end() - 1;
+        double value = last.key();
+        if (--last.value() == 0) lower.erase(last);
+        lowerCount--;
+        insert(upper, value);
+        upperCount++;
+    }
+    while (lowerCount < target)
+    {
+        QMap<double, int>::iterator first = upper.begin();
+        double value = first.key();
+        if (--first.value() == 0) upper.erase(first);
+        upperCount--;
+        insert(lower, value);
+        lowerCount++;
+    }
+}
+
+double QGCRollingQuantile::getValue() const
+{
+    const int n = lowerCount + upperCount;
+    if (n == 0) return 0.0;
+
+    const double position = quantile * (n - 1);
+    const double fraction = position - static_cast<int>(position);
+    const double below = (lower.constEnd() - 1).key();
+    if (fraction <= 0.0 || upperCount == 0) return below;
+    return below + fraction * (upper.constBegin().key() - below);
+}
+
+QGCRollingStatistics::QGCRollingStatistics(int windowSize) :
+    window(qMax(1, windowSize)),
+    next(0),
+    n(0),
+    replaced(0),
+    mean(0.0),
+    m2(0.0),
+    median(0.5)
+{
+}
+
+void QGCRollingStatistics::append(double value)
+{
+    // A single invalid sample would spoil the running sums for good
+    if (!qIsFinite(value)) return;
+
+    const int size = window.size();
+    if (n < size)
+    {
+        // Window still filling, plain Welford update
+        n++;
+        const double delta = value - mean;
+        mean += delta / n;
+        m2 += delta * (value - mean);
+    }
+    else
+    {
+        // Replace the oldest sample in one step
+        const double old = window[next];
+        const double oldMean = mean;
+        mean += (value - old) / n;
+        m2 += (value - old) * (value - mean + old - oldMean);
+        // Rounding must not make the variance negative
+        if (m2 < 0.0) m2 = 0.0;
+        median.remove(old);
+        replaced++;
+    }
+    median.add(value);
+
+    window[next] = value;
+    next = (next + 1) % size;
+
+    // Drop the rounding errors of the updates once per window
+    if (replaced >= size) recompute();
+}
+
+void QGCRollingStatistics::recompute()
+{
+    // The ring is full here, so every slot holds a sample of the window
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) sum += window[i];
+    mean = sum / n;
+
+    double squares = 0.0;
+    for (int i = 0; i < n; i++) squares += (window[i] - mean) * (window[i] - mean);
+    m2 = squares;
+    replaced = 0;
+}
+
+void QGCRollingStatistics::setWindowSize(int windowSize)
+{
+    window.resize(qMax(1, windowSize));
+    clear();
+}
+
+void QGCRollingStatistics::clear()
+{
+    next = 0;
+    n = 0;
+    replaced = 0;
+    mean = 0.0;
+    m2 = 0.0;
+    median.clear();
+}
@@ -0,0 +1,134 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Sliding window statistics for the linechart
+ *
+ */
+
+#ifndef QGCROLLINGSTATISTICS_H
+#define QGCROLLINGSTATISTICS_H
+
+#include <QVector>
+#include <QMap>
+
+/**
+ * @brief Quantile of the last samples of a series
+ *
+ * The window is split into two sorted halves: the lower one holds the
+ * samples up to the quantile, the upper one the rest. Both are kept as
+ * value -> count maps, so adding or removing a sample and moving the border
+ * element between the halves costs O(log w). The quantile is read from the
+ * border elements in constant time and interpolated linearly between the
+ * two closest ranks, so the median of an even window is the mean of the
+ * two middle values.
+ */
+class QGCRollingQuantile
+{
+public:
+    QGCRollingQuantile(double quantile = 0.5);
+
+    /** @brief Add a sample to the window */
+    void add(double value);
+    /** @brief Remove a sample which was added before */
+    void remove(double value);
+    void clear();
+
+    /** @brief Get the quantile of the samples in the window, 0 if empty */
+    double getValue() const;
+    double getQuantile() const {
+        return quantile;
+    }
+    int count() const {
+        return lowerCount + upperCount;
+    }
+
+protected:
+    /** @brief Move border elements until the lower half has the target size */
+    void balance();
+
+    static void insert(QMap<double, int>& map, double value);
+    static void take(QMap<double, int>& map, double value);
+
+    double quantile;
+    QMap<double, int> lower;    ///< Samples up to the quantile
+    QMap<double, int> upper;    ///< Samples above the quantile
+    int lowerCount;
+    int upperCount;
+};
+
+/**
+ * @brief Mean, variance and median of the last samples of a series
+ *
+ * The samples of the window are kept in a ring. Mean and variance are
+ * updated with Welford's method for each sample entering and leaving the
+ * window, the median by QGCRollingQuantile. Appending a sample therefore
+ * costs O(1) for mean and variance and O(log w) for the median, instead of
+ * iterating over the whole window. Rounding errors of the updates would add
+ * up over time, so mean and variance are recomputed from the ring each time
+ * the whole window has been replaced, which keeps the amortized cost O(1).
+ */
+class QGCRollingStatistics
+{
+public:
+    QGCRollingStatistics(int windowSize = 50);
+
+    /** @brief Append a sample, the oldest one leaves a full window, NaN and inf are ignored */
+    void append(double value);
+    /** @brief Change the window size, this clears the window */
+    void setWindowSize(int windowSize);
+    int getWindowSize() const {
+        return window.size();
+    }
+    void clear();
+
+    /** @brief Get the number of samples in the window */
+    int count() const {
+        return n;
+    }
+    double getMean() const {
+        return mean;
+    }
+    /** @brief Get the population variance of the window */
+    double getVariance() const {
+        return (n > 0) ? m2 / n : 0.0;
+    }
+    double getMedian() const {
+        return median.getValue();
+    }
+
+protected:
+    /** @brief Recompute mean and variance from the samples in the ring */
+    void recompute();
+
+    QVector<double> window;     ///< Ring of the samples in the window
+    int next;                   ///< Ring index of the next sample
+    int n;                      ///< Number of samples in the window
+    int replaced;               ///< Samples replaced since the last recompute
+    double mean;
+    double m2;                  ///< Sum of squared differences from the mean
+    QGCRollingQuantile median;
+};
+
+#endif // QGCROLLINGSTATISTICS_H
@@ -0,0 +1,469 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of class QGCSampleRecorder
+ *
+ */
+
+#include <limits.h>
+#include <QtEndian>
+#include <QList>
+
+#include "QGCSampleRecorder.h"
+
+const int QGCSampleRecorder::headerLength;
+const quint32 QGCSampleRecorder::formatVersion;
+const int QGCSampleRecorder::blockSize;
+
+/** @brief Tags of the records following the file header */
+enum QGCSampleRecordTag {
+    CHANNEL_RECORD = 1, ///< channel, system, type, name length, name
+    BLOCK_RECORD = 2    ///< channel, count, count timestamps, count values
+};
+
+namespace
+{
+/** @brief Read position of one channel while exporting */
+struct ExportCursor
+{
+    ExportCursor() : type(QGCSampleRecorder::DOUBLE), block(0), index(0) {}
+    QByteArray prefix;       ///< System and name, already separated
+    int type;                ///< Value type of the channel
+    QList<qint64> blocks;    ///< Offsets of the block data in the file
+    int block;               ///< Next block to load
+    int index;               ///< Current value in the loaded block
+    QVector<quint64> times;
+    QVector<quint64> values;
+};
+
+/** @brief Load the next block of a channel, false once all blocks are read */
+bool loadBlock(QFile& file, ExportCursor& cursor)
+{
+    while (cursor.block < cursor.blocks.size())
+    {
+        file.seek(cursor.blocks.at(cursor.block++));
+        quint32 count;
+        if (file.read(reinterpret_cast<char*>(&count), sizeof(count)) != sizeof(count)) return false;
+        cursor.times.resize(count);
+        cursor.values.resize(count);
+        const qint64 length = count * sizeof(quint64);
+        if (file.read(reinterpret_cast<char*>(cursor.times.data()), length) != length) return false;
+        if (file.read(reinterpret_cast<char*>(cursor.values.data()), length) != length) return false;
+        cursor.index = 0;
+        if (count > 0) return true;
+    }
+    return false;
+}
+
+/** @brief Order of the channels in the export heap, by time and then by channel */
+bool exportBefore(const QVector<ExportCursor>& cursors, int a, int b)
+{
+    const quint64 ta = cursors.at(a).times.at(cursors.at(a).index);
+    const quint64 tb = cursors.at(b).times.at(cursors.at(b).index);
+    return (ta < tb) || (ta == tb && a < b);
+}
+
+/** @brief Restore the heap order below the given position */
+void exportSiftDown(const QVector<ExportCursor>& cursors, QVector<int>& heap, int pos)
+{
+    const int size = heap.size();
+    while (true)
+    {
+        int smallest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        if (left < size && exportBefore(cursors, heap[left], heap[smallest])) smallest = left;
+        if (right < size && exportBefore(cursors, heap[right], heap[smallest])) smallest = right;
+        if (smallest == pos) return;
+        qSwap(heap[pos], heap[smallest]);
+        pos = smallest;
+    }
+}
+}
+
+QGCSampleRecorder::QGCSampleRecorder(QObject* parent) :
+    QThread(parent),
+    ring(ringSize),
+    accepting(false),
+    wakeupPending(0),
+    running(false),
+    failed(false),
+    channelCount(0),
+    valuesRecorded(0),
+    valuesDropped(0),
+    bytesWritten(0)
+{
+}
+
+QGCSampleRecorder::~QGCSampleRecorder()
+{
+    close();
+    wait();
+}
+
+QByteArray QGCSampleRecorder::fileHeader()
+{
+    QByteArray header("QGCSMPLS", 8);
+    uchar version[4];
+    qToLittleEndian<quint32>(formatVersion, version);
+    header.append(reinterpret_cast<const char*>(version), sizeof(version));
+    header.append(QByteArray(headerLength - header.size(), '\0'));
+    return header;
+}
+
+/**
+ * An existing file is replaced. If the previous recording is still being
+ * exported, this waits for the export to finish.
+ *
+ * @param fileName The file to record to
+ * @return True if the file could be created
+ */
+bool QGCSampleRecorder::open(const QString& fileName)
+{
+    close();
+    wait();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+    if (file.write(fileHeader()) != headerLength)
+    {
+        file.close();
+        return false;
+    }
+
+    columns.clear();
+    output.clear();
+    exportName.clear();
+    channelCount = 0;
+    valuesRecorded = 0;
+    valuesDropped = 0;
+    bytesWritten = headerLength;
+    failed = false;
+    running = true;
+    wakeupPending.fetchAndStoreRelease(0);
+    start(QThread::LowPriority);
+    accepting = true;
+    return true;
+}
+
+/**
+ * Returns immediately. The writer thread commits the queued values, writes
+ * the incomplete blocks, closes the file and exports it if requested.
+ */
+void QGCSampleRecorder::close(const QString& exportFileName)
+{
+    if (!accepting) return;
+    accepting = false;
+    exportName = exportFileName;
+    running = false;
+    wakeup.release();
+}
+
+/**
+ * The dictionary entry travels through the same queue as the values, so it
+ * is always written before the first block of the channel.
+ */
+int QGCSampleRecorder::addChannel(int uasId, const QString& name, Type type)
+{
+    if (!accepting || failed) return -1;
+
+    QByteArray utf8 = name.toUtf8();
+    Entry entry;
+    entry.channel = -1 - channelCount;
+    entry.length = utf8.size();
+    entry.time = static_cast<quint64>(static_cast<qint64>(uasId));
+    entry.value = type;
+
+    QByteArray data(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    data.append(utf8);
+    if (ring.space() < data.size()) return -1;
+    ring.write(data.constData(), data.size());
+    return channelCount++;
+}
+
+/**
+ * Copies the value into the queue. This never blocks, if the writer does
+ * not keep up the value is dropped and counted.
+ */
+bool QGCSampleRecorder::queue(int channel, quint64 time, quint64 value)
+{
+    if (!accepting || failed || channel < 0 || channel >= channelCount) return false;
+
+    const int space = ring.space();
+    if (space < static_cast<int>(sizeof(Entry)))
+    {
+        valuesDropped++;
+        return false;
+    }
+
+    Entry entry;
+    entry.channel = channel;
+    entry.length = 0;
+    entry.time = time;
+    entry.value = value;
+    ring.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    valuesRecorded++;
+
+    // Only wake up the writer early if the queue is filling up
+    if (ring.capacity() - space > ring.capacity() / 2 && wakeupPending.testAndSetOrdered(0, 1))
+    {
+        wakeup.release();
+    }
+    return true;
+}
+
+/**
+ * @return False if the file could not be written
+ */
+bool QGCSampleRecorder::commit()
+{
+    Entry entry;
+    while (ring.read(reinterpret_cast<char*>(&entry), sizeof(entry)) == sizeof(entry))
+    {
+        if (entry.channel < 0)
+        {
+            // Dictionary entry, the name follows in the queue
+            const quint32 channel = -1 - entry.channel;
+            QByteArray name(entry.length, '\0');
+            ring.read(name.data(), entry.length);
+            if (static_cast<int>(channel) >= columns.size()) columns.resize(channel + 1);
+
+            quint32 record[5];
+            record[0] = CHANNEL_RECORD;
+            record[1] = channel;
+            record[2] = static_cast<quint32>(entry.time);
+            record[3] = static_cast<quint32>(entry.value);
+            record[4] = entry.length;
+            output.append(reinterpret_cast<const char*>(record), sizeof(record));
+            output.append(name);
+        }
+        else
+        {
+            Column& column = columns[entry.channel];
+            column.times[column.count] = entry.time;
+            column.values[column.count] = entry.value;
+            if (++column.count == blockSize) writeBlock(entry.channel);
+        }
+        if (output.size() >= flushSize) flush();
+    }
+    flush();
+    return !failed;
+}
+
+void QGCSampleRecorder::writeBlock(int channel)
+{
+    Column& column = columns[channel];
+    if (column.count == 0) return;
+
+    quint32 record[3];
+    record[0] = BLOCK_RECORD;
+    record[1] = channel;
+    record[2] = column.count;
+    output.append(reinterpret_cast<const char*>(record), sizeof(record));
+    output.append(reinterpret_cast<const char*>(column.times), column.count * sizeof(quint64));
+    output.append(reinterpret_cast<const char*>(column.values), column.count * sizeof(quint64));
+    column.count = 0;
+}
+
+void QGCSampleRecorder::flush()
+{
+    if (output.isEmpty()) return;
+
+    // Keep draining after a failure so the GUI thread never sees a full queue
+    if (!failed)
+    {
+        if (file.write(output) != output.size())
+        {
+            failed = true;
+            emit writeFailed(file.fileName());
+        }
+        else
+        {
+            bytesWritten += output.size();
+        }
+    }
+    output.clear();
+}
+
+void QGCSampleRecorder::run()
+{
+    while (running)
+    {
+        wakeup.tryAcquire(1, commitInterval);
+        wakeupPending.fetchAndStoreRelease(0);
+        commit();
+    }
+    // Commit the values queued before close() was called
+    commit();
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        writeBlock(i);
+    }
+    flush();
+    file.close();
+
+    if (valuesDropped > 0)
+    {
+        emit valuesDroppedOnClose(file.fileName(), static_cast<int>(qMin<quint64>(valuesDropped, INT_MAX)),
+                                  static_cast<int>(qMin<quint64>(valuesRecorded + valuesDropped, INT_MAX)));
+    }
+
+    if (!exportName.isEmpty() && !failed)
+    {
+        if (exportText(file.fileName(), exportName))
+        {
+            emit exported(exportName);
+        }
+        else
+        {
+            emit exportFailed(exportName);
+        }
+    }
+}
+
+/**
+ * The blocks of all channels are merged by time, values with the same
+ * timestamp are ordered by channel.
+ *
+ * @param recordingName The binary recording
+ * @param textName The text file to write
+ * @return False if the recording could not be read or the text file not written
+ */
+bool QGCSampleRecorder::exportText(const QString& recordingName, const QString& textName)
+{
+    QFile in(recordingName);
+    if (!in.open(QIODevice::ReadOnly) || in.read(headerLength) != fileHeader())
+    {
+        return false;
+    }
+
+    // Read the dictionary and locate the blocks, a truncated record ends the recording
+    QVector<ExportCursor> cursors;
+    QVector<bool> known;
+    quint32 record[5];
+    while (in.read(reinterpret_cast<char*>(record), 2 * sizeof(quint32)) == 2 * sizeof(quint32))
+    {
+        const quint32 channel = record[1];
+        if (record[0] == CHANNEL_RECORD)
+        {
+            if (in.read(reinterpret_cast<char*>(record + 2), 3 * sizeof(quint32)) != 3 * sizeof(quint32)) break;
+            QByteArray name = in.read(record[4]);
+            if (name.size() != static_cast<int>(record[4])) break;
+            if (static_cast<int>(channel) >= cursors.size())
+            {
+                cursors.resize(channel + 1);
+                known.resize(channel + 1);
+            }
+            ExportCursor& cursor = cursors[channel];
+            cursor.prefix = "\t" + QByteArray::number(static_cast<qint32>(record[2])) + "\t" + QString::fromUtf8(name).toLatin1() + "\t";
+            cursor.type = record[3];
+            known[channel] = true;
+        }
+        else if (record[0] == BLOCK_RECORD)
+        {
+            const qint64 offset = in.pos();
+            quint32 count;
+            if (in.read(reinterpret_cast<char*>(&count), sizeof(count)) != sizeof(count)) break;
+            const qint64 end = offset + sizeof(count) + 2 * static_cast<qint64>(count) * sizeof(quint64);
+            if (end > in.size()) break;
+            if (static_cast<int>(channel) < cursors.size() && known.at(channel))
+            {
+                cursors[channel].blocks.append(offset);
+            }
+            in.seek(end);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    QFile out(textName);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        return false;
+    }
+
+    // Merge the channels by time
+    QVector<int> heap;
+    for (int i = 0; i < cursors.size(); ++i)
+    {
+        if (loadBlock(in, cursors[i])) heap.append(i);
+    }
+    for (int i = heap.size() / 2 - 1; i >= 0; --i)
+    {
+        exportSiftDown(cursors, heap, i);
+    }
+
+    QByteArray text;
+    bool ok = true;
+    while (!heap.isEmpty())
+    {
+        ExportCursor& cursor = cursors[heap.first()];
+        const quint64 bits = cursor.values.at(cursor.index);
+        text += QByteArray::number(cursor.times.at(cursor.index));
+        text += cursor.prefix;
+        switch (cursor.type)
+        {
+        case INTEGER:
+        {
+            qint64 value;
+            memcpy(&value, &bits, sizeof(value));
+            text += QByteArray::number(value);
+            break;
+        }
+        case UNSIGNED:
+            text += QByteArray::number(bits);
+            break;
+        default:
+        {
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            text += QByteArray::number(value, 'g', 18);
+            break;
+        }
+        }
+        text += '\n';
+
+        if (++cursor.index == cursor.times.size() && !loadBlock(in, cursor))
+        {
+            heap.first() = heap.last();
+            heap.resize(heap.size() - 1);
+        }
+        if (!heap.isEmpty()) exportSiftDown(cursors, heap, 0);
+
+        if (text.size() >= flushSize)
+        {
+            ok = ok && (out.write(text) == text.size());
+            text.clear();
+        }
+    }
+    ok = ok && (out.write(text) == text.size());
+    out.close();
+    return ok;
+}
@@ -0,0 +1,202 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Background recorder of the linechart values
+ *
+ */
+
+#ifndef QGCSAMPLERECORDER_H
+#define QGCSAMPLERECORDER_H
+
+#include <QThread>
+#include <QFile>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QVector>
+#include <QByteArray>
+#include <string.h>
+#include "QGCByteRing.h"
+
+/**
+ * @brief Records plotted values into a compact binary file
+ *
+ * The GUI thread only copies each value into a lock-free ring. A low
+ * priority thread sorts the values into per-channel columns and writes a
+ * column block once it is full, so the file consists of blocks of
+ * timestamps followed by blocks of values.
+ *
+ * The file starts with a 16 byte header (magic and format version). Each
+ * channel is described by a dictionary record with its name, system and
+ * value type ahead of its first block, so a recording which ended
+ * unexpectedly stays readable up to the last complete block.
+ *
+ * exportText() converts a recording into the tab-separated format of the
+ * former text logs (time, system, name, value per line), ordered by time.
+ */
+class QGCSampleRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    /** @brief Value type of a channel, decides how values are printed */
+    enum Type {
+        INTEGER = 0,
+        UNSIGNED = 1,
+        DOUBLE = 2
+    };
+
+    QGCSampleRecorder(QObject* parent = 0);
+    ~QGCSampleRecorder();
+
+    /** @brief Create the recording and start the writer thread */
+    bool open(const QString& fileName);
+    /**
+     * @brief Stop recording, the writer thread finishes the file in the background
+     *
+     * @param exportFileName If not empty, the recording is exported to this text file afterwards
+     */
+    void close(const QString& exportFileName = QString());
+    /** @brief Check if values are currently accepted */
+    bool isOpen() const {
+        return accepting;
+    }
+
+    /**
+     * @brief Add a channel to the dictionary of the recording
+     *
+     * @return The channel ID to record values with, -1 if the recorder is
+     *         closed or its queue is full
+     */
+    int addChannel(int uasId, const QString& name, Type type);
+
+    /** @brief Queue a value of an INTEGER channel */
+    bool record(int channel, quint64 time, qint64 value) {
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return queue(channel, time, bits);
+    }
+    /** @brief Queue a value of an UNSIGNED channel */
+    bool record(int channel, quint64 time, quint64 value) {
+        return queue(channel, time, value);
+    }
+    /** @brief Queue a value of a DOUBLE channel */
+    bool record(int channel, quint64 time, double value) {
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return queue(channel, time, bits);
+    }
+
+    /** @brief Get the number of values queued since the recording was opened */
+    quint64 getValuesRecorded() const {
+        return valuesRecorded;
+    }
+    /** @brief Get the number of values dropped because the queue was full */
+    quint64 getValuesDropped() const {
+        return valuesDropped;
+    }
+    /** @brief Get the number of bytes written to the recording */
+    quint64 getBytesWritten() const {
+        return bytesWritten;
+    }
+    /** @brief Get the number of channels in the dictionary */
+    int getChannelCount() const {
+        return channelCount;
+    }
+
+    /**
+     * @brief Export a recording to the tab-separated text format
+     *
+     * Runs in the calling thread and reads one block per channel at a time.
+     */
+    static bool exportText(const QString& recordingName, const QString& textName);
+    /** @brief Get the file header of a recording */
+    static QByteArray fileHeader();
+
+    static const int headerLength = 16;     ///< Size of the file header in bytes
+    static const quint32 formatVersion = 1; ///< Version stored in the file header
+    static const int blockSize = 512;       ///< Values per column block
+
+signals:
+    /** @brief Writing the recording failed, no further values are accepted */
+    void writeFailed(const QString& fileName);
+    /** @brief The recording has been exported to a text file */
+    void exported(const QString& textName);
+    /** @brief Exporting the recording to a text file failed */
+    void exportFailed(const QString& textName);
+    /** @brief The recording was closed after values were dropped because the queue was full */
+    void valuesDroppedOnClose(const QString& fileName, int dropped, int total);
+
+protected:
+    /** @brief Entry of the queue between the GUI and the writer thread */
+    struct Entry
+    {
+        qint32 channel;   ///< Channel ID, or -1 - ID for a dictionary entry
+        qint32 length;    ///< Length of the name following a dictionary entry
+        quint64 time;     ///< Timestamp, or system ID of a dictionary entry
+        quint64 value;    ///< Value bits, or value type of a dictionary entry
+    };
+
+    /** @brief Values of one channel waiting for a full block */
+    struct Column
+    {
+        Column() : count(0) {}
+        int count;
+        quint64 times[blockSize];
+        quint64 values[blockSize];
+    };
+
+    bool queue(int channel, quint64 time, quint64 value);
+    void run();
+    /** @brief Sort the queued values into the columns, writer thread only */
+    bool commit();
+    /** @brief Write the values of a column as one block, writer thread only */
+    void writeBlock(int channel);
+    /** @brief Write the output buffer to the file, writer thread only */
+    void flush();
+
+    static const int ringSize = 4*1024*1024; ///< Queue size, about 170000 values
+    static const int commitInterval = 200;   ///< Maximum time a value stays queued in ms
+    static const int flushSize = 256*1024;   ///< Output is written in pieces of about this size
+
+    QFile file;                ///< Recording, only accessed by the writer thread while running
+    QGCByteRing ring;          ///< Queued values, written by the GUI thread
+    QSemaphore wakeup;         ///< Wakes up the writer before the commit interval elapsed
+    bool accepting;            ///< Set while values are accepted, GUI thread only
+    QAtomicInt wakeupPending;  ///< Set once the GUI thread requested a wakeup
+    volatile bool running;     ///< False once close() was called
+    volatile bool failed;      ///< Set once writing the file failed
+    int channelCount;          ///< Channels in the dictionary, GUI thread only
+    QString exportName;        ///< Text file to export to after closing
+    QVector<Column> columns;   ///< Values by channel, writer thread only
+    QByteArray output;         ///< Encoded records waiting to be written, writer thread only
+    volatile quint64 valuesRecorded;
+    volatile quint64 valuesDropped;
+    volatile quint64 bytesWritten;
+
+private:
+    Q_DISABLE_COPY(QGCSampleRecorder)
+};
+
+#endif // QGCSAMPLERECORDER_H
@@ -0,0 +1,83 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the level of detail adapter
+ *
+ */
+
+#include <QWidget>
+
+#include "QGCSeriesPlotData.h"
+
+QGCSeriesPlotData::QGCSeriesPlotData(const QGCSeriesStore* store, const QWidget* canvas, int width, bool envelope) :
+    store(store),
+    canvas(canvas),
+    width(width),
+    envelope(envelope),
+    level(-1),
+    from(0),
+    to(0),
+    bucket(0)
+{
+}
+
+QwtData* QGCSeriesPlotData::copy() const
+{
+    return new QGCSeriesPlotData(store, canvas, width, envelope);
+}
+
+size_t QGCSeriesPlotData::size() const
+{
+    from = store->windowIndex();
+    to = store->endIndex();
+    if (to <= from) return 0;
+
+    const int pixels = canvas ? canvas->width() : width;
+    level = envelope ? QGCSeriesStore::envelopeLevel(to - from, pixels) : -1;
+    if (level < 0) return static_cast<size_t>(to - from);
+
+    const int shift = QGCSeriesStore::envelopeShift(level);
+    bucket = from >> shift;
+    return static_cast<size_t>(2 * (((to - 1) >> shift) - bucket + 1));
+}
+
+double QGCSeriesPlotData::x(size_t i) const
+{
+    if (level < 0) return store->time(from + i);
+
+    // Minimum at the start, maximum at the end of the bucket, both within the window
+    const int shift = QGCSeriesStore::envelopeShift(level);
+    const quint64 first = (bucket + i / 2) << shift;
+    if (i % 2 == 0) return store->time(qMax(first, from));
+    return store->time(qMin(first + (Q_UINT64_C(1) << shift) - 1, to - 1));
+}
+
+double QGCSeriesPlotData::y(size_t i) const
+{
+    if (level < 0) return store->value(from + i);
+
+    const quint64 b = bucket + i / 2;
+    return (i % 2 == 0) ? store->envelopeMin(level, b) : store->envelopeMax(level, b);
+}
@@ -0,0 +1,81 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Level of detail adapter between the linechart storage and Qwt
+ *
+ */
+
+#ifndef QGCSERIESPLOTDATA_H
+#define QGCSERIESPLOTDATA_H
+
+#include <qwt_data.h>
+
+#include "QGCSeriesStore.h"
+
+class QWidget;
+
+/**
+ * @brief Plot window of a QGCSeriesStore at the resolution of the canvas
+ *
+ * As long as the plot window holds less than a few samples per pixel, the
+ * samples are passed on as they are. Otherwise the envelope level with at
+ * least one bucket per pixel is drawn as a minimum and a maximum point per
+ * bucket, so a curve never has more than about 16 points per pixel column
+ * and spikes stay visible. The drawing cost is bounded by the canvas width
+ * instead of the number of samples in the window.
+ *
+ * The level is selected in size(), which Qwt calls before reading the
+ * points. Copies refer to the same store, which has to outlive the curve.
+ */
+class QGCSeriesPlotData : public QwtData
+{
+public:
+    /**
+     * @param store The samples, the plot window starts at QGCSeriesStore::windowIndex()
+     * @param canvas Widget whose width is the resolution, e.g. the plot canvas
+     * @param width Resolution in pixels if there is no canvas
+     * @param envelope False to always draw all samples
+     */
+    QGCSeriesPlotData(const QGCSeriesStore* store, const QWidget* canvas, int width = 800, bool envelope = true);
+
+    virtual QwtData* copy() const;
+    virtual size_t size() const;
+    virtual double x(size_t i) const;
+    virtual double y(size_t i) const;
+
+protected:
+    const QGCSeriesStore* store;
+    const QWidget* canvas;
+    int width;
+    bool envelope;
+
+    // Selection of the last call of size()
+    mutable int level;          ///< Envelope level, -1 for the samples
+    mutable quint64 from;       ///< First sample of the window
+    mutable quint64 to;         ///< Sample after the window
+    mutable quint64 bucket;     ///< First bucket of the window
+};
+
+#endif // QGCSERIESPLOTDATA_H
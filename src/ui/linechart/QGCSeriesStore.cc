@@ -0,0 +1,393 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the chunked sample storage
+ *
+ */
+
+#include "QGCSeriesStore.h"
+
+QGCSeriesMemoryBudget* QGCSeriesMemoryBudget::instance()
+{
+    static QGCSeriesMemoryBudget* _instance = 0;
+    if (_instance == 0)
+    {
+        _instance = new QGCSeriesMemoryBudget();
+    }
+    return _instance;
+}
+
+QGCSeriesMemoryBudget::QGCSeriesMemoryBudget() :
+    budget(DEFAULT_BUDGET),
+    used(0),
+    enforcing(false)
+{
+}
+
+void QGCSeriesMemoryBudget::setBudget(qint64 bytes)
+{
+    budget = bytes;
+    enforce();
+}
+
+QGCSeriesChunk* QGCSeriesMemoryBudget::allocate()
+{
+    QGCSeriesChunk* chunk;
+    if (!freeChunks.isEmpty())
+    {
+        chunk = freeChunks.takeLast();
+    }
+    else
+    {
+        chunk = new QGCSeriesChunk;
+    }
+    chunk->count = 0;
+    used++;
+    return chunk;
+}
+
+void QGCSeriesMemoryBudget::release(QGCSeriesChunk* chunk)
+{
+    used--;
+    if (freeChunks.count() < MAX_FREE_CHUNKS)
+    {
+        freeChunks.append(chunk);
+    }
+    else
+    {
+        delete chunk;
+    }
+}
+
+void QGCSeriesMemoryBudget::add(QGCSeriesStore* store)
+{
+    stores.append(store);
+}
+
+void QGCSeriesMemoryBudget::remove(QGCSeriesStore* store)
+{
+    stores.removeAll(store);
+}
+
+void QGCSeriesMemoryBudget::enforce()
+{
+    // Retiring allocates downsampled chunks, which must not recurse
+    if (enforcing) return;
+    enforcing = true;
+
+    while (getUsed() > budget)
+    {
+        // Retire the globally oldest full resolution chunk first
+        QGCSeriesStore* oldest = NULL;
+        foreach (QGCSeriesStore* store, stores)
+        {
+            if (store->canRetire() && (!oldest || store->oldestTime() < oldest->oldestTime()))
+            {
+                oldest = store;
+            }
+        }
+        if (oldest)
+        {
+            oldest->retire();
+            continue;
+        }
+
+        // Only the plot windows are left at full resolution, thin out the history
+        QGCSeriesStore* largest = NULL;
+        foreach (QGCSeriesStore* store, stores)
+        {
+            if (store->coarse.count() > 1 && (!largest || store->coarse.count() > largest->coarse.count()))
+            {
+                largest = store;
+            }
+        }
+        if (!largest || !largest->compact()) break;
+    }
+
+    enforcing = false;
+}
+
+QGCSeriesStore::QGCSeriesStore() :
+    fullCount(0),
+    coarseCount(0),
+    retired(0),
+    bucket(RETIRE_BUCKET),
+    keepFrom(0.0),
+    window(0),
+    pendingCount(0),
+    pendingMinTime(0.0),
+    pendingMin(0.0),
+    pendingMaxTime(0.0),
+    pendingMax(0.0)
+{
+    for (int level = 0; level < ENVELOPE_LEVELS; ++level)
+    {
+        envelope[level].base = 0;
+        envelope[level].end = 0;
+    }
+    QGCSeriesMemoryBudget::instance()->add(this);
+}
+
+QGCSeriesStore::~QGCSeriesStore()
+{
+    clear();
+    QGCSeriesMemoryBudget::instance()->remove(this);
+}
+
+void QGCSeriesStore::clear()
+{
+    QGCSeriesMemoryBudget* budget = QGCSeriesMemoryBudget::instance();
+    foreach (QGCSeriesChunk* chunk, full) budget->release(chunk);
+    foreach (QGCSeriesChunk* chunk, coarse) budget->release(chunk);
+    full.clear();
+    coarse.clear();
+    for (int level = 0; level < ENVELOPE_LEVELS; ++level)
+    {
+        foreach (QGCSeriesChunk* chunk, envelope[level].chunks) budget->release(chunk);
+        envelope[level].chunks.clear();
+        envelope[level].base = 0;
+        envelope[level].end = 0;
+    }
+    fullCount = 0;
+    coarseCount = 0;
+    retired = 0;
+    window = 0;
+    bucket = RETIRE_BUCKET;
+    pendingCount = 0;
+}
+
+void QGCSeriesStore::append(double time, double value)
+{
+    bool allocated = false;
+    if (full.isEmpty() || full.last()->count == QGCSeriesChunk::CAPACITY)
+    {
+        full.append(QGCSeriesMemoryBudget::instance()->allocate());
+        allocated = true;
+    }
+    QGCSeriesChunk* chunk = full.last();
+    chunk->time[chunk->count] = time;
+    chunk->value[chunk->count] = value;
+    chunk->count++;
+    if (appendEnvelope(endIndex(), value)) allocated = true;
+    fullCount++;
+
+    // Only check the budget when a chunk was taken, not per sample
+    if (allocated) QGCSeriesMemoryBudget::instance()->enforce();
+}
+
+bool QGCSeriesStore::appendEnvelope(quint64 index, double value)
+{
+    bool allocated = false;
+    for (int level = 0; level < ENVELOPE_LEVELS; ++level)
+    {
+        Envelope& e = envelope[level];
+        const quint64 bucket = index >> envelopeShift(level);
+        if (bucket == e.end)
+        {
+            // First sample of a new bucket
+            if (e.chunks.isEmpty() || e.chunks.last()->count == QGCSeriesChunk::CAPACITY)
+            {
+                e.chunks.append(QGCSeriesMemoryBudget::instance()->allocate());
+                allocated = true;
+            }
+            QGCSeriesChunk* chunk = e.chunks.last();
+            chunk->min[chunk->count] = value;
+            chunk->max[chunk->count] = value;
+            chunk->count++;
+            e.end++;
+        }
+        else
+        {
+            QGCSeriesChunk* chunk = e.chunks.last();
+            double& min = chunk->min[chunk->count - 1];
+            double& max = chunk->max[chunk->count - 1];
+            if (value < min) min = value;
+            if (value > max) max = value;
+        }
+    }
+    return allocated;
+}
+
+int QGCSeriesStore::envelopeLevel(quint64 count, int width)
+{
+    if (width < 1) width = 1;
+    const quint64 perPixel = count / width;
+    int level = -1;
+    while (level + 1 < ENVELOPE_LEVELS && (Q_UINT64_C(1) << envelopeShift(level + 1)) <= perPixel)
+    {
+        level++;
+    }
+    return level;
+}
+
+qint64 QGCSeriesStore::getMemoryUsage() const
+{
+    int chunks = full.count() + coarse.count();
+    for (int level = 0; level < ENVELOPE_LEVELS; ++level)
+    {
+        chunks += envelope[level].chunks.count();
+    }
+    return static_cast<qint64>(chunks) * sizeof(QGCSeriesChunk);
+}
+
+void QGCSeriesStore::setKeepFrom(double time)
+{
+    keepFrom = time;
+    // The window only moves forward, amortized constant time
+    if (window < retired) window = retired;
+    while (window + 1 < endIndex() && this->time(window) < keepFrom)
+    {
+        window++;
+    }
+}
+
+bool QGCSeriesStore::canRetire() const
+{
+    // The chunk being written stays, as well as everything in the plot window
+    if (full.count() < 2) return false;
+    const QGCSeriesChunk* chunk = full.first();
+    return chunk->time[chunk->count - 1] < keepFrom;
+}
+
+void QGCSeriesStore::retireBefore(double time)
+{
+    while (canRetire() && full.first()->time[QGCSeriesChunk::CAPACITY - 1] < time)
+    {
+        retire();
+    }
+}
+
+void QGCSeriesStore::retire()
+{
+    QGCSeriesChunk* chunk = full.takeFirst();
+    for (int i = 0; i < chunk->count; ++i)
+    {
+        const double t = chunk->time[i];
+        const double v = chunk->value[i];
+        if (pendingCount == 0 || v < pendingMin)
+        {
+            pendingMin = v;
+            pendingMinTime = t;
+        }
+        if (pendingCount == 0 || v > pendingMax)
+        {
+            pendingMax = v;
+            pendingMaxTime = t;
+        }
+        if (++pendingCount == bucket)
+        {
+            appendPair(pendingMinTime, pendingMin, pendingMaxTime, pendingMax);
+            pendingCount = 0;
+        }
+    }
+    fullCount -= chunk->count;
+    retired += chunk->count;
+    QGCSeriesMemoryBudget::instance()->release(chunk);
+
+    // Drop envelope chunks once all their buckets are retired
+    for (int level = 0; level < ENVELOPE_LEVELS; ++level)
+    {
+        Envelope& e = envelope[level];
+        while (e.chunks.count() > 1 && ((e.base + QGCSeriesChunk::CAPACITY) << envelopeShift(level)) <= retired)
+        {
+            QGCSeriesMemoryBudget::instance()->release(e.chunks.takeFirst());
+            e.base += QGCSeriesChunk::CAPACITY;
+        }
+    }
+}
+
+void QGCSeriesStore::appendPair(double minTime, double minValue, double maxTime, double maxValue)
+{
+    if (minTime <= maxTime)
+    {
+        appendDownsampled(minTime, minValue);
+        appendDownsampled(maxTime, maxValue);
+    }
+    else
+    {
+        appendDownsampled(maxTime, maxValue);
+        appendDownsampled(minTime, minValue);
+    }
+}
+
+void QGCSeriesStore::appendDownsampled(double time, double value)
+{
+    if (coarse.isEmpty() || coarse.last()->count == QGCSeriesChunk::CAPACITY)
+    {
+        coarse.append(QGCSeriesMemoryBudget::instance()->allocate());
+    }
+    QGCSeriesChunk* chunk = coarse.last();
+    chunk->time[chunk->count] = time;
+    chunk->value[chunk->count] = value;
+    chunk->count++;
+    coarseCount++;
+}
+
+bool QGCSeriesStore::compact()
+{
+    const int chunksBefore = coarse.count();
+
+    // Merge two neighbouring min/max pairs into one, in place
+    int out = 0;
+    int in = 0;
+    for (; in + 4 <= coarseCount; in += 4)
+    {
+        double minTime = downsampledTime(in), minValue = downsampledValue(in);
+        double maxTime = minTime, maxValue = minValue;
+        for (int j = in + 1; j < in + 4; ++j)
+        {
+            const double v = downsampledValue(j);
+            if (v < minValue) { minValue = v; minTime = downsampledTime(j); }
+            if (v > maxValue) { maxValue = v; maxTime = downsampledTime(j); }
+        }
+        const bool minFirst = (minTime <= maxTime);
+        const int a = out++;
+        const int b = out++;
+        coarse[a / QGCSeriesChunk::CAPACITY]->time[a % QGCSeriesChunk::CAPACITY] = minFirst ? minTime : maxTime;
+        coarse[a / QGCSeriesChunk::CAPACITY]->value[a % QGCSeriesChunk::CAPACITY] = minFirst ? minValue : maxValue;
+        coarse[b / QGCSeriesChunk::CAPACITY]->time[b % QGCSeriesChunk::CAPACITY] = minFirst ? maxTime : minTime;
+        coarse[b / QGCSeriesChunk::CAPACITY]->value[b % QGCSeriesChunk::CAPACITY] = minFirst ? maxValue : minValue;
+    }
+    // An odd pair at the end is kept as it is
+    for (; in < coarseCount; ++in, ++out)
+    {
+        coarse[out / QGCSeriesChunk::CAPACITY]->time[out % QGCSeriesChunk::CAPACITY] = downsampledTime(in);
+        coarse[out / QGCSeriesChunk::CAPACITY]->value[out % QGCSeriesChunk::CAPACITY] = downsampledValue(in);
+    }
+    coarseCount = out;
+    bucket *= 2;
+
+    // Return the chunks which became empty
+    const int chunksAfter = (coarseCount + QGCSeriesChunk::CAPACITY - 1) / QGCSeriesChunk::CAPACITY;
+    while (coarse.count() > chunksAfter)
+    {
+        QGCSeriesMemoryBudget::instance()->release(coarse.takeLast());
+    }
+    for (int i = 0; i < coarse.count(); ++i)
+    {
+        coarse[i]->count = qMin(QGCSeriesChunk::CAPACITY, coarseCount - i * QGCSeriesChunk::CAPACITY);
+    }
+    return coarse.count() < chunksBefore;
+}
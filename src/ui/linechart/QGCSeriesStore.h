@@ -0,0 +1,265 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009 - 2012 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Chunked sample storage of the linechart with a global memory budget
+ *
+ */
+
+#ifndef QGCSERIESSTORE_H
+#define QGCSERIESSTORE_H
+
+#include <QList>
+
+/**
+ * @brief Fixed size block of samples
+ *
+ * Chunks are never resized, full ones are retired as a whole and recycled
+ * through the free list of QGCSeriesMemoryBudget. Sample chunks use time
+ * and value, envelope chunks hold the minimum and maximum of each bucket
+ * in the same memory, so both kinds share the budget and the free list.
+ */
+struct QGCSeriesChunk
+{
+    static const int CAPACITY = 512;
+    int count;
+    union {
+        double time[CAPACITY];
+        double min[CAPACITY];       ///< Envelope chunks only
+    };
+    union {
+        double value[CAPACITY];
+        double max[CAPACITY];       ///< Envelope chunks only
+    };
+};
+
+class QGCSeriesStore;
+
+/**
+ * @brief Memory budget shared by the series of all linecharts
+ *
+ * All chunks are taken from and returned to this budget. When the chunks
+ * in use exceed the budget, the oldest full resolution chunks of all
+ * series are retired into their downsampled tier first. If this is not
+ * enough, the downsampled tiers are compacted further, starting with the
+ * largest one. The samples shown in the plot windows are never retired,
+ * so the memory stays flat at the budget for any flight duration.
+ */
+class QGCSeriesMemoryBudget
+{
+public:
+    static QGCSeriesMemoryBudget* instance();
+
+    /** @brief Set the budget in bytes */
+    void setBudget(qint64 bytes);
+    qint64 getBudget() const {
+        return budget;
+    }
+    /** @brief Get the bytes of all chunks in use */
+    qint64 getUsed() const {
+        return static_cast<qint64>(used) * sizeof(QGCSeriesChunk);
+    }
+
+    /** @brief Take an empty chunk, recycled if possible */
+    QGCSeriesChunk* allocate();
+    /** @brief Return a chunk which is not used any more */
+    void release(QGCSeriesChunk* chunk);
+
+    void add(QGCSeriesStore* store);
+    void remove(QGCSeriesStore* store);
+
+    /** @brief Retire and compact samples until the budget is met again */
+    void enforce();
+
+    static const qint64 DEFAULT_BUDGET = Q_INT64_C(256) * 1024 * 1024;
+
+protected:
+    QGCSeriesMemoryBudget();
+
+    qint64 budget;
+    int used;                           ///< Chunks in use
+    QList<QGCSeriesChunk*> freeChunks;  ///< Recycled chunks, not counted as used
+    QList<QGCSeriesStore*> stores;
+    bool enforcing;
+
+    static const int MAX_FREE_CHUNKS = 64;
+};
+
+/**
+ * @brief Samples of one series in two tiers
+ *
+ * New samples go to the full resolution tier. Retired chunks of it are
+ * reduced to the minimum and maximum of every bucket of samples and
+ * appended to the downsampled tier, so spikes stay visible in the
+ * history. Both tiers are lists of fixed size chunks where only the last
+ * one may be partially filled, so any sample is found in constant time.
+ *
+ * Samples are addressed by absolute indices which keep counting across
+ * retirements, firstIndex() is the oldest sample still at full resolution.
+ *
+ * For drawing, the full resolution tier is summarized by envelope levels:
+ * level k holds the minimum and maximum of every aligned bucket of
+ * 8^(k+1) samples. They are updated on append, so a plot can pick the
+ * level matching its pixel resolution and draw a bounded number of points
+ * for any number of samples without losing spikes.
+ */
+class QGCSeriesStore
+{
+public:
+    QGCSeriesStore();
+    ~QGCSeriesStore();
+
+    void append(double time, double value);
+    void clear();
+
+    /**
+     * @brief Samples at or after this time are never retired
+     *
+     * This is the start of the plot window, windowIndex() follows it.
+     */
+    void setKeepFrom(double time);
+    /** @brief Get the absolute index of the first sample in the plot window */
+    quint64 windowIndex() const {
+        return qMax(window, retired);
+    }
+    /** @brief Search the plot window from the oldest sample again, e.g. after it grew */
+    void resetWindow() {
+        window = retired;
+    }
+    /** @brief Retire all full chunks older than this time, regardless of the budget */
+    void retireBefore(double time);
+
+    /** @brief Get the absolute index of the oldest full resolution sample */
+    quint64 firstIndex() const {
+        return retired;
+    }
+    /** @brief Get the absolute index after the newest sample */
+    quint64 endIndex() const {
+        return retired + fullCount;
+    }
+    double time(quint64 index) const {
+        const int i = static_cast<int>(index - retired);
+        return full.at(i / QGCSeriesChunk::CAPACITY)->time[i % QGCSeriesChunk::CAPACITY];
+    }
+    double value(quint64 index) const {
+        const int i = static_cast<int>(index - retired);
+        return full.at(i / QGCSeriesChunk::CAPACITY)->value[i % QGCSeriesChunk::CAPACITY];
+    }
+
+    /** @brief Get the number of samples in the downsampled tier */
+    int getDownsampledCount() const {
+        return coarseCount;
+    }
+    double downsampledTime(int i) const {
+        return coarse.at(i / QGCSeriesChunk::CAPACITY)->time[i % QGCSeriesChunk::CAPACITY];
+    }
+    double downsampledValue(int i) const {
+        return coarse.at(i / QGCSeriesChunk::CAPACITY)->value[i % QGCSeriesChunk::CAPACITY];
+    }
+    /** @brief Get the number of original samples one downsampled min/max pair stands for */
+    int getDownsampledBucket() const {
+        return bucket;
+    }
+
+    static const int ENVELOPE_LEVELS = 4;
+    /** @brief Get the log2 of the bucket size of an envelope level */
+    static int envelopeShift(int level) {
+        return 3 * (level + 1);
+    }
+    /**
+     * @brief Select the envelope level to draw samples at a resolution
+     *
+     * @param count Number of samples to draw
+     * @param width Number of pixels available for them
+     * @return The coarsest level with at least one bucket per pixel, -1 to draw the samples
+     */
+    static int envelopeLevel(quint64 count, int width);
+    /** @brief Get the minimum of a bucket, bucket is the absolute sample index shifted by envelopeShift() */
+    double envelopeMin(int level, quint64 bucket) const {
+        const Envelope& e = envelope[level];
+        const int i = static_cast<int>(bucket - e.base);
+        return e.chunks.at(i / QGCSeriesChunk::CAPACITY)->min[i % QGCSeriesChunk::CAPACITY];
+    }
+    /** @brief Get the maximum of a bucket */
+    double envelopeMax(int level, quint64 bucket) const {
+        const Envelope& e = envelope[level];
+        const int i = static_cast<int>(bucket - e.base);
+        return e.chunks.at(i / QGCSeriesChunk::CAPACITY)->max[i % QGCSeriesChunk::CAPACITY];
+    }
+
+    /** @brief Get the memory of this series in bytes */
+    qint64 getMemoryUsage() const;
+
+protected:
+    /** @brief Check if the oldest full resolution chunk may be retired */
+    bool canRetire() const;
+    /** @brief Get the time of the oldest full resolution sample */
+    double oldestTime() const {
+        return full.first()->time[0];
+    }
+    /** @brief Move the oldest full resolution chunk to the downsampled tier */
+    void retire();
+    /** @brief Halve the resolution of the downsampled tier, false if nothing was freed */
+    bool compact();
+    /** @brief Append a point to the downsampled tier */
+    void appendDownsampled(double time, double value);
+    /** @brief Append the minimum and maximum in time order */
+    void appendPair(double minTime, double minValue, double maxTime, double maxValue);
+    /** @brief Add a new sample to the envelope levels, true if a chunk was taken */
+    bool appendEnvelope(quint64 index, double value);
+
+    /** @brief Minimum and maximum per bucket, kept in chunk min and max */
+    struct Envelope
+    {
+        QList<QGCSeriesChunk*> chunks;
+        quint64 base;   ///< Bucket of the first entry in chunks
+        quint64 end;    ///< Bucket after the last entry
+    };
+
+    QList<QGCSeriesChunk*> full;    ///< Full resolution tier
+    QList<QGCSeriesChunk*> coarse;  ///< Downsampled tier, min/max pairs in time order
+    int fullCount;                  ///< Samples in the full resolution tier
+    int coarseCount;                ///< Points in the downsampled tier
+    quint64 retired;                ///< Samples moved to the downsampled tier so far
+    int bucket;                     ///< Samples per min/max pair in the downsampled tier
+    double keepFrom;
+    quint64 window;                 ///< First sample at or after keepFrom
+    Envelope envelope[ENVELOPE_LEVELS];
+
+    // Bucket being reduced, retired samples are fed one by one
+    int pendingCount;
+    double pendingMinTime;
+    double pendingMin;
+    double pendingMaxTime;
+    double pendingMax;
+
+    static const int RETIRE_BUCKET = 32;
+
+    friend class QGCSeriesMemoryBudget;
+
+private:
+    Q_DISABLE_COPY(QGCSeriesStore)
+};
+
+#endif // QGCSERIESSTORE_H
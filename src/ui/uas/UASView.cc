@@ -35,6 +35,7 @@ This file is part of the PIXHAWK project
 #include <QInputDialog>
 
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include "UASManager.h"
 #include "UASView.h"
 #include "UASWaypointManager.h"
@@ -72,7 +73,6 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
         selectAirframeAction(new QAction("Choose Airframe", this)),
         setBatterySpecsAction(new QAction("Set Battery Options", this)),
         lowPowerModeEnabled(true),
-        generalUpdateCount(0),
         filterTime(0),
         m_ui(new Ui::UASView)
 {
@@ -88,9 +88,6 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
     connect(uas, SIGNAL(batteryChanged(UASInterface*, double, double, int)), this, SLOT(updateBattery(UASInterface*, double, double, int)));
     connect(uas, SIGNAL(heartbeat(UASInterface*)), this, SLOT(receiveHeartbeat(UASInterface*)));
     connect(uas, SIGNAL(thrustChanged(UASInterface*, double)), this, SLOT(updateThrust(UASInterface*, double)));
-    connect(uas, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateLocalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
-    connect(uas, SIGNAL(speedChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateSpeed(UASInterface*,double,double,double,quint64)));
     connect(uas, SIGNAL(statusChanged(UASInterface*,QString,QString)), this, SLOT(updateState(UASInterface*,QString,QString)));
     connect(uas, SIGNAL(modeChanged(int,QString,QString)), this, SLOT(updateMode(int,QString,QString)));
     connect(uas, SIGNAL(loadChanged(UASInterface*, double)), this, SLOT(updateLoad(UASInterface*, double)));
@@ -140,17 +137,17 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
 
     setBackgroundColor();
 
-    // Heartbeat fade
-    refreshTimer = new QTimer(this);
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+    // Heartbeat fade, only refreshed while something changes
     if (lowPowerModeEnabled)
     {
-        refreshTimer->start(updateInterval*3);
+        refreshInterval = updateInterval*3;
     }
     else
     {
-        refreshTimer->start(updateInterval);
+        refreshInterval = updateInterval;
     }
+    QGCFrameScheduler::instance()->add(this, "refresh", refreshInterval);
+    connect(uas, SIGNAL(telemetryUpdated(UASInterface*)), this, SLOT(markDirty()));
 
     // Hide kill and shutdown buttons per default
     m_ui->killButton->hide();
@@ -173,6 +170,12 @@ UASView::~UASView()
 void UASView::heartbeatTimeout()
 {
     timeout = true;
+    markDirty();
+}
+
+void UASView::markDirty()
+{
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::updateNavMode(int uasid, int mode, const QString& text)
@@ -280,7 +283,7 @@ void UASView::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval*10);
+    markDirty();
 }
 
 void UASView::hideEvent(QHideEvent* event)
@@ -288,7 +291,7 @@ void UASView::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
+    // Hidden views are skipped by the frame scheduler
 }
 
 void UASView::receiveHeartbeat(UASInterface* uas)
@@ -299,6 +302,7 @@ void UASView::receiveHeartbeat(UASInterface* uas)
     m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(heartbeatColor.name()));
     if (timeout) setBackgroundColor();
     timeout = false;
+    markDirty();
 }
 
 void UASView::updateName(const QString& name)
@@ -390,6 +394,15 @@ void UASView::updateSpeed(UASInterface*, double x, double y, double z, quint64 u
     totalSpeed = sqrt(x*x + y*y + z*z);
 }
 
+void UASView::pollTelemetry()
+{
+    // Position and speed arrive far faster than this view refreshes,
+    // so they are read from the snapshot instead of connected
+    const UASTelemetrySnapshot current = uas->getTelemetrySnapshot();
+    current.forwardChanges(telemetry, uas, this, 0, &UASView::updateLocalPosition, &UASView::updateGlobalPosition, &UASView::updateSpeed);
+    telemetry = current;
+}
+
 void UASView::currentWaypointUpdated(quint16 waypoint)
 {
     m_ui->waypointLabel->setText(tr("WP") + QString::number(waypoint));
@@ -424,6 +437,7 @@ void UASView::updateThrust(UASInterface* uas, double thrust)
     if (this->uas == uas)
     {
         this->thrust = thrust;
+        markDirty();
     }
 }
 
@@ -434,6 +448,7 @@ void UASView::updateBattery(UASInterface* uas, double voltage, double percent, i
     {
         timeRemaining = seconds;
         chargeLevel = percent;
+        markDirty();
     }
 }
 
@@ -443,6 +458,7 @@ void UASView::updateState(UASInterface* uas, QString uasState, QString stateDesc
     {
         state = uasState;
         stateDesc = stateDescription;
+        markDirty();
     }
 }
 
@@ -451,6 +467,7 @@ void UASView::updateLoad(UASInterface* uas, double load)
     if (this->uas == uas)
     {
         this->load = load;
+        markDirty();
     }
 }
 
@@ -537,105 +554,102 @@ void UASView::refresh()
     //// qDebug() << "UASVIEW update diff: " << MG::TIME::getGroundTimeNow() - lastupdate;
     lastupdate = QGC::groundTimeMilliseconds();
 
-    if (generalUpdateCount == 4)
-    {
 #if (QGC_EVENTLOOP_DEBUG)
-        // qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
+    // qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
-        generalUpdateCount = 0;
-        //// qDebug() << "UPDATING EVERYTHING";
-        // State
-        m_ui->stateLabel->setText(state);
-        m_ui->statusTextLabel->setText(stateDesc);
-
-        // Battery
-        m_ui->batteryBar->setValue(static_cast<int>(this->chargeLevel));
-        //m_ui->loadBar->setValue(static_cast<int>(this->load));
-        m_ui->thrustBar->setValue(this->thrust);
-
-        // Position
-        // If global position is known, prefer it over local coordinates
+    // The frame scheduler limits the refresh rate, every refresh applies all values
+    pollTelemetry();
+    //// qDebug() << "UPDATING EVERYTHING";
+    // State
+    m_ui->stateLabel->setText(state);
+    m_ui->statusTextLabel->setText(stateDesc);
+
+    // Battery
+    m_ui->batteryBar->setValue(static_cast<int>(this->chargeLevel));
+    //m_ui->loadBar->setValue(static_cast<int>(this->load));
+    m_ui->thrustBar->setValue(this->thrust);
+
+    // Position
+    // If global position is known, prefer it over local coordinates
+
+    if (!globalFrameKnown && localFrame)
+    {
+        QString position;
+        position = position.sprintf("%05.1f %05.1f %06.1f m", x, y, z);
+        m_ui->positionLabel->setText(position);
+    }
 
-        if (!globalFrameKnown && localFrame)
+    if (globalFrameKnown)
+    {
+        QString globalPosition;
+        QString latIndicator;
+        if (lat > 0)
         {
-            QString position;
-            position = position.sprintf("%05.1f %05.1f %06.1f m", x, y, z);
-            m_ui->positionLabel->setText(position);
+            latIndicator = "N";
         }
-
-        if (globalFrameKnown)
+        else
         {
-            QString globalPosition;
-            QString latIndicator;
-            if (lat > 0)
-            {
-                latIndicator = "N";
-            }
-            else
-            {
-                latIndicator = "S";
-            }
-            QString lonIndicator;
-            if (lon > 0)
-            {
-                lonIndicator = "E";
-            }
-            else
-            {
-                lonIndicator = "W";
-            }
-
-            globalPosition = globalPosition.sprintf("%05.1f%s %05.1f%s %06.1f m", lon, lonIndicator.toStdString().c_str(), lat, latIndicator.toStdString().c_str(), alt);
-            m_ui->positionLabel->setText(globalPosition);
+            latIndicator = "S";
         }
-
-        // Altitude
-        if (groundDistance == 0 && alt != 0)
+        QString lonIndicator;
+        if (lon > 0)
         {
-            m_ui->groundDistanceLabel->setText(QString("%1 m").arg(alt, 6, 'f', 1, '0'));
+            lonIndicator = "E";
         }
         else
         {
-            m_ui->groundDistanceLabel->setText(QString("%1 m").arg(groundDistance, 6, 'f', 1, '0'));
+            lonIndicator = "W";
         }
 
-        // Speed
-        QString speed("%1 m/s");
-        m_ui->speedLabel->setText(speed.arg(totalSpeed, 4, 'f', 1, '0'));
+        globalPosition = globalPosition.sprintf("%05.1f%s %05.1f%s %06.1f m", lon, lonIndicator.toStdString().c_str(), lat, latIndicator.toStdString().c_str(), alt);
+        m_ui->positionLabel->setText(globalPosition);
+    }
 
-        // Thrust
-        m_ui->thrustBar->setValue(thrust * 100);
+    // Altitude
+    if (groundDistance == 0 && alt != 0)
+    {
+        m_ui->groundDistanceLabel->setText(QString("%1 m").arg(alt, 6, 'f', 1, '0'));
+    }
+    else
+    {
+        m_ui->groundDistanceLabel->setText(QString("%1 m").arg(groundDistance, 6, 'f', 1, '0'));
+    }
 
-        if(this->timeRemaining > 1 && this->timeRemaining < QGC::MAX_FLIGHT_TIME)
-        {
-            // Filter output to get a higher stability
-            filterTime = static_cast<int>(this->timeRemaining);
-            filterTime = 0.8 * filterTime + 0.2 * static_cast<int>(this->timeRemaining);
-            int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60.0f) * 60);
-            int min = static_cast<int>(filterTime / 60);
-            int hours = static_cast<int>(filterTime - min * 60 - sec);
-
-            QString timeText;
-            timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
-            m_ui->timeRemainingLabel->setText(timeText);
-        }
-        else
-        {
-            m_ui->timeRemainingLabel->setText(tr("Calc.."));
-        }
+    // Speed
+    QString speed("%1 m/s");
+    m_ui->speedLabel->setText(speed.arg(totalSpeed, 4, 'f', 1, '0'));
 
-        // Time Elapsed
-        //QDateTime time = MG::TIME::msecToQDateTime(uas->getUptime());
+    // Thrust
+    m_ui->thrustBar->setValue(thrust * 100);
 
-        quint64 filterTime = uas->getUptime() / 1000;
-        int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60) * 60);
+    if(this->timeRemaining > 1 && this->timeRemaining < QGC::MAX_FLIGHT_TIME)
+    {
+        // Filter output to get a higher stability
+        filterTime = static_cast<int>(this->timeRemaining);
+        filterTime = 0.8 * filterTime + 0.2 * static_cast<int>(this->timeRemaining);
+        int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60.0f) * 60);
         int min = static_cast<int>(filterTime / 60);
         int hours = static_cast<int>(filterTime - min * 60 - sec);
+
         QString timeText;
         timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
-        m_ui->timeElapsedLabel->setText(timeText);
+        m_ui->timeRemainingLabel->setText(timeText);
+    }
+    else
+    {
+        m_ui->timeRemainingLabel->setText(tr("Calc.."));
     }
-    generalUpdateCount++;
+
+    // Time Elapsed
+    //QDateTime time = MG::TIME::msecToQDateTime(uas->getUptime());
+
+    quint64 filterTime = uas->getUptime() / 1000;
+    int sec = static_cast<int>(filterTime - static_cast<int>(filterTime / 60) * 60);
+    int min = static_cast<int>(filterTime / 60);
+    int hours = static_cast<int>(filterTime - min * 60 - sec);
+    QString timeText;
+    timeText = timeText.sprintf("%02d:%02d:%02d", hours, min, sec);
+    m_ui->timeElapsedLabel->setText(timeText);
 
     QString colorstyle("QGroupBox { border-radius: 5px; padding: 2px; margin: 0px; border: 0px; background-color: %1; }");
 
@@ -662,11 +676,12 @@ void UASView::refresh()
             m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(warnColor.name()));
             QString style = QString("QGroupBox { border-radius: 12px; padding: 0px; margin: 0px; border: 2px solid %1; background-color: %2; }").arg(borderColor, warnColor.name());
             m_ui->uasViewFrame->setStyleSheet(style);
-
-            refreshTimer->setInterval(errorUpdateInterval);
-            refreshTimer->start();
         }
         iconIsRed = !iconIsRed;
+
+        // Keep blinking until the heartbeat is back
+        QGCFrameScheduler::instance()->setInterval(this, errorUpdateInterval);
+        markDirty();
     }
     else
     {
@@ -678,9 +693,11 @@ void UASView::refresh()
 
             //m_ui->heartbeatIcon->setAutoFillBackground(true);
             m_ui->heartbeatIcon->setStyleSheet(colorstyle.arg(heartbeatColor.name()));
-            refreshTimer->setInterval(updateInterval);
-            refreshTimer->start();
+
+            // Keep fading until the icon is dark
+            if (heartbeatColor.value() > 0) markDirty();
         }
+        QGCFrameScheduler::instance()->setInterval(this, refreshInterval);
     }
     //setUpdatesEnabled(true);
 
@@ -91,10 +91,12 @@ public slots:
     void showStatusText(int uasid, int componentid, int severity, QString text);
     /** @brief Update the navigation mode state */
     void updateNavMode(int uasid, int mode, const QString& text);
+    /** @brief Refresh the view with the next frame */
+    void markDirty();
 
 protected:
     void changeEvent(QEvent *e);
-    QTimer* refreshTimer;
+    int refreshInterval; ///< Minimum time between two refreshes in milliseconds
     QColor heartbeatColor;
     quint64 startTime;
     bool timeout;
@@ -127,8 +129,11 @@ protected:
     static const int updateInterval = 800;
     static const int errorUpdateInterval = 200;
     bool lowPowerModeEnabled; ///< Low power mode reduces update rates
-    unsigned int generalUpdateCount; ///< Skip counter for updates
     double filterTime; ///< Filter time estimate of battery
+    UASTelemetrySnapshot telemetry; ///< Vehicle state read at the last refresh
+
+    /** @brief Read the position and speed of the vehicle, called on refresh */
+    void pollTelemetry();
 
 
     void mouseDoubleClickEvent (QMouseEvent * event);